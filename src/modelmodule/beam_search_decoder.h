@@ -0,0 +1,150 @@
+#ifndef MODELMODULE_BEAM_SEARCH_DECODER_H_
+#define MODELMODULE_BEAM_SEARCH_DECODER_H_
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include "utils/typedeclaration.h"
+
+namespace slnn{
+
+/**
+ * Beam search decoder for the tag-history (pretag) output layers, whose scores at a time step depend on the previous tag.
+ * At every time step, the scores of all the hypotheses in the beam are built together by `score_func`
+ * (so one graph forward for a step), and normalized by log-softmax here. The hypothesis score is the sum of log probabilities.
+ * Hypotheses with the same last tag are recombined (only the best is kept), because the future scores depend on the last tag only.
+ * beam size 1 is the greedy decoding: the (valid) tag with max score is selected, the smallest tag wins for equal scores.
+ * No computation graph here, buffers are reused between sentences. Not thread safe.
+ */
+class BeamSearchDecoder
+{
+public:
+    using real = slnn::type::real;
+public:
+    explicit BeamSearchDecoder(unsigned beam_size = 1U);
+    void set_beam_size(unsigned beam_size);
+    unsigned get_beam_size() const { return beam_size; }
+    /**
+     * decode.
+     * @param seq_len sequence length
+     * @param tag_num tag number
+     * @param score_func void(std::size_t time_step, const std::vector<Index> &pretag_list, std::vector<real> &score_list),
+     *        pretag_list is the last tag of every hypothesis in the beam (-1 for the start of sequence),
+     *        score_list[out] is the (tag_num x pretag_list.size()) raw score (before softmax), flat index is `tag + tag_num * hypothesis`.
+     * @param is_valid bool(std::size_t time_step, Index pretag, Index tag), tag constraint. pretag is -1 at time step 0.
+     * @param pred_seq[out] the best tag sequence
+     */
+    template <typename ScoreFunc, typename ValidFunc>
+    void decode(std::size_t seq_len, std::size_t tag_num, ScoreFunc score_func, ValidFunc is_valid, std::vector<Index> &pred_seq);
+    template <typename ScoreFunc>
+    void decode(std::size_t seq_len, std::size_t tag_num, ScoreFunc score_func, std::vector<Index> &pred_seq)
+    { decode(seq_len, tag_num, score_func, [](std::size_t, Index, Index){ return true; }, pred_seq); }
+private:
+    struct Candidate
+    {
+        real score;
+        unsigned hypothesis;
+        Index tag;
+    };
+private:
+    unsigned beam_size;
+    std::vector<Index> pretag_list;
+    std::vector<real> hypothesis_score_list;
+    std::vector<real> score_list;
+    std::vector<Candidate> candidate_list;
+    std::vector<char> tag_taken_list;
+    std::vector<Index> tag_buffer; // (seq_len x beam_size), tag of the hypotheses at every time step
+    std::vector<unsigned> backpointer_buffer; // (seq_len x beam_size), hypothesis index at the previous time step
+};
+
+
+/**************************************
+ * Inline Implementation
+ **************************************/
+
+inline
+BeamSearchDecoder::BeamSearchDecoder(unsigned beam_size)
+    :beam_size(std::max(beam_size, 1U))
+{}
+
+inline
+void BeamSearchDecoder::set_beam_size(unsigned beam_size)
+{
+    this->beam_size = std::max(beam_size, 1U);
+}
+
+template <typename ScoreFunc, typename ValidFunc>
+void BeamSearchDecoder::decode(std::size_t seq_len, std::size_t tag_num, ScoreFunc score_func, ValidFunc is_valid,
+    std::vector<Index> &pred_seq)
+{
+    pred_seq.clear();
+    if( seq_len == 0 ){ return; }
+    tag_buffer.resize(seq_len * beam_size);
+    backpointer_buffer.resize(seq_len * beam_size);
+    tag_taken_list.resize(tag_num);
+    pretag_list.assign(1U, -1);
+    hypothesis_score_list.assign(1U, 0.f);
+    for( std::size_t t = 0; t < seq_len; ++t )
+    {
+        std::size_t nr_hypothesis = pretag_list.size();
+        score_func(t, pretag_list, score_list);
+        if( score_list.size() != tag_num * nr_hypothesis )
+        {
+            throw std::invalid_argument("beam search decoder: score size is not equal to tag_num * hypothesis number.");
+        }
+        candidate_list.clear();
+        for( std::size_t h = 0; h < nr_hypothesis; ++h )
+        {
+            const real *score = score_list.data() + h * tag_num;
+            real max_score = *std::max_element(score, score + tag_num),
+                sum_exp = 0.f;
+            for( std::size_t tag = 0; tag < tag_num; ++tag ){ sum_exp += std::exp(score[tag] - max_score); }
+            real log_z = max_score + std::log(sum_exp);
+            for( std::size_t tag = 0; tag < tag_num; ++tag )
+            {
+                if( !is_valid(t, pretag_list[h], static_cast<Index>(tag)) ){ continue; }
+                candidate_list.push_back(Candidate{ hypothesis_score_list[h] + score[tag] - log_z,
+                    static_cast<unsigned>(h), static_cast<Index>(tag) });
+            }
+        }
+        if( candidate_list.empty() )
+        {
+            throw std::runtime_error("beam search decoder: no valid tag at time step " + std::to_string(t) + ".");
+        }
+        // stable, so for equal scores, the former hypothesis and the smaller tag win.
+        std::stable_sort(candidate_list.begin(), candidate_list.end(), [](const Candidate &lhs, const Candidate &rhs)
+        {
+            return lhs.score > rhs.score;
+        });
+        std::fill(tag_taken_list.begin(), tag_taken_list.end(), 0);
+        pretag_list.clear();
+        hypothesis_score_list.clear();
+        for( const Candidate &candidate : candidate_list )
+        {
+            if( tag_taken_list[candidate.tag] ){ continue; } // recombined
+            tag_taken_list[candidate.tag] = 1;
+            std::size_t flat_idx = t * beam_size + pretag_list.size();
+            tag_buffer[flat_idx] = candidate.tag;
+            backpointer_buffer[flat_idx] = candidate.hypothesis;
+            pretag_list.push_back(candidate.tag);
+            hypothesis_score_list.push_back(candidate.score);
+            if( pretag_list.size() == beam_size ){ break; }
+        }
+    }
+    // the best hypothesis is the first one
+    pred_seq.resize(seq_len);
+    unsigned hypothesis = 0;
+    for( std::size_t t = seq_len; t > 0; --t )
+    {
+        std::size_t flat_idx = (t - 1) * beam_size + hypothesis;
+        pred_seq[t - 1] = tag_buffer[flat_idx];
+        hypothesis = backpointer_buffer[flat_idx];
+    }
+}
+
+} // end of namespace slnn
+
+#endif
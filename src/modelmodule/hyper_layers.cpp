@@ -67,26 +67,42 @@ std::vector<std::vector<dynet::expr::Expression>>
 WindowExprGenerateLayer::generate_window_expr_list(const std::vector<dynet::expr::Expression> &unit_exprs)
 {
     unsigned len = unit_exprs.size();
-    std::vector<std::vector<dynet::expr::Expression>> window_expr_list(len);
-    std::deque<dynet::expr::Expression> window_expr(window_sz);
-    // init . generate the first window expr
+    std::vector<std::vector<int>> window_unit_index_list = generate_window_unit_index_list(len, window_sz);
+    std::vector<std::vector<dynet::expr::Expression>> window_expr_list(len, std::vector<dynet::expr::Expression>(window_sz));
+    for( unsigned i = 0; i < len; ++i )
+    {
+        for( unsigned slot = 0; slot < window_sz; ++slot )
+        {
+            int unit_index = window_unit_index_list[i][slot];
+            window_expr_list[i][slot] = unit_index == SosUnitIndex ? sos_expr :
+                unit_index == EosUnitIndex ? eos_expr : unit_exprs[unit_index];
+        }
+    }
+    return window_expr_list;
+}
+
+std::vector<std::vector<int>>
+WindowExprGenerateLayer::generate_window_unit_index_list(unsigned len, unsigned window_sz)
+{
+    std::vector<std::vector<int>> window_unit_index_list(len);
+    if( len == 0 ){ return window_unit_index_list; }
+    std::deque<int> window_unit_index(window_sz);
+    // init . generate the first window
     unsigned half_sz = window_sz / 2;
-    for( unsigned i = 0; i < half_sz; ++i ){ window_expr[i] = sos_expr; }
+    for( unsigned i = 0; i < half_sz; ++i ){ window_unit_index[i] = SosUnitIndex; }
     for( unsigned i = half_sz; i < window_sz; ++i )
     {
-        window_expr[i] = i < len ? unit_exprs[i] : eos_expr;
+        window_unit_index[i] = i < len ? static_cast<int>(i) : EosUnitIndex;
     }
-    // generate window expr list 
-    // TODO: can be optimized -> at range [ 1 -> len - half_sz), no need to jude i + half_sz < len; 
-    window_expr_list[0] = std::vector<dynet::expr::Expression>(window_expr.begin(), window_expr.end());
+    window_unit_index_list[0] = std::vector<int>(window_unit_index.begin(), window_unit_index.end());
     for( unsigned i = 1; i < len; ++i )
     {
         // scroll
-        window_expr.pop_front();
-        window_expr.push_back(i + half_sz < len ? unit_exprs[i + half_sz] : eos_expr);
-        window_expr_list[i] = std::vector<dynet::expr::Expression>(window_expr.begin(), window_expr.end());
+        window_unit_index.pop_front();
+        window_unit_index.push_back(i + half_sz < len ? static_cast<int>(i + half_sz) : EosUnitIndex);
+        window_unit_index_list[i] = std::vector<int>(window_unit_index.begin(), window_unit_index.end());
     }
-    return window_expr_list;
+    return window_unit_index_list;
 }
 
 } // end of namespace slnn
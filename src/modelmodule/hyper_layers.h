@@ -14,6 +14,7 @@ struct Index2ExprLayer
     Index2ExprLayer(dynet::Model *m, unsigned vocab_size, unsigned embedding_dim);
     void new_graph(dynet::ComputationGraph &cg);
     void index_seq2expr_seq(const IndexSeq &indexSeq, std::vector<dynet::expr::Expression> &exprs);
+    void index_seq2expr_seq(const Index *indexSeq, std::size_t sz, std::vector<dynet::expr::Expression> &exprs);
     dynet::expr::Expression index2expr(Index index);
     dynet::LookupParameter  get_lookup_param(){ return lookup_param; }
 protected:
@@ -51,6 +52,17 @@ struct WindowExprGenerateLayer
     WindowExprGenerateLayer(dynet::Model *dynet_model, unsigned window_sz, unsigned embedding_dim);
     void new_graph(dynet::ComputationGraph &cg);
     std::vector<std::vector<dynet::expr::Expression>> generate_window_expr_list(const std::vector<dynet::expr::Expression> &unit_exprs);
+    /**
+     * the unit index in every (position, slot) of the windows that `generate_window_expr_list` builds,
+     * `SosUnitIndex` / `EosUnitIndex` for the padding.
+     * NOTE: the windows are NOT always [i - window_sz/2, i + window_sz/2]. the first window takes units [window_sz/2, window_sz)
+     * and the following ones scroll in unit (i + window_sz/2), so the windows of the first positions are shifted.
+     * trained models depend on this layout, so anything that computes on the windows without building them (e.g. the
+     * precomputation of the mlp segmenter) should take the layout from here.
+     */
+    static std::vector<std::vector<int>> generate_window_unit_index_list(unsigned len, unsigned window_sz);
+    static constexpr int SosUnitIndex = -1;
+    static constexpr int EosUnitIndex = -2;
     // data
     dynet::Parameter sos_param;
     dynet::Parameter eos_param;
@@ -73,9 +85,14 @@ void Index2ExprLayer::new_graph(dynet::ComputationGraph &cg)
 
 inline
 void Index2ExprLayer::index_seq2expr_seq(const IndexSeq &indexSeq, std::vector<dynet::expr::Expression> &exprs)
+{
+    index_seq2expr_seq(indexSeq.data(), indexSeq.size(), exprs);
+}
+
+inline
+void Index2ExprLayer::index_seq2expr_seq(const Index *indexSeq, std::size_t sz, std::vector<dynet::expr::Expression> &exprs)
 {
     using std::swap;
-    size_t sz = indexSeq.size();
     std::vector<dynet::expr::Expression> tmp_exprs(sz);
     for( size_t i = 0; i < sz; ++i )
     {
@@ -34,7 +34,8 @@ PretagOutput::PretagOutput(dynet::Model *m,
     hidden_layer(m , input_dim1 , input_dim2 , tag_embedding_dim , hidden_dim) ,
     output_layer(m , hidden_dim , output_dim) ,
     tag_lookup_param(m->add_lookup_parameters(output_dim , {tag_embedding_dim})) ,
-    TAG_SOS(m->add_parameters({tag_embedding_dim})) 
+    TAG_SOS(m->add_parameters({tag_embedding_dim})) ,
+    tag_num(output_dim)
 {}
 
 PretagOutput::~PretagOutput(){} 
@@ -62,9 +63,9 @@ CRFOutput::build_output_loss(const std::vector<dynet::expr::Expression> &expr_co
     const std::vector<dynet::expr::Expression> &expr_cont2,
     const IndexSeq &gold_seq)
 {
+    viterbi_decoder.clear_score(); // parameters will be updated.
     size_t len = expr_cont1.size() ;
     // viterbi data preparation
-    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
     std::vector<dynet::expr::Expression> init_score(tag_num);
     std::vector<dynet::expr::Expression> trans_score(tag_num * tag_num);
     std::vector<std::vector<dynet::expr::Expression>> emit_score(len,
@@ -72,10 +73,9 @@ CRFOutput::build_output_loss(const std::vector<dynet::expr::Expression> &expr_co
     std::vector<dynet::expr::Expression> cur_score_expr_cont(tag_num),
         pre_score_expr_cont(tag_num);
     std::vector<dynet::expr::Expression> gold_score_expr_cont(len) ;
-    // init tag expr , init score
+    // init score
     for( size_t i = 0; i < tag_num ; ++i )
     {
-        all_tag_expr_cont[i] = dynet::expr::lookup(*pcg, tag_lookup_param, i);
         init_score[i] = dynet::expr::lookup(*pcg, init_score_lookup_param, i);
     }
     // init translation score
@@ -84,15 +84,12 @@ CRFOutput::build_output_loss(const std::vector<dynet::expr::Expression> &expr_co
         trans_score[flat_idx] = lookup(*pcg, trans_score_lookup_param, flat_idx);
     }
     // init emit score
+    dynet::expr::Expression emit_score_expr = build_emit_score_expr(expr_cont1, expr_cont2, true);
     for( size_t time_step = 0; time_step < len; ++time_step )
     {
         for( size_t i = 0; i < tag_num; ++i )
         {
-            dynet::expr::Expression hidden_out_expr = hidden_layer.build_graph(expr_cont1[time_step],
-                expr_cont2[time_step], all_tag_expr_cont[i]);
-            dynet::expr::Expression non_linear_expr = (*nonlinear_func)(hidden_out_expr) ;
-            dynet::expr::Expression dropout_expr = dropout(non_linear_expr, dropout_rate) ;
-            emit_score[time_step][i] = emit_layer.build_graph(dropout_expr);
+            emit_score[time_step][i] = dynet::expr::pick(emit_score_expr, i + tag_num * time_step);
         }
     }
     // viterbi docoding
@@ -139,83 +136,55 @@ void CRFOutput::build_output(const std::vector<dynet::expr::Expression> &expr_co
     IndexSeq &pred_seq)
 {
     size_t len = expr_cont1.size() ;
-    // viterbi data preparation
-    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
+    if( len == 0 ){ pred_seq.clear(); return; }
+    if( !viterbi_decoder.has_score() ){ set_decoder_score(); }
+    // all the emit score in one fetch, flat index of emit score: tag + tag_num * time_step
+    std::vector<dynet::real> emit_score = dynet::as_vector(pcg->get_value(
+        build_emit_score_expr(expr_cont1, expr_cont2, false)));
+    viterbi_decoder.decode(emit_score.data(), len, pred_seq);
+}
+
+void CRFOutput::set_decoder_score()
+{
     std::vector<dynet::real> init_score(tag_num);
-    std::vector < dynet::real> trans_score(tag_num * tag_num);
-    std::vector<std::vector<dynet::real>> emit_score(len, std::vector<dynet::real>(tag_num));
-    // get initial score
+    std::vector<dynet::real> trans_score(tag_num * tag_num);
     for( size_t i = 0 ; i < tag_num ; ++i )
     {
-        dynet::expr::Expression init_score_expr = dynet::expr::lookup(*pcg, init_score_lookup_param, i);
-        init_score[i] = dynet::as_scalar(pcg->get_value(init_score_expr)) ;
+        init_score[i] = dynet::as_scalar(init_score_lookup_param.get()->values[i]);
     }
-    // get translation score
+    // flat index is `pre_tag * tag_num + cur_tag`, just the decoder wanted.
     for( size_t flat_idx = 0; flat_idx < tag_num * tag_num ; ++flat_idx )
     {
-        dynet::expr::Expression trans_score_expr = lookup(*pcg, trans_score_lookup_param, flat_idx);
-        trans_score[flat_idx] = dynet::as_scalar(pcg->get_value(trans_score_expr)) ;
+        trans_score[flat_idx] = dynet::as_scalar(trans_score_lookup_param.get()->values[flat_idx]);
     }
-    // get emit score
+    viterbi_decoder.set_score(init_score, trans_score);
+}
+
+dynet::expr::Expression
+CRFOutput::build_emit_score_expr(const std::vector<dynet::expr::Expression> &expr_cont1,
+    const std::vector<dynet::expr::Expression> &expr_cont2,
+    bool is_train)
+{
+    size_t len = expr_cont1.size() ;
+    // tag part, (hidden_dim x tag_num)
+    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
     for( size_t i = 0; i < tag_num ; ++i )
     {
         all_tag_expr_cont[i] = dynet::expr::lookup(*pcg, tag_lookup_param, i);
     }
+    dynet::expr::Expression tag_part_expr = hidden_layer.build_last_on_cols(all_tag_expr_cont);
+    // input part is added to every column of the tag part, (hidden_dim x tag_num) for every time step.
+    std::vector<dynet::expr::Expression> hidden_out_expr_cont(len);
     for( size_t time_step = 0; time_step < len; ++time_step )
     {
-        for( size_t i = 0; i < tag_num; ++i )
-        {
-            dynet::expr::Expression hidden_out_expr = hidden_layer.build_graph(expr_cont1[time_step],
-                expr_cont2[time_step], all_tag_expr_cont[i]);
-            dynet::expr::Expression non_linear_expr = (*nonlinear_func)(hidden_out_expr) ;
-            dynet::expr::Expression emit_expr = emit_layer.build_graph(non_linear_expr);
-            emit_score[time_step][i] = dynet::as_scalar( pcg->get_value(emit_expr) );
-        }
-    }
-    // viterbi - process
-    std::vector<std::vector<size_t>> path_matrix(len, std::vector<size_t>(tag_num));
-    std::vector<dynet::real> current_scores(tag_num); 
-    // time 0
-    for (size_t i = 0; i < tag_num ; ++i)
-    {
-        current_scores[i] = init_score[i] + emit_score[0][i];
+        hidden_out_expr_cont[time_step] = dynet::expr::colwise_add(tag_part_expr,
+            hidden_layer.build_graph_except_last(expr_cont1[time_step], expr_cont2[time_step]));
     }
-    // continues time
-    std::vector<dynet::real>  pre_timestep_scores(tag_num);
-    for (size_t time_step = 1; time_step < len ; ++time_step)
-    {
-        std::swap(pre_timestep_scores, current_scores); // move current_score -> pre_timestep_score
-        for (size_t i = 0; i < tag_num ; ++i )
-        {
-            size_t pre_tag_with_max_score = 0;
-            dynet::real max_score = pre_timestep_scores[pre_tag_with_max_score] + 
-                trans_score[pre_tag_with_max_score * tag_num + i];
-            for (size_t pre_i = 1 ; pre_i < tag_num ; ++pre_i)
-            {
-                size_t flat_idx = pre_i * tag_num + pre_i ;
-                dynet::real score = pre_timestep_scores[pre_i] + trans_score[flat_idx];
-                if (score > max_score)
-                {
-                    pre_tag_with_max_score = pre_i;
-                    max_score = score;
-                }
-            }
-            path_matrix[time_step][i] = pre_tag_with_max_score;
-            current_scores[i] = max_score + emit_score[time_step][i];
-        }
-    }
-    // get result 
-    IndexSeq tmp_predict_ner_seq(len);
-    Index end_predicted_idx = std::distance(current_scores.cbegin(),
-        max_element(current_scores.cbegin(), current_scores.cend()));
-    tmp_predict_ner_seq[len - 1] = end_predicted_idx;
-    Index pre_predicted_idx = end_predicted_idx;
-    for (size_t reverse_idx = len - 1; reverse_idx >= 1; --reverse_idx)
-    {
-        pre_predicted_idx = path_matrix[reverse_idx][pre_predicted_idx]; // backtrace
-        tmp_predict_ner_seq[reverse_idx - 1] = pre_predicted_idx;
-    }
-    std::swap(tmp_predict_ner_seq, pred_seq);
+    dynet::expr::Expression non_linear_expr = (*nonlinear_func)(dynet::expr::concatenate_cols(hidden_out_expr_cont));
+    if( is_train ){ non_linear_expr = dynet::expr::dropout(non_linear_expr, dropout_rate); }
+    // (1 x tag_num * len) score matrix, column major, so the flat index is `tag + tag_num * time_step`
+    return dynet::expr::reshape(emit_layer.build_graph_on_matrix(non_linear_expr),
+        dynet::Dim({ static_cast<unsigned>(tag_num * len) }));
 }
 
 
@@ -242,8 +211,8 @@ SimpleBareOutput::SimpleBareOutput(dynet::Model *m, unsigned input_dim, unsigned
 CrfBareOutput::CrfBareOutput(dynet::Model *m, unsigned input_dim, unsigned output_dim)
     :tagdict_sz(output_dim),
     state_score_layer(m, input_dim, output_dim),
-    init_score_lookup_param(m->add_lookup_parameters(output_dim, { 1 })),
-    transition_score_lookup_param(m->add_lookup_parameters(output_dim * output_dim, {1}))
+    init_score_param(m->add_parameters({ output_dim })),
+    transition_score_param(m->add_parameters({ output_dim, output_dim }))
 {}
 
 
@@ -251,58 +220,35 @@ dynet::expr::Expression
 CrfBareOutput::build_output_loss(const std::vector<dynet::expr::Expression>& input_expr_seq,
     const std::vector<Index>& gold_tag_seq)
 {
+    viterbi_decoder.clear_score(); // parameters will be updated.
     unsigned seq_len = input_expr_seq.size();
     if( seq_len == 0 ){ return dynet::expr::Expression(); }
-    // get init score expr
-    std::vector<dynet::expr::Expression> init_score_expr(tagdict_sz);
-    for( unsigned i = 0; i < tagdict_sz; ++i )
-    {
-        init_score_expr[i] = dynet::expr::lookup(*pcg, init_score_lookup_param, i);
-    }
-    // get trans score expr
-    std::vector<dynet::expr::Expression> transition_score_expr(tagdict_sz * tagdict_sz);
-    for( unsigned flat_idx = 0; flat_idx < tagdict_sz * tagdict_sz; ++flat_idx )
-    {
-        transition_score_expr[flat_idx] = dynet::expr::lookup(*pcg, transition_score_lookup_param, flat_idx);
-    }
-    // calculate all state score.
-    std::vector<dynet::expr::Expression> state_score_expr(seq_len);
-    for( unsigned i = 0; i < seq_len; ++i )
-    {
-        state_score_expr[i] = state_score_layer.build_graph(input_expr_seq[i]);
-    }
-    // viterbi
-    std::vector<dynet::expr::Expression> cur_time_score_list(tagdict_sz),
-        pre_time_score_list(tagdict_sz);
+    // flat view of the transition matrix, for picking the gold transition score.
+    dynet::expr::Expression flat_transition_score_expr = dynet::expr::reshape(transition_score_expr,
+        dynet::Dim({ static_cast<unsigned>(tagdict_sz * tagdict_sz) }));
+    // forward algorithm in matrix form.
+    // every time step only need 1 broadcasted add and 1 column-wise logsumexp, 
+    // so the graph size is O(T), instead of O(T * K^2) when building from the scalar expressions.
     std::vector<dynet::expr::Expression> gold_score_container;
     gold_score_container.reserve(2 * seq_len);
     // 1. init
-    for( unsigned tagidx = 0; tagidx < tagdict_sz; ++tagidx )
-    {
-        cur_time_score_list[tagidx] = init_score_expr[tagidx] + dynet::expr::pick(state_score_expr[0], tagidx);
-    }
-    gold_score_container.push_back(init_score_expr[gold_tag_seq[0]]);
-    gold_score_container.push_back(dynet::expr::pick(state_score_expr[0], gold_tag_seq[0]));
+    dynet::expr::Expression state_score_expr = state_score_layer.build_graph(input_expr_seq[0]);
+    dynet::expr::Expression cur_time_score_expr = init_score_expr + state_score_expr;
+    gold_score_container.push_back(dynet::expr::pick(init_score_expr, gold_tag_seq[0]));
+    gold_score_container.push_back(dynet::expr::pick(state_score_expr, gold_tag_seq[0]));
     // 2. continues
     for( unsigned t = 1; t < seq_len; ++t )
     {
-        swap(cur_time_score_list, pre_time_score_list);
-        for( unsigned tagidx = 0; tagidx < tagdict_sz; ++tagidx )
-        {
-            std::vector<dynet::expr::Expression> pre2cur_score(tagdict_sz);
-            for( unsigned pre_tagidx = 0; pre_tagidx < tagdict_sz; ++pre_tagidx )
-            {
-                unsigned flat_idx = flat_transition_index(pre_tagidx, tagidx);
-                pre2cur_score[pre_tagidx] = pre_time_score_list[pre_tagidx] + transition_score_expr[flat_idx];
-            }
-            cur_time_score_list[tagidx] = dynet::expr::logsumexp(pre2cur_score) + dynet::expr::pick(state_score_expr[t], tagidx);
-           
-        }
+        state_score_expr = state_score_layer.build_graph(input_expr_seq[t]);
+        // pre2cur_score(from, to) = pre_time_score(from) + transition_score(from, to)
+        dynet::expr::Expression pre2cur_score_expr = dynet::expr::colwise_add(transition_score_expr, cur_time_score_expr);
+        cur_time_score_expr = logsumexp_colwise(pre2cur_score_expr) + state_score_expr;
         unsigned gold_flat_idx = flat_transition_index(gold_tag_seq[t - 1], gold_tag_seq[t]);
-        gold_score_container.push_back(transition_score_expr[gold_flat_idx]);
-        gold_score_container.push_back(dynet::expr::pick(state_score_expr[t], gold_tag_seq[t]));
+        gold_score_container.push_back(dynet::expr::pick(flat_transition_score_expr, gold_flat_idx));
+        gold_score_container.push_back(dynet::expr::pick(state_score_expr, gold_tag_seq[t]));
     }
-    dynet::expr::Expression pred_score_expr = dynet::expr::logsumexp(cur_time_score_list),
+    // score vector is a (tagdict_sz x 1) matrix, colwise logsumexp gets the total score.
+    dynet::expr::Expression pred_score_expr = logsumexp_colwise(cur_time_score_expr),
         gold_score_expr = dynet::expr::sum(gold_score_container);
     return pred_score_expr - gold_score_expr;
 }
@@ -313,67 +259,34 @@ CrfBareOutput::build_output(const std::vector<dynet::expr::Expression>& input_ex
     std::vector<Index>& pred_tagseq)
 {
     unsigned seq_len = input_expr_seq.size();
-    // init score
-    std::vector<slnn::type::real> init_score_list(tagdict_sz);
-    for( unsigned tagidx = 0; tagidx < tagdict_sz; ++tagidx )
-    {
-        auto cur_init_score_expr = dynet::expr::lookup(*pcg, init_score_lookup_param, tagidx);
-        init_score_list[tagidx] = dynet::as_scalar(pcg->get_value(cur_init_score_expr));
-    }
-    // transition score
-    std::vector<slnn::type::real> transition_score_list(tagdict_sz * tagdict_sz);
-    for( unsigned flat_idx = 0; flat_idx < tagdict_sz * tagdict_sz; ++flat_idx )
-    {
-        auto cur_score_expr = dynet::expr::lookup(*pcg, transition_score_lookup_param, flat_idx);
-        transition_score_list[flat_idx] = dynet::as_scalar(pcg->get_value(cur_score_expr));
-    }
-    // state score
-    std::vector<std::vector<slnn::type::real>> state_score_list(seq_len);
+    if( seq_len == 0 ){ pred_tagseq.clear(); return; }
+    if( !viterbi_decoder.has_score() ){ set_decoder_score(); }
+    // state score, (tagdict_sz x seq_len) matrix, fetched at once.
+    std::vector<dynet::expr::Expression> state_score_expr_seq(seq_len);
     for( unsigned t = 0; t < seq_len; ++t )
     {
-        auto cur_score_expr = state_score_layer.build_graph(input_expr_seq[t]);
-        state_score_list[t] = dynet::as_vector(pcg->get_value(cur_score_expr));
-    }
-    // viterbi
-    // - time 0 no trace back
-    std::vector<std::vector<unsigned>> traceback_matrix(seq_len - 1, std::vector<unsigned>(tagdict_sz));
-    std::vector<slnn::type::real> cur_time_score_list(tagdict_sz),
-        pre_time_score_list(tagdict_sz);
-    // - time 0
-    for( unsigned tagidx = 0; tagidx < tagdict_sz; ++tagidx )
-    {
-        cur_time_score_list[tagidx] = init_score_list[tagidx] + state_score_list[0][tagidx];
+        state_score_expr_seq[t] = state_score_layer.build_graph(input_expr_seq[t]);
     }
-    // - continues
-    for( unsigned t = 1; t < seq_len; ++t )
-    {
-        swap(cur_time_score_list, pre_time_score_list);
-        for( unsigned tagidx = 0; tagidx < tagdict_sz; ++tagidx )
+    std::vector<slnn::type::real> state_score_list = dynet::as_vector(
+        pcg->get_value(dynet::expr::concatenate_cols(state_score_expr_seq)));
+    viterbi_decoder.decode(state_score_list.data(), seq_len, pred_tagseq);
+}
+
+void CrfBareOutput::set_decoder_score()
+{
+    std::vector<slnn::type::real> init_score_list = dynet::as_vector(init_score_param.get()->values);
+    // column-major layout, the flat index is `flat_transition_index(from, to)`.
+    // transpose it to `from * tagdict_sz + to` for the decoder.
+    std::vector<slnn::type::real> transition_score_list = dynet::as_vector(transition_score_param.get()->values);
+    std::vector<slnn::type::real> decoder_transition_score_list(tagdict_sz * tagdict_sz);
+    for( unsigned from = 0; from < tagdict_sz; ++from )
+    {
+        for( unsigned to = 0; to < tagdict_sz; ++to )
         {
-            std::vector<slnn::type::real> pre2cur_tag_score_list(tagdict_sz);
-            for( unsigned pre_tagidx = 0; pre_tagidx < tagdict_sz; ++pre_tagidx )
-            {
-                unsigned flat_idx = flat_transition_index(pre_tagidx, tagidx);
-                pre2cur_tag_score_list[pre_tagidx] = pre_time_score_list[pre_tagidx] + transition_score_list[flat_idx];
-            }
-            auto max_pre2cur_score_iter = std::max_element(pre2cur_tag_score_list.begin(), pre2cur_tag_score_list.end());
-            unsigned pre_tagidx_with_max_score = std::distance(pre2cur_tag_score_list.begin(), max_pre2cur_score_iter);
-            cur_time_score_list[tagidx] = *max_pre2cur_score_iter + state_score_list[t][tagidx];
-            traceback_matrix[t - 1][tagidx] = pre_tagidx_with_max_score;
+            decoder_transition_score_list[from * tagdict_sz + to] = transition_score_list[flat_transition_index(from, to)];
         }
     }
-    // - find the path with max score.
-    auto end_tagidx_with_max_score = std::distance(cur_time_score_list.begin(), 
-        std::max_element(cur_time_score_list.begin(), cur_time_score_list.end()) );
-    std::vector<Index> tmp_pred_tagseq(seq_len);
-    tmp_pred_tagseq.back() = end_tagidx_with_max_score;
-    unsigned pre_tag = tmp_pred_tagseq.back();
-    for( int t = seq_len - 1; t >= 1; --t )
-    {
-        pre_tag = traceback_matrix[t - 1][pre_tag]; // traceback matrix record from time 1.
-        tmp_pred_tagseq[t - 1] = pre_tag;
-    }
-    swap(tmp_pred_tagseq, pred_tagseq);
+    viterbi_decoder.set_score(init_score_list, decoder_transition_score_list);
 }
 
 
@@ -414,7 +327,8 @@ PretagOutputWithFeature::PretagOutputWithFeature(dynet::Model *m, unsigned tag_e
     hidden_layer(m, input_dim1, input_dim2, feature_dim, tag_embedding_dim, hidden_dim),
     output_layer(m, hidden_dim, output_dim),
     tag_lookup_param(m->add_lookup_parameters(output_dim , {tag_embedding_dim})) ,
-    TAG_SOS(m->add_parameters({tag_embedding_dim})) 
+    TAG_SOS(m->add_parameters({tag_embedding_dim})) ,
+    tag_num(output_dim)
 {}
 
 PretagOutputWithFeature::~PretagOutputWithFeature(){}
@@ -446,9 +360,9 @@ CRFOutputWithFeature::build_output_loss(const std::vector<dynet::expr::Expressio
     const std::vector<dynet::expr::Expression> &feature_expr_cont,
     const IndexSeq &gold_seq)
 {
+    viterbi_decoder.clear_score(); // parameters will be updated.
     size_t len = expr_cont1.size() ;
     // viterbi data preparation
-    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
     std::vector<dynet::expr::Expression> init_score(tag_num);
     std::vector<dynet::expr::Expression> trans_score(tag_num * tag_num);
     std::vector<std::vector<dynet::expr::Expression>> emit_score(len,
@@ -456,10 +370,9 @@ CRFOutputWithFeature::build_output_loss(const std::vector<dynet::expr::Expressio
     std::vector<dynet::expr::Expression> cur_score_expr_cont(tag_num),
         pre_score_expr_cont(tag_num);
     std::vector<dynet::expr::Expression> gold_score_expr_cont(len) ;
-    // init tag expr , init score
+    // init score
     for( size_t i = 0; i < tag_num ; ++i )
     {
-        all_tag_expr_cont[i] = dynet::expr::lookup(*pcg, tag_lookup_param, i);
         init_score[i] = dynet::expr::lookup(*pcg, init_score_lookup_param, i);
     }
     // init translation score
@@ -468,15 +381,12 @@ CRFOutputWithFeature::build_output_loss(const std::vector<dynet::expr::Expressio
         trans_score[flat_idx] = lookup(*pcg, trans_score_lookup_param, flat_idx);
     }
     // init emit score
+    dynet::expr::Expression emit_score_expr = build_emit_score_expr(expr_cont1, expr_cont2, feature_expr_cont, true);
     for( size_t time_step = 0; time_step < len; ++time_step )
     {
         for( size_t i = 0; i < tag_num; ++i )
         {
-            dynet::expr::Expression hidden_out_expr = hidden_layer.build_graph(expr_cont1.at(time_step),
-                expr_cont2.at(time_step), feature_expr_cont.at(time_step), all_tag_expr_cont.at(i));
-            dynet::expr::Expression non_linear_expr = (*nonlinear_func)(hidden_out_expr) ;
-            dynet::expr::Expression dropout_expr = dropout(non_linear_expr, dropout_rate) ;
-            emit_score[time_step][i] = emit_layer.build_graph(dropout_expr);
+            emit_score[time_step][i] = dynet::expr::pick(emit_score_expr, i + tag_num * time_step);
         }
     }
     // viterbi docoding
@@ -525,82 +435,52 @@ void CRFOutputWithFeature::build_output(const std::vector<dynet::expr::Expressio
     IndexSeq &pred_seq)
 {
     size_t len = expr_cont1.size() ;
-    // viterbi data preparation
-    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
+    if( len == 0 ){ pred_seq.clear(); return; }
+    if( !viterbi_decoder.has_score() ){ set_decoder_score(); }
+    // all the emit score in one fetch, flat index of emit score: tag + tag_num * time_step
+    std::vector<dynet::real> emit_score = dynet::as_vector(pcg->get_value(
+        build_emit_score_expr(expr_cont1, expr_cont2, feature_expr_cont, false)));
+    viterbi_decoder.decode(emit_score.data(), len, pred_seq);
+}
+
+void CRFOutputWithFeature::set_decoder_score()
+{
     std::vector<dynet::real> init_score(tag_num);
-    std::vector < dynet::real> trans_score(tag_num * tag_num);
-    std::vector<std::vector<dynet::real>> emit_score(len, std::vector<dynet::real>(tag_num));
-    // get initial score
+    std::vector<dynet::real> trans_score(tag_num * tag_num);
     for( size_t i = 0 ; i < tag_num ; ++i )
     {
-        dynet::expr::Expression init_score_expr = dynet::expr::lookup(*pcg, init_score_lookup_param, i);
-        init_score[i] = dynet::as_scalar(pcg->get_value(init_score_expr)) ;
+        init_score[i] = dynet::as_scalar(init_score_lookup_param.get()->values[i]);
     }
-    // get translation score
+    // flat index is `pre_tag * tag_num + cur_tag`, just the decoder wanted.
     for( size_t flat_idx = 0; flat_idx < tag_num * tag_num ; ++flat_idx )
     {
-        dynet::expr::Expression trans_score_expr = lookup(*pcg, trans_score_lookup_param, flat_idx);
-        trans_score[flat_idx] = dynet::as_scalar(pcg->get_value(trans_score_expr)) ;
+        trans_score[flat_idx] = dynet::as_scalar(trans_score_lookup_param.get()->values[flat_idx]);
     }
-    // get emit score
+    viterbi_decoder.set_score(init_score, trans_score);
+}
+
+dynet::expr::Expression
+CRFOutputWithFeature::build_emit_score_expr(const std::vector<dynet::expr::Expression> &expr_cont1,
+    const std::vector<dynet::expr::Expression> &expr_cont2,
+    const std::vector<dynet::expr::Expression> &feature_expr_cont,
+    bool is_train)
+{
+    size_t len = expr_cont1.size() ;
+    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
     for( size_t i = 0; i < tag_num ; ++i )
     {
         all_tag_expr_cont[i] = dynet::expr::lookup(*pcg, tag_lookup_param, i);
     }
+    dynet::expr::Expression tag_part_expr = hidden_layer.build_last_on_cols(all_tag_expr_cont);
+    std::vector<dynet::expr::Expression> hidden_out_expr_cont(len);
     for( size_t time_step = 0; time_step < len; ++time_step )
     {
-        for( size_t i = 0; i < tag_num; ++i )
-        {
-            dynet::expr::Expression hidden_out_expr = hidden_layer.build_graph(expr_cont1.at(time_step),
-                expr_cont2.at(time_step), feature_expr_cont.at(time_step), all_tag_expr_cont.at(i));
-            dynet::expr::Expression non_linear_expr = (*nonlinear_func)(hidden_out_expr) ;
-            dynet::expr::Expression emit_expr = emit_layer.build_graph(non_linear_expr);
-            emit_score[time_step][i] = dynet::as_scalar( pcg->get_value(emit_expr) );
-        }
-    }
-    // viterbi - process
-    std::vector<std::vector<size_t>> path_matrix(len, std::vector<size_t>(tag_num));
-    std::vector<dynet::real> current_scores(tag_num); 
-    // time 0
-    for (size_t i = 0; i < tag_num ; ++i)
-    {
-        current_scores[i] = init_score[i] + emit_score[0][i];
-    }
-    // continues time
-    std::vector<dynet::real>  pre_timestep_scores(tag_num);
-    for (size_t time_step = 1; time_step < len ; ++time_step)
-    {
-        std::swap(pre_timestep_scores, current_scores); // move current_score -> pre_timestep_score
-        for (size_t i = 0; i < tag_num ; ++i )
-        {
-            size_t pre_tag_with_max_score = 0;
-            dynet::real max_score = pre_timestep_scores[pre_tag_with_max_score] + 
-                trans_score[pre_tag_with_max_score * tag_num + i];
-            for (size_t pre_i = 1 ; pre_i < tag_num ; ++pre_i)
-            {
-                size_t flat_idx = pre_i * tag_num + pre_i ;
-                dynet::real score = pre_timestep_scores[pre_i] + trans_score[flat_idx];
-                if (score > max_score)
-                {
-                    pre_tag_with_max_score = pre_i;
-                    max_score = score;
-                }
-            }
-            path_matrix[time_step][i] = pre_tag_with_max_score;
-            current_scores[i] = max_score + emit_score[time_step][i];
-        }
-    }
-    // get result 
-    IndexSeq tmp_predict_ner_seq(len);
-    Index end_predicted_idx = std::distance(current_scores.cbegin(),
-        max_element(current_scores.cbegin(), current_scores.cend()));
-    tmp_predict_ner_seq[len - 1] = end_predicted_idx;
-    Index pre_predicted_idx = end_predicted_idx;
-    for (size_t reverse_idx = len - 1; reverse_idx >= 1; --reverse_idx)
-    {
-        pre_predicted_idx = path_matrix[reverse_idx][pre_predicted_idx]; // backtrace
-        tmp_predict_ner_seq[reverse_idx - 1] = pre_predicted_idx;
+        hidden_out_expr_cont[time_step] = dynet::expr::colwise_add(tag_part_expr,
+            hidden_layer.build_graph_except_last(expr_cont1.at(time_step), expr_cont2.at(time_step), feature_expr_cont.at(time_step)));
     }
-    std::swap(tmp_predict_ner_seq, pred_seq);
+    dynet::expr::Expression non_linear_expr = (*nonlinear_func)(dynet::expr::concatenate_cols(hidden_out_expr_cont));
+    if( is_train ){ non_linear_expr = dynet::expr::dropout(non_linear_expr, dropout_rate); }
+    return dynet::expr::reshape(emit_layer.build_graph_on_matrix(non_linear_expr),
+        dynet::Dim({ static_cast<unsigned>(tag_num * len) }));
 }
 } // end of namespace slnn
\ No newline at end of file
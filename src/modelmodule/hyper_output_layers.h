@@ -3,6 +3,8 @@
 
 #include <initializer_list>
 #include "layers.h"
+#include "viterbi_decoder.h"
+#include "beam_search_decoder.h"
 #include "utils/typedeclaration.h"
 
 namespace slnn{
@@ -53,12 +55,19 @@ struct PretagOutput : public OutputBase
     dynet::LookupParameter tag_lookup_param ;
     dynet::Parameter TAG_SOS ;
     dynet::ComputationGraph *pcg;
+    size_t tag_num;
+    std::vector<dynet::expr::Expression> pretag_part_expr_cont; // built when used, index `tag_num` is TAG_SOS
+    BeamSearchDecoder beam_decoder; // beam size 1 (greedy) by default
 
     PretagOutput(dynet::Model *m, unsigned tag_embedding_dim, unsigned input_dim1, unsigned input_dim2,
         unsigned hidden_dim, unsigned output_dim , 
         dynet::real dropout_rate=0.f, NonLinearFunc *nonlinear_fun=&dynet::expr::rectify);
     virtual ~PretagOutput();
     void new_graph(dynet::ComputationGraph &cg);
+    // the pre-tag part of the hidden layer (w * pretag_embedding), built once for every pre-tag in the graph.
+    // pretag_id < 0 for TAG_SOS.
+    dynet::expr::Expression get_pretag_part_expr(Index pretag_id);
+    void set_beam_size(unsigned beam_size){ beam_decoder.set_beam_size(beam_size); }
     dynet::expr::Expression
         build_output_loss(const std::vector<dynet::expr::Expression> &expr_cont1,
             const std::vector<dynet::expr::Expression> &expr_cont2,
@@ -77,6 +86,7 @@ struct CRFOutput : public OutputBase
     dynet::LookupParameter init_score_lookup_param ;
     dynet::ComputationGraph *pcg ;
     size_t tag_num ;
+    ViterbiDecoder viterbi_decoder ; // score is cached until the next `build_output_loss`
     CRFOutput(dynet::Model *m,
         unsigned tag_embedding_dim, unsigned input_dim1, unsigned input_dim2,
         unsigned hidden_dim,
@@ -93,6 +103,15 @@ struct CRFOutput : public OutputBase
     void build_output(const std::vector<dynet::expr::Expression> &expr_cont1,
         const std::vector<dynet::expr::Expression> &expr_cont2,
         IndexSeq &pred_seq) ;
+    // read the init and transition score from the parameter storage directly (no graph).
+    void set_decoder_score() ;
+protected:
+    // emit score of all the tags at all the time steps, a (tag_num * len) vector, flat index is `tag + tag_num * time_step`.
+    // the hidden layer is factorized: the input part is built once for every time step, the tag part once for every tag,
+    // then all the (time step, tag) pairs are merged by broadcasted add, and scored by one nonlinear and one dense node.
+    dynet::expr::Expression build_emit_score_expr(const std::vector<dynet::expr::Expression> &expr_cont1,
+        const std::vector<dynet::expr::Expression> &expr_cont2,
+        bool is_train) ;
 };
 
 /******************
@@ -163,13 +182,21 @@ public:
         std::vector<Index>& pred_output_seq) override;
 private:
     // `to` keeps unchange when viterbi.
+    // it is also the (column-major) flat index of (from, to) in the transition matrix.
     unsigned flat_transition_index(unsigned from, unsigned to){ return from + tagdict_sz * to; }
+    // for every column j, out[j] = log( sum_i( exp(m[i, j]) ) ), calculated stablely.
+    static dynet::expr::Expression logsumexp_colwise(const dynet::expr::Expression& m);
+    // read the init and transition score from the parameter storage directly (no graph).
+    void set_decoder_score();
 protected:
     std::size_t tagdict_sz;
     DenseLayer state_score_layer;
-    dynet::LookupParameter init_score_lookup_param;
-    dynet::LookupParameter transition_score_lookup_param;
+    dynet::Parameter init_score_param; // (tagdict_sz)
+    dynet::Parameter transition_score_param; // (tagdict_sz, tagdict_sz), row is `from` tag, column is `to` tag.
+    dynet::expr::Expression init_score_expr;
+    dynet::expr::Expression transition_score_expr;
     dynet::ComputationGraph *pcg;
+    ViterbiDecoder viterbi_decoder; // score is cached until the next `build_output_loss`
 };
 
 // softmax layer
@@ -238,6 +265,9 @@ struct PretagOutputWithFeature : public OutputBaseWithFeature
     dynet::LookupParameter tag_lookup_param ;
     dynet::Parameter TAG_SOS ;
     dynet::ComputationGraph *pcg;
+    size_t tag_num;
+    std::vector<dynet::expr::Expression> pretag_part_expr_cont; // built when used, index `tag_num` is TAG_SOS
+    BeamSearchDecoder beam_decoder; // beam size 1 (greedy) by default
 
     PretagOutputWithFeature(dynet::Model *m, unsigned tag_embedding_dim, unsigned input_dim1, unsigned input_dim2, 
         unsigned feature_dim,
@@ -245,6 +275,10 @@ struct PretagOutputWithFeature : public OutputBaseWithFeature
         dynet::real dropout_rate=0.f, NonLinearFunc *nonlinear_fun=&dynet::expr::rectify);
     virtual ~PretagOutputWithFeature();
     void new_graph(dynet::ComputationGraph &cg);
+    // the pre-tag part of the hidden layer (w * pretag_embedding), built once for every pre-tag in the graph.
+    // pretag_id < 0 for TAG_SOS.
+    dynet::expr::Expression get_pretag_part_expr(Index pretag_id);
+    void set_beam_size(unsigned beam_size){ beam_decoder.set_beam_size(beam_size); }
     dynet::expr::Expression
         build_output_loss(const std::vector<dynet::expr::Expression> &expr_cont1,
             const std::vector<dynet::expr::Expression> &expr_cont2,
@@ -265,6 +299,7 @@ struct CRFOutputWithFeature : public  OutputBaseWithFeature
     dynet::LookupParameter init_score_lookup_param ;
     dynet::ComputationGraph *pcg ;
     size_t tag_num ;
+    ViterbiDecoder viterbi_decoder ; // score is cached until the next `build_output_loss`
     CRFOutputWithFeature(dynet::Model *m,
         unsigned tag_embedding_dim, unsigned input_dim1, unsigned input_dim2,
         unsigned feature_dim,
@@ -284,6 +319,14 @@ struct CRFOutputWithFeature : public  OutputBaseWithFeature
         const std::vector<dynet::expr::Expression> &expr_cont2,
         const std::vector<dynet::expr::Expression> &feature_expr_cont,
         IndexSeq &pred_seq) ;
+    // read the init and transition score from the parameter storage directly (no graph).
+    void set_decoder_score() ;
+protected:
+    // the same as CRFOutput
+    dynet::expr::Expression build_emit_score_expr(const std::vector<dynet::expr::Expression> &expr_cont1,
+        const std::vector<dynet::expr::Expression> &expr_cont2,
+        const std::vector<dynet::expr::Expression> &feature_expr_cont,
+        bool is_train) ;
 };
 
 
@@ -343,6 +386,20 @@ void PretagOutput::new_graph(dynet::ComputationGraph &cg)
     hidden_layer.new_graph(cg) ;
     output_layer.new_graph(cg) ;
     pcg = &cg ;
+    pretag_part_expr_cont.assign(tag_num + 1, dynet::expr::Expression()) ;
+}
+
+inline
+dynet::expr::Expression PretagOutput::get_pretag_part_expr(Index pretag_id)
+{
+    size_t idx = pretag_id < 0 ? tag_num : static_cast<size_t>(pretag_id) ;
+    dynet::expr::Expression &pretag_part_expr = pretag_part_expr_cont.at(idx) ;
+    if( pretag_part_expr.pg == nullptr )
+    {
+        dynet::expr::Expression pretag_exp = pretag_id < 0 ? parameter(*pcg, TAG_SOS) : lookup(*pcg, tag_lookup_param, pretag_id) ;
+        pretag_part_expr = hidden_layer.build_last_on_cols({ pretag_exp }) ;
+    }
+    return pretag_part_expr ;
 }
 
 inline
@@ -353,15 +410,16 @@ PretagOutput::build_output_loss(const std::vector<dynet::expr::Expression> &expr
 {
     size_t len = expr_cont1.size() ;
     std::vector<dynet::expr::Expression> loss_cont(len);
-    dynet::expr::Expression pretag_exp = parameter(*pcg, TAG_SOS) ;
+    Index pretag_id = -1 ; // TAG_SOS
     for( size_t i = 0; i < len; ++i )
     {
-        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph(expr_cont1[i], expr_cont2[i] , pretag_exp);
+        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph_except_last(expr_cont1[i], expr_cont2[i]) +
+            get_pretag_part_expr(pretag_id);
         dynet::expr::Expression nonlinear_expr = (*nonlinear_func)(merge_out_expr);
         dynet::expr::Expression dropout_expr = dynet::expr::dropout(nonlinear_expr, dropout_rate);
         dynet::expr::Expression out_expr = output_layer.build_graph(dropout_expr);
         loss_cont[i] = dynet::expr::pickneglogsoftmax(out_expr, gold_seq.at(i));
-        pretag_exp = lookup(*pcg, tag_lookup_param, gold_seq.at(i)) ;
+        pretag_id = gold_seq.at(i) ;
     }
     return dynet::expr::sum(loss_cont);
 }
@@ -371,20 +429,17 @@ void PretagOutput::build_output(const std::vector<dynet::expr::Expression> &expr
     const std::vector<dynet::expr::Expression> &expr_cont2,
     IndexSeq &pred_seq)
 {
-    size_t len = expr_cont1.size() ;
-    IndexSeq tmp_pred(len) ;
-    dynet::expr::Expression pretag_exp = parameter(*pcg, TAG_SOS) ;
-    for( size_t i = 0; i < len; ++i )
+    // the hypotheses of the beam are stacked as columns, scored by one merge, one nonlinear and one dense node.
+    auto score_func = [this, &expr_cont1, &expr_cont2](size_t i, const IndexSeq &pretag_list, std::vector<dynet::real> &score_list)
     {
-        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph(expr_cont1[i], expr_cont2[i], pretag_exp);
+        std::vector<dynet::expr::Expression> pretag_part_expr_list(pretag_list.size());
+        for( size_t k = 0; k < pretag_list.size(); ++k ){ pretag_part_expr_list[k] = get_pretag_part_expr(pretag_list[k]); }
+        dynet::expr::Expression merge_out_expr = dynet::expr::colwise_add(dynet::expr::concatenate_cols(pretag_part_expr_list),
+            hidden_layer.build_graph_except_last(expr_cont1[i], expr_cont2[i]));
         dynet::expr::Expression nonlinear_expr = (*nonlinear_func)(merge_out_expr);
-        dynet::expr::Expression out_expr = output_layer.build_graph(nonlinear_expr);
-        std::vector<dynet::real> dist = as_vector(pcg->get_value(out_expr)) ;
-        Index id_of_max_prob = std::distance(dist.cbegin(), std::max_element(dist.cbegin(), dist.cend())) ;
-        tmp_pred[i] = id_of_max_prob ;
-        pretag_exp = lookup(*pcg, tag_lookup_param,id_of_max_prob) ;
-    }
-    std::swap(pred_seq, tmp_pred) ;
+        score_list = as_vector(pcg->get_value(output_layer.build_graph_on_matrix(nonlinear_expr))) ;
+    };
+    beam_decoder.decode(expr_cont1.size(), tag_num, score_func, pred_seq) ;
 }
 
 /****** crf output *******/
@@ -468,13 +523,15 @@ void SimpleBareOutput::build_output(const std::vector<dynet::expr::Expression> &
 {
     using std::swap;
     size_t seq_len = input_expr_seq.size();
+    if( seq_len == 0 ){ predicted_seq.clear(); return; }
+    // (output_dim x seq_len) score matrix, built and fetched at once. softmax is monotonic, so skip it.
+    std::vector<dynet::real> score_list = dynet::as_vector(pcg->get_value(softmax_layer.build_graph_on_cols(input_expr_seq)));
+    size_t output_dim = score_list.size() / seq_len;
     IndexSeq tmp_pred_seq(seq_len);
     for( size_t i = 0; i < seq_len; ++i )
     {
-        dynet::expr::Expression dest_expr = softmax_layer.build_graph(input_expr_seq[i]);
-        std::vector<dynet::real> dist = dynet::as_vector(pcg->get_value(dest_expr));
-        Index id_of_max_prob = std::distance(dist.begin(), std::max_element(dist.begin(), dist.end()) );
-        tmp_pred_seq[i] = id_of_max_prob;
+        const dynet::real *dist = score_list.data() + i * output_dim;
+        tmp_pred_seq[i] = std::distance(dist, std::max_element(dist, dist + output_dim));
     }
     swap(predicted_seq, tmp_pred_seq);
 }
@@ -487,9 +544,21 @@ inline
 void CrfBareOutput::new_graph(dynet::ComputationGraph& cg)
 {
     state_score_layer.new_graph(cg);
+    init_score_expr = dynet::expr::parameter(cg, init_score_param);
+    transition_score_expr = dynet::expr::parameter(cg, transition_score_param);
     pcg = &cg;
 }
 
+inline
+dynet::expr::Expression CrfBareOutput::logsumexp_colwise(const dynet::expr::Expression& m)
+{
+    // work on the transposed matrix, so the reduction is done along the row for every (original) column.
+    dynet::expr::Expression m_t = dynet::expr::transpose(m);
+    dynet::expr::Expression max_expr = dynet::expr::max_dim(m_t, 1);
+    dynet::expr::Expression shifted_expr = dynet::expr::colwise_add(m_t, -max_expr);
+    return max_expr + dynet::expr::log(dynet::expr::sum_cols(dynet::expr::exp(shifted_expr)));
+}
+
 
 /******* Softmax layer **********/
 
@@ -606,6 +675,20 @@ void PretagOutputWithFeature::new_graph(dynet::ComputationGraph &cg)
     hidden_layer.new_graph(cg) ;
     output_layer.new_graph(cg) ;
     pcg = &cg ;
+    pretag_part_expr_cont.assign(tag_num + 1, dynet::expr::Expression()) ;
+}
+
+inline
+dynet::expr::Expression PretagOutputWithFeature::get_pretag_part_expr(Index pretag_id)
+{
+    size_t idx = pretag_id < 0 ? tag_num : static_cast<size_t>(pretag_id) ;
+    dynet::expr::Expression &pretag_part_expr = pretag_part_expr_cont.at(idx) ;
+    if( pretag_part_expr.pg == nullptr )
+    {
+        dynet::expr::Expression pretag_exp = pretag_id < 0 ? parameter(*pcg, TAG_SOS) : lookup(*pcg, tag_lookup_param, pretag_id) ;
+        pretag_part_expr = hidden_layer.build_last_on_cols({ pretag_exp }) ;
+    }
+    return pretag_part_expr ;
 }
 
 
@@ -618,16 +701,16 @@ PretagOutputWithFeature::build_output_loss(const std::vector<dynet::expr::Expres
 {
     size_t len = expr_cont1.size() ;
     std::vector<dynet::expr::Expression> loss_cont(len);
-    dynet::expr::Expression pretag_exp = parameter(*pcg, TAG_SOS) ;
+    Index pretag_id = -1 ; // TAG_SOS
     for( size_t i = 0; i < len; ++i )
     {
-        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph(expr_cont1.at(i), expr_cont2.at(i), feature_expr_cont.at(i),
-            pretag_exp);
+        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph_except_last(expr_cont1.at(i), expr_cont2.at(i),
+            feature_expr_cont.at(i)) + get_pretag_part_expr(pretag_id);
         dynet::expr::Expression nonlinear_expr = (*nonlinear_func)(merge_out_expr);
         dynet::expr::Expression dropout_expr = dynet::expr::dropout(nonlinear_expr, dropout_rate);
         dynet::expr::Expression out_expr = output_layer.build_graph(dropout_expr);
         loss_cont[i] = dynet::expr::pickneglogsoftmax(out_expr, gold_seq.at(i));
-        pretag_exp = lookup(*pcg, tag_lookup_param, gold_seq.at(i)) ;
+        pretag_id = gold_seq.at(i) ;
     }
     return dynet::expr::sum(loss_cont);
 }
@@ -638,20 +721,17 @@ void PretagOutputWithFeature::build_output(const std::vector<dynet::expr::Expres
     const std::vector<dynet::expr::Expression> &feature_expr_cont,
     IndexSeq &pred_seq)
 {
-    size_t len = expr_cont1.size() ;
-    IndexSeq tmp_pred(len) ;
-    dynet::expr::Expression pretag_exp = parameter(*pcg, TAG_SOS) ;
-    for( size_t i = 0; i < len; ++i )
+    auto score_func = [this, &expr_cont1, &expr_cont2, &feature_expr_cont](size_t i, const IndexSeq &pretag_list,
+        std::vector<dynet::real> &score_list)
     {
-        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph(expr_cont1.at(i), expr_cont2.at(i), feature_expr_cont.at(i), pretag_exp);
+        std::vector<dynet::expr::Expression> pretag_part_expr_list(pretag_list.size());
+        for( size_t k = 0; k < pretag_list.size(); ++k ){ pretag_part_expr_list[k] = get_pretag_part_expr(pretag_list[k]); }
+        dynet::expr::Expression merge_out_expr = dynet::expr::colwise_add(dynet::expr::concatenate_cols(pretag_part_expr_list),
+            hidden_layer.build_graph_except_last(expr_cont1.at(i), expr_cont2.at(i), feature_expr_cont.at(i)));
         dynet::expr::Expression nonlinear_expr = (*nonlinear_func)(merge_out_expr);
-        dynet::expr::Expression out_expr = output_layer.build_graph(nonlinear_expr);
-        std::vector<dynet::real> dist = as_vector(pcg->get_value(out_expr)) ;
-        Index id_of_max_prob = std::distance(dist.cbegin(), std::max_element(dist.cbegin(), dist.cend())) ;
-        tmp_pred[i] = id_of_max_prob ;
-        pretag_exp = lookup(*pcg, tag_lookup_param,id_of_max_prob) ;
-    }
-    std::swap(pred_seq, tmp_pred) ;
+        score_list = as_vector(pcg->get_value(output_layer.build_graph_on_matrix(nonlinear_expr))) ;
+    };
+    beam_decoder.decode(expr_cont1.size(), tag_num, score_func, pred_seq) ;
 }
 
 /* CRF output with feature */
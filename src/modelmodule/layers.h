@@ -52,6 +52,10 @@ struct DenseLayer
     ~DenseLayer();
     void new_graph(dynet::ComputationGraph &cg);
     dynet::expr::Expression build_graph(const dynet::expr::Expression &e);
+    // inputs are stacked as columns, returns the (output_dim x len) matrix in one node.
+    dynet::expr::Expression build_graph_on_cols(const std::vector<dynet::expr::Expression> &e_list);
+    // inputs are the columns of `m`.
+    dynet::expr::Expression build_graph_on_matrix(const dynet::expr::Expression &m);
 };
 
 struct Merge2Layer
@@ -66,6 +70,8 @@ struct Merge2Layer
     ~Merge2Layer();
     void new_graph(dynet::ComputationGraph &cg);
     dynet::expr::Expression build_graph(const dynet::expr::Expression &e1, const dynet::expr::Expression &e2);
+    dynet::expr::Expression build_graph_on_cols(const std::vector<dynet::expr::Expression> &e1_list,
+        const std::vector<dynet::expr::Expression> &e2_list);
 };
 
 struct Merge3Layer
@@ -82,6 +88,11 @@ struct Merge3Layer
     ~Merge3Layer();
     void new_graph(dynet::ComputationGraph &cg);
     dynet::expr::Expression build_graph(const dynet::expr::Expression &e1, const dynet::expr::Expression &e2, const dynet::expr::Expression &e3);
+    // factorized form: build_graph(e1, e2, e3) = build_graph_except_last(e1, e2) + w3 * e3.
+    // when e3 takes values from a small set (e.g. tag embedding), the last part is built once for every value and shared.
+    dynet::expr::Expression build_graph_except_last(const dynet::expr::Expression &e1, const dynet::expr::Expression &e2);
+    // w3 * [e3_list[0], e3_list[1], ...], (output_dim x len) matrix.
+    dynet::expr::Expression build_last_on_cols(const std::vector<dynet::expr::Expression> &e3_list);
 };
 
 struct Merge4Layer
@@ -101,6 +112,10 @@ struct Merge4Layer
     void new_graph(dynet::ComputationGraph &cg);
     dynet::expr::Expression build_graph(const dynet::expr::Expression &e1, const dynet::expr::Expression &e2, const dynet::expr::Expression &e3,
         const dynet::expr::Expression &e4);
+    // factorized form, the same as Merge3Layer.
+    dynet::expr::Expression build_graph_except_last(const dynet::expr::Expression &e1, const dynet::expr::Expression &e2,
+        const dynet::expr::Expression &e3);
+    dynet::expr::Expression build_last_on_cols(const std::vector<dynet::expr::Expression> &e4_list);
 };
 
 class MLPHiddenLayer
@@ -117,7 +132,11 @@ public:
     void new_graph(dynet::ComputationGraph &cg);
     dynet::expr::Expression build_graph(const dynet::expr::Expression &input_expr);
     void build_graph(const std::vector<dynet::expr::Expression> &input_exprs, std::vector<dynet::expr::Expression> &output_exprs);
+    // build from the net (affine output) of the first hidden layer, which is computed outside (e.g. by precomputed table).
+    dynet::expr::Expression build_graph_from_first_net(const dynet::expr::Expression &first_net_expr);
     unsigned get_output_dim(){ return output_dim; }
+    dynet::Parameter get_w_param(unsigned layer_idx) const { return w_list.at(layer_idx); }
+    dynet::Parameter get_b_param(unsigned layer_idx) const { return b_list.at(layer_idx); }
     // setter
     void enable_dropout(){ is_enable_dropout = true; }
     void disable_dropout(){ is_enable_dropout = false; }
@@ -151,6 +170,16 @@ Expression DenseLayer::build_graph(const dynet::expr::Expression &e)
        w_exp , e 
     });
 }
+inline
+Expression DenseLayer::build_graph_on_cols(const std::vector<dynet::expr::Expression> &e_list)
+{
+    return build_graph_on_matrix(dynet::expr::concatenate_cols(e_list));
+}
+inline
+Expression DenseLayer::build_graph_on_matrix(const dynet::expr::Expression &m)
+{
+    return dynet::expr::colwise_add(w_exp * m, b_exp);
+}
 
 // Merge2Layer 
 inline 
@@ -169,6 +198,14 @@ dynet::expr::Expression Merge2Layer::build_graph(const dynet::expr::Expression &
         w2_exp , e2,
     });
 }
+inline
+dynet::expr::Expression Merge2Layer::build_graph_on_cols(const std::vector<dynet::expr::Expression> &e1_list,
+    const std::vector<dynet::expr::Expression> &e2_list)
+{
+    return dynet::expr::colwise_add(
+        w1_exp * dynet::expr::concatenate_cols(e1_list) + w2_exp * dynet::expr::concatenate_cols(e2_list),
+        b_exp);
+}
 
 // Merge3Layer
 inline 
@@ -190,6 +227,20 @@ dynet::expr::Expression Merge3Layer::build_graph(const dynet::expr::Expression &
         w3_exp, e3
     });
 }
+inline
+dynet::expr::Expression Merge3Layer::build_graph_except_last(const dynet::expr::Expression &e1, const dynet::expr::Expression &e2)
+{
+    return affine_transform({
+        b_exp,
+        w1_exp, e1 ,
+        w2_exp, e2
+    });
+}
+inline
+dynet::expr::Expression Merge3Layer::build_last_on_cols(const std::vector<dynet::expr::Expression> &e3_list)
+{
+    return w3_exp * dynet::expr::concatenate_cols(e3_list);
+}
 
 // Merge4Layer
 inline 
@@ -215,6 +266,24 @@ dynet::expr::Expression Merge4Layer::build_graph(const dynet::expr::Expression &
     });
 }
 
+inline
+dynet::expr::Expression Merge4Layer::build_graph_except_last(const dynet::expr::Expression &e1, const dynet::expr::Expression &e2,
+    const dynet::expr::Expression &e3)
+{
+    return affine_transform({
+        b_exp,
+        w1_exp, e1 ,
+        w2_exp, e2 ,
+        w3_exp, e3
+    });
+}
+
+inline
+dynet::expr::Expression Merge4Layer::build_last_on_cols(const std::vector<dynet::expr::Expression> &e4_list)
+{
+    return w4_exp * dynet::expr::concatenate_cols(e4_list);
+}
+
 // MLPHiddenLayer
 
 inline
@@ -256,6 +325,25 @@ void MLPHiddenLayer::build_graph(const std::vector<dynet::expr::Expression> &inp
     swap(output_exprs, tmp_output_exprs);
 }
 
+inline
+dynet::expr::Expression
+MLPHiddenLayer::build_graph_from_first_net(const dynet::expr::Expression &first_net_expr)
+{
+    dynet::expr::Expression net_expr = first_net_expr;
+    for( unsigned i = 0 ; i < nr_hidden_layer; ++i )
+    {
+        if( i > 0 )
+        {
+            net_expr = affine_transform({
+                b_expr_list[i],
+                w_expr_list[i], net_expr });
+        }
+        if( is_enable_dropout && std::abs(dropout_rate - 0.f) > 1e-6 ) { net_expr = dynet::expr::dropout(net_expr, dropout_rate); }
+        net_expr = (*nonlinear_func)(net_expr);
+    }
+    return net_expr;
+}
+
 /*****************************
 *    Template Implementation
 *****************************/
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <stdexcept>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "viterbi_decoder.h"
+
+namespace slnn{
+
+constexpr ViterbiDecoder::real ViterbiDecoder::InvalidScore;
+constexpr std::size_t ViterbiDecoder::Alignment;
+constexpr std::size_t ViterbiDecoder::Lane;
+unsigned long ViterbiDecoder::global_score_generation = 0UL;
+
+ViterbiDecoder::ViterbiDecoder()
+    :tag_num(0),
+    stride(0),
+    score_generation(0UL)
+{}
+
+void ViterbiDecoder::set_score(const std::vector<real> &init_score, const std::vector<real> &transition_score)
+{
+    unsigned sz = init_score.size();
+    if( sz == 0 || transition_score.size() != static_cast<std::size_t>(sz) * sz )
+    {
+        throw std::invalid_argument("viterbi decoder: init score size and transition score size are not matched.");
+    }
+    tag_num = sz;
+    score_generation = global_score_generation;
+    stride = (tag_num + Lane - 1) / Lane * Lane;
+    init_score_list.assign(init_score.begin(), init_score.end());
+    // the padding `to` tags can never be reached.
+    transition_score_matrix.assign(tag_num * stride, InvalidScore);
+    for( unsigned from = 0; from < tag_num; ++from )
+    {
+        std::copy(transition_score.begin() + from * tag_num, transition_score.begin() + (from + 1) * tag_num,
+            transition_score_matrix.begin() + from * stride);
+    }
+    pre_score_buffer.assign(stride, InvalidScore);
+    cur_score_buffer.assign(stride, InvalidScore);
+}
+
+void ViterbiDecoder::decode(const real *emission_score, std::size_t seq_len, std::vector<Index> &pred_seq)
+{
+    using std::swap;
+    if( !has_score() ){ throw std::logic_error("viterbi decoder: score has not been set."); }
+    if( seq_len == 0 ){ pred_seq.clear(); return; }
+    if( backpointer_buffer.size() < (seq_len - 1) * stride ){ backpointer_buffer.resize((seq_len - 1) * stride); }
+    // time 0
+    real *cur_score = cur_score_buffer.data(),
+        *pre_score = pre_score_buffer.data();
+    for( unsigned tag = 0; tag < tag_num; ++tag ){ cur_score[tag] = init_score_list[tag] + emission_score[tag]; }
+    // continues time. backpointer records from time 1.
+    for( std::size_t t = 1; t < seq_len; ++t )
+    {
+        swap(cur_score, pre_score);
+        maxplus_step(pre_score, cur_score, backpointer_buffer.data() + (t - 1) * stride);
+        const real *cur_emission_score = emission_score + t * tag_num;
+        for( unsigned tag = 0; tag < tag_num; ++tag ){ cur_score[tag] += cur_emission_score[tag]; }
+    }
+    // trace back
+    std::vector<Index> tmp_pred_seq(seq_len);
+    Index tag = std::distance(cur_score, std::max_element(cur_score, cur_score + tag_num));
+    tmp_pred_seq[seq_len - 1] = tag;
+    for( std::size_t t = seq_len - 1; t >= 1; --t )
+    {
+        tag = backpointer_buffer[(t - 1) * stride + tag];
+        tmp_pred_seq[t - 1] = tag;
+    }
+    swap(pred_seq, tmp_pred_seq);
+}
+
+/**
+ * cur_score[to] = max_{from}( pre_score[from] + transition[from][to] ), backpointer[to] = argmax.
+ */
+#ifdef __AVX2__
+void ViterbiDecoder::maxplus_step(const real *pre_score, real *cur_score, std::int32_t *backpointer) const
+{
+    const real *trans = transition_score_matrix.data();
+    for( std::size_t to = 0; to < stride; to += Lane )
+    {
+        // from = 0 as the initial best.
+        __m256 best = _mm256_add_ps(_mm256_set1_ps(pre_score[0]), _mm256_load_ps(trans + to));
+        __m256 best_from = _mm256_setzero_ps(); // int32 stored in float register, to use the blend.
+        for( unsigned from = 1; from < tag_num; ++from )
+        {
+            __m256 score = _mm256_add_ps(_mm256_set1_ps(pre_score[from]),
+                _mm256_load_ps(trans + from * stride + to));
+            __m256 is_better = _mm256_cmp_ps(score, best, _CMP_GT_OQ);
+            best = _mm256_blendv_ps(best, score, is_better);
+            best_from = _mm256_blendv_ps(best_from,
+                _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(from))), is_better);
+        }
+        _mm256_store_ps(cur_score + to, best);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(backpointer + to), _mm256_castps_si256(best_from));
+    }
+}
+#else
+void ViterbiDecoder::maxplus_step(const real *pre_score, real *cur_score, std::int32_t *backpointer) const
+{
+    const real *trans = transition_score_matrix.data();
+    for( std::size_t to = 0; to < stride; ++to )
+    {
+        real best = pre_score[0] + trans[to];
+        std::int32_t best_from = 0;
+        for( unsigned from = 1; from < tag_num; ++from )
+        {
+            real score = pre_score[from] + trans[from * stride + to];
+            if( score > best ){ best = score; best_from = from; }
+        }
+        cur_score[to] = best;
+        backpointer[to] = best_from;
+    }
+}
+#endif
+
+} // end of namespace slnn
@@ -0,0 +1,123 @@
+#ifndef MODELMODULE_VITERBI_DECODER_H_
+#define MODELMODULE_VITERBI_DECODER_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "utils/typedeclaration.h"
+
+namespace slnn{
+
+/**
+ * Aligned allocator, to make the score and backpointer buffers cache-line (and SIMD register) aligned.
+ */
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+    template <typename U>
+    struct rebind{ using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n);
+    void deallocate(T *p, std::size_t) noexcept;
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&){ return true; }
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&){ return false; }
+
+
+/**
+ * Viterbi decoder for the linear-chain CRF, working on plain score arrays (No computation graph).
+ * Usage:
+ *  1. set_score(init_score, transition_score) once for a model(re-set it after the model parameters changed);
+ *  2. decode(emission_score) for every sentence.
+ * The max-plus recursion is vectorized along the current tag (AVX2 if available),
+ * and the backpointers are kept in a flat aligned buffer which is reused between sentences.
+ * For equal scores, the smallest previous tag wins, the same as the original scalar implementation.
+ */
+class ViterbiDecoder
+{
+public:
+    using real = slnn::type::real;
+    // score for invalid state or transition.
+    // a finite value (not -inf), because we are compiled with fast-math.
+    static constexpr real InvalidScore = -1e20f;
+public:
+    ViterbiDecoder();
+    /**
+     * set the model score.
+     * @param init_score tag_num scores
+     * @param transition_score tag_num * tag_num scores, flat index is `from * tag_num + to`
+     */
+    void set_score(const std::vector<real> &init_score, const std::vector<real> &transition_score);
+    bool has_score() const { return tag_num != 0 && score_generation == global_score_generation; }
+    /**
+     * clear the cached score. should be called when the model parameters have been updated.
+     */
+    void clear_score(){ tag_num = 0; }
+    /**
+     * clear the cached score of all the decoders in current process.
+     * should be called when the model parameters are overwritten out of the training step
+     * (restore the stashed model, load or bind the parameters, update by other processes).
+     */
+    static void clear_all_score(){ ++global_score_generation; }
+    unsigned get_tag_num() const { return tag_num; }
+    /**
+     * decode.
+     * @param emission_score seq_len * tag_num scores, flat index is `tag + tag_num * time_step`
+     * @param seq_len sequence length
+     * @param pred_seq[out] best tag sequence
+     */
+    void decode(const real *emission_score, std::size_t seq_len, std::vector<Index> &pred_seq);
+    void decode(const std::vector<real> &emission_score, std::vector<Index> &pred_seq)
+    { decode(emission_score.data(), has_score() ? emission_score.size() / tag_num : 0, pred_seq); }
+private:
+    void maxplus_step(const real *pre_score, real *cur_score, std::int32_t *backpointer) const;
+private:
+    static constexpr std::size_t Alignment = 64;
+    static constexpr std::size_t Lane = 8; // float number in an AVX register
+    static unsigned long global_score_generation;
+    unsigned tag_num;
+    std::size_t stride; // tag_num padded to `Lane`
+    unsigned long score_generation; // `global_score_generation` when the score is set
+    std::vector<real, AlignedAllocator<real, Alignment>> init_score_list;
+    std::vector<real, AlignedAllocator<real, Alignment>> transition_score_matrix; // (tag_num x stride), row is `from` tag.
+    std::vector<real, AlignedAllocator<real, Alignment>> pre_score_buffer,
+        cur_score_buffer;
+    std::vector<std::int32_t, AlignedAllocator<std::int32_t, Alignment>> backpointer_buffer; // (seq_len - 1) x stride
+};
+
+
+/**************************************
+ * Inline Implementation
+ **************************************/
+
+template <typename T, std::size_t Alignment>
+inline
+T* AlignedAllocator<T, Alignment>::allocate(std::size_t n)
+{
+    // allocate extra space to align the pointer, and keep the original pointer just before the aligned memory.
+    std::size_t extra = Alignment + sizeof(void*);
+    void *raw = ::operator new(n * sizeof(T) + extra);
+    std::uintptr_t aligned_addr = (reinterpret_cast<std::uintptr_t>(raw) + extra) & ~(Alignment - 1);
+    reinterpret_cast<void**>(aligned_addr)[-1] = raw;
+    return reinterpret_cast<T*>(aligned_addr);
+}
+
+template <typename T, std::size_t Alignment>
+inline
+void AlignedAllocator<T, Alignment>::deallocate(T *p, std::size_t) noexcept
+{
+    if( p ){ ::operator delete(reinterpret_cast<void**>(p)[-1]); }
+}
+
+} // end of namespace slnn
+
+#endif
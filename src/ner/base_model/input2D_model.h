@@ -11,6 +11,7 @@
 #include "utils/typedeclaration.h"
 #include "utils/dict_wrapper.hpp"
 #include "modelmodule/hyper_layers.h"
+#include "modelmodule/viterbi_decoder.h"
 
 namespace slnn{
 
@@ -38,7 +39,7 @@ public :
     dynet::Model *get_dynet_model(){ return m ; } ;
 
 
-    void set_dynet_model(std::istream &mis){ boost::archive::text_iarchive ti(mis) ; ti >> *m ; } 
+    void set_dynet_model(std::istream &mis){ boost::archive::text_iarchive ti(mis) ; ti >> *m ; ViterbiDecoder::clear_all_score() ; } 
 
     virtual void save_model(std::ostream &os) = 0 ;
     virtual void load_model(std::istream &is) = 0 ;
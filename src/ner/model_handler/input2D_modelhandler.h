@@ -1,12 +1,16 @@
 #ifndef SLNN_NER_MODELHANDLER_INPUT2D_MODELHANDLER_H
 #define SLNN_NER_MODELHANDLER_INPUT2D_MODELHANDLER_H
 
+#include <memory>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include "ner/base_model/input2D_model.h"
 
 #include "utils/stat.hpp"
+#include "utils/parameter_snapshot.hpp"
+#include "utils/reusable_graph.hpp"
+#include "utils/parallel_reduce.hpp"
 namespace slnn{
 
 template <typename SIModel>
@@ -16,7 +20,8 @@ public :
     Input2DModel *sim ;
 
     float best_F1;
-    std::stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
+    unsigned nr_devel_worker; // devel by forked processes if > 1, @see utils::reduce_in_parallel
 
     const size_t SentMaxLen = 256;
     const size_t MaxSentNum = 0x8000; // 32k
@@ -39,6 +44,7 @@ public :
                          std::vector<IndexSeq> &postag_seqs , std::vector<IndexSeq> &ner_seqs);
     void read_test_data(std::istream &is, std::vector<Seq> &raw_test_sents, std::vector<IndexSeq> &sents ,
                         std::vector<IndexSeq> &postag_seqs);
+    void process_test_line(std::string &line, Seq &raw_sent, IndexSeq &sent, IndexSeq &postag_seq);
 
     // After Reading Training data
     void finish_read_training_data(boost::program_options::variables_map &varmap);
@@ -50,12 +56,10 @@ public :
                unsigned max_epoch, 
                const std::vector<IndexSeq> *p_dev_sents, 
                const std::vector<IndexSeq> *p_dev_postag_seqs , const std::vector<IndexSeq> *p_dev_ner_seqs ,
-               const std::string *p_conlleval_script_path,
                unsigned do_devel_freq ,
                unsigned trivial_report_freq);
     float devel(const std::vector<IndexSeq> *p_sents, const std::vector<IndexSeq> *p_postag_seqs ,
-                const std::vector<IndexSeq> *p_ner_seqs ,
-                const std::string *p_conlleval_script_path);
+                const std::vector<IndexSeq> *p_ner_seqs);
     void predict(std::istream &is, std::ostream &os);
 
     // Save & Load
@@ -86,7 +90,8 @@ template <typename SIModel>
 Input2DModelHandler<SIModel>::Input2DModelHandler()
     : sim(new SIModel()) ,
     best_F1(0.f) ,
-    best_model_tmp_ss()
+    best_model_snapshot(),
+    nr_devel_worker(1U)
 {}
 
 template <typename SIModel>
@@ -101,9 +106,7 @@ void Input2DModelHandler<SIModel>::save_current_best_model(float F1)
 {
     BOOST_LOG_TRIVIAL(info) << "better model has been found . stash it .";
     best_F1 = F1 ;
-    best_model_tmp_ss.str(""); // first , clear it's content !
-    boost::archive::text_oarchive to(best_model_tmp_ss);
-    to << *sim->get_dynet_model();
+    best_model_snapshot.take(sim->get_dynet_model());
 }
 
 template<typename SIModel>
@@ -248,9 +251,6 @@ void Input2DModelHandler<SIModel>::read_test_data(std::istream &is,
                                                   std::vector<IndexSeq> &sents ,
                                                   std::vector<IndexSeq> &postag_seqs)
 {
-    dynet::Dict &word_dict = sim->get_word_dict() ;
-    dynet::Dict &postag_dict = sim->get_postag_dict() ;
-    assert(word_dict.is_frozen() && postag_dict.is_frozen()) ;
     BOOST_LOG_TRIVIAL(info) << "read test data .";
     std::vector<Seq> tmp_raw_sents;
     std::vector<IndexSeq> tmp_sents,
@@ -258,34 +258,43 @@ void Input2DModelHandler<SIModel>::read_test_data(std::istream &is,
     std::string line;
     while (getline(is, line))
     {
-        boost::trim(line);
-        std::vector<std::string> parts_seq;
-        boost::split(parts_seq, line, boost::is_any_of("\t"));
-        unsigned seq_len = parts_seq.size();
-        tmp_raw_sents.emplace_back(seq_len);
-        tmp_sents.emplace_back(seq_len); // using constructor `vector(nr_num)` => push_back(vector<int>(nr_words)) 
-        tmp_postag_seqs.emplace_back(seq_len);
-        Seq &raw_sent = tmp_raw_sents.back();
-        IndexSeq &words_index_seq = tmp_sents.back() ,
-            &postag_index_seq = tmp_postag_seqs.back();
-        for (unsigned i = 0; i < seq_len; ++i)
-        {
-            std::string &part = parts_seq.at(i);
-            std::string::size_type delim_pos = part.rfind("_");
-            std::string raw_word = part.substr(0, delim_pos);
-            std::string postag = part.substr(delim_pos + 1);
-            std::string number_transed_word = replace_number(raw_word);
-            raw_sent[i] = raw_word ;
-            words_index_seq[i] = word_dict.convert(number_transed_word);
-            postag_index_seq[i] = postag_dict.convert(postag);
-        }
-
+        tmp_raw_sents.emplace_back();
+        tmp_sents.emplace_back();
+        tmp_postag_seqs.emplace_back();
+        process_test_line(line, tmp_raw_sents.back(), tmp_sents.back(), tmp_postag_seqs.back());
     }
     swap(tmp_raw_sents, raw_test_sents);
     swap(tmp_sents, sents);
     swap(tmp_postag_seqs, postag_seqs);
 }
 
+template <typename SIModel>
+void Input2DModelHandler<SIModel>::process_test_line(std::string &line, Seq &raw_sent, IndexSeq &words_index_seq,
+                                                     IndexSeq &postag_index_seq)
+{
+    dynet::Dict &word_dict = sim->get_word_dict() ;
+    dynet::Dict &postag_dict = sim->get_postag_dict() ;
+    assert(word_dict.is_frozen() && postag_dict.is_frozen()) ;
+    boost::trim(line);
+    std::vector<std::string> parts_seq;
+    boost::split(parts_seq, line, boost::is_any_of("\t"));
+    unsigned seq_len = parts_seq.size();
+    raw_sent.resize(seq_len);
+    words_index_seq.resize(seq_len);
+    postag_index_seq.resize(seq_len);
+    for (unsigned i = 0; i < seq_len; ++i)
+    {
+        std::string &part = parts_seq.at(i);
+        std::string::size_type delim_pos = part.rfind("_");
+        std::string raw_word = part.substr(0, delim_pos);
+        std::string postag = part.substr(delim_pos + 1);
+        std::string number_transed_word = replace_number(raw_word);
+        raw_sent[i] = raw_word ;
+        words_index_seq[i] = word_dict.convert(number_transed_word);
+        postag_index_seq[i] = postag_dict.convert(postag);
+    }
+}
+
 template <typename SIModel>
 void Input2DModelHandler<SIModel>::finish_read_training_data(boost::program_options::variables_map &varmap)
 {
@@ -307,7 +316,6 @@ void Input2DModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sents,
                                          const std::vector<IndexSeq> *p_dev_sents, 
                                          const std::vector<IndexSeq> *p_dev_postag_seqs,
                                          const std::vector<IndexSeq> *p_dev_ner_seqs,
-                                         const std::string *p_conlleval_script_path,
                                          unsigned do_devel_freq,
                                          unsigned trivial_report_freq)
 {
@@ -323,6 +331,7 @@ void Input2DModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sents,
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq sent_after_replace_unk(SentMaxLen , 0);
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for (unsigned nr_epoch = 0; nr_epoch < max_epoch && is_train_ok; ++nr_epoch)
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -341,9 +350,10 @@ void Input2DModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sents,
             const IndexSeq &sent = p_sents->at(access_idx),
                 &postag_seq = p_postag_seqs->at(access_idx) ,
                 &ner_seq = p_ner_seqs->at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 sent_after_replace_unk.resize(sent.size());
                 for( size_t word_idx = 0; word_idx < sent.size(); ++word_idx )
                 {
@@ -368,7 +378,8 @@ void Input2DModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sents,
             // If developing samples is available , do `devel` to get model training effect . 
             if (p_dev_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
             {
-                float F1 = devel(p_dev_sents  , p_dev_postag_seqs , p_dev_ner_seqs, p_conlleval_script_path);
+                pgraph.reset();
+                float F1 = devel(p_dev_sents  , p_dev_postag_seqs , p_dev_ner_seqs);
                 if (F1 > best_F1) save_current_best_model(F1);
                 line_cnt_for_devel = 0; // avoid overflow
                 if( is_train_error_occurs(F1) )
@@ -394,7 +405,8 @@ void Input2DModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sents,
         if (p_dev_sents != nullptr && is_train_ok)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
-            float F1 = devel(p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs, p_conlleval_script_path);
+            pgraph.reset();
+            float F1 = devel(p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs);
             if (F1 > best_F1) save_current_best_model(F1);
             if( is_train_error_occurs(F1) )
             {
@@ -410,28 +422,42 @@ void Input2DModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sents,
 template <typename SIModel>
 float Input2DModelHandler<SIModel>::devel(const std::vector<IndexSeq> *p_sents, 
                                           const std::vector<IndexSeq> *p_postag_seqs,
-                                          const std::vector<IndexSeq> *p_ner_seqs,
-                                          const std::string *p_conlleval_script_path)
+                                          const std::vector<IndexSeq> *p_ner_seqs)
 {
     unsigned nr_samples = p_sents->size();
     BOOST_LOG_TRIVIAL(info) << "validation at " << nr_samples << " instances .";
 
-    NerStat stat(*p_conlleval_script_path, "eval_out.tmp", true) ;
-    std::vector<IndexSeq> pred_ner_seqs(p_ner_seqs->size());
+    NerStat stat(true);
+    ConllChunkEval chunk_eval(sim->get_ner_dict());
     stat.start_time_stat();
-    for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
+    chunk_eval.start_eval();
+    // every worker process builds its own graph at its first instance.
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
+    auto devel_one = [&](unsigned idx, ConllChunkEval::EvalTempResultT &result)
     {
-        dynet::ComputationGraph cg;
+        if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+        dynet::ComputationGraph &cg = pgraph->renew();
         IndexSeq predict_ner_seq;
-        const IndexSeq &sent = p_sents->at(access_idx) ,
-            &postag_seq = p_postag_seqs->at(access_idx);
+        const IndexSeq &sent = p_sents->at(idx) ,
+            &postag_seq = p_postag_seqs->at(idx);
         sim->predict(cg, sent, postag_seq, predict_ner_seq);
-        stat.total_tags += predict_ner_seq.size();
-        pred_ner_seqs[access_idx] = predict_ner_seq;
+        result += chunk_eval.eval_one(p_ner_seqs->at(idx), predict_ner_seq);
+    };
+    ConllChunkEval::EvalTempResultT result;
+    if( nr_devel_worker > 1 && slnn::utils::is_parallel_reduce_supported() )
+    {
+        result = slnn::utils::reduce_in_parallel<ConllChunkEval::EvalTempResultT>(nr_devel_worker, 0U, nr_samples,
+            devel_one);
+    }
+    else
+    {
+        for( unsigned idx = 0; idx < nr_samples; ++idx ){ devel_one(idx, result); }
     }
+    chunk_eval.merge_temp_result(result);
+    stat.total_tags = result.nr_token;
     stat.end_time_stat();
   
-    std::array<float , 4> eval_scores = stat.conlleval(*p_ner_seqs, pred_ner_seqs, sim->get_ner_dict());
+    std::array<float , 4> eval_scores = chunk_eval.end_eval();
     float Acc = eval_scores[0] , 
         P = eval_scores[1] ,
         R = eval_scores[2] ,
@@ -443,31 +469,36 @@ float Input2DModelHandler<SIModel>::devel(const std::vector<IndexSeq> *p_sents,
     return F1;
 }
 
+/**
+ * predict in streaming mode : read a line, predict and write it. 
+ * memory is constant and the input can be a pipe. output is flushed every `FlushLineNum` lines.
+ */
 template <typename SIModel>
 void Input2DModelHandler<SIModel>::predict(std::istream &is, std::ostream &os)
 {
-    
-    std::vector<Seq> raw_instances;
-    std::vector<IndexSeq> sents ,
-        postag_seqs;
-    read_test_data(is,raw_instances, sents , postag_seqs);
-    BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
+    constexpr unsigned FlushLineNum = 1024;
+    BOOST_LOG_TRIVIAL(info) << "do prediction in streaming mode .";
     BasicStat stat(true);
     dynet::Dict &postag_dict = sim->get_postag_dict() ;
     dynet::Dict &ner_dict = sim->get_ner_dict() ;
     stat.start_time_stat();
-    for (unsigned int i = 0; i < raw_instances.size(); ++i)
+    std::string line;
+    Seq raw_sent;
+    IndexSeq sent,
+        postag_seq;
+    unsigned long nr_instance = 0;
+    slnn::ReusableGraph graph;
+    while( getline(is, line) )
     {
-        Seq &raw_sent = raw_instances.at(i);
+        if( ++nr_instance % FlushLineNum == 0 ){ os.flush(); }
+        process_test_line(line, raw_sent, sent, postag_seq);
         if (0 == raw_sent.size())
         {
             os << "\n";
             continue;
         }
-        IndexSeq &sent = sents.at(i) ,
-            postag_seq = postag_seqs.at(i);
         IndexSeq pred_ner_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         sim->predict(cg, sent, postag_seq, pred_ner_seq);
         os << raw_sent[0] 
             << "/" << postag_dict.convert(postag_seq[0]) 
@@ -482,16 +513,18 @@ void Input2DModelHandler<SIModel>::predict(std::istream &is, std::ostream &os)
         os << "\n";
         stat.total_tags += pred_ner_seq.size() ;
     }
+    os.flush();
     stat.end_time_stat() ;
+    BOOST_LOG_TRIVIAL(info) << "predicted instance : " << nr_instance ;
     BOOST_LOG_TRIVIAL(info) << stat.get_stat_str("predict done.")  ;
 }
 
 template <typename SIModel>
 void Input2DModelHandler<SIModel>::save_model(std::ostream &os)
 {
-    if( best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail() )
+    if( best_model_snapshot.restore(sim->get_dynet_model()) )
     {
-        sim->set_dynet_model(best_model_tmp_ss) ;
+        ViterbiDecoder::clear_all_score() ; // drop the decoder score of the old parameters
     }
     sim->save_model(os) ;
 }
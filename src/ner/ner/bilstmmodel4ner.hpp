@@ -13,6 +13,7 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <memory>
 #include <string>
 #include <chrono>
 #include <functional>
@@ -28,9 +29,14 @@
 #include <boost/program_options.hpp>
 
 #include "modelmodule/layers.h"
+#include "modelmodule/beam_search_decoder.h"
 #include "utils/utf8processing.hpp"
 #include "utils/dict_wrapper.hpp"
 #include "utils/stat.hpp"
+#include "utils/parameter_snapshot.hpp"
+#include "utils/reusable_graph.hpp"
+#include "utils/parallel_reduce.hpp"
+#include "utils/reader.hpp"
 
 using namespace std;
 using namespace dynet;
@@ -82,7 +88,13 @@ struct BILSTMModel4NER
 
     // model saving
     float best_F1;
-    stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
+
+    // devel by processes
+    unsigned nr_devel_worker;
+
+    // decoding, beam size 1 (greedy) by default
+    BeamSearchDecoder beam_decoder;
 
     // others 
     dynet::Dict word_dict;
@@ -104,7 +116,7 @@ struct BILSTMModel4NER
     BILSTMModel4NER() :
         m(nullptr), input_merge_layer(nullptr) , bilstm_layer(nullptr),
         bilstm_pretag_merge_layer(nullptr) , output_linear_layer(nullptr) ,
-        best_F1(0.f), best_model_tmp_ss() ,
+        best_F1(0.f), best_model_snapshot() , nr_devel_worker(1U) ,
         word_dict_wrapper(word_dict)
     {}
 
@@ -152,7 +164,6 @@ struct BILSTMModel4NER
         // Each line is combined with `WORD_TAG`s and delimeters , delimeter is only TAB . `WORD_TAG` should be split to `WORD` and `TAG`
         // Attention : empty line will be skipped 
         unsigned line_cnt = 0;
-        string line;
         vector<IndexSeq> tmp_sents;
         vector<IndexSeq> tmp_postag_seqs;
         vector<IndexSeq> tmp_nertag_seqs;
@@ -167,15 +178,21 @@ struct BILSTMModel4NER
         postag_seq.reserve(256);
         nertag_seq.reserve(256);
 
-        while (getline(is, line)) {
-            boost::algorithm::trim(line);
-            if (0 == line.size()) continue;
-            vector<string> parts ;
-            boost::algorithm::split(parts, line, boost::is_any_of("\t"));
+        // lines are split in the block of the reader, and the part string is reused.
+        Reader reader(is);
+        const char *line_data = nullptr;
+        size_t line_len = 0;
+        vector<TokenSpan> part_span_list;
+        string part;
+        while (reader.readline_view(line_data, line_len)) {
+            trim_view(line_data, line_len);
+            if (0 == line_len) continue;
+            split_to_spans(line_data, line_len, [](char c){ return c == '\t'; }, part_span_list);
             sent.clear();
             postag_seq.clear();
             nertag_seq.clear();
-            for (string &part : parts) {
+            for (const TokenSpan &part_span : part_span_list) {
+                part.assign(line_data + part_span.first, part_span.second);
                 string::size_type postag_pos = part.rfind("/");
                 string::size_type nertag_pos = part.rfind("#");
                 assert(postag_pos != string::npos && nertag_pos != string::npos);
@@ -245,19 +262,23 @@ struct BILSTMModel4NER
         sent.reserve(256);
         postag_seq.reserve(256);
         
-        string line;
-        while (getline(is, line))
+        Reader reader(is);
+        const char *line_data = nullptr;
+        size_t line_len = 0;
+        vector<TokenSpan> part_span_list;
+        string part;
+        while (reader.readline_view(line_data, line_len))
         {
-            boost::trim(line);
-            vector<string> parts;
-            boost::split(parts , line, boost::is_any_of("\t"));
+            trim_view(line_data, line_len);
+            split_to_spans(line_data, line_len, [](char c){ return c == '\t'; }, part_span_list);
             
             raw_sent.resize(0);
             sent.resize(0);
             postag_seq.resize(0);
 
-            for (string &part : parts)
+            for (const TokenSpan &part_span : part_span_list)
             {
+                part.assign(line_data + part_span.first, part_span.second);
                 string::size_type delim_pos = part.rfind("_");
                 string raw_word = part.substr(0, delim_pos);
                 string postag = part.substr(delim_pos + 1);
@@ -406,11 +427,7 @@ struct BILSTMModel4NER
             << NER_LAYER_HIDDEN_DIM << NER_LAYER_OUTPUT_DIM;
 
         to << word_dict << postag_dict << ner_dict ;
-        if (0 != best_model_tmp_ss.rdbuf()->in_avail())
-        {
-            boost::archive::text_iarchive ti(best_model_tmp_ss);
-            ti >> *m;
-        }
+        best_model_snapshot.restore(m);
         
         to << *m; 
         BOOST_LOG_TRIVIAL(info) << "saving model done .";
@@ -564,38 +581,40 @@ struct BILSTMModel4NER
         // 2 calc Expression of every timestep of BI-LSTM
 
         bilstm_layer->build_graph(input_exp_cont , l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont);
-        // 3. set previous tag lookup expression
-
-        Expression pretag_lookup_exp = pretag_SOS_exp ;
-
-        // build tag network , calc loss Expression of every timestep 
-        for (unsigned i = 0; i < sent_len; ++i)
+        // 3. decode by beam search (greedy for beam size 1)
+        // the merge layer is factorized : the bilstm part is built once for every timestep,
+        // the pre-tag part once for every pre-tag (index NER_LAYER_OUTPUT_DIM for SOS).
+        // the hypotheses of the beam are stacked as columns and scored together.
+        vector<Expression> pretag_part_exp_cont(NER_LAYER_OUTPUT_DIM + 1);
+        vector<bool> is_pretag_part_built(NER_LAYER_OUTPUT_DIM + 1, false);
+        auto score_func = [&](size_t i, const IndexSeq &pretag_list, vector<float> &score_list)
         {
-            Expression bilstm_pretag_merge_exp = bilstm_pretag_merge_layer->build_graph(l2r_lstm_output_exp_cont[i],
-                r2l_lstm_output_exp_cont[i], pretag_lookup_exp);
-            Expression tag_hidden_layer_output_at_timestep_t = dynet::expr::rectify(bilstm_pretag_merge_exp);
-            Expression output_expr = output_linear_layer->build_graph(tag_hidden_layer_output_at_timestep_t); 
-            vector<float> output_values = as_vector(cg.incremental_forward(output_expr));
-            float max_value = output_values[0];
-            unsigned tag_id_with_max_value = 0;
-            for (unsigned i = 1; i < NER_LAYER_OUTPUT_DIM; ++i)
+            vector<Expression> pretag_part_exp_list(pretag_list.size());
+            for( size_t k = 0; k < pretag_list.size(); ++k )
             {
-                if (max_value < output_values[i])
+                size_t idx = pretag_list[k] < 0 ? NER_LAYER_OUTPUT_DIM : pretag_list[k];
+                if( !is_pretag_part_built[idx] )
                 {
-                    max_value = output_values[i];
-                    tag_id_with_max_value = i;
+                    Expression pretag_lookup_exp = pretag_list[k] < 0 ? pretag_SOS_exp : lookup(cg, nertags_lookup_param, pretag_list[k]);
+                    pretag_part_exp_cont[idx] = bilstm_pretag_merge_layer->build_last_on_cols({ pretag_lookup_exp });
+                    is_pretag_part_built[idx] = true;
                 }
+                pretag_part_exp_list[k] = pretag_part_exp_cont[idx];
             }
-            p_predict_tag_seq->push_back(tag_id_with_max_value);
-            // set pretag_lookup_exp for next timestep 
-            pretag_lookup_exp = lookup(cg, nertags_lookup_param, tag_id_with_max_value);
-        }
+            Expression bilstm_pretag_merge_exp = colwise_add(concatenate_cols(pretag_part_exp_list),
+                bilstm_pretag_merge_layer->build_graph_except_last(l2r_lstm_output_exp_cont[i], r2l_lstm_output_exp_cont[i]));
+            Expression tag_hidden_layer_output = dynet::expr::rectify(bilstm_pretag_merge_exp);
+            Expression output_expr = output_linear_layer->build_graph_on_matrix(tag_hidden_layer_output);
+            score_list = as_vector(cg.incremental_forward(output_expr));
+        };
+        IndexSeq predict_tag_seq;
+        beam_decoder.decode(sent_len, NER_LAYER_OUTPUT_DIM, score_func, predict_tag_seq);
+        p_predict_tag_seq->insert(p_predict_tag_seq->end(), predict_tag_seq.begin(), predict_tag_seq.end());
     }
 
     void train(const vector<IndexSeq> *p_sents, const vector<IndexSeq> *p_postag_seqs , const vector<IndexSeq> *p_ner_seqs ,
         unsigned max_epoch, const vector<IndexSeq> *p_dev_sents = nullptr, const vector<IndexSeq> *p_dev_postag_seqs = nullptr ,
         const vector<IndexSeq> *p_dev_ner_seqs = nullptr ,
-        const string &conlleval_script_path="./ner_eval.sh" ,
         unsigned do_devel_freq=10000)
     {
         unsigned nr_samples = p_sents->size();
@@ -610,6 +629,9 @@ struct BILSTMModel4NER
         unsigned long long total_time_cost_in_seconds = 0ULL ;
         IndexSeq sent_unk_replace;
         sent_unk_replace.reserve(256);
+        // because at one scope , only one ComputationGraph is permited ,
+        // the training graph is released before develing (devel has its own graph).
+        std::unique_ptr<slnn::ReusableGraph> pgraph;
         for (unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch)
         {
             BOOST_LOG_TRIVIAL(info) << "Epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -637,14 +659,12 @@ struct BILSTMModel4NER
                     sent_unk_replace[ite - sent.cbegin()] = word_dict_wrapper.unk_replace_probability(*ite);
                 }
                 // using negative_loglikelihood loss to build model
-                ComputationGraph *cg = new ComputationGraph(); // because at one scope , only one ComputationGraph is permited .
-                                                               // so we have to declaring it as pointer and destroy it handly 
-                                                               // before develing.
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                ComputationGraph *cg = &pgraph->renew();
                 auto loss_expr = negative_loglikelihood(&sent_unk_replace, &postag_seq, &ner_seq, cg, &training_stat_per_report);
                 training_stat_per_report.loss += as_scalar(cg->forward(loss_expr));
                 cg->backward(loss_expr);
                 sgd.update(1.0);
-                delete cg;
 
                 if (0 == (i + 1) % report_freq) // Report 
                 {
@@ -665,14 +685,13 @@ struct BILSTMModel4NER
                 if (p_dev_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
                 {
                     BOOST_LOG_TRIVIAL(info) << "do validation at every " << do_devel_freq << " samples " ;
-                    float F1 = devel(p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs , conlleval_script_path);
+                    pgraph.reset();
+                    float F1 = devel(p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs);
                     if (F1 > best_F1)
                     {
                         BOOST_LOG_TRIVIAL(info) << "Better model found . stash it .";
                         best_F1 = F1;
-                        best_model_tmp_ss.str(""); // first , clear it's content !
-                        boost::archive::text_oarchive to(best_model_tmp_ss);
-                        to << *m;
+                        best_model_snapshot.take(m);
                     }
                     line_cnt_for_devel = 0; // avoid overflow
                 }
@@ -701,14 +720,13 @@ struct BILSTMModel4NER
             if (p_dev_sents != nullptr)
             {
                 BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch ." ;
-                float F1 = devel(p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs , conlleval_script_path);
+                pgraph.reset();
+                float F1 = devel(p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs);
                 if (F1 > best_F1)
                 {
                     BOOST_LOG_TRIVIAL(info) << "Better model found . stash it .";
                     best_F1 = F1;
-                    best_model_tmp_ss.str(""); // first , clear it's content !
-                    boost::archive::text_oarchive to(best_model_tmp_ss);
-                    to << *m;
+                    best_model_snapshot.take(m);
                 }
             }
         }
@@ -716,30 +734,42 @@ struct BILSTMModel4NER
     }
 
     float devel(const vector<IndexSeq> *p_dev_sents , const vector<IndexSeq> *p_dev_postag_seqs , 
-        const vector<IndexSeq> *p_dev_ner_seqs , const string conlleval_script_path="./ner_eval.sh" )
+        const vector<IndexSeq> *p_dev_ner_seqs)
     {
         unsigned nr_samples = p_dev_sents->size();
         BOOST_LOG_TRIVIAL(info) << "validation at " << nr_samples << " instances .";
-        unsigned long line_cnt4error_output = 0;
-        NerStat stat(conlleval_script_path);
+        NerStat stat;
+        ConllChunkEval chunk_eval(ner_dict);
         stat.start_time_stat();
-        vector<IndexSeq> predict_ner_seqs(*p_dev_ner_seqs); // copy
-        for (size_t idx = 0; idx < nr_samples; ++idx )
+        chunk_eval.start_eval();
+        // every worker process builds its own graph at its first instance.
+        std::unique_ptr<slnn::ReusableGraph> pgraph;
+        auto devel_one = [&](unsigned idx, ConllChunkEval::EvalTempResultT &result)
         {
-
-            ++line_cnt4error_output;
-            ComputationGraph cg;
+            if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+            ComputationGraph &cg = pgraph->renew();
             IndexSeq predict_ner_seq;
             const IndexSeq &sent = p_dev_sents->at(idx),
                 &postag_seq = p_dev_postag_seqs->at(idx) ,
                 &ner_seq = p_dev_ner_seqs->at(idx);
             do_predict(&sent, &postag_seq, &predict_ner_seq, &cg);
             assert(predict_ner_seq.size() == ner_seq.size());
-            stat.total_tags += predict_ner_seq.size() ;
-            predict_ner_seqs[idx] = predict_ner_seq;
+            result += chunk_eval.eval_one(ner_seq, predict_ner_seq);
+        };
+        ConllChunkEval::EvalTempResultT result;
+        if( nr_devel_worker > 1 && slnn::utils::is_parallel_reduce_supported() )
+        {
+            result = slnn::utils::reduce_in_parallel<ConllChunkEval::EvalTempResultT>(nr_devel_worker, 0U, nr_samples,
+                devel_one);
+        }
+        else
+        {
+            for( unsigned idx = 0; idx < nr_samples; ++idx ){ devel_one(idx, result); }
         }
+        chunk_eval.merge_temp_result(result);
+        stat.total_tags = result.nr_token;
         stat.end_time_stat();
-        array<float , 4> eval_scores = stat.conlleval(*p_dev_ner_seqs , predict_ner_seqs , ner_dict);
+        array<float , 4> eval_scores = chunk_eval.end_eval();
         float Acc = eval_scores[0] ,
             P = eval_scores[1] ,
             R = eval_scores[2] ,
@@ -762,6 +792,7 @@ struct BILSTMModel4NER
         BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_sents.size() << " instances .";
         BasicStat stat;
         stat.start_time_stat();
+        slnn::ReusableGraph graph;
         for (unsigned int i = 0; i < raw_sents.size(); ++i)
         {
             vector<string> *p_raw_sent = &raw_sents.at(i);
@@ -773,7 +804,7 @@ struct BILSTMModel4NER
             IndexSeq *p_sent = &sents.at(i);
             IndexSeq *p_postag_seq = &postag_seqs.at(i);
             IndexSeq predict_ner_seq;
-            ComputationGraph cg;
+            ComputationGraph &cg = graph.renew();
             do_predict(p_sent, p_postag_seq , &predict_ner_seq , &cg);
             // output the result directly
             os << p_raw_sent->at(0) 
@@ -3,12 +3,14 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 #include <boost/log/trivial.hpp>
 #include <boost/log/expressions.hpp>
 #include <boost/program_options.hpp>
 
 #include "bilstmmodel4ner.hpp"
+#include "utils/parallel_predictor.hpp"
 
 using namespace std;
 using namespace dynet;
@@ -59,8 +61,9 @@ int train_process(int argc, char *argv[] , const string &program_name)
         
         ("max_epoch", po::value<unsigned>()->default_value(4), "The epoch to iterate for training")
         ("devel_freq", po::value<unsigned long>()->default_value(6000), "The frequent(samples number)to validate(if set) . validation will be done after every devel-freq training samples")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("model", po::value<string>(), "Use to specify the model name(path)")
-        ("conlleval_script_path" , po::value<string>() , "Use to specify the conll evaluation script path")
 
         ("word_embedding_dim", po::value<unsigned>()->default_value(50), "The dimension for word embedding.")
         ("postag_embedding_dim", po::value<unsigned>()->default_value(5), "The dimension for tag embedding.")
@@ -117,6 +120,8 @@ int train_process(int argc, char *argv[] , const string &program_name)
     // Init 
     dynet::initialize(argc , argv , 1234); // 
     BILSTMModel4NER ner_model;
+    ner_model.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
+    ner_model.beam_decoder.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // reading traing data , get word dict size and output tag number
     // -> set replace frequency for word_dict_wrapper
@@ -141,25 +146,8 @@ int train_process(int argc, char *argv[] , const string &program_name)
     vector<IndexSeq> dev_sents, *p_dev_sents = nullptr,
         dev_postag_seqs, *p_dev_postag_seqs = nullptr,
         dev_ner_seqs, *p_dev_ner_seqs = nullptr;
-    string conlleval_script_path = "";
     if ("" != devel_data_path)
     {
-        if(0 == var_map.count("conlleval_script_path"))
-        {
-            BOOST_LOG_TRIVIAL(fatal) << "Eval script path should be specified when doing validation ." 
-                << "\nExit!"  ;
-            return -1 ;
-        }
-        conlleval_script_path = var_map["conlleval_script_path"].as<string>();
-        // Check is evaluation scripts exists 
-        ifstream tmpis_for_check(conlleval_script_path);
-        if (!tmpis_for_check)
-        {
-            BOOST_LOG_TRIVIAL(fatal) << "Eval script is not exists at `" << conlleval_script_path << "`\n"
-                "Exit! ";
-            return -1;
-        }
-        tmpis_for_check.close();
         std::ifstream devel_is(devel_data_path);
         if (!devel_is) {
             BOOST_LOG_TRIVIAL(error) << "failed to open devel file: `" << devel_data_path << "`\n Exit!";
@@ -175,7 +163,7 @@ int train_process(int argc, char *argv[] , const string &program_name)
     
     // Train 
     ner_model.train(&sents , &postag_seqs , &ner_seqs , max_epoch,
-        p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs , conlleval_script_path , devel_freq);
+        p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs , devel_freq);
 
     // save model
     string model_path;
@@ -205,12 +193,12 @@ int devel_process(int argc, char *argv[] , const string &program_name)
         "using `" + program_name + " devel <options>` to validate . devel options are as following";
     po::options_description op_des = po::options_description(description);
     // set params to receive the arguments 
-    string devel_data_path , model_path, eval_script_path;
+    string devel_data_path , model_path;
     op_des.add_options()
         ("devel_data", po::value<string>(&devel_data_path), "The path to validation data .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
-        ("conlleval_script_path", po::value<string>(&eval_script_path)->default_value(string("./ner_eval.sh")), 
-            "Use to specify the conll evaluation script path")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc , argv).options(op_des).allow_unregistered().run(), var_map);
@@ -233,20 +221,13 @@ int devel_process(int argc, char *argv[] , const string &program_name)
             "Exit! ";
         return -1;
     }
-  
-    // Check is evaluation scripts exists 
-    ifstream tmpis_for_check(eval_script_path);
-    if (!tmpis_for_check)
-    {
-        BOOST_LOG_TRIVIAL(fatal) << "Eval script is not exists at `" << eval_script_path << "`\n"
-            "Exit! ";
-        return -1;
-    }
-    tmpis_for_check.close();
+
 
     // Init 
     dynet::initialize(argc, argv, 1234);
     BILSTMModel4NER ner_model;
+    ner_model.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
+    ner_model.beam_decoder.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // Load model 
     ifstream is(model_path);
@@ -274,7 +255,7 @@ int devel_process(int argc, char *argv[] , const string &program_name)
     devel_is.close();
 
     // devel
-    ner_model.devel(&sents , &postag_seqs , &ner_seqs , eval_script_path); // Get the same result , it is OK .
+    ner_model.devel(&sents , &postag_seqs , &ner_seqs); // Get the same result , it is OK .
     return 0;
 }
 
@@ -288,6 +269,10 @@ int predict_process(int argc, char *argv[] , const string &program_name)
         ("raw_data", po::value<string>(), "The path to raw data(It should be segmented) .")
         ("output" , po::value<string>() , "The path to storing result . using `stdout` if not specified ." )
         ("model", po::value<string>(), "Use to specify the model name(path)")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
+        ("threads", po::value<unsigned>()->default_value(1), "Number of prediction workers (processes sharing the loaded model).")
+        ("socket", po::value<string>(), "Serve on the unix socket instead of predicting raw data. "
+            "a client writes lines, shuts down writing, then reads the result.")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc , argv).options(op_des).allow_unregistered().run(), var_map);
@@ -300,13 +285,13 @@ int predict_process(int argc, char *argv[] , const string &program_name)
 
     //set params 
     string raw_data_path, output_path, model_path;
-    if (0 == var_map.count("raw_data"))
+    if (0 == var_map.count("raw_data") && 0 == var_map.count("socket"))
     {
         BOOST_LOG_TRIVIAL(fatal) << "raw_data path should be specified .\n"
             "Exit!";
         return -1;
     }
-    else raw_data_path = var_map["raw_data"].as<string>();
+    else if (var_map.count("raw_data")) raw_data_path = var_map["raw_data"].as<string>();
 
     if (0 == var_map.count("output"))
     {
@@ -326,6 +311,7 @@ int predict_process(int argc, char *argv[] , const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234);
     BILSTMModel4NER ner_model;
+    ner_model.beam_decoder.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // load model 
     ifstream is(model_path);
@@ -338,6 +324,15 @@ int predict_process(int argc, char *argv[] , const string &program_name)
     ner_model.load_model(is);
     is.close();
 
+    constexpr unsigned ChunkLineNum = 1024;
+    unsigned nr_thread = var_map["threads"].as<unsigned>();
+    auto predict_func = [&ner_model](istream &chunk_is, ostream &chunk_os){ ner_model.predict(chunk_is, chunk_os); };
+    if( var_map.count("socket") )
+    {
+        utils::serve_on_unix_socket(var_map["socket"].as<string>(), predict_func, max(nr_thread, 1U));
+        return 0;
+    }
+
     // open raw_data
     ifstream raw_is(raw_data_path);
     if (!raw_is)
@@ -349,7 +344,11 @@ int predict_process(int argc, char *argv[] , const string &program_name)
     // open output 
     if ("" == output_path)
     {
-        ner_model.predict(raw_is, cout); // using `cout` as output stream 
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, cout, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { ner_model.predict(raw_is, cout); } // using `cout` as output stream 
         raw_is.close();
     }
     else
@@ -361,7 +360,11 @@ int predict_process(int argc, char *argv[] , const string &program_name)
             raw_is.close();
             return -1;
         }
-        ner_model.predict(raw_is, os);
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, os, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { ner_model.predict(raw_is, os); }
         os.close();
         is.close();
     }
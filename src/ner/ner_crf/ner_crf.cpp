@@ -1,6 +1,8 @@
+#include <algorithm>
 #include "ner_crf_model.h"
 #include "ner_crf_modelhandler.h"
 #include "utils/general.hpp"
+#include "utils/parallel_predictor.hpp"
 
 using namespace std;
 using namespace slnn;
@@ -19,9 +21,9 @@ int train_process(int argc, char *argv[], const string &program_name)
         ("devel_data", po::value<string>(), "The path to developing data . For validation duration training . Empty for discarding .")
         ("max_epoch", po::value<unsigned>(), "The epoch to iterate for training")
         ("model", po::value<string>(), "Use to specify the model name(path)")
-        ("conlleval_script_path", po::value<string>(), "Use to specify the conll evaluation script path")
         ("dropout_rate" , po::value<float>() , "droupout rate for training")
         ("devel_freq", po::value<unsigned>()->default_value(6000), "The frequent(samples number)to validate(if set) . validation will be done after every devel-freq training samples")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
         ("do_stat_in_training" , po::value<bool>()->default_value(false) , "1 to calculate the acc during traing ,"
             "which will slow down the training speed . default 0 .")
         ("trivial_report_freq", po::value<unsigned>()->default_value(5000), "Trace frequent during training process")
@@ -57,7 +59,7 @@ int train_process(int argc, char *argv[], const string &program_name)
         );
     }
     // checking requiring key 
-    string training_data_path, devel_data_path , conlleval_script_path ;
+    string training_data_path, devel_data_path ;
     varmap_key_fatal_check(var_map, "training_data",
         "Error : Training data should be specified ! \n"
         "using `" + program_name + " train -h ` to see detail parameters .");
@@ -65,17 +67,6 @@ int train_process(int argc, char *argv[], const string &program_name)
     
     if (0 == var_map.count("devel_data")) devel_data_path = "";
     else devel_data_path = var_map["devel_data"].as<string>();
-    if ("" != devel_data_path)
-    {
-        varmap_key_fatal_check(var_map, "conlleval_script_path",
-            "Eval script path should be specified when doing validation .");
-        conlleval_script_path = var_map["conlleval_script_path"].as<string>();
-        // Check is evaluation scripts exists 
-        if (!FileUtils::exists(conlleval_script_path))
-        {
-            fatal_error("Eval script is not exists at `" + conlleval_script_path + "`") ;
-        }
-    }
     
     varmap_key_fatal_check(var_map, "max_epoch",
         "Error : max epoch num should be specified .");
@@ -94,7 +85,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     {
         fatal_error("Error : model file `" + model_path + "` has already exists .");
     }
-    ofstream model_os(model_path);
+    ofstream model_os(model_path, ios::binary);
     if (!model_os)
     {
         BOOST_LOG_TRIVIAL(fatal) << "failed to open model path at '" << model_path << "'. \n Exit !";
@@ -112,6 +103,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234); 
     NERCRFModelHandler model_handler;
+    model_handler.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
 
     // reading traing data , get word dict size and output tag number
     // -> set replace frequency for word_dict_wrapper
@@ -160,7 +152,6 @@ int train_process(int argc, char *argv[], const string &program_name)
         max_epoch, 
         dropout_rate , 
         p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs , 
-        conlleval_script_path , 
         devel_freq , 
         is_do_stat_in_training ,
         trivial_report_freq);
@@ -178,12 +169,11 @@ int devel_process(int argc, char *argv[], const string &program_name)
         "using `" + program_name + " devel <options>` to validate . devel options are as following";
     po::options_description op_des = po::options_description(description);
     // set params to receive the arguments 
-    string devel_data_path, model_path, eval_script_path;
+    string devel_data_path, model_path;
     op_des.add_options()
         ("devel_data", po::value<string>(&devel_data_path), "The path to validation data .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
-        ("conlleval_script_path", po::value<string>(&eval_script_path)->default_value(string("./ner_eval.sh")),
-            "Use to specify the conll evaluation script path")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -196,19 +186,18 @@ int devel_process(int argc, char *argv[], const string &program_name)
 
     varmap_key_fatal_check(var_map, "devel_data", "Error : validation(develop) data should be specified !");
     varmap_key_fatal_check(var_map, "model", "Error : model path should be specified !");
-    // Check is evaluation scripts exists 
-    if (!FileUtils::exists(eval_script_path)) fatal_error("Error : eval script is not exists at `" + eval_script_path + "`");
     
     // Init 
     dynet::initialize(argc, argv, 1234);
     NERCRFModelHandler model_handler;
+    model_handler.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
     // Load model 
     ifstream model_is(model_path);
     if (!model_is)
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' .");
     }
-    model_handler.load_model(model_is);
+    model_handler.load_model(model_path);
     model_is.close();
 
     // read validation(develop) data
@@ -225,7 +214,7 @@ int devel_process(int argc, char *argv[], const string &program_name)
     devel_is.close();
 
     // devel
-    model_handler.devel(&sents , &postag_seqs, &ner_seqs , eval_script_path); // Get the same result , it is OK .
+    model_handler.devel(&sents , &postag_seqs, &ner_seqs); // Get the same result , it is OK .
     
     return 0;
 }
@@ -237,11 +226,15 @@ int predict_process(int argc, char *argv[], const string &program_name)
         "Predict process ."
         "using `" + program_name + " predict <options>` to predict . predict options are as following";
     po::options_description op_des = po::options_description(description);
-    string raw_data_path, output_path, model_path;
+    string raw_data_path, output_path, model_path, socket_path;
+    unsigned nr_thread;
     op_des.add_options()
         ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
+        ("threads", po::value<unsigned>(&nr_thread)->default_value(1), "Number of prediction workers (processes sharing the loaded model).")
+        ("socket", po::value<string>(&socket_path), "Serve on the unix socket instead of predicting raw data. "
+            "a client writes lines, shuts down writing, then reads the result.")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -254,7 +247,7 @@ int predict_process(int argc, char *argv[], const string &program_name)
 
     //set params 
     
-    varmap_key_fatal_check(var_map, "raw_data", "raw_data path should be specified .");
+    if( !var_map.count("socket") ){ varmap_key_fatal_check(var_map, "raw_data", "raw_data path should be specified ."); }
     
     if (output_path == "")
     {
@@ -273,9 +266,17 @@ int predict_process(int argc, char *argv[], const string &program_name)
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' . ");
     }
-    model_handler.load_model(is);
+    model_handler.load_model(model_path);
     is.close();
 
+    constexpr unsigned ChunkLineNum = 1024;
+    auto predict_func = [&model_handler](istream &chunk_is, ostream &chunk_os){ model_handler.predict(chunk_is, chunk_os); };
+    if( var_map.count("socket") )
+    {
+        utils::serve_on_unix_socket(socket_path, predict_func, max(nr_thread, 1U));
+        return 0;
+    }
+
     // open raw_data
     ifstream raw_is(raw_data_path);
     if (!raw_is)
@@ -286,7 +287,11 @@ int predict_process(int argc, char *argv[], const string &program_name)
     // open output 
     if ("" == output_path)
     {
-        model_handler.predict(raw_is, cout); // using `cout` as output stream 
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, cout, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, cout); } // using `cout` as output stream 
         raw_is.close();
     }
     else
@@ -297,7 +302,11 @@ int predict_process(int argc, char *argv[], const string &program_name)
             raw_is.close();
             fatal_error("Error : failed open output file at : `" +  output_path + "`.");
         }
-        model_handler.predict(raw_is, os);
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, os, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, os); }
         os.close();
     }
     return 0;
@@ -71,6 +71,7 @@ Expression NERCRFModel::viterbi_train(ComputationGraph *p_cg,
 {
     const unsigned sent_len = p_sent->size();
     ComputationGraph &cg = *p_cg;
+    viterbi_decoder.clear_score(); // parameters will be updated.
     // New graph , ready for new sentence
     merge_input_layer->new_graph(cg);
     bilstm_layer->new_graph(cg);
@@ -97,7 +98,6 @@ Expression NERCRFModel::viterbi_train(ComputationGraph *p_cg,
     bilstm_layer->build_graph(merge_dc_exp_cont, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont);
 
     // viterbi data preparation
-    vector<Expression> all_ner_exp_cont(ner_embedding_dict_size);
     vector<Expression> init_score(ner_embedding_dict_size);
     vector<Expression> trans_score(ner_embedding_dict_size * ner_embedding_dict_size);
     vector<vector<Expression>> emit_score(sent_len, vector<Expression>(ner_embedding_dict_size));
@@ -107,10 +107,9 @@ Expression NERCRFModel::viterbi_train(ComputationGraph *p_cg,
     //   - allocate memory only when using p_stat
     if (p_stat) p_path_matrix.reset(new vector<vector<size_t>>(sent_len, vector<size_t>(ner_embedding_dict_size)));
     Expression gold_score_exp;
-    // init all_ner_exp_cont , init_score together
+    // init init_score
     for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
     {
-        all_ner_exp_cont[ner_idx] = lookup(cg, ner_lookup_param, ner_idx);
         init_score[ner_idx] = lookup(cg, init_score_lookup_param, ner_idx);
     }
     // init translation score
@@ -119,15 +118,13 @@ Expression NERCRFModel::viterbi_train(ComputationGraph *p_cg,
         trans_score[flat_idx] = lookup(cg, trans_score_lookup_param, flat_idx);
     }
     // init emit score
+    Expression emit_score_exp = build_emit_score_exp(cg, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont, 
+        true, dropout_rate);
     for (size_t time_step = 0; time_step < sent_len; ++time_step)
     {
         for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
         {
-            Expression emit_hidden_out_exp = emit_hidden_layer->build_graph(l2r_lstm_output_exp_cont[time_step],
-                r2l_lstm_output_exp_cont[time_step], all_ner_exp_cont[ner_idx]);
-            Expression non_linear_exp = rectify(emit_hidden_out_exp) ;
-            Expression dropout_exp = dropout(non_linear_exp , dropout_rate) ;
-            emit_score[time_step][ner_idx] = emit_output_layer->build_graph(dropout_exp);
+            emit_score[time_step][ner_idx] = pick(emit_score_exp, ner_idx + ner_embedding_dict_size * time_step);
         }
     }
     // viterbi docoding
@@ -209,6 +206,32 @@ Expression NERCRFModel::viterbi_train(ComputationGraph *p_cg,
     return loss;
 }
 
+Expression NERCRFModel::build_emit_score_exp(ComputationGraph &cg,
+    const vector<Expression> &l2r_lstm_output_exp_cont, const vector<Expression> &r2l_lstm_output_exp_cont,
+    bool is_train, float dropout_rate)
+{
+    const unsigned sent_len = l2r_lstm_output_exp_cont.size();
+    // ner part, (emit_hidden_layer_dim x ner_embedding_dict_size), built once for every ner tag
+    vector<Expression> all_ner_exp_cont(ner_embedding_dict_size);
+    for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
+    {
+        all_ner_exp_cont[ner_idx] = lookup(cg, ner_lookup_param, ner_idx);
+    }
+    Expression ner_part_exp = emit_hidden_layer->build_last_on_cols(all_ner_exp_cont);
+    // input part is built once for every time step, and added to every column of the ner part
+    vector<Expression> emit_hidden_out_exp_cont(sent_len);
+    for (size_t time_step = 0; time_step < sent_len; ++time_step)
+    {
+        emit_hidden_out_exp_cont[time_step] = colwise_add(ner_part_exp, 
+            emit_hidden_layer->build_graph_except_last(l2r_lstm_output_exp_cont[time_step], r2l_lstm_output_exp_cont[time_step]));
+    }
+    Expression non_linear_exp = rectify(concatenate_cols(emit_hidden_out_exp_cont));
+    if (is_train) non_linear_exp = dropout(non_linear_exp, dropout_rate);
+    // (1 x ner_embedding_dict_size * sent_len) score matrix, flatten it (column major)
+    return reshape(emit_output_layer->build_graph_on_matrix(non_linear_exp), 
+        Dim({ static_cast<unsigned>(ner_embedding_dict_size * sent_len) }));
+}
+
 void NERCRFModel::viterbi_predict(ComputationGraph *p_cg, 
     const IndexSeq *p_sent, const IndexSeq *p_postag_seq ,
     IndexSeq *p_predict_ner_seq)
@@ -243,82 +266,26 @@ void NERCRFModel::viterbi_predict(ComputationGraph *p_cg,
     bilstm_layer->build_graph(merge_dc_exp_cont, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont);
    
     //viterbi - preparing score
-    vector<Expression> all_ner_exp_cont(ner_embedding_dict_size);
-    vector<dynet::real> init_score(ner_embedding_dict_size);
-    vector<dynet::real> trans_score(ner_embedding_dict_size * ner_embedding_dict_size);
-    vector<vector<dynet::real>> emit_score(sent_len, vector<dynet::real>(ner_embedding_dict_size));
-
-    // get init score
-    for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
-    {
-        Expression init_exp = lookup(cg, init_score_lookup_param, ner_idx);
-        init_score[ner_idx] = as_scalar(cg.get_value(init_exp));
-    }
-    // get trans score
-    for (size_t flat_idx = 0; flat_idx < ner_embedding_dict_size * ner_embedding_dict_size; ++flat_idx)
-    {
-        Expression trans_exp = lookup(cg, trans_score_lookup_param, flat_idx);
-        trans_score[flat_idx] = as_scalar(cg.get_value(trans_exp));
-    }
-    // get emit score
-    for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
-    {
-        all_ner_exp_cont[ner_idx] = lookup(cg, ner_lookup_param, ner_idx);
-    }
-    for (size_t time_step = 0; time_step < sent_len; ++time_step)
+    if( !viterbi_decoder.has_score() )
     {
+        // read init and trans score from the parameter storage directly, only once for the model.
+        vector<dynet::real> init_score(ner_embedding_dict_size);
+        vector<dynet::real> trans_score(ner_embedding_dict_size * ner_embedding_dict_size);
         for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
         {
-            Expression emit_hidden_out_exp = emit_hidden_layer->build_graph(l2r_lstm_output_exp_cont[time_step],
-                r2l_lstm_output_exp_cont[time_step], all_ner_exp_cont[ner_idx]);
-            Expression emit_score_exp = emit_output_layer->build_graph(rectify(emit_hidden_out_exp));
-            emit_score[time_step][ner_idx] = as_scalar(cg.get_value(emit_score_exp));
+            init_score[ner_idx] = as_scalar(init_score_lookup_param.get()->values[ner_idx]);
         }
-
-    }
-    // viterbi - process
-    vector<vector<size_t>> path_matrix(sent_len, vector<size_t>(ner_embedding_dict_size));
-    vector<dynet::real> current_scores(ner_embedding_dict_size); 
-    // time 0
-    for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
-    {
-        current_scores[ner_idx] = init_score[ner_idx] + emit_score[0][ner_idx];
-    }
-    // continues time
-    vector<dynet::real>  pre_timestep_scores(current_scores.size());
-    for (size_t time_step = 1; time_step < sent_len; ++time_step)
-    {
-        swap(pre_timestep_scores, current_scores); // move current_score -> pre_timestep_score
-        for (size_t ner_idx = 0; ner_idx < ner_embedding_dict_size; ++ner_idx)
+        for (size_t flat_idx = 0; flat_idx < ner_embedding_dict_size * ner_embedding_dict_size; ++flat_idx)
         {
-            size_t pre_tag_with_max_score = 0;
-            dynet::real max_score = pre_timestep_scores[pre_tag_with_max_score] + 
-                trans_score[pre_tag_with_max_score * ner_embedding_dict_size + ner_idx];
-            for (size_t pre_ner_idx = 1 ; pre_ner_idx < ner_embedding_dict_size; ++pre_ner_idx)
-            {
-                size_t flat_idx = pre_ner_idx * ner_embedding_dict_size + ner_idx;
-                dynet::real score = pre_timestep_scores[pre_ner_idx] + trans_score[flat_idx];
-                if (score > max_score)
-                {
-                    pre_tag_with_max_score = pre_ner_idx;
-                    max_score = score;
-                }
-            }
-            path_matrix[time_step][ner_idx] = pre_tag_with_max_score;
-            current_scores[ner_idx] = max_score + emit_score[time_step][ner_idx];
+            trans_score[flat_idx] = as_scalar(trans_score_lookup_param.get()->values[flat_idx]);
         }
+        viterbi_decoder.set_score(init_score, trans_score);
     }
-    // get result 
-    IndexSeq tmp_predict_ner_seq(sent_len);
-    Index end_predicted_idx = distance(current_scores.begin(), max_element(current_scores.begin(), current_scores.end()));
-    tmp_predict_ner_seq[sent_len - 1] = end_predicted_idx;
-    Index pre_predicted_idx = end_predicted_idx;
-    for (size_t reverse_idx = sent_len - 1; reverse_idx >= 1; --reverse_idx)
-    {
-        pre_predicted_idx = path_matrix[reverse_idx][pre_predicted_idx]; // backtrace
-        tmp_predict_ner_seq[reverse_idx - 1] = pre_predicted_idx;
-    }
-    swap(tmp_predict_ner_seq, *p_predict_ner_seq);
+    // get emit score in one fetch, flat index is `ner_idx + ner_embedding_dict_size * time_step`
+    vector<dynet::real> emit_score = as_vector(cg.get_value(
+        build_emit_score_exp(cg, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont, false, 0.f)));
+    // viterbi - process
+    viterbi_decoder.decode(emit_score.data(), sent_len, *p_predict_ner_seq);
 }
 
 
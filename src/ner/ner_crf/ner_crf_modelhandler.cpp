@@ -1,10 +1,19 @@
 
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 
 #include "utils/typedeclaration.h"
+#include "utils/reusable_graph.hpp"
+#include "utils/parallel_reduce.hpp"
+#include "utils/dynet_binary_model.hpp"
 #include "ner_crf_modelhandler.h"
 
 using namespace std;
@@ -12,12 +21,32 @@ using namespace dynet;
 namespace slnn
 {
 
+namespace
+{
+
+// structure param and dicts, the part of model before parameters
+template <typename IArchive>
+void read_model_meta(IArchive &ti, NERCRFModel &m)
+{
+    ti >> m.word_embedding_dim 
+        >> m.postag_embedding_dim >> m.ner_embedding_dim 
+        >> m.nr_lstm_stacked_layer >> m.lstm_x_dim >> m.lstm_h_dim
+        >> m.emit_hidden_layer_dim
+        >> m.word_embedding_dict_size
+        >> m.postag_embedding_dict_size >> m.ner_embedding_dict_size ;
+
+    ti >> m.word_dict  >> m.postag_dict >> m.ner_dict ;
+    assert(m.word_embedding_dict_size == m.word_dict.size()
+        && m.postag_embedding_dict_size == m.postag_dict.size() && m.ner_embedding_dict_size == m.ner_dict.size());
+}
+
+} // end of anonymous namespace
 
 const std::string NERCRFModelHandler::number_transform_str = "##";
 const size_t NERCRFModelHandler::length_transform_str = number_transform_str.length();
 
 NERCRFModelHandler::NERCRFModelHandler() 
-    :dc_m(NERCRFModel()) , best_F1(0.f) , best_model_tmp_ss()
+    :dc_m(NERCRFModel()) , best_F1(0.f) , best_model_snapshot() , nr_devel_worker(1U)
 {}
 
 void NERCRFModelHandler::set_unk_replace_threshold(int freq_thres, float prob_thres)
@@ -107,43 +136,47 @@ void NERCRFModelHandler::read_devel_data(istream &is, vector<IndexSeq> &sents,
 void NERCRFModelHandler::read_test_data(istream &is, vector<Seq> &raw_test_sents, vector<IndexSeq> &sents,
     vector<IndexSeq> &postag_seqs)
 {
-    assert(dc_m.word_dict.is_frozen() && 
-        dc_m.postag_dict.is_frozen() && dc_m.ner_dict.is_frozen());
     BOOST_LOG_TRIVIAL(info) << "read test data .";
     vector<Seq> tmp_raw_sents;
-    vector<IndexSeq> tmp_sents,
+    vector<IndexSeq> tmp_sents ,
         tmp_postag_seqs;
     string line;
     while (getline(is, line))
     {
-        boost::trim(line);
-        vector<string> parts_seq;
-        boost::split(parts_seq, line, boost::is_any_of("\t"));
-        unsigned seq_len = parts_seq.size();
-        tmp_raw_sents.emplace_back(seq_len);
-        tmp_sents.emplace_back(seq_len); // using constructor `vector(nr_num)` => push_back(vector<int>(nr_words)) 
-        tmp_postag_seqs.emplace_back(seq_len);
-        Seq &raw_sent = tmp_raw_sents.back();
-        IndexSeq &words_index_seq = tmp_sents.back() ,
-            &postag_index_seq = tmp_postag_seqs.back();
-        for (unsigned i = 0; i < seq_len; ++i)
-        {
-            string &part = parts_seq.at(i);
-            string::size_type delim_pos = part.rfind("_");
-            string raw_word = part.substr(0, delim_pos);
-            string postag = part.substr(delim_pos + 1);
-            string number_transed_word = replace_number(raw_word);
-            raw_sent[i] = raw_word ;
-            words_index_seq[i] = dc_m.word_dict.convert(number_transed_word);
-            postag_index_seq[i] = dc_m.postag_dict.convert(postag);
-        }
-
+        tmp_raw_sents.emplace_back();
+        tmp_sents.emplace_back();
+        tmp_postag_seqs.emplace_back();
+        process_test_line(line, tmp_raw_sents.back(), tmp_sents.back(), tmp_postag_seqs.back());
     }
     swap(tmp_raw_sents, raw_test_sents);
     swap(tmp_sents, sents);
     swap(tmp_postag_seqs, postag_seqs);
 }
 
+void NERCRFModelHandler::process_test_line(string &line, Seq &raw_sent, IndexSeq &words_index_seq, IndexSeq &postag_index_seq)
+{
+    assert(dc_m.word_dict.is_frozen() && 
+        dc_m.postag_dict.is_frozen() && dc_m.ner_dict.is_frozen());
+    boost::trim(line);
+    vector<string> parts_seq;
+    boost::split(parts_seq, line, boost::is_any_of("\t"));
+    unsigned seq_len = parts_seq.size();
+    raw_sent.resize(seq_len);
+    words_index_seq.resize(seq_len);
+    postag_index_seq.resize(seq_len);
+    for (unsigned i = 0; i < seq_len; ++i)
+    {
+        string &part = parts_seq.at(i);
+        string::size_type delim_pos = part.rfind("_");
+        string raw_word = part.substr(0, delim_pos);
+        string postag = part.substr(delim_pos + 1);
+        string number_transed_word = replace_number(raw_word);
+        raw_sent[i] = raw_word ;
+        words_index_seq[i] = dc_m.word_dict.convert(number_transed_word);
+        postag_index_seq[i] = dc_m.postag_dict.convert(postag);
+    }
+}
+
 void NERCRFModelHandler::finish_read_training_data(boost::program_options::variables_map &varmap)
 {
     assert(dc_m.word_dict.is_frozen() && dc_m.postag_dict.is_frozen()
@@ -174,7 +207,6 @@ void NERCRFModelHandler::train(const vector<IndexSeq> *p_sents,
     float dropout_rate , 
     const vector<IndexSeq> *p_dev_sents, 
     const vector<IndexSeq> *p_dev_postag_seqs, const vector<IndexSeq> *p_dev_ner_seqs ,
-    const string &conlleval_script_path , 
     unsigned do_devel_freq ,
     bool do_stat_in_training , 
     unsigned trivial_report_freq)
@@ -190,6 +222,9 @@ void NERCRFModelHandler::train(const vector<IndexSeq> *p_sents,
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq dynamic_sent_after_replace_unk(SentMaxLen , 0);
+    // because at one scope , only one ComputationGraph is permited ,
+    // the training graph is released before develing (devel has its own graph).
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
     for (unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch)
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -211,10 +246,9 @@ void NERCRFModelHandler::train(const vector<IndexSeq> *p_sents,
             const IndexSeq *p_sent = &p_sents->at(access_idx),
                 *p_postag_seq = &p_postag_seqs->at(access_idx) ,
                 *p_ner_seq = &p_ner_seqs->at(access_idx);
-            ComputationGraph *cg = new ComputationGraph(); // because at one scope , only one ComputationGraph is permited .
-                                                           // so we have to declaring it as pointer and destroy it handly 
-                                                           // before develing.
-                                                           // transform low-frequent words to UNK according to the probability
+            if (!pgraph) pgraph.reset(new slnn::ReusableGraph());
+            ComputationGraph *cg = &pgraph->renew();
+            // transform low-frequent words to UNK according to the probability
             dynamic_sent_after_replace_unk.resize(p_sent->size());
             for (size_t word_idx = 0; word_idx < p_sent->size(); ++word_idx)
             {
@@ -226,7 +260,6 @@ void NERCRFModelHandler::train(const vector<IndexSeq> *p_sents,
             dynet::real loss =  as_scalar(cg->forward(loss_expr));
             cg->backward(loss_expr);
             sgd.update(1.f);
-            delete cg;
             if (training_stat4trivial) training_stat4trivial->loss += loss;
             else
             { 
@@ -255,8 +288,9 @@ void NERCRFModelHandler::train(const vector<IndexSeq> *p_sents,
             // If developing samples is available , do `devel` to get model training effect . 
             if (p_dev_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
             {
+                pgraph.reset();
                 float F1 = devel(p_dev_sents  , p_dev_postag_seqs , 
-                    p_dev_ner_seqs , conlleval_script_path);
+                    p_dev_ner_seqs);
                 if (F1 > best_F1) save_current_best_model(F1);
                 line_cnt_for_devel = 0; // avoid overflow
             }
@@ -286,8 +320,9 @@ void NERCRFModelHandler::train(const vector<IndexSeq> *p_sents,
         if (p_dev_sents != nullptr)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float F1 = devel(p_dev_sents , p_dev_postag_seqs , 
-                p_dev_ner_seqs , conlleval_script_path);
+                p_dev_ner_seqs);
             if (F1 > best_F1) save_current_best_model(F1);
         }
 
@@ -296,27 +331,41 @@ void NERCRFModelHandler::train(const vector<IndexSeq> *p_sents,
 }
 
 float NERCRFModelHandler::devel(const std::vector<IndexSeq> *p_sents,
-    const std::vector<IndexSeq> *p_postag_seqs, const vector<IndexSeq> *p_ner_seqs , 
-    const string &conlleval_script_path)
+    const std::vector<IndexSeq> *p_postag_seqs, const vector<IndexSeq> *p_ner_seqs)
 {
     unsigned nr_samples = p_sents->size();
     BOOST_LOG_TRIVIAL(info) << "validation at " << nr_samples << " instances .";
 
-    NerStat stat(conlleval_script_path);
+    NerStat stat;
+    ConllChunkEval chunk_eval(dc_m.ner_dict);
     stat.start_time_stat();
-    vector<IndexSeq> predict_ner_seqs(p_ner_seqs->size());
-    for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
+    chunk_eval.start_eval();
+    // every worker process builds its own graph at its first instance.
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
+    auto devel_one = [&](unsigned idx, ConllChunkEval::EvalTempResultT &result)
     {
-        ComputationGraph cg;
+        if (!pgraph) pgraph.reset(new slnn::ReusableGraph());
+        ComputationGraph &cg = pgraph->renew();
         IndexSeq predict_ner_seq;
-        const IndexSeq *p_sent = &p_sents->at(access_idx),
-            *p_postag_seq = &p_postag_seqs->at(access_idx);
+        const IndexSeq *p_sent = &p_sents->at(idx),
+            *p_postag_seq = &p_postag_seqs->at(idx);
         dc_m.viterbi_predict(&cg, p_sent,p_postag_seq , &predict_ner_seq);
-        predict_ner_seqs[access_idx] = predict_ner_seq;
-        stat.total_tags += predict_ner_seq.size();
+        result += chunk_eval.eval_one(p_ner_seqs->at(idx), predict_ner_seq);
+    };
+    ConllChunkEval::EvalTempResultT result;
+    if (nr_devel_worker > 1 && slnn::utils::is_parallel_reduce_supported())
+    {
+        result = slnn::utils::reduce_in_parallel<ConllChunkEval::EvalTempResultT>(nr_devel_worker, 0U, nr_samples,
+            devel_one);
     }
+    else
+    {
+        for (unsigned idx = 0; idx < nr_samples; ++idx) devel_one(idx, result);
+    }
+    chunk_eval.merge_temp_result(result);
+    stat.total_tags = result.nr_token;
     stat.end_time_stat();
-    array<float , 4> eval_scores = stat.conlleval(*p_ner_seqs, predict_ner_seqs, dc_m.ner_dict);
+    array<float , 4> eval_scores = chunk_eval.end_eval();
     float Acc = eval_scores[0] , 
           P = eval_scores[1] ,
           R = eval_scores[2] ,
@@ -328,44 +377,51 @@ float NERCRFModelHandler::devel(const std::vector<IndexSeq> *p_sents,
     return F1;
 }
 
+/**
+ * predict in streaming mode : read a line, predict and write it. 
+ * memory is constant and the input can be a pipe. output is flushed every `FlushLineNum` lines.
+ */
 void NERCRFModelHandler::predict(std::istream &is, std::ostream &os)
 {
+    constexpr unsigned FlushLineNum = 1024;
     const string SPLIT_DELIMITER = "\t";
-    vector<Seq> raw_instances;
-    vector<IndexSeq> sents,
-        postag_seqs ;
-    read_test_data(is,raw_instances, sents , postag_seqs);
-    
-    BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
+    BOOST_LOG_TRIVIAL(info) << "do prediction in streaming mode .";
     BasicStat stat;
     stat.start_time_stat();
-    for (unsigned int i = 0; i < raw_instances.size(); ++i)
+    string line;
+    Seq raw_sent;
+    IndexSeq sent,
+        postag_seq;
+    unsigned long nr_instance = 0;
+    slnn::ReusableGraph graph;
+    while (getline(is, line))
     {
-        vector<string> *p_raw_sent = &raw_instances.at(i);
-        if (0 == p_raw_sent->size())
+        if (++nr_instance % FlushLineNum == 0) os.flush();
+        process_test_line(line, raw_sent, sent, postag_seq);
+        if (0 == raw_sent.size())
         {
             os << "\n";
             continue;
         }
-        IndexSeq *p_sent = &sents.at(i) ,
-            *p_postag_seq = &postag_seqs.at(i);
         IndexSeq predict_seq;
-        ComputationGraph cg;
-        dc_m.viterbi_predict(&cg, p_sent, p_postag_seq , &predict_seq);
+        ComputationGraph &cg = graph.renew();
+        dc_m.viterbi_predict(&cg, &sent , &postag_seq , &predict_seq);
         // output the result directly
-        os << p_raw_sent->at(0)
-            << "/" << dc_m.postag_dict.convert(p_postag_seq->at(0))
+        os << raw_sent.at(0)
+            << "/" << dc_m.postag_dict.convert(postag_seq.at(0))
             << "#" << dc_m.ner_dict.convert(predict_seq.at(0));
-        for (unsigned k = 1; k < p_raw_sent->size(); ++k)
+        for (unsigned k = 1; k < raw_sent.size(); ++k)
         {
             os << SPLIT_DELIMITER
-                << p_raw_sent->at(k)
-                << "/" << dc_m.postag_dict.convert(p_postag_seq->at(k))
+                << raw_sent.at(k)
+                << "/" << dc_m.postag_dict.convert(postag_seq.at(k))
                 << "#" << dc_m.ner_dict.convert(predict_seq.at(k));
         }
         os << "\n";
         stat.total_tags += predict_seq.size() ;
     }
+    os.flush();
+    BOOST_LOG_TRIVIAL(info) << "predicted instance : " << nr_instance ;
     stat.end_time_stat() ;
     BOOST_LOG_TRIVIAL(info) << stat.get_stat_str("predict done.")  ;
 }
@@ -373,21 +429,25 @@ void NERCRFModelHandler::predict(std::istream &is, std::ostream &os)
 void NERCRFModelHandler::save_model(std::ostream &os)
 {
     BOOST_LOG_TRIVIAL(info) << "saving model ...";
-    boost::archive::text_oarchive to(os);
-    to << dc_m.word_embedding_dim 
-        << dc_m.postag_embedding_dim << dc_m.ner_embedding_dim
-        << dc_m.nr_lstm_stacked_layer << dc_m.lstm_x_dim << dc_m.lstm_h_dim
-        << dc_m.emit_hidden_layer_dim 
-        << dc_m.word_embedding_dict_size 
-        << dc_m.postag_embedding_dict_size << dc_m.ner_embedding_dict_size ;
-
-    to << dc_m.word_dict << dc_m.postag_dict << dc_m.ner_dict ;
-    if (best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail())
+    // 1. dict section: structure param and dicts
+    std::ostringstream dict_os;
+    {
+        boost::archive::binary_oarchive to(dict_os);
+        to << dc_m.word_embedding_dim 
+            << dc_m.postag_embedding_dim << dc_m.ner_embedding_dim
+            << dc_m.nr_lstm_stacked_layer << dc_m.lstm_x_dim << dc_m.lstm_h_dim
+            << dc_m.emit_hidden_layer_dim 
+            << dc_m.word_embedding_dict_size 
+            << dc_m.postag_embedding_dict_size << dc_m.ner_embedding_dict_size ;
+
+        to << dc_m.word_dict << dc_m.postag_dict << dc_m.ner_dict ;
+    }
+    // 2. parameter section (reset to the best model first)
+    if (best_model_snapshot.restore(dc_m.m))
     {
-        boost::archive::text_iarchive ti(best_model_tmp_ss);
-        ti >> *dc_m.m;
+        ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     }
-    to << *dc_m.m;
+    dynet_binary_model::write_binary_model(os, dict_os.str(), dc_m.m);
     BOOST_LOG_TRIVIAL(info) << "save model done .";
 }
 
@@ -395,18 +455,35 @@ void NERCRFModelHandler::load_model(std::istream &is)
 {
     BOOST_LOG_TRIVIAL(info) << "loading model ...";
     boost::archive::text_iarchive ti(is);
-    ti >> dc_m.word_embedding_dim 
-        >> dc_m.postag_embedding_dim >> dc_m.ner_embedding_dim 
-        >> dc_m.nr_lstm_stacked_layer >> dc_m.lstm_x_dim >> dc_m.lstm_h_dim
-        >> dc_m.emit_hidden_layer_dim
-        >> dc_m.word_embedding_dict_size
-        >> dc_m.postag_embedding_dict_size >> dc_m.ner_embedding_dict_size ;
-
-    ti >> dc_m.word_dict  >> dc_m.postag_dict >> dc_m.ner_dict ;
-    assert(dc_m.word_embedding_dict_size == dc_m.word_dict.size()
-        && dc_m.postag_embedding_dict_size == dc_m.postag_dict.size() && dc_m.ner_embedding_dict_size == dc_m.ner_dict.size());
+    read_model_meta(ti, dc_m);
     build_model();
     ti >> *dc_m.m;
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
+    BOOST_LOG_TRIVIAL(info) << "load model done .";
+}
+
+void NERCRFModelHandler::load_model(const std::string &model_path)
+{
+    if( !trivial::model_container::is_binary_model(model_path) )
+    {
+        std::ifstream is(model_path);
+        if( !is ){ throw std::runtime_error("failed to open model: '" + model_path + "'"); }
+        load_model(is);
+        return;
+    }
+    BOOST_LOG_TRIVIAL(info) << "loading binary model ...";
+    std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_file =
+        std::make_shared<const trivial::model_container::MappedModelFile>(model_path);
+    std::istringstream dict_is(std::string(mapped_file->get_dict_data(), mapped_file->get_dict_size()));
+    {
+        boost::archive::binary_iarchive ti(dict_is);
+        read_model_meta(ti, dc_m);
+    }
+    // build structure, use the mapped parameters in place.
+    build_model();
+    dynet_binary_model::bind_parameters(dc_m.m, *mapped_file);
+    mapped_model_file = mapped_file;
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     BOOST_LOG_TRIVIAL(info) << "load model done .";
 }
 
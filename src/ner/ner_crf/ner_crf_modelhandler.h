@@ -1,11 +1,15 @@
 #ifndef NER_CRF_MODELHANDLER_H_INCLUDED_
 #define NER_CRF_MODELHANDLER_H_INCLUDED_
 
+#include <memory>
+#include <string>
 #include <boost/archive/text_oarchive.hpp>
 
 #include "ner_crf_model.h"
 #include "utils/utf8processing.hpp"
 #include "utils/typedeclaration.h"
+#include "utils/parameter_snapshot.hpp"
+#include "trivial/model_container/binary_model_container.h"
 #include "utils/stat.hpp"
 
 namespace slnn
@@ -16,7 +20,9 @@ struct NERCRFModelHandler
     
     // Saving temporal model
     float best_F1;
-    std::stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
+    unsigned nr_devel_worker; // devel by forked processes if > 1, @see utils::reduce_in_parallel
+    std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_model_file; // parameters are bound to it
 
     // others 
     static const std::string number_transform_str;
@@ -39,6 +45,7 @@ struct NERCRFModelHandler
         std::vector<IndexSeq> &postag_seqs , std::vector<IndexSeq> &ner_seqs);
     void read_test_data(std::istream &is, std::vector<Seq> &raw_test_sents, std::vector<IndexSeq> &sents ,
         std::vector<IndexSeq> &postag_seqs);
+    void process_test_line(std::string &line, Seq &raw_sent, IndexSeq &sent, IndexSeq &postag_seq);
     
     // After Reading Training data
     void finish_read_training_data(boost::program_options::variables_map &varmap);
@@ -51,18 +58,20 @@ struct NERCRFModelHandler
         float dropout_rate , 
         const std::vector<IndexSeq> *p_de_sents, 
         const std::vector<IndexSeq> *p_dev_postag_seqs , const std::vector<IndexSeq> *p_dev_ner_seqs ,
-        const std::string &conlleval_script_path , 
         unsigned do_devel_freq ,
         bool is_do_stat_in_training , 
         unsigned trivial_report_freq);
     float devel(const std::vector<IndexSeq> *p_sents,
-        const std::vector<IndexSeq> *p_postag_seqs, const std::vector<IndexSeq> *p_ner_seqs,
-        const std::string &conlleval_script_path);
+        const std::vector<IndexSeq> *p_postag_seqs, const std::vector<IndexSeq> *p_ner_seqs);
     void predict(std::istream &is, std::ostream &os);
 
     // Save & Load
+    // save to the binary model container
     void save_model(std::ostream &os);
+    // load the model saved in text archive (the format before binary model container)
     void load_model(std::istream &is);
+    // load the model by path, binary model container will be mapped, text archive is also supported.
+    void load_model(const std::string &model_path);
 private :
     inline void save_current_best_model(float F1);
 
@@ -102,9 +111,7 @@ void NERCRFModelHandler::save_current_best_model(float F1)
 {
     BOOST_LOG_TRIVIAL(info) << "better model has been found . stash it .";
     best_F1 = F1;
-    best_model_tmp_ss.str(""); // first , clear it's content !
-    boost::archive::text_oarchive to(best_model_tmp_ss);
-    to << *dc_m.m;
+    best_model_snapshot.take(dc_m.m);
 }
 
 } // end of namespace 
@@ -16,6 +16,7 @@
 
 #include "utils/typedeclaration.h"
 #include "modelmodule/layers.h"
+#include "modelmodule/viterbi_decoder.h"
 #include "utils/utf8processing.hpp" 
 #include "utils/dict_wrapper.hpp"
 #include "utils/stat.hpp"
@@ -56,6 +57,7 @@ struct NERCRFDCModel
     
     dynet::LookupParameter init_score_lookup_param;
     dynet::LookupParameter trans_score_lookup_param;
+    ViterbiDecoder viterbi_decoder; // score is cached until the next `viterbi_train`
 
 
     // Dict
@@ -76,6 +78,15 @@ struct NERCRFDCModel
     void print_model_info();
 
 
+    // emit score of all the (time step, ner tag) pairs, a (ner_embedding_dict_size * sent_len) vector,
+    // flat index is `ner_idx + ner_embedding_dict_size * time_step`.
+    // the emit hidden layer is factorized: the input part is built once for every time step, the ner part once for
+    // every ner tag, then they are merged by broadcasted add, and scored by one nonlinear and one dense node.
+    dynet::expr::Expression build_emit_score_exp(dynet::ComputationGraph &cg,
+        const std::vector<dynet::expr::Expression> &l2r_lstm_output_exp_cont,
+        const std::vector<dynet::expr::Expression> &r2l_lstm_output_exp_cont,
+        bool is_train, float dropout_rate);
+
     dynet::expr::Expression viterbi_train(dynet::ComputationGraph *p_cg, 
         const IndexSeq *p_dynamic_sent, const IndexSeq *p_fixed_sent, const IndexSeq *p_postag_seq,
         const IndexSeq *p_ner_seq ,
@@ -1,10 +1,20 @@
 
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 
 #include "utils/typedeclaration.h"
+#include "utils/reusable_graph.hpp"
+#include "utils/parallel_reduce.hpp"
+#include "utils/dynet_binary_model.hpp"
+#include "utils/word2vec_embedding_helper.h"
 #include "ner_crf_dc_modelhandler.h"
 
 using namespace std;
@@ -12,37 +22,39 @@ using namespace dynet;
 namespace slnn
 {
 
+namespace
+{
+
+// structure param and dicts, the part of model before parameters
+template <typename IArchive>
+void read_model_meta(IArchive &ti, NERCRFDCModel &m)
+{
+    ti >> m.dynamic_embedding_dim >> m.fixed_embedding_dim
+        >> m.postag_embedding_dim >> m.ner_embedding_dim 
+        >> m.nr_lstm_stacked_layer >> m.lstm_x_dim >> m.lstm_h_dim
+        >> m.emit_hidden_layer_dim
+        >> m.dynamic_embedding_dict_size >> m.fixed_embedding_dict_size
+        >> m.postag_embedding_dict_size >> m.ner_embedding_dict_size ;
+
+    ti >> m.dynamic_dict >> m.fixed_dict >> m.postag_dict >> m.ner_dict ;
+    assert(m.dynamic_embedding_dict_size == m.dynamic_dict.size() && m.fixed_embedding_dict_size == m.fixed_dict.size()
+        && m.postag_embedding_dict_size == m.postag_dict.size() && m.ner_embedding_dict_size == m.ner_dict.size());
+}
+
+} // end of anonymous namespace
 
 const std::string NERCRFDCModelHandler::number_transform_str = "##";
 const size_t NERCRFDCModelHandler::length_transform_str = number_transform_str.length();
 
 NERCRFDCModelHandler::NERCRFDCModelHandler() 
-    :dc_m(NERCRFDCModel()) , best_F1(0.f) , best_model_tmp_ss()
+    :dc_m(NERCRFDCModel()) , best_F1(0.f) , best_model_snapshot() , nr_devel_worker(1U)
 {}
 
 void NERCRFDCModelHandler::build_fixed_dict_from_word2vec_file(std::ifstream &is)
 {
-    BOOST_LOG_TRIVIAL(info) << "initialize fixed dict .";
-    string line;
-    vector<string> split_cont;
-    getline(is, line); // first line is the infomation !
-    boost::split(split_cont, line, boost::is_any_of(" "));
-    assert(2U == split_cont.size());
-    dc_m.fixed_embedding_dict_size = stol(split_cont[0]) + 1; // another UNK
-    dc_m.fixed_embedding_dim = stol(split_cont[1]);
-    
-    // read all words and add to dc_m.fixed_dict
-    while (getline(is, line))
-    {
-        string::size_type delim_pos = line.find(" ");
-        assert(delim_pos != string::npos);
-        string word = line.substr(0, delim_pos);
-        dc_m.fixed_dict.convert(word);  // add to dict
-    }
-    //  freeze & add unk to fixed_dict
-    dc_m.fixed_dict.freeze();
-    dc_m.fixed_dict.set_unk(dc_m.UNK_STR);
-    BOOST_LOG_TRIVIAL(info) << "initialize fixed dict done .";
+    // text or binary embedding (@see Word2vecEmbeddingHelper)
+    Word2vecEmbeddingHelper::build_fixed_dict(is, dc_m.fixed_dict, dc_m.UNK_STR,
+        &dc_m.fixed_embedding_dict_size, &dc_m.fixed_embedding_dim);
 }
 
 void NERCRFDCModelHandler::set_unk_replace_threshold(int freq_thres, float prob_thres)
@@ -142,41 +154,20 @@ void NERCRFDCModelHandler::read_devel_data(istream &is, vector<IndexSeq> &dynami
 void NERCRFDCModelHandler::read_test_data(istream &is, vector<Seq> &raw_test_sents, vector<IndexSeq> &dynamic_sents,
     vector<IndexSeq> &fixed_sents , vector<IndexSeq> &postag_seqs)
 {
-    assert(dc_m.dynamic_dict.is_frozen() && dc_m.fixed_dict.is_frozen() && 
-        dc_m.postag_dict.is_frozen() && dc_m.ner_dict.is_frozen());
     BOOST_LOG_TRIVIAL(info) << "read test data .";
     vector<Seq> tmp_raw_sents;
-    vector<IndexSeq> tmp_dynamic_sents,
-        tmp_fixed_sents , 
+    vector<IndexSeq> tmp_dynamic_sents ,
+        tmp_fixed_sents ,
         tmp_postag_seqs;
     string line;
     while (getline(is, line))
     {
-        boost::trim(line);
-        vector<string> parts_seq;
-        boost::split(parts_seq, line, boost::is_any_of("\t"));
-        unsigned seq_len = parts_seq.size();
-        tmp_raw_sents.emplace_back(seq_len);
-        tmp_dynamic_sents.emplace_back(seq_len); // using constructor `vector(nr_num)` => push_back(vector<int>(nr_words)) 
-        tmp_fixed_sents.emplace_back(seq_len);
-        tmp_postag_seqs.emplace_back(seq_len);
-        Seq &raw_sent = tmp_raw_sents.back();
-        IndexSeq &dynamic_words_index_seq = tmp_dynamic_sents.back() ,
-            &fixed_words_index_seq = tmp_fixed_sents.back() , 
-            &postag_index_seq = tmp_postag_seqs.back();
-        for (unsigned i = 0; i < seq_len; ++i)
-        {
-            string &part = parts_seq.at(i);
-            string::size_type delim_pos = part.rfind("_");
-            string raw_word = part.substr(0, delim_pos);
-            string postag = part.substr(delim_pos + 1);
-            string number_transed_word = replace_number(raw_word);
-            raw_sent[i] = raw_word ;
-            dynamic_words_index_seq[i] = dc_m.dynamic_dict.convert(number_transed_word);
-            fixed_words_index_seq[i] = dc_m.fixed_dict.convert(number_transed_word);
-            postag_index_seq[i] = dc_m.postag_dict.convert(postag);
-        }
-
+        tmp_raw_sents.emplace_back();
+        tmp_dynamic_sents.emplace_back();
+        tmp_fixed_sents.emplace_back();
+        tmp_postag_seqs.emplace_back();
+        process_test_line(line, tmp_raw_sents.back(), tmp_dynamic_sents.back(), tmp_fixed_sents.back(),
+            tmp_postag_seqs.back());
     }
     swap(tmp_raw_sents, raw_test_sents);
     swap(tmp_dynamic_sents, dynamic_sents);
@@ -184,6 +175,33 @@ void NERCRFDCModelHandler::read_test_data(istream &is, vector<Seq> &raw_test_sen
     swap(tmp_postag_seqs, postag_seqs);
 }
 
+void NERCRFDCModelHandler::process_test_line(string &line, Seq &raw_sent, IndexSeq &dynamic_words_index_seq,
+    IndexSeq &fixed_words_index_seq, IndexSeq &postag_index_seq)
+{
+    assert(dc_m.dynamic_dict.is_frozen() && dc_m.fixed_dict.is_frozen() && 
+        dc_m.postag_dict.is_frozen() && dc_m.ner_dict.is_frozen());
+    boost::trim(line);
+    vector<string> parts_seq;
+    boost::split(parts_seq, line, boost::is_any_of("\t"));
+    unsigned seq_len = parts_seq.size();
+    raw_sent.resize(seq_len);
+    dynamic_words_index_seq.resize(seq_len);
+    fixed_words_index_seq.resize(seq_len);
+    postag_index_seq.resize(seq_len);
+    for (unsigned i = 0; i < seq_len; ++i)
+    {
+        string &part = parts_seq.at(i);
+        string::size_type delim_pos = part.rfind("_");
+        string raw_word = part.substr(0, delim_pos);
+        string postag = part.substr(delim_pos + 1);
+        string number_transed_word = replace_number(raw_word);
+        raw_sent[i] = raw_word ;
+        dynamic_words_index_seq[i] = dc_m.dynamic_dict.convert(number_transed_word);
+        fixed_words_index_seq[i] = dc_m.fixed_dict.convert(number_transed_word);
+        postag_index_seq[i] = dc_m.postag_dict.convert(postag);
+    }
+}
+
 void NERCRFDCModelHandler::finish_read_training_data(boost::program_options::variables_map &varmap)
 {
     assert(dc_m.dynamic_dict.is_frozen() && dc_m.fixed_dict.is_frozen() && dc_m.postag_dict.is_frozen()
@@ -211,40 +229,9 @@ void NERCRFDCModelHandler::build_model()
 
 void NERCRFDCModelHandler::load_fixed_embedding(std::istream &is)
 {
-    // set lookup parameters from outer word embedding
-    // using words_loopup_param.initialize( word_id , value_vector )
-    BOOST_LOG_TRIVIAL(info) << "load pre-trained word embedding .";
-    string line;
-    vector<string> split_cont;
-    getline(is, line); // first line is the infomation , skip
-    split_cont.reserve(dc_m.fixed_embedding_dim + 1); // word + numbers 
-    unsigned long line_cnt = 0; // for warning when read embedding error
-    unsigned long words_cnt_hit = 0;
-    vector<float> embedding_vec(dc_m.fixed_embedding_dim , 0.f);
-    Index dynamic_unk = dc_m.dynamic_dict.convert(dc_m.UNK_STR); // for calc hit rate
-    while (getline(is, line))
-    {
-        ++line_cnt;
-        boost::trim_right(line);
-        boost::split(split_cont, line, boost::is_any_of(" "));
-        if (dc_m.fixed_embedding_dim + 1 != split_cont.size())
-        {
-            BOOST_LOG_TRIVIAL(info) << "bad word dimension : `" << split_cont.size() - 1 << "` at line " << line_cnt;
-            continue;
-        }
-        string &word = split_cont.at(0);
-        Index word_id = dc_m.fixed_dict.convert(word);
-        for (size_t idx = 1; idx < split_cont.size(); ++idx)
-        {
-            embedding_vec[idx - 1] = stof(split_cont[idx]);
-        }
-        dc_m.fixed_words_lookup_param.initialize(word_id, embedding_vec);
-        if(dc_m.dynamic_dict.convert(word) != dynamic_unk) ++words_cnt_hit;
-    }
-    BOOST_LOG_TRIVIAL(info) << "load fixed embedding done . hit rate " 
-        << words_cnt_hit << "/" << dc_m.fixed_embedding_dict_size  << " ("
-        << ( dc_m.fixed_embedding_dict_size ? static_cast<float>(words_cnt_hit) / dc_m.fixed_embedding_dict_size : 0. ) * 100 
-        << " %) " ;
+    Word2vecEmbeddingHelper::load_fixed_embedding(is, dc_m.fixed_dict, dc_m.fixed_embedding_dim,
+        dc_m.fixed_words_lookup_param);
+    Word2vecEmbeddingHelper::calc_hit_rate(dc_m.fixed_dict, dc_m.dynamic_dict, dc_m.UNK_STR);
 }
 
 void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const vector<IndexSeq> *p_fixed_sents,
@@ -253,7 +240,6 @@ void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const
     float dropout_rate , 
     const vector<IndexSeq> *p_dev_dynamic_sents, const vector<IndexSeq> *p_dev_fixed_sents,
     const vector<IndexSeq> *p_dev_postag_seqs, const vector<IndexSeq> *p_dev_ner_seqs ,
-    const string &conlleval_script_path , 
     unsigned do_devel_freq ,
     bool do_stat_in_training , 
     unsigned trivial_report_freq)
@@ -269,6 +255,9 @@ void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq dynamic_sent_after_replace_unk(SentMaxLen , 0);
+    // because at one scope , only one ComputationGraph is permited ,
+    // the training graph is released before develing (devel has its own graph).
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
     for (unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch)
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -291,10 +280,9 @@ void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const
                 *p_fixed_sent = &p_fixed_sents->at(access_idx) ,
                 *p_postag_seq = &p_postag_seqs->at(access_idx) ,
                 *p_ner_seq = &p_ner_seqs->at(access_idx);
-            ComputationGraph *cg = new ComputationGraph(); // because at one scope , only one ComputationGraph is permited .
-                                                           // so we have to declaring it as pointer and destroy it handly 
-                                                           // before develing.
-                                                           // transform low-frequent words to UNK according to the probability
+            if (!pgraph) pgraph.reset(new slnn::ReusableGraph());
+            ComputationGraph *cg = &pgraph->renew();
+            // transform low-frequent words to UNK according to the probability
             dynamic_sent_after_replace_unk.resize(p_dynamic_sent->size());
             for (size_t word_idx = 0; word_idx < p_dynamic_sent->size(); ++word_idx)
             {
@@ -308,7 +296,6 @@ void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const
             dynet::real loss =  as_scalar(cg->forward(loss_expr));
             cg->backward(loss_expr);
             sgd.update(1.0f);
-            delete cg;
             if (training_stat4trivial) training_stat4trivial->loss += loss;
             else
             { 
@@ -337,8 +324,9 @@ void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const
             // If developing samples is available , do `devel` to get model training effect . 
             if (p_dev_dynamic_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
             {
+                pgraph.reset();
                 float F1 = devel(p_dev_dynamic_sents , p_dev_fixed_sents , p_dev_postag_seqs , 
-                    p_dev_ner_seqs , conlleval_script_path);
+                    p_dev_ner_seqs);
                 if (F1 > best_F1) save_current_best_model(F1);
                 line_cnt_for_devel = 0; // avoid overflow
             }
@@ -368,8 +356,9 @@ void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const
         if (p_dev_dynamic_sents != nullptr)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float F1 = devel(p_dev_dynamic_sents , p_dev_fixed_sents , p_dev_postag_seqs , 
-                p_dev_ner_seqs , conlleval_script_path);
+                p_dev_ner_seqs);
             if (F1 > best_F1) save_current_best_model(F1);
         }
 
@@ -378,28 +367,42 @@ void NERCRFDCModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, const
 }
 
 float NERCRFDCModelHandler::devel(const std::vector<IndexSeq> *p_dynamic_sents, const std::vector<IndexSeq> *p_fixed_sents,
-    const std::vector<IndexSeq> *p_postag_seqs, const vector<IndexSeq> *p_ner_seqs , 
-    const string &conlleval_script_path)
+    const std::vector<IndexSeq> *p_postag_seqs, const vector<IndexSeq> *p_ner_seqs)
 {
     unsigned nr_samples = p_dynamic_sents->size();
     BOOST_LOG_TRIVIAL(info) << "validation at " << nr_samples << " instances .";
 
-    NerStat stat(conlleval_script_path);
+    NerStat stat;
+    ConllChunkEval chunk_eval(dc_m.ner_dict);
     stat.start_time_stat();
-    vector<IndexSeq> predict_ner_seqs(p_ner_seqs->size());
-    for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
+    chunk_eval.start_eval();
+    // every worker process builds its own graph at its first instance.
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
+    auto devel_one = [&](unsigned idx, ConllChunkEval::EvalTempResultT &result)
     {
-        ComputationGraph cg;
+        if (!pgraph) pgraph.reset(new slnn::ReusableGraph());
+        ComputationGraph &cg = pgraph->renew();
         IndexSeq predict_ner_seq;
-        const IndexSeq *p_dynamic_sent = &p_dynamic_sents->at(access_idx),
-            *p_fixed_sent = &p_fixed_sents->at(access_idx) ,
-            *p_postag_seq = &p_postag_seqs->at(access_idx);
+        const IndexSeq *p_dynamic_sent = &p_dynamic_sents->at(idx),
+            *p_fixed_sent = &p_fixed_sents->at(idx) ,
+            *p_postag_seq = &p_postag_seqs->at(idx);
         dc_m.viterbi_predict(&cg, p_dynamic_sent, p_fixed_sent, p_postag_seq , &predict_ner_seq);
-        predict_ner_seqs[access_idx] = predict_ner_seq;
-        stat.total_tags += predict_ner_seq.size();
+        result += chunk_eval.eval_one(p_ner_seqs->at(idx), predict_ner_seq);
+    };
+    ConllChunkEval::EvalTempResultT result;
+    if (nr_devel_worker > 1 && slnn::utils::is_parallel_reduce_supported())
+    {
+        result = slnn::utils::reduce_in_parallel<ConllChunkEval::EvalTempResultT>(nr_devel_worker, 0U, nr_samples,
+            devel_one);
     }
+    else
+    {
+        for (unsigned idx = 0; idx < nr_samples; ++idx) devel_one(idx, result);
+    }
+    chunk_eval.merge_temp_result(result);
+    stat.total_tags = result.nr_token;
     stat.end_time_stat();
-    array<float , 4> eval_scores = stat.conlleval(*p_ner_seqs, predict_ner_seqs, dc_m.ner_dict);
+    array<float , 4> eval_scores = chunk_eval.end_eval();
     float Acc = eval_scores[0] , 
           P = eval_scores[1] ,
           R = eval_scores[2] ,
@@ -411,46 +414,52 @@ float NERCRFDCModelHandler::devel(const std::vector<IndexSeq> *p_dynamic_sents,
     return F1;
 }
 
+/**
+ * predict in streaming mode : read a line, predict and write it. 
+ * memory is constant and the input can be a pipe. output is flushed every `FlushLineNum` lines.
+ */
 void NERCRFDCModelHandler::predict(std::istream &is, std::ostream &os)
 {
+    constexpr unsigned FlushLineNum = 1024;
     const string SPLIT_DELIMITER = "\t";
-    vector<Seq> raw_instances;
-    vector<IndexSeq> dynamic_sents,
-        fixed_sents , 
-        postag_seqs ;
-    read_test_data(is,raw_instances,dynamic_sents ,fixed_sents , postag_seqs);
-    
-    BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
+    BOOST_LOG_TRIVIAL(info) << "do prediction in streaming mode .";
     BasicStat stat;
     stat.start_time_stat();
-    for (unsigned int i = 0; i < raw_instances.size(); ++i)
+    string line;
+    Seq raw_sent;
+    IndexSeq dynamic_sent,
+        fixed_sent,
+        postag_seq;
+    unsigned long nr_instance = 0;
+    slnn::ReusableGraph graph;
+    while (getline(is, line))
     {
-        vector<string> *p_raw_sent = &raw_instances.at(i);
-        if (0 == p_raw_sent->size())
+        if (++nr_instance % FlushLineNum == 0) os.flush();
+        process_test_line(line, raw_sent, dynamic_sent, fixed_sent, postag_seq);
+        if (0 == raw_sent.size())
         {
             os << "\n";
             continue;
         }
-        IndexSeq *p_dynamic_sent = &dynamic_sents.at(i) ,
-            *p_fixed_sent = &fixed_sents.at(i) ,
-            *p_postag_seq = &postag_seqs.at(i);
         IndexSeq predict_seq;
-        ComputationGraph cg;
-        dc_m.viterbi_predict(&cg, p_dynamic_sent, p_fixed_sent , p_postag_seq , &predict_seq);
+        ComputationGraph &cg = graph.renew();
+        dc_m.viterbi_predict(&cg, &dynamic_sent , &fixed_sent , &postag_seq , &predict_seq);
         // output the result directly
-        os << p_raw_sent->at(0)
-            << "/" << dc_m.postag_dict.convert(p_postag_seq->at(0))
+        os << raw_sent.at(0)
+            << "/" << dc_m.postag_dict.convert(postag_seq.at(0))
             << "#" << dc_m.ner_dict.convert(predict_seq.at(0));
-        for (unsigned k = 1; k < p_raw_sent->size(); ++k)
+        for (unsigned k = 1; k < raw_sent.size(); ++k)
         {
             os << SPLIT_DELIMITER
-                << p_raw_sent->at(k)
-                << "/" << dc_m.postag_dict.convert(p_postag_seq->at(k))
+                << raw_sent.at(k)
+                << "/" << dc_m.postag_dict.convert(postag_seq.at(k))
                 << "#" << dc_m.ner_dict.convert(predict_seq.at(k));
         }
         os << "\n";
         stat.total_tags += predict_seq.size() ;
     }
+    os.flush();
+    BOOST_LOG_TRIVIAL(info) << "predicted instance : " << nr_instance ;
     stat.end_time_stat() ;
     BOOST_LOG_TRIVIAL(info) << "predict done . time cosing " << stat.get_time_cost_in_seconds() << " s , speed "
         << stat.get_speed_as_kilo_tokens_per_sencond() << " K tokens/s"  ;
@@ -459,21 +468,25 @@ void NERCRFDCModelHandler::predict(std::istream &is, std::ostream &os)
 void NERCRFDCModelHandler::save_model(std::ostream &os)
 {
     BOOST_LOG_TRIVIAL(info) << "saving model ...";
-    boost::archive::text_oarchive to(os);
-    to << dc_m.dynamic_embedding_dim << dc_m.fixed_embedding_dim
-        << dc_m.postag_embedding_dim << dc_m.ner_embedding_dim
-        << dc_m.nr_lstm_stacked_layer << dc_m.lstm_x_dim << dc_m.lstm_h_dim
-        << dc_m.emit_hidden_layer_dim 
-        << dc_m.dynamic_embedding_dict_size << dc_m.fixed_embedding_dict_size
-        << dc_m.postag_embedding_dict_size << dc_m.ner_embedding_dict_size ;
-
-    to << dc_m.dynamic_dict << dc_m.fixed_dict << dc_m.postag_dict << dc_m.ner_dict ;
-    if (best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail())
+    // 1. dict section: structure param and dicts
+    std::ostringstream dict_os;
+    {
+        boost::archive::binary_oarchive to(dict_os);
+        to << dc_m.dynamic_embedding_dim << dc_m.fixed_embedding_dim
+            << dc_m.postag_embedding_dim << dc_m.ner_embedding_dim
+            << dc_m.nr_lstm_stacked_layer << dc_m.lstm_x_dim << dc_m.lstm_h_dim
+            << dc_m.emit_hidden_layer_dim 
+            << dc_m.dynamic_embedding_dict_size << dc_m.fixed_embedding_dict_size
+            << dc_m.postag_embedding_dict_size << dc_m.ner_embedding_dict_size ;
+
+        to << dc_m.dynamic_dict << dc_m.fixed_dict << dc_m.postag_dict << dc_m.ner_dict ;
+    }
+    // 2. parameter section (reset to the best model first)
+    if (best_model_snapshot.restore(dc_m.m))
     {
-        boost::archive::text_iarchive ti(best_model_tmp_ss);
-        ti >> *dc_m.m;
+        ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     }
-    to << *dc_m.m;
+    dynet_binary_model::write_binary_model(os, dict_os.str(), dc_m.m);
     BOOST_LOG_TRIVIAL(info) << "save model done .";
 }
 
@@ -481,18 +494,35 @@ void NERCRFDCModelHandler::load_model(std::istream &is)
 {
     BOOST_LOG_TRIVIAL(info) << "loading model ...";
     boost::archive::text_iarchive ti(is);
-    ti >> dc_m.dynamic_embedding_dim >> dc_m.fixed_embedding_dim
-        >> dc_m.postag_embedding_dim >> dc_m.ner_embedding_dim 
-        >> dc_m.nr_lstm_stacked_layer >> dc_m.lstm_x_dim >> dc_m.lstm_h_dim
-        >> dc_m.emit_hidden_layer_dim
-        >> dc_m.dynamic_embedding_dict_size >> dc_m.fixed_embedding_dict_size
-        >> dc_m.postag_embedding_dict_size >> dc_m.ner_embedding_dict_size ;
-
-    ti >> dc_m.dynamic_dict >> dc_m.fixed_dict >> dc_m.postag_dict >> dc_m.ner_dict ;
-    assert(dc_m.dynamic_embedding_dict_size == dc_m.dynamic_dict.size() && dc_m.fixed_embedding_dict_size == dc_m.fixed_dict.size()
-        && dc_m.postag_embedding_dict_size == dc_m.postag_dict.size() && dc_m.ner_embedding_dict_size == dc_m.ner_dict.size());
+    read_model_meta(ti, dc_m);
     build_model();
     ti >> *dc_m.m;
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
+    BOOST_LOG_TRIVIAL(info) << "load model done .";
+}
+
+void NERCRFDCModelHandler::load_model(const std::string &model_path)
+{
+    if( !trivial::model_container::is_binary_model(model_path) )
+    {
+        std::ifstream is(model_path);
+        if( !is ){ throw std::runtime_error("failed to open model: '" + model_path + "'"); }
+        load_model(is);
+        return;
+    }
+    BOOST_LOG_TRIVIAL(info) << "loading binary model ...";
+    std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_file =
+        std::make_shared<const trivial::model_container::MappedModelFile>(model_path);
+    std::istringstream dict_is(std::string(mapped_file->get_dict_data(), mapped_file->get_dict_size()));
+    {
+        boost::archive::binary_iarchive ti(dict_is);
+        read_model_meta(ti, dc_m);
+    }
+    // build structure, use the mapped parameters in place.
+    build_model();
+    dynet_binary_model::bind_parameters(dc_m.m, *mapped_file);
+    mapped_model_file = mapped_file;
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     BOOST_LOG_TRIVIAL(info) << "load model done .";
 }
 
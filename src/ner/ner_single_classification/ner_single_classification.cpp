@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <boost/log/core.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/expressions.hpp>
@@ -5,6 +6,7 @@
 #include "ner_single_classification_model.h"
 #include "ner/model_handler/input2D_modelhandler.h"
 #include "utils/general.hpp"
+#include "utils/parallel_predictor.hpp"
 
 using namespace std;
 using namespace slnn;
@@ -21,11 +23,11 @@ int train_process(int argc, char *argv[], const string &program_name)
     op_des.add_options()
         ("training_data", po::value<string>(), "[required] The path to training data")
         ("devel_data", po::value<string>(), "The path to developing data . For validation duration training . Empty for discarding .")
-        ("conlleval_script_path" , po::value<string>() , "The path to conlleval script for NER")
         ("max_epoch", po::value<unsigned>(), "The epoch to iterate for training")
         ("model", po::value<string>(), "Use to specify the model name(path)")
         ("dropout_rate" , po::value<float>() , "droupout rate for training (Only for bi-lstm)")
         ("devel_freq", po::value<unsigned>()->default_value(6000), "The frequent(samples number)to validate(if set) . validation will be done after every devel-freq training samples")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
         ("trivial_report_freq", po::value<unsigned>()->default_value(5000), "Trace frequent during training process")
         ("replace_freq_threshold", po::value<unsigned>()->default_value(1), "The frequency threshold to replace the word to UNK in probability"
             "(eg , if set 1, the words of training data which frequency <= 1 may be "
@@ -66,15 +68,6 @@ int train_process(int argc, char *argv[], const string &program_name)
     
     if (0 == var_map.count("devel_data")) devel_data_path = "";
     else devel_data_path = var_map["devel_data"].as<string>();  
-    
-    string conlleval_script_path, *p_conlleval_script_path ;
-    if( devel_data_path == "" ) p_conlleval_script_path = nullptr ;
-    else
-    {
-        varmap_key_fatal_check(var_map, "conlleval_script_path", "conlleval script path should be specified .") ;
-        conlleval_script_path = var_map["conlleval_script_path"].as<string>() ;
-        p_conlleval_script_path = &conlleval_script_path ;
-    }
 
     varmap_key_fatal_check(var_map, "max_epoch",
         "Error : max epoch num should be specified .");
@@ -105,6 +98,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234); 
     Input2DModelHandler<NERSingleClassificationModel> model_handler;
+    model_handler.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
 
     // reading traing data , get word dict size and output tag number
     // -> set replace frequency for word_dict_wrapper
@@ -151,7 +145,6 @@ int train_process(int argc, char *argv[], const string &program_name)
     model_handler.train(&sents , &postag_seqs , &ner_seqs,
         max_epoch, 
         p_dev_sents , p_dev_postag_seqs , p_dev_ner_seqs,
-        p_conlleval_script_path,
         devel_freq , 
         trivial_report_freq);
 
@@ -168,11 +161,11 @@ int devel_process(int argc, char *argv[], const string &program_name)
         "using `" + program_name + " devel <options>` to validate . devel options are as following";
     po::options_description op_des = po::options_description(description);
     // set params to receive the arguments 
-    string devel_data_path, model_path , conlleval_script_path ;
+    string devel_data_path, model_path ;
     op_des.add_options()
         ("devel_data", po::value<string>(&devel_data_path), "The path to validation data .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
-        ("conlleval_script_path" , po::value<string>(&conlleval_script_path) , "path to conlleval script for NER")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -186,15 +179,10 @@ int devel_process(int argc, char *argv[], const string &program_name)
     varmap_key_fatal_check(var_map, "devel_data", "Error : validation(develop) data should be specified !");
     varmap_key_fatal_check(var_map, "model", "Error : model path should be specified !");
     if( !FileUtils::exists(devel_data_path) ) fatal_error("Error : failed to find devel data at `" + devel_data_path + "`") ;
-    varmap_key_fatal_check(var_map, "conlleval_script_path", "conlleval script path should be specified .") ;
-    if( !FileUtils::exists(conlleval_script_path) )
-    {
-        fatal_error("Error : failed to find conlleval script at `" +
-                    conlleval_script_path + "`") ;
-    }
     // Init 
     dynet::initialize(argc, argv, 1234);
     Input2DModelHandler<NERSingleClassificationModel> model_handler;
+    model_handler.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
     // Load model 
     ifstream model_is(model_path);
     if (!model_is)
@@ -214,7 +202,7 @@ int devel_process(int argc, char *argv[], const string &program_name)
     devel_is.close();
 
     // devel
-    model_handler.devel(&sents , &postag_seqs , &ner_seqs , &conlleval_script_path); 
+    model_handler.devel(&sents , &postag_seqs , &ner_seqs); 
     
     return 0;
 }
@@ -226,11 +214,15 @@ int predict_process(int argc, char *argv[], const string &program_name)
         "Predict process ."
         "using `" + program_name + " predict <options>` to predict . predict options are as following";
     po::options_description op_des = po::options_description(description);
-    string raw_data_path, output_path, model_path;
+    string raw_data_path, output_path, model_path, socket_path;
+    unsigned nr_thread;
     op_des.add_options()
-        ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) .")
+        ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) . using `stdin` if not specified or is `-` .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
+        ("threads", po::value<unsigned>(&nr_thread)->default_value(1), "Number of prediction workers (processes sharing the loaded model).")
+        ("socket", po::value<string>(&socket_path), "Serve on the unix socket instead of predicting raw data. "
+            "a client writes lines, shuts down writing, then reads the result.")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -243,7 +235,6 @@ int predict_process(int argc, char *argv[], const string &program_name)
 
     //set params 
     
-    varmap_key_fatal_check(var_map, "raw_data", "raw_data path should be specified .");
     
     if (output_path == "")
     {
@@ -265,28 +256,53 @@ int predict_process(int argc, char *argv[], const string &program_name)
     model_handler.load_model(is);
     is.close();
 
+    constexpr unsigned ChunkLineNum = 1024;
+    auto predict_func = [&model_handler](istream &chunk_is, ostream &chunk_os){ model_handler.predict(chunk_is, chunk_os); };
+    if( var_map.count("socket") )
+    {
+        utils::serve_on_unix_socket(socket_path, predict_func, max(nr_thread, 1U));
+        return 0;
+    }
+
     // open raw_data
-    ifstream raw_is(raw_data_path);
-    if (!raw_is)
+    ifstream raw_fis;
+    if( raw_data_path != "" && raw_data_path != "-" )
     {
-        fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        raw_fis.open(raw_data_path);
+        if( !raw_fis )
+        {
+            fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        }
+    }
+    else
+    {
+        BOOST_LOG_TRIVIAL(info) << "no raw_data is specified . using stdin .";
     }
+    istream &raw_is = raw_fis.is_open() ? static_cast<istream&>(raw_fis) : cin;
 
     // open output 
     if ("" == output_path)
     {
-        model_handler.predict(raw_is, cout); // using `cout` as output stream 
-        raw_is.close();
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, cout, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, cout); } // using `cout` as output stream 
+        raw_fis.close();
     }
     else
     {
         ofstream os(output_path);
         if (!os)
         {
-            raw_is.close();
+            raw_fis.close();
             fatal_error("Error : failed open output file at : `" +  output_path + "`.");
         }
-        model_handler.predict(raw_is, os);
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, os, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, os); }
         os.close();
     }
     return 0;
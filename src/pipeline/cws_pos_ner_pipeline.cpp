@@ -0,0 +1,171 @@
+#include <boost/program_options.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/log/expressions.hpp>
+
+#include "segmenter/cws_mlp_input1/cws_mlp_input1_instance.h"
+#include "segmenter/cws_module/cws_general_modelhandler.h"
+#include "postagger/pos_single_classification/pos_single_classification_model.h"
+#include "postagger/model_handler/single_input_modelhandler.h"
+#include "ner/ner_single_classification/ner_single_classification_model.h"
+#include "ner/model_handler/input2D_modelhandler.h"
+#include "utils/general.hpp"
+#include "utils/parallel_predictor.hpp"
+
+using namespace std;
+using namespace slnn;
+namespace po = boost::program_options;
+using slnn::segmenter::mlp_input1::MlpInput1All;
+
+static const string PROGRAM_HEADER = "CWS -> POSTAG -> NER pipeline based on DyNet Library";
+constexpr unsigned DEFAULT_RNG_SEED = 1234;
+
+/**
+ * every stage is run in its own process (DyNet keeps one graph per process), and loads its model there.
+ * stages are connected by pipes: segmenter outputs the tab-separated words, postagger outputs `word_TAG`,
+ * which is just the input format of ner. the segmenter flushes every `chunk_size` lines, postagger and ner
+ * flush every 1024 lines (their predict), so the next stage works on a block while the previous stage works on the next one.
+ */
+int pipeline_process(int argc, char *argv[], const string &program_name)
+{
+    string description = PROGRAM_HEADER + "\n"
+        "using `" + program_name + " <options>` to segment, postag and recognize named entities for raw text .\n"
+        "options are as following";
+    po::options_description generic_op("generic options");
+    generic_op.add_options()
+        ("logging_verbose", po::value<int>()->default_value(0), "The switch for logging trace . If 0 , trace will be ignored ,"
+            "else value leads to output trace info.")
+        ("help,h", "Show help information.");
+    
+    po::options_description dynet_op("dynet options");
+    dynet_op.add_options()
+        ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) for every stage.");
+
+    string raw_data_path, output_path, cws_model_path, pos_model_path, ner_model_path;
+    po::options_description file_op("file options");
+    file_op.add_options()
+        ("input", po::value<string>(&raw_data_path), "The path to raw data . using `stdin` if not specified or is `-` .")
+        ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
+        ("cws_model", po::value<string>(&cws_model_path), "[required] The path to segmenter model (Mlp-input1-all)")
+        ("pos_model", po::value<string>(&pos_model_path), "[required] The path to postagger model (single classification)")
+        ("ner_model", po::value<string>(&ner_model_path), "[required] The path to ner model (single classification)");
+
+    unsigned chunk_size;
+    po::options_description predict_op("predict options");
+    predict_op.add_options()
+        ("chunk_size", po::value<unsigned>(&chunk_size)->default_value(segmenter::modelhandler::DefaultPredictChunkSize),
+            "Line number to segment and pass to the next stage at a time (postagger and ner always pass 1024 lines).");
+
+    po::options_description all_op(description);
+    all_op.add(generic_op).add(dynet_op).add(file_op).add(predict_op);
+
+    po::variables_map var_map;
+    po::store(po::command_line_parser(argc, argv).options(all_op).allow_unregistered().run(), var_map);
+    po::notify(var_map);
+    if( var_map.count("help") )
+    {
+        cerr << all_op << endl;
+        return 0;
+    }
+    // trace switch
+    if( 0 == var_map["logging_verbose"].as<int>() )
+    {
+        boost::log::core::get()->set_filter(
+            boost::log::trivial::severity >= boost::log::trivial::debug
+        );
+    }
+    varmap_key_fatal_check(var_map, "cws_model", "Error : segmenter model path should be specified ! ");
+    varmap_key_fatal_check(var_map, "pos_model", "Error : postagger model path should be specified ! ");
+    varmap_key_fatal_check(var_map, "ner_model", "Error : ner model path should be specified ! ");
+    for( const string &model_path : { cws_model_path, pos_model_path, ner_model_path } )
+    {
+        if( !FileUtils::exists(model_path) )
+        {
+            fatal_error("Error : failed to open model path at '" + model_path + "' . ");
+        }
+    }
+    if( chunk_size == 0 ){ fatal_error("Error : chunk_size should be positive ."); }
+
+    // Init 
+    int dynet_argc;
+    shared_ptr<char *> dynet_argv;
+    unsigned dynet_mem = 0 ;
+    if( var_map.count("dynet-mem") != 0 ){ dynet_mem = var_map["dynet-mem"].as<unsigned>();}
+    build_dynet_parameters(program_name, dynet_mem, dynet_argc, dynet_argv);
+
+    // stages, models are loaded in the stage process.
+    vector<utils::StreamPredictFunc> stage_list;
+    stage_list.push_back([&](istream &stage_is, ostream &stage_os)
+    {
+        char **dynet_argv_ptr = dynet_argv.get();
+        shared_ptr<MlpInput1All> mia = MlpInput1All::load_and_build_model(cws_model_path, dynet_argc, dynet_argv_ptr);
+        segmenter::modelhandler::predict(*mia, stage_is, stage_os, chunk_size);
+    });
+    stage_list.push_back([&](istream &stage_is, ostream &stage_os)
+    {
+        int stage_argc = dynet_argc;
+        char **dynet_argv_ptr = dynet_argv.get();
+        dynet::initialize(stage_argc, dynet_argv_ptr, DEFAULT_RNG_SEED);
+        SingleInputModelHandler<POSSingleClassificationModel> model_handler;
+        ifstream model_is(pos_model_path);
+        model_handler.load_model(model_is);
+        model_handler.predict(stage_is, stage_os);
+    });
+    stage_list.push_back([&](istream &stage_is, ostream &stage_os)
+    {
+        int stage_argc = dynet_argc;
+        char **dynet_argv_ptr = dynet_argv.get();
+        dynet::initialize(stage_argc, dynet_argv_ptr, DEFAULT_RNG_SEED);
+        Input2DModelHandler<NERSingleClassificationModel> model_handler;
+        ifstream model_is(ner_model_path);
+        model_handler.load_model(model_is);
+        model_handler.predict(stage_is, stage_os);
+    });
+
+    // open raw_data
+    ifstream raw_fis;
+    if( raw_data_path != "" && raw_data_path != "-" )
+    {
+        raw_fis.open(raw_data_path);
+        if( !raw_fis )
+        {
+            fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        }
+    }
+    else
+    {
+        BOOST_LOG_TRIVIAL(info) << "no input is specified . using stdin .";
+    }
+    istream &raw_is = raw_fis.is_open() ? static_cast<istream&>(raw_fis) : cin;
+
+    // open output 
+    if( "" == output_path )
+    {
+        BOOST_LOG_TRIVIAL(info) << "no output is specified . using stdout .";
+        utils::run_pipeline(raw_is, cout, stage_list);
+    }
+    else
+    {
+        ofstream os(output_path);
+        if( !os )
+        {
+            fatal_error("Error : failed open output file at : `" +  output_path + "`.");
+        }
+        utils::run_pipeline(raw_is, os, stage_list);
+        os.close();
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        return pipeline_process(argc, argv, argv[0]);
+    }
+    catch( const exception &e )
+    {
+        cerr << e.what() << endl;
+        return -1;
+    }
+}
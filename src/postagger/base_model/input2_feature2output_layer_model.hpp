@@ -124,7 +124,8 @@ template <typename RNNDerived>
 void Input2F2OModel<RNNDerived>::build_fixed_dict(std::ifstream &is)
 {
     Word2vecEmbeddingHelper::build_fixed_dict(is, this->fixed_word_dict, this->UNK_STR, 
-        &fixed_word_dict_size, &fixed_word_embedding_dim);
+        &fixed_word_dict_size, &fixed_word_embedding_dim,
+        this->get_fixed_vocab_filter());
 }
 
 template <typename RNNDerived>
@@ -199,7 +200,7 @@ void Input2F2OModel<RNNDerived>::save(Archive &ar, const unsigned version) const
         & hidden_dim & output_dim
         & dropout_rate ;
     ar & this->dynamic_word_dict & this->fixed_word_dict & this->postag_dict & this->pos_feature ;
-    ar & *this->m ;
+    if( this->is_parameters_archived ){ ar & *this->m ; }
 }
 
 template <typename RNNDerived>template< typename Archive>
@@ -214,7 +215,7 @@ void Input2F2OModel<RNNDerived>::load(Archive &ar, const unsigned version)
     assert(this->dynamic_word_dict.size() == dynamic_word_dict_size && this->fixed_word_dict.size() == fixed_word_dict_size &&
         this->postag_dict.size() == output_dim) ;
     build_model_structure() ;
-    ar & *this->m ;
+    if( this->is_parameters_archived ){ ar & *this->m ; }
 }
 
 template <typename RNNDerived>
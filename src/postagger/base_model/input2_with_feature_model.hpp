@@ -1,6 +1,7 @@
 #ifndef POS_BASE_MODEL_INPUT2_WITH_FEATURE_MODEL_HPP_
 #define POS_BASE_MODEL_INPUT2_WITH_FEATURE_MODEL_HPP_
 #include <fstream>
+#include <unordered_set>
 #include <boost/program_options.hpp>
 
 #include "dynet/dynet.h"
@@ -35,6 +36,9 @@ public:
     bool is_dict_frozen();
     void freeze_dict();
     virtual void build_fixed_dict(std::ifstream &is) = 0; // bacause paremeter about size is in derived class
+    void add_to_fixed_vocab_filter(const Seq &sent); // only words added are loaded from embedding (if any added)
+    const std::unordered_set<std::string>* get_fixed_vocab_filter() const
+    { return fixed_vocab_filter.empty() ? nullptr : &fixed_vocab_filter; }
     void print_dynamic_word_hit_info();
     virtual void set_model_param(const boost::program_options::variables_map &var_map) = 0;
     
@@ -69,6 +73,8 @@ public:
     dynet::Dict& get_postag_dict(){ return postag_dict ; } 
     DictWrapper& get_word_dict_wrapper(){ return dynamic_word_dict_wrapper ; } 
     dynet::Model *get_dynet_model(){ return m ; } 
+    // false : parameters are not in the archive (stored by the binary model container), only meta info and dicts.
+    void set_parameters_archived(bool archived){ is_parameters_archived = archived; }
 
 
 protected:
@@ -78,6 +84,8 @@ protected:
     dynet::Dict fixed_word_dict;
     dynet::Dict postag_dict;
     DictWrapper dynamic_word_dict_wrapper;
+    std::unordered_set<std::string> fixed_vocab_filter; // not serialized, only for building fixed dict
+    bool is_parameters_archived;
 
 public:
     POSFeature pos_feature; // also as parameters
@@ -98,7 +106,8 @@ const size_t Input2WithFeatureModel<RNNDerived>::LenStrOfRepalceNumber = StrOfRe
 template<typename RNNDerived>
 Input2WithFeatureModel<RNNDerived>::Input2WithFeatureModel() 
     :m(nullptr),
-    dynamic_word_dict_wrapper(dynamic_word_dict)
+    dynamic_word_dict_wrapper(dynamic_word_dict),
+    is_parameters_archived(true)
 {}
 
 template <typename RNNDerived>
@@ -129,6 +138,15 @@ void Input2WithFeatureModel<RNNDerived>::freeze_dict()
     pos_feature.freeze_dict();
 }
 
+template <typename RNNDerived>
+void Input2WithFeatureModel<RNNDerived>::add_to_fixed_vocab_filter(const Seq &sent)
+{
+    for( const std::string &word : sent )
+    {
+        fixed_vocab_filter.insert(UTF8Processing::replace_number(word, StrOfReplaceNumber, LenStrOfRepalceNumber));
+    }
+}
+
 template <typename RNNDerived>
 void Input2WithFeatureModel<RNNDerived>::print_dynamic_word_hit_info()
 {
@@ -3,10 +3,12 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
 #include "postagger/base_model/input1_mlp_model.h"
 #include "postagger/postagger_module/pos_reader.h"
 #include "utils/stash_model.hpp"
 #include "utils/stat.hpp"
+#include "utils/reusable_graph.hpp"
 namespace slnn{
 
 template <typename MLPModel>
@@ -260,6 +262,7 @@ void Input1MLPModelHandler<MLPModel>::train(const std::vector<IndexSeq> &sents,
 
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for( unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch )
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -279,9 +282,10 @@ void Input1MLPModelHandler<MLPModel>::train(const std::vector<IndexSeq> &sents,
                 &tag_seq = tag_seqs.at(access_idx);
             const POSFeature::POSFeatureIndexGroupSeq &feature_gp_seq = feature_gp_seqs.at(access_idx);
             const ContextFeatureDataSeq &context_feature_gp_seq = context_feature_gp_seqs.at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 IndexSeq sent_after_replace ;
                 POSFeature::POSFeatureIndexGroupSeq feature_gp_seq_after_replace;
                 ContextFeatureDataSeq context_feature_gp_seq_after_replace;
@@ -305,6 +309,7 @@ void Input1MLPModelHandler<MLPModel>::train(const std::vector<IndexSeq> &sents,
             // If developing samples is available , do `devel` to get model training effect . 
             if(  0 == line_cnt_for_devel % do_devel_freq )
             {
+                pgraph.reset();
                 do_devel_in_training(model_stash);
                 if( !model_stash.is_training_ok() ){ break; }
             }
@@ -325,6 +330,7 @@ void Input1MLPModelHandler<MLPModel>::train(const std::vector<IndexSeq> &sents,
         if( model_stash.is_training_ok() )
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             do_devel_in_training(model_stash);
         }
         if( !model_stash.is_training_ok() ){ break; }
@@ -345,9 +351,10 @@ float Input1MLPModelHandler<MLPModel>::devel(const std::vector<IndexSeq> &sents,
 
     Stat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for( unsigned access_idx = 0; access_idx < nr_samples; ++access_idx )
     {
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq &sent = sents.at(access_idx),
             &gold_tag = tag_seqs.at(access_idx);
@@ -382,6 +389,7 @@ void Input1MLPModelHandler<MLPModel>::predict(std::istream &is, std::ostream &os
     BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
     BasicStat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for( unsigned int i = 0; i < raw_instances.size(); ++i )
     {
         Seq &raw_sent = raw_instances.at(i);
@@ -394,7 +402,7 @@ void Input1MLPModelHandler<MLPModel>::predict(std::istream &is, std::ostream &os
         ContextFeatureDataSeq &context_feature_gp_seq = context_feature_gp_seqs.at(i);
         POSFeature::POSFeatureIndexGroupSeq &feature_gp_seq = feature_gp_seqs.at(i);
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         mlp_model->predict(cg, sent, context_feature_gp_seq, feature_gp_seq, pred_tag_seq);
         Seq postag_seq;
         mlp_model->postag_index_seq2postag_str_seq(pred_tag_seq, postag_seq);
@@ -3,10 +3,12 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
 #include "postagger/base_model/input1_mlp_model_no_feature.h"
 #include "postagger/postagger_module/pos_reader.h"
 #include "utils/stash_model.hpp"
 #include "utils/stat.hpp"
+#include "utils/reusable_graph.hpp"
 namespace slnn{
 
 template <typename MLPModel>
@@ -237,6 +239,7 @@ void Input1MLPModelNoFeatureHandler<MLPModel>::train(const std::vector<IndexSeq>
 
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for( unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch )
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -255,9 +258,10 @@ void Input1MLPModelNoFeatureHandler<MLPModel>::train(const std::vector<IndexSeq>
             const IndexSeq &sent = sents.at(access_idx),
                 &tag_seq = tag_seqs.at(access_idx);
             const ContextFeatureDataSeq &context_feature_gp_seq = context_feature_gp_seqs.at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 IndexSeq sent_after_replace ;
                 ContextFeatureDataSeq context_feature_gp_seq_after_replace;
                 mlp_model->replace_word_with_unk(sent, context_feature_gp_seq, 
@@ -280,6 +284,7 @@ void Input1MLPModelNoFeatureHandler<MLPModel>::train(const std::vector<IndexSeq>
             // If developing samples is available , do `devel` to get model training effect . 
             if( 0 == line_cnt_for_devel % do_devel_freq )
             {
+                pgraph.reset();
                 do_devel_in_training(model_stash);
                 if( model_stash.is_training_ok() ){ break; }
             }
@@ -300,6 +305,7 @@ void Input1MLPModelNoFeatureHandler<MLPModel>::train(const std::vector<IndexSeq>
         if( model_stash.is_training_ok() )
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             do_devel_in_training(model_stash);
         }
         if( !model_stash.is_training_ok() ){ break; }
@@ -320,9 +326,10 @@ float Input1MLPModelNoFeatureHandler<MLPModel>::devel(const std::vector<IndexSeq
 
     Stat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for( unsigned access_idx = 0; access_idx < nr_samples; ++access_idx )
     {
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq &sent = sents.at(access_idx),
             &gold_tag = tag_seqs.at(access_idx);
@@ -355,6 +362,7 @@ void Input1MLPModelNoFeatureHandler<MLPModel>::predict(std::istream &is, std::os
     BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
     BasicStat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for( unsigned int i = 0; i < raw_instances.size(); ++i )
     {
         Seq &raw_sent = raw_instances.at(i);
@@ -366,7 +374,7 @@ void Input1MLPModelNoFeatureHandler<MLPModel>::predict(std::istream &is, std::os
         IndexSeq &sent = sents.at(i) ;
         ContextFeatureDataSeq &context_feature_gp_seq = context_feature_gp_seqs.at(i);
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         mlp_model->predict(cg, sent, context_feature_gp_seq, pred_tag_seq);
         Seq postag_seq;
         mlp_model->postag_index_seq2postag_str_seq(pred_tag_seq, postag_seq);
@@ -2,10 +2,22 @@
 #define POS_MODEL_HANDLER_INPUT2_WITH_FEATURE_MODELHANDLERS_HPP_
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
 #include "postagger/base_model/input2_with_feature_model.hpp"
 #include "postagger/postagger_module/pos_reader.h"
 #include "utils/stash_model.hpp"
 #include "utils/stat.hpp"
+#include "utils/reusable_graph.hpp"
+#include "utils/parallel_reduce.hpp"
+#include "utils/dynet_binary_model.hpp"
+#include "trivial/model_container/binary_model_container.h"
 namespace slnn{
 
 template <typename RNNDerived, typename I2Model>
@@ -23,6 +35,8 @@ public:
 
     // before reading
     void build_fixed_dict(std::ifstream &is);
+    // collect words of the data to restrict the fixed dict, should be called before `build_fixed_dict`
+    void collect_fixed_vocab(std::istream &is, bool is_annotated);
 
     // Reading data 
     void read_annotated_data(std::istream &is,
@@ -67,9 +81,17 @@ public:
         const std::vector<IndexSeq> *p_tag_seqs);
 
     void predict(std::istream &is, std::ostream &os);
+    // decoding option, only for the model with beam search decoding (pretag)
+    void set_beam_size(unsigned beam_size){ static_cast<I2Model*>(i2m)->set_beam_size(beam_size); }
+    // devel by `nr_worker` processes
+    void set_devel_worker(unsigned nr_worker){ nr_devel_worker = std::max(nr_worker, 1U); }
 
+    // save to the binary model container
     void save_model(std::ostream &os);
+    // load the model saved in text archive (the format before binary model container)
     void load_model(std::istream &is);
+    // load the model by path, binary model container will be mapped, text archive is also supported.
+    void load_model(const std::string &model_path);
 
     // After read data
     void set_model_param_after_reading_training_data(const boost::program_options::variables_map &varmap);
@@ -78,6 +100,8 @@ public:
 
 private:
     CNNModelStash model_stash;
+    unsigned nr_devel_worker;
+    std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_model_file; // parameters are bound to it
 };
 
 template <typename RNNDerived, typename I2Model>
@@ -85,7 +109,8 @@ const std::string Input2WithFeatureModelHandler<RNNDerived, I2Model>::OutputDeli
 
 template <typename RNNDerived, typename I2Model>
 Input2WithFeatureModelHandler<RNNDerived, I2Model>::Input2WithFeatureModelHandler()
-    :i2m(new I2Model())
+    :i2m(new I2Model()),
+    nr_devel_worker(1U)
 {}
 
 template <typename RNNDerived, typename I2Model>
@@ -100,6 +125,18 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::build_fixed_dict(std::i
     i2m->build_fixed_dict(is);
 }
 
+template <typename RNNDerived, typename I2Model>
+void Input2WithFeatureModelHandler<RNNDerived, I2Model>::collect_fixed_vocab(std::istream &is, bool is_annotated)
+{
+    POSReader reader(is);
+    Seq str_sent,
+        str_postag_seq;
+    while( is_annotated ? reader.readline(str_sent, str_postag_seq) : reader.readline(str_sent) )
+    {
+        i2m->add_to_fixed_vocab_filter(str_sent);
+    }
+}
+
 template <typename RNNDerived, typename I2Model>
 void Input2WithFeatureModelHandler<RNNDerived, I2Model>::read_annotated_data(std::istream &is,
     std::vector<IndexSeq> &dynamic_sents,
@@ -259,6 +296,7 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::train(const std::vector
     dynet::SimpleSGDTrainer sgd(i2m->get_dynet_model());
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for( unsigned nr_epoch = 0; nr_epoch < max_epoch && is_train_ok; ++nr_epoch )
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -278,9 +316,10 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::train(const std::vector
                 &fixed_sent = p_fixed_sents->at(access_idx),
                 &tag_seq = p_tag_seqs->at(access_idx);
             const POSFeature::POSFeatureIndexGroupSeq &feature_gp_seq = p_feature_gp_seqs->at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 IndexSeq sent_after_replace ;
                 POSFeature::POSFeatureIndexGroupSeq feature_gp_seq_after_replace;
                 i2m->replace_word_with_unk(dynamic_sent, feature_gp_seq, sent_after_replace, feature_gp_seq_after_replace);
@@ -302,6 +341,7 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::train(const std::vector
             // If developing samples is available , do `devel` to get model training effect . 
             if( p_dev_dynamic_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq )
             {
+                pgraph.reset();
                 float acc = devel(p_dev_dynamic_sents, p_dev_fixed_sents, p_dev_feature_gp_seqs, p_dev_tag_seqs);
                 model_stash.save_when_best(i2m->get_dynet_model(), acc);
                 line_cnt_for_devel = 0; // avoid overflow
@@ -328,6 +368,7 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::train(const std::vector
         if( p_dev_dynamic_sents != nullptr && is_train_ok )
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float acc = devel(p_dev_dynamic_sents, p_dev_fixed_sents, p_dev_feature_gp_seqs, p_dev_tag_seqs);
             model_stash.save_when_best(i2m->get_dynet_model(), acc);
             if( model_stash.is_train_error_occurs(acc) )
@@ -353,9 +394,12 @@ float Input2WithFeatureModelHandler<RNNDerived, I2Model>::devel(const std::vecto
 
     Stat stat(true);
     stat.start_time_stat();
-    for( unsigned access_idx = 0; access_idx < nr_samples; ++access_idx )
+    // the graph is built at the first instance of a worker, so every worker process has its own graph.
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
+    auto devel_one = [&](unsigned access_idx, Stat &part_stat)
     {
-        dynet::ComputationGraph cg;
+        if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+        dynet::ComputationGraph &cg = pgraph->renew();
         IndexSeq predict_tag_seq;
         const IndexSeq &dynamic_sent = p_dynamic_sents->at(access_idx),
             &fixed_sent = p_fixed_sents->at(access_idx),
@@ -363,11 +407,20 @@ float Input2WithFeatureModelHandler<RNNDerived, I2Model>::devel(const std::vecto
         const POSFeature::POSFeatureIndexGroupSeq &feature_gp_seq = p_feature_gp_seqs->at(access_idx);
         i2m->predict(cg, dynamic_sent, fixed_sent, feature_gp_seq, predict_tag_seq);
 
-        stat.total_tags += predict_tag_seq.size();
+        part_stat.total_tags += predict_tag_seq.size();
         for( size_t tag_idx = 0 ; tag_idx < gold_tag.size() ; ++tag_idx )
         {
-            if( gold_tag.at(tag_idx) == predict_tag_seq.at(tag_idx) ) ++stat.correct_tags ;
+            if( gold_tag.at(tag_idx) == predict_tag_seq.at(tag_idx) ) ++part_stat.correct_tags ;
         }
+    };
+    if( nr_devel_worker > 1 && utils::is_parallel_reduce_supported() )
+    {
+        // partial stat of every worker is merged.
+        stat += utils::reduce_in_parallel<Stat>(nr_devel_worker, 0U, nr_samples, devel_one);
+    }
+    else
+    {
+        for( unsigned access_idx = 0; access_idx < nr_samples; ++access_idx ){ devel_one(access_idx, stat); }
     }
     stat.end_time_stat();
 
@@ -390,6 +443,7 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::predict(std::istream &i
     BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
     BasicStat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for( unsigned int i = 0; i < raw_instances.size(); ++i )
     {
         Seq &raw_sent = raw_instances.at(i);
@@ -402,7 +456,7 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::predict(std::istream &i
             fixed_sent = fixed_sents.at(i);
         POSFeature::POSFeatureIndexGroupSeq &feature_gp_seq = feature_gp_seqs.at(i);
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         i2m->predict(cg, dynamic_sent, fixed_sent, feature_gp_seq, pred_tag_seq);
         Seq postag_seq;
         i2m->postag_index_seq2postag_str_seq(pred_tag_seq, postag_seq);
@@ -424,8 +478,16 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::save_model(std::ostream
 {
     BOOST_LOG_TRIVIAL(info) << "saving model ...";
     model_stash.load_if_exists(i2m->get_dynet_model());
-    boost::archive::text_oarchive to(os);
-    to << *(static_cast<I2Model*>(i2m));
+    // 1. dict section: structure param, dicts and feature, without parameters
+    std::ostringstream dict_os;
+    {
+        boost::archive::binary_oarchive to(dict_os);
+        i2m->set_parameters_archived(false);
+        to << *(static_cast<I2Model*>(i2m));
+        i2m->set_parameters_archived(true);
+    }
+    // 2. parameter section
+    dynet_binary_model::write_binary_model(os, dict_os.str(), i2m->get_dynet_model());
     BOOST_LOG_TRIVIAL(info) << "save model done .";
 }
 
@@ -435,6 +497,34 @@ void Input2WithFeatureModelHandler<RNNDerived, I2Model>::load_model(std::istream
     BOOST_LOG_TRIVIAL(info) << "loading model ...";
     boost::archive::text_iarchive ti(is) ;
     ti >> *(static_cast<I2Model*>(i2m));
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
+    i2m->print_model_info() ;
+}
+
+template <typename RNNDerived, typename I2Model>
+void Input2WithFeatureModelHandler<RNNDerived, I2Model>::load_model(const std::string &model_path)
+{
+    if( !trivial::model_container::is_binary_model(model_path) )
+    {
+        std::ifstream is(model_path);
+        if( !is ){ throw std::runtime_error("failed to open model: '" + model_path + "'"); }
+        load_model(is);
+        return;
+    }
+    BOOST_LOG_TRIVIAL(info) << "loading binary model ...";
+    std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_file =
+        std::make_shared<const trivial::model_container::MappedModelFile>(model_path);
+    std::istringstream dict_is(std::string(mapped_file->get_dict_data(), mapped_file->get_dict_size()));
+    {
+        // structure is built when reading, then use the mapped parameters in place.
+        boost::archive::binary_iarchive ti(dict_is);
+        i2m->set_parameters_archived(false);
+        ti >> *(static_cast<I2Model*>(i2m));
+        i2m->set_parameters_archived(true);
+    }
+    dynet_binary_model::bind_parameters(i2m->get_dynet_model(), *mapped_file);
+    mapped_model_file = mapped_file;
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     i2m->print_model_info() ;
 }
 
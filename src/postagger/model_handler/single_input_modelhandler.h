@@ -1,12 +1,15 @@
 #ifndef SLNN_POSTAGGER_POS_SINGLE_SINGLE_INPUT_MODELHANDLER_H
 #define SLNN_POSTAGGER_POS_SINGLE_SINGLE_INPUT_MODELHANDLER_H
 
+#include <memory>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include "postagger/base_model/single_input_model.h"
 
 #include "utils/stat.hpp"
+#include "utils/parameter_snapshot.hpp"
+#include "utils/reusable_graph.hpp"
 namespace slnn{
 
 template <typename SIModel>
@@ -16,7 +19,7 @@ public :
     SingleInputModel *sim ;
 
     float best_acc;
-    std::stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
 
     const size_t SentMaxLen = 256;
     const size_t MaxSentNum = 0x8000; // 32k
@@ -39,6 +42,7 @@ public :
                          std::vector<IndexSeq> &sents, std::vector<IndexSeq> &tag_seqs);
     void read_test_data(std::istream &is,
                         std::vector<Seq> &raw_test_sents, std::vector<IndexSeq> &sents);
+    void process_test_line(const std::string &line, Seq &raw_sent, IndexSeq &sent);
 
     // After Reading Training data
     void finish_read_training_data(boost::program_options::variables_map &varmap);
@@ -81,7 +85,7 @@ template <typename SIModel>
 SingleInputModelHandler<SIModel>::SingleInputModelHandler()
     : sim(new SIModel()) ,
     best_acc(0.f) ,
-    best_model_tmp_ss()
+    best_model_snapshot()
 {}
 
 template <typename SIModel>
@@ -96,9 +100,7 @@ void SingleInputModelHandler<SIModel>::save_current_best_model(float acc)
 {
     BOOST_LOG_TRIVIAL(info) << "better model has been found . stash it .";
     best_acc = acc;
-    best_model_tmp_ss.str(""); // first , clear it's content !
-    boost::archive::text_oarchive to(best_model_tmp_ss);
-    to << *sim->get_dynet_model();
+    best_model_snapshot.take(sim->get_dynet_model());
 }
 
 template<typename SIModel>
@@ -221,7 +223,6 @@ void SingleInputModelHandler<SIModel>::read_test_data(std::istream &is,
                                                       std::vector<Seq> &raw_test_sents, 
                                                       std::vector<IndexSeq> &sents)
 {
-    dynet::Dict &word_dict = sim->get_input_dict() ;
     std::string line ;
     std::vector<Seq> tmp_raw_sents ;
     std::vector<IndexSeq> tmp_sents ;
@@ -231,13 +232,7 @@ void SingleInputModelHandler<SIModel>::read_test_data(std::istream &is,
     while( getline(is, line) )
     {
         // do not skip empty line .
-        boost::algorithm::split(raw_sent, line, boost::is_any_of("\t")) ;
-        sent.resize(raw_sent.size()) ;
-        for( size_t i = 0 ; i < raw_sent.size() ; ++i )
-        {
-            Index word_id = word_dict.convert(raw_sent.at(i)) ;
-            sent.at(i) = word_id ;
-        }
+        process_test_line(line, raw_sent, sent);
         tmp_raw_sents.push_back(raw_sent) ;
         tmp_sents.push_back(sent) ;
     }
@@ -245,6 +240,19 @@ void SingleInputModelHandler<SIModel>::read_test_data(std::istream &is,
     std::swap(sents, tmp_sents) ;
 }
 
+template <typename SIModel>
+void SingleInputModelHandler<SIModel>::process_test_line(const std::string &line, Seq &raw_sent, IndexSeq &sent)
+{
+    dynet::Dict &word_dict = sim->get_input_dict() ;
+    boost::algorithm::split(raw_sent, line, boost::is_any_of("\t")) ;
+    sent.resize(raw_sent.size()) ;
+    for( size_t i = 0 ; i < raw_sent.size() ; ++i )
+    {
+        Index word_id = word_dict.convert(raw_sent.at(i)) ;
+        sent.at(i) = word_id ;
+    }
+}
+
 template <typename SIModel>
 void SingleInputModelHandler<SIModel>::finish_read_training_data(boost::program_options::variables_map &varmap)
 {
@@ -279,6 +287,7 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq dynamic_sent_after_replace_unk(SentMaxLen , 0);
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for (unsigned nr_epoch = 0; nr_epoch < max_epoch && is_train_ok; ++nr_epoch)
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -296,9 +305,10 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
             // using negative_loglikelihood loss to build model
             const IndexSeq &sent = p_sents->at(access_idx),
                 &tag_seq = p_tag_seqs->at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 dynamic_sent_after_replace_unk.resize(sent.size());
                 for( size_t word_idx = 0; word_idx < sent.size(); ++word_idx )
                 {
@@ -323,6 +333,7 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
             // If developing samples is available , do `devel` to get model training effect . 
             if (p_dev_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
             {
+                pgraph.reset();
                 float acc = devel(p_dev_sents  , p_dev_tag_seqs);
                 if (acc > best_acc) save_current_best_model(acc);
                 line_cnt_for_devel = 0; // avoid overflow
@@ -349,6 +360,7 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
         if (p_dev_sents != nullptr && is_train_ok)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float acc = devel(p_dev_sents , p_dev_tag_seqs);
             if (acc > best_acc) save_current_best_model(acc);
             if( is_train_error_occurs(acc) )
@@ -372,9 +384,10 @@ float SingleInputModelHandler<SIModel>::devel(const std::vector<IndexSeq> *p_sen
 
     Stat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
     {
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq &sent = p_sents->at(access_idx) ,
             &gold_tag = p_tag_seqs->at(access_idx);
@@ -394,28 +407,34 @@ float SingleInputModelHandler<SIModel>::devel(const std::vector<IndexSeq> *p_sen
     return stat.get_acc() ;
 }
 
+/**
+ * predict in streaming mode : read a line, predict and write it. 
+ * memory is constant and the input can be a pipe. output is flushed every `FlushLineNum` lines.
+ */
 template <typename SIModel>
 void SingleInputModelHandler<SIModel>::predict(std::istream &is, std::ostream &os)
 {
-    
-    std::vector<Seq> raw_instances;
-    std::vector<IndexSeq> sents ;
-    read_test_data(is,raw_instances, sents );
-    BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
+    constexpr unsigned FlushLineNum = 1024;
+    BOOST_LOG_TRIVIAL(info) << "do prediction in streaming mode .";
     BasicStat stat(true);
     dynet::Dict &tag_dict = sim->get_output_dict() ;
     stat.start_time_stat();
-    for (unsigned int i = 0; i < raw_instances.size(); ++i)
+    std::string line;
+    Seq raw_sent;
+    IndexSeq sent;
+    unsigned long nr_instance = 0;
+    slnn::ReusableGraph graph;
+    while( getline(is, line) )
     {
-        Seq &raw_sent = raw_instances.at(i);
-        if (0 == raw_sent.size())
+        if( ++nr_instance % FlushLineNum == 0 ){ os.flush(); }
+        process_test_line(line, raw_sent, sent);
+        if( 0 == raw_sent.size() )
         {
             os << "\n";
             continue;
         }
-        IndexSeq &sent = sents.at(i) ;
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         sim->predict(cg, sent, pred_tag_seq);
         os << raw_sent[0] << "_" << tag_dict.convert(pred_tag_seq[0]) ;
         for( size_t i = 1 ; i < raw_sent.size() ; ++i )
@@ -426,16 +445,18 @@ void SingleInputModelHandler<SIModel>::predict(std::istream &is, std::ostream &o
         os << "\n";
         stat.total_tags += pred_tag_seq.size() ;
     }
+    os.flush();
     stat.end_time_stat() ;
+    BOOST_LOG_TRIVIAL(info) << "predicted instance : " << nr_instance ;
     BOOST_LOG_TRIVIAL(info) << stat.get_stat_str("predict done.")  ;
 }
 
 template <typename SIModel>
 void SingleInputModelHandler<SIModel>::save_model(std::ostream &os)
 {
-    if( best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail() )
+    if( best_model_snapshot.restore(sim->get_dynet_model()) )
     {
-        sim->set_dynet_model(best_model_tmp_ss) ;
+        ViterbiDecoder::clear_all_score() ; // drop the decoder score of the old parameters
     }
     sim->save_model(os) ;
 }
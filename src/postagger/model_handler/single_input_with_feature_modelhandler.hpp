@@ -2,10 +2,12 @@
 #define POS_MODEL_HANDLER_SINGLE_INPUT_WITH_FEATURE_MODELHANDLERS_HPP_
 #include <iostream>
 #include <vector>
+#include <memory>
 #include "postagger/base_model/single_input_with_feature_model.hpp"
 #include "postagger/postagger_module/pos_reader.h"
 #include "utils/stash_model.hpp"
 #include "utils/stat.hpp"
+#include "utils/reusable_graph.hpp"
 namespace slnn{
 
 template <typename RNNDerived, typename SIModel>
@@ -59,6 +61,8 @@ public:
         const std::vector<IndexSeq> *p_tag_seqs);
 
     void predict(std::istream &is, std::ostream &os);
+    // decoding option, only for the model with beam search decoding (pretag)
+    void set_beam_size(unsigned beam_size){ static_cast<SIModel*>(sim)->set_beam_size(beam_size); }
 
     void save_model(std::ostream &os);
     void load_model(std::istream &is);
@@ -223,6 +227,7 @@ void SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::train(const std::v
     dynet::SimpleSGDTrainer sgd(sim->get_dynet_model());
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for( unsigned nr_epoch = 0; nr_epoch < max_epoch && is_train_ok; ++nr_epoch )
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -241,9 +246,10 @@ void SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::train(const std::v
             const IndexSeq &sent = p_sents->at(access_idx),
                 &tag_seq = p_tag_seqs->at(access_idx);
             const POSFeature::POSFeatureIndexGroupSeq &feature_gp_seq = p_feature_gp_seqs->at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 IndexSeq sent_after_replace ;
                 POSFeature::POSFeatureIndexGroupSeq feature_gp_seq_after_replace;
                 sim->replace_word_with_unk(sent, feature_gp_seq, sent_after_replace, feature_gp_seq_after_replace);
@@ -265,6 +271,7 @@ void SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::train(const std::v
             // If developing samples is available , do `devel` to get model training effect . 
             if( p_dev_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq )
             {
+                pgraph.reset();
                 float acc = devel(p_dev_sents, p_dev_feature_gp_seqs, p_dev_tag_seqs);
                 model_stash.save_when_best(sim->get_dynet_model(), acc);
                 line_cnt_for_devel = 0; // avoid overflow
@@ -291,6 +298,7 @@ void SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::train(const std::v
         if( p_dev_sents != nullptr && is_train_ok )
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float acc = devel(p_dev_sents, p_dev_feature_gp_seqs, p_dev_tag_seqs);
             model_stash.save_when_best(sim->get_dynet_model(), acc);
             if( model_stash.is_train_error_occurs(acc) )
@@ -316,9 +324,10 @@ float SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::devel(const std::
 
     Stat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for( unsigned access_idx = 0; access_idx < nr_samples; ++access_idx )
     {
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq &sent = p_sents->at(access_idx),
             &gold_tag = p_tag_seqs->at(access_idx);
@@ -351,6 +360,7 @@ void SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::predict(std::istre
     BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
     BasicStat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for( unsigned int i = 0; i < raw_instances.size(); ++i )
     {
         Seq &raw_sent = raw_instances.at(i);
@@ -362,7 +372,7 @@ void SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::predict(std::istre
         IndexSeq &sent = sents.at(i) ;
         POSFeature::POSFeatureIndexGroupSeq &feature_gp_seq = feature_gp_seqs.at(i);
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         sim->predict(cg, sent, feature_gp_seq, pred_tag_seq);
         Seq postag_seq;
         sim->postag_index_seq2postag_str_seq(pred_tag_seq, postag_seq);
@@ -395,6 +405,7 @@ void SingleInputWithFeatureModelHandler<RNNDerived, SIModel>::load_model(std::is
     BOOST_LOG_TRIVIAL(info) << "loading model ...";
     boost::archive::text_iarchive ti(is) ;
     ti >> *(static_cast<SIModel*>(sim));
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     sim->print_model_info() ;
 }
 
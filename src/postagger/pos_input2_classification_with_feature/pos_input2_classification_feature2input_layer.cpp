@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <sstream>
 
 #include <boost/log/core.hpp>
@@ -11,6 +12,7 @@
 #include "pos_input2_classification_feature2input_layer_model.h"
 #include "postagger/model_handler/input2_with_feature_modelhandler.hpp"
 #include "utils/general.hpp"
+#include "utils/parallel_predictor.hpp"
 
 using namespace std;
 using namespace dynet;
@@ -31,10 +33,15 @@ int train_process(int argc, char *argv[], const string &program_name)
         ("training_data", po::value<string>(), "[required] The path to training data")
         ("devel_data", po::value<string>(), "The path to developing data . For validation duration training . Empty for discarding .")
         ("word2vec_embedding" , po::value<string>(), "The path to word2vec embedding")
+        ("embedding_vocab_filter", po::value<bool>()->default_value(false), "Only load embedding of words in training/devel data "
+         "(and `embedding_vocab_data`, if given) .")
+        ("embedding_vocab_data", po::value<string>(), "The path to raw(segmented) data whose words are also loaded from embedding "
+         "(eg , the test data) .")
         ("max_epoch", po::value<unsigned>(), "The epoch to iterate for training")
         ("model", po::value<string>(), "Use to specify the model name(path)")
         ("dropout_rate", po::value<float>(), "droupout rate for training (Only for bi-lstm)")
         ("devel_freq", po::value<unsigned>()->default_value(100000), "The frequent(samples number)to validate(if set) . validation will be done after every devel-freq training samples")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
         ("trivial_report_freq", po::value<unsigned>()->default_value(5000), "Trace frequent during training process")
         ("replace_freq_threshold", po::value<unsigned>()->default_value(1), "The frequency threshold to replace the word to UNK in probability"
          "(eg , if set 1, the words of training data which frequency <= 1 may be "
@@ -114,6 +121,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
     dynet::initialize(dynet_argc, dynet_argv_ptr, CNNRandomSeed); 
     Input2WithFeatureModelHandler<RNNDerived, POSInput2ClassificationF2IModel<RNNDerived>> model_handler;
+    model_handler.set_devel_worker(var_map["devel_worker"].as<unsigned>());
 
     ifstream embedding_is(word2vec_embedding_path);
     if (!embedding_is)
@@ -121,12 +129,27 @@ int train_process(int argc, char *argv[], const string &program_name)
         BOOST_LOG_TRIVIAL(fatal) << "failed to open word2vec embedding : `" << word2vec_embedding_path << "` .\n Exit! \n";
         return -1;
     }
+    if( var_map["embedding_vocab_filter"].as<bool>() )
+    {
+        ifstream train_vocab_is(training_data_path),
+            devel_vocab_is(devel_data_path);
+        if( !train_vocab_is || !devel_vocab_is ) fatal_error("Error : failed to open training/devel data to collect vocabulary .");
+        model_handler.collect_fixed_vocab(train_vocab_is, true);
+        model_handler.collect_fixed_vocab(devel_vocab_is, true);
+        if( var_map.count("embedding_vocab_data") )
+        {
+            string vocab_data_path = var_map["embedding_vocab_data"].as<string>();
+            ifstream vocab_data_is(vocab_data_path);
+            if( !vocab_data_is ) fatal_error("Error : failed to open embedding vocab data: `" + vocab_data_path + "` .");
+            model_handler.collect_fixed_vocab(vocab_data_is, false);
+        }
+    }
     model_handler.build_fixed_dict(embedding_is);
     embedding_is.clear() ; // !! MUST calling before `seekg` ! even thouth using  c++ 11 .
     embedding_is.seekg(0); // will use in the following 
 
     // pre-open model file, avoid fail after a long time training
-    ofstream model_os(model_path);
+    ofstream model_os(model_path, ios::binary);
     if( !model_os ) fatal_error("failed to open model path at '" + model_path + "'") ;
     // reading traing data , get word dict size and output tag number
     
@@ -185,6 +208,7 @@ int devel_process(int argc, char *argv[], const string &program_name)
         ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) .")
         ("devel_data", po::value<string>(&devel_data_path), "The path to validation data .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process) .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -208,13 +232,14 @@ int devel_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
     dynet::initialize(dynet_argc, dynet_argv_ptr, CNNRandomSeed); 
     Input2WithFeatureModelHandler<RNNDerived, POSInput2ClassificationF2IModel<RNNDerived>> model_handler;
+    model_handler.set_devel_worker(var_map["devel_worker"].as<unsigned>());
     // Load model 
     ifstream model_is(model_path);
     if (!model_is)
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' .");
     }
-    model_handler.load_model(model_is);
+    model_handler.load_model(model_path);
     model_is.close();
 
     // read devel data
@@ -240,12 +265,16 @@ int predict_process(int argc, char *argv[], const string &program_name)
         "Predict process ."
         "using `" + program_name + " predict [rnn-type] <options>` to predict . predict options are as following";
     po::options_description op_des = po::options_description(description);
-    string raw_data_path, output_path, model_path;
+    string raw_data_path, output_path, model_path, socket_path;
+    unsigned nr_thread;
     op_des.add_options()
         ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) .")
         ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
+        ("threads", po::value<unsigned>(&nr_thread)->default_value(1), "Number of prediction workers (processes sharing the loaded model).")
+        ("socket", po::value<string>(&socket_path), "Serve on the unix socket instead of predicting raw data. "
+            "a client writes lines, shuts down writing, then reads the result.")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -258,7 +287,7 @@ int predict_process(int argc, char *argv[], const string &program_name)
 
     //set params 
     
-    varmap_key_fatal_check(var_map, "raw_data", "raw_data path should be specified .");
+    if( !var_map.count("socket") ){ varmap_key_fatal_check(var_map, "raw_data", "raw_data path should be specified ."); }
     
     if (output_path == "")
     {
@@ -283,9 +312,17 @@ int predict_process(int argc, char *argv[], const string &program_name)
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' . ");
     }
-    model_handler.load_model(is);
+    model_handler.load_model(model_path);
     is.close();
 
+    constexpr unsigned ChunkLineNum = 1024;
+    auto predict_func = [&model_handler](istream &chunk_is, ostream &chunk_os){ model_handler.predict(chunk_is, chunk_os); };
+    if( var_map.count("socket") )
+    {
+        utils::serve_on_unix_socket(socket_path, predict_func, max(nr_thread, 1U));
+        return 0;
+    }
+
     // open raw_data
     ifstream raw_is(raw_data_path);
     if (!raw_is)
@@ -296,7 +333,11 @@ int predict_process(int argc, char *argv[], const string &program_name)
     // open output 
     if ("" == output_path)
     {
-        model_handler.predict(raw_is, cout); // using `cout` as output stream 
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, cout, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, cout); } // using `cout` as output stream 
         raw_is.close();
     }
     else
@@ -307,7 +348,11 @@ int predict_process(int argc, char *argv[], const string &program_name)
             raw_is.close();
             fatal_error("Error : failed open output file at : `" +  output_path + "`.");
         }
-        model_handler.predict(raw_is, os);
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, os, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, os); }
         os.close();
     }
     return 0;
@@ -21,16 +21,19 @@ public:
     void set_model_param(const boost::program_options::variables_map &var_map) ;
     void build_model_structure() ;
     void print_model_info() ;
+    void set_beam_size(unsigned beam_size) ;
 
     template<typename Archive>
     void serialize(Archive &ar, const unsigned version);
 public :
     unsigned tag_embedding_dim;
+    unsigned beam_size;
 };
 
 template <typename RNNDerived>
 POSInput2PretagF2IModel<RNNDerived>::POSInput2PretagF2IModel()
-    : Input2F2IModel<RNNDerived>()
+    : Input2F2IModel<RNNDerived>(),
+    beam_size(1U)
 {}
 
 template <typename RNNDerived>
@@ -57,6 +60,14 @@ void POSInput2PretagF2IModel<RNNDerived>::build_model_structure()
                                                    this->rnn_x_dim, this->rnn_h_dim, this->dropout_rate) ;
     this->output_layer = new PretagOutput(this->m, tag_embedding_dim,this->rnn_h_dim, this->rnn_h_dim, this->hidden_dim, this->output_dim,
         this->dropout_rate) ;
+    set_beam_size(beam_size) ;
+}
+
+template <typename RNNDerived>
+void POSInput2PretagF2IModel<RNNDerived>::set_beam_size(unsigned beam_size)
+{
+    this->beam_size = beam_size ;
+    if( this->output_layer ){ static_cast<PretagOutput*>(this->output_layer)->set_beam_size(beam_size) ; }
 }
 
 template <typename RNNDerived>
@@ -5,6 +5,7 @@
 #include "pos_single_classification_model.h"
 #include "postagger/model_handler/single_input_modelhandler.h"
 #include "utils/general.hpp"
+#include "utils/parallel_predictor.hpp"
 
 using namespace std;
 using namespace slnn;
@@ -203,11 +204,15 @@ int predict_process(int argc, char *argv[], const string &program_name)
         "Predict process ."
         "using `" + program_name + " predict <options>` to predict . predict options are as following";
     po::options_description op_des = po::options_description(description);
-    string raw_data_path, output_path, model_path;
+    string raw_data_path, output_path, model_path, socket_path;
+    unsigned nr_thread;
     op_des.add_options()
-        ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) .")
+        ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) . using `stdin` if not specified or is `-` .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
+        ("threads", po::value<unsigned>(&nr_thread)->default_value(1), "Number of prediction workers (processes sharing the loaded model).")
+        ("socket", po::value<string>(&socket_path), "Serve on the unix socket instead of predicting raw data. "
+            "a client writes lines, shuts down writing, then reads the result.")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -220,7 +225,6 @@ int predict_process(int argc, char *argv[], const string &program_name)
 
     //set params 
     
-    varmap_key_fatal_check(var_map, "raw_data", "raw_data path should be specified .");
     
     if (output_path == "")
     {
@@ -242,28 +246,53 @@ int predict_process(int argc, char *argv[], const string &program_name)
     model_handler.load_model(is);
     is.close();
 
+    constexpr unsigned ChunkLineNum = 1024;
+    auto predict_func = [&model_handler](istream &chunk_is, ostream &chunk_os){ model_handler.predict(chunk_is, chunk_os); };
+    if( var_map.count("socket") )
+    {
+        utils::serve_on_unix_socket(socket_path, predict_func, max(nr_thread, 1U));
+        return 0;
+    }
+
     // open raw_data
-    ifstream raw_is(raw_data_path);
-    if (!raw_is)
+    ifstream raw_fis;
+    if( raw_data_path != "" && raw_data_path != "-" )
     {
-        fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        raw_fis.open(raw_data_path);
+        if( !raw_fis )
+        {
+            fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        }
     }
+    else
+    {
+        BOOST_LOG_TRIVIAL(info) << "no raw_data is specified . using stdin .";
+    }
+    istream &raw_is = raw_fis.is_open() ? static_cast<istream&>(raw_fis) : cin;
 
     // open output 
     if ("" == output_path)
     {
-        model_handler.predict(raw_is, cout); // using `cout` as output stream 
-        raw_is.close();
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, cout, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, cout); } // using `cout` as output stream 
+        raw_fis.close();
     }
     else
     {
         ofstream os(output_path);
         if (!os)
         {
-            raw_is.close();
+            raw_fis.close();
             fatal_error("Error : failed open output file at : `" +  output_path + "`.");
         }
-        model_handler.predict(raw_is, os);
+        if( nr_thread > 1 && utils::is_parallel_predict_supported() )
+        {
+            utils::predict_in_parallel(raw_is, os, predict_func, nr_thread, ChunkLineNum);
+        }
+        else { model_handler.predict(raw_is, os); }
         os.close();
     }
     return 0;
@@ -28,6 +28,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     po::options_description op_des = po::options_description(description);
     op_des.add_options()
         ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) .")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("training_data", po::value<string>(), "[required] The path to training data")
         ("devel_data", po::value<string>(), "The path to developing data . For validation duration training . Empty for discarding .")
         ("max_epoch", po::value<unsigned>(), "The epoch to iterate for training")
@@ -112,6 +113,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
     dynet::initialize(dynet_argc, dynet_argv_ptr, CNNRandomSeed); 
     SingleInputWithFeatureModelHandler<RNNDerived, POSInput1PretagF2IModel<RNNDerived>> model_handler;
+    model_handler.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // pre-open model file, avoid fail after a long time training
     ofstream model_os(model_path);
@@ -167,6 +169,7 @@ int devel_process(int argc, char *argv[], const string &program_name)
     string devel_data_path, model_path ;
     op_des.add_options()
         ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) .")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("devel_data", po::value<string>(&devel_data_path), "The path to validation data .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
         ("help,h", "Show help information.");
@@ -192,6 +195,7 @@ int devel_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
     dynet::initialize(dynet_argc, dynet_argv_ptr, CNNRandomSeed); 
     SingleInputWithFeatureModelHandler<RNNDerived, POSInput1PretagF2IModel<RNNDerived>> model_handler;
+    model_handler.set_beam_size(var_map["beam_size"].as<unsigned>());
     // Load model 
     ifstream model_is(model_path);
     if (!model_is)
@@ -226,6 +230,7 @@ int predict_process(int argc, char *argv[], const string &program_name)
     string raw_data_path, output_path, model_path;
     op_des.add_options()
         ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) .")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
@@ -259,6 +264,7 @@ int predict_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
     dynet::initialize(dynet_argc, dynet_argv_ptr, CNNRandomSeed); 
     SingleInputWithFeatureModelHandler<RNNDerived, POSInput1PretagF2IModel<RNNDerived>> model_handler ;
+    model_handler.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // load model 
     ifstream is(model_path);
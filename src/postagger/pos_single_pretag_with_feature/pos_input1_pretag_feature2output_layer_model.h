@@ -21,17 +21,20 @@ public:
     void set_model_param(const boost::program_options::variables_map &var_map) ;
     void build_model_structure() ;
     void print_model_info() ;
+    void set_beam_size(unsigned beam_size) ;
 
     template<typename Archive>
     void serialize(Archive &ar, const unsigned version);
 public :
     unsigned tag_embedding_dim;
+    unsigned beam_size;
 
 };
 
 template <typename RNNDerived>
 POSInput1PretagF2OModel<RNNDerived>::POSInput1PretagF2OModel()
-    : Input1F2OModel<RNNDerived>()
+    : Input1F2OModel<RNNDerived>(),
+    beam_size(1U)
 {}
 
 template <typename RNNDerived>
@@ -57,6 +60,14 @@ void POSInput1PretagF2OModel<RNNDerived>::build_model_structure()
         this->pos_feature.concatenated_feature_embedding_dim,
         this->hidden_dim, this->output_dim,
         this->dropout_rate) ;
+    set_beam_size(beam_size) ;
+}
+
+template <typename RNNDerived>
+void POSInput1PretagF2OModel<RNNDerived>::set_beam_size(unsigned beam_size)
+{
+    this->beam_size = beam_size ;
+    if( this->output_layer ){ static_cast<PretagOutputWithFeature*>(this->output_layer)->set_beam_size(beam_size) ; }
 }
 
 template <typename RNNDerived>
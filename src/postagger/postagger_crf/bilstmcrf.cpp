@@ -65,6 +65,7 @@ Expression BILSTMCRFModel4POSTAG::viterbi_train(ComputationGraph *p_cg,
 {
     const unsigned sent_len = p_sent->size();
     ComputationGraph &cg = *p_cg;
+    viterbi_decoder.clear_score(); // parameters will be updated.
     // New graph , ready for new sentence
     bilstm_layer->new_graph(cg);
     merge_hidden_layer->new_graph(cg);
@@ -87,7 +88,6 @@ Expression BILSTMCRFModel4POSTAG::viterbi_train(ComputationGraph *p_cg,
     bilstm_layer->build_graph(word_exp_cont, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont);
 
     // viterbi data preparation
-    vector<Expression> all_postag_exp_cont(postag_dict_size);
     vector<Expression> init_score(postag_dict_size);
     vector<Expression> trans_score(postag_dict_size * postag_dict_size);
     vector<vector<Expression>> emit_score(sent_len, vector<Expression>(postag_dict_size));
@@ -98,10 +98,9 @@ Expression BILSTMCRFModel4POSTAG::viterbi_train(ComputationGraph *p_cg,
     if(p_stat) p_path_matrix = new vector<vector<size_t>>(sent_len , vector<size_t>(postag_dict_size)) ;
     Expression gold_score_exp ;
     
-    // init all_postag_exp_cont , init_score together
+    // init init_score
     for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
     {
-        all_postag_exp_cont[postag_idx] = lookup(cg, postags_lookup_param, postag_idx);
         init_score[postag_idx] = lookup(cg, init_score_lookup_param, postag_idx);
     }
     // init translation score
@@ -110,13 +109,12 @@ Expression BILSTMCRFModel4POSTAG::viterbi_train(ComputationGraph *p_cg,
         trans_score[flat_idx] = lookup(cg, trans_score_lookup_param, flat_idx);
     }
     // init emit score
+    Expression emit_score_exp = build_emit_score_exp(cg, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont);
     for (size_t time_step = 0; time_step < sent_len; ++time_step)
     {
         for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
         {
-            Expression hidden_out_exp = merge_hidden_layer->build_graph(l2r_lstm_output_exp_cont[time_step],
-                r2l_lstm_output_exp_cont[time_step], all_postag_exp_cont[postag_idx]);
-            emit_score[time_step][postag_idx] = emit_layer->build_graph( rectify(hidden_out_exp) );
+            emit_score[time_step][postag_idx] = pick(emit_score_exp, postag_idx + postag_dict_size * time_step);
         }
     }
     // viterbi docoding
@@ -199,6 +197,29 @@ Expression BILSTMCRFModel4POSTAG::viterbi_train(ComputationGraph *p_cg,
     return loss;
 }
 
+Expression BILSTMCRFModel4POSTAG::build_emit_score_exp(ComputationGraph &cg,
+    const vector<Expression> &l2r_lstm_output_exp_cont, const vector<Expression> &r2l_lstm_output_exp_cont)
+{
+    const unsigned sent_len = l2r_lstm_output_exp_cont.size();
+    // postag part, (merge_hidden_dim x postag_dict_size), built once for every postag
+    vector<Expression> all_postag_exp_cont(postag_dict_size);
+    for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
+    {
+        all_postag_exp_cont[postag_idx] = lookup(cg, postags_lookup_param, postag_idx);
+    }
+    Expression postag_part_exp = merge_hidden_layer->build_last_on_cols(all_postag_exp_cont);
+    // input part is built once for every time step, and added to every column of the postag part
+    vector<Expression> hidden_out_exp_cont(sent_len);
+    for (size_t time_step = 0; time_step < sent_len; ++time_step)
+    {
+        hidden_out_exp_cont[time_step] = colwise_add(postag_part_exp,
+            merge_hidden_layer->build_graph_except_last(l2r_lstm_output_exp_cont[time_step], r2l_lstm_output_exp_cont[time_step]));
+    }
+    // (1 x postag_dict_size * sent_len) score matrix, flatten it (column major)
+    return reshape(emit_layer->build_graph_on_matrix(rectify(concatenate_cols(hidden_out_exp_cont))),
+        Dim({ static_cast<unsigned>(postag_dict_size * sent_len) }));
+}
+
 void BILSTMCRFModel4POSTAG::viterbi_predict(ComputationGraph *p_cg, 
     const IndexSeq *p_sent, IndexSeq *p_predict_tag_seq)
 {
@@ -229,82 +250,26 @@ void BILSTMCRFModel4POSTAG::viterbi_predict(ComputationGraph *p_cg,
     
 
     //viterbi - preparing score
-    vector<Expression> all_postag_exp_cont(postag_dict_size);
-    vector<dynet::real> init_score(postag_dict_size);
-    vector<dynet::real> trans_score(postag_dict_size * postag_dict_size);
-    vector<vector<dynet::real>> emit_score(sent_len, vector<dynet::real>(postag_dict_size));
-
-    // get init score
-    for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
-    {
-        Expression init_exp = lookup(cg, init_score_lookup_param, postag_idx);
-        init_score[postag_idx] = as_scalar(cg.get_value(init_exp));
-    }
-    // get trans score
-    for (size_t flat_idx = 0; flat_idx < postag_dict_size * postag_dict_size; ++flat_idx)
-    {
-        Expression trans_exp = lookup(cg, trans_score_lookup_param, flat_idx);
-        trans_score[flat_idx] = as_scalar(cg.get_value(trans_exp));
-    }
-    // get emit score
-    for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
-    {
-        all_postag_exp_cont[postag_idx] = lookup(cg, postags_lookup_param, postag_idx);
-    }
-    for (size_t time_step = 0; time_step < sent_len; ++time_step)
+    if( !viterbi_decoder.has_score() )
     {
+        // read init and trans score from the parameter storage directly, only once for the model.
+        vector<dynet::real> init_score(postag_dict_size);
+        vector<dynet::real> trans_score(postag_dict_size * postag_dict_size);
         for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
         {
-            Expression hidden_out_exp = merge_hidden_layer->build_graph(l2r_lstm_output_exp_cont[time_step],
-                r2l_lstm_output_exp_cont[time_step], all_postag_exp_cont[postag_idx]);
-            Expression emit_score_exp = emit_layer->build_graph(rectify(hidden_out_exp));
-            emit_score[time_step][postag_idx] =  as_scalar(cg.get_value(emit_score_exp));
+            init_score[postag_idx] = as_scalar(init_score_lookup_param.get()->values[postag_idx]);
         }
-            
-    }
-    // viterbi - process
-    vector<vector<size_t>> path_matrix(sent_len, vector<size_t>(postag_dict_size));
-    vector<dynet::real> current_scores(postag_dict_size);
-    // time 0
-    for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
-    {
-        current_scores[postag_idx] = init_score[postag_idx] + emit_score[0][postag_idx];
-    }
-    // continues time
-    vector<dynet::real>  pre_timestep_scores(current_scores);
-    for (size_t time_step = 1; time_step < sent_len; ++time_step)
-    {
-        swap(pre_timestep_scores, current_scores); // move current_score -> pre_timestep_score
-        for (size_t postag_idx = 0; postag_idx < postag_dict_size; ++postag_idx)
+        for (size_t flat_idx = 0; flat_idx < postag_dict_size * postag_dict_size; ++flat_idx)
         {
-            size_t pre_tag_with_max_score = 0;
-            dynet::real max_score = pre_timestep_scores[0] + trans_score[postag_idx]; // 0*postag_dict_size + postag_idx
-            for (size_t pre_tag_idx = 1; pre_tag_idx < postag_dict_size; ++pre_tag_idx)
-            {
-                size_t flat_idx = pre_tag_idx * postag_dict_size + postag_idx;
-                dynet::real score = pre_timestep_scores[pre_tag_idx] + trans_score[flat_idx];
-                if (score > max_score)
-                {
-                    pre_tag_with_max_score = pre_tag_idx;
-                    max_score = score;
-                }
-            }
-            path_matrix[time_step][postag_idx] = pre_tag_with_max_score;
-            current_scores[postag_idx] = max_score + emit_score[time_step][postag_idx];
+            trans_score[flat_idx] = as_scalar(trans_score_lookup_param.get()->values[flat_idx]);
         }
+        viterbi_decoder.set_score(init_score, trans_score);
     }
-    // get result 
-    IndexSeq tmp_predict_tag_seq(sent_len);
-    Index end_predicted_idx = distance(current_scores.begin() ,  max_element(current_scores.begin(), current_scores.end()));
-    tmp_predict_tag_seq[sent_len - 1] = end_predicted_idx;
-    Index pre_predicted_idx = end_predicted_idx;
-    for (size_t reverse_idx = sent_len - 1; reverse_idx >= 1 ; --reverse_idx)
-    {
-        pre_predicted_idx = path_matrix[reverse_idx][pre_predicted_idx]; // backtrace
-        tmp_predict_tag_seq[reverse_idx-1] = pre_predicted_idx;
-
-    }
-    swap(tmp_predict_tag_seq, *p_predict_tag_seq);
+    // get emit score in one fetch, flat index is `postag_idx + postag_dict_size * time_step`
+    vector<dynet::real> emit_score = as_vector(cg.get_value(
+        build_emit_score_exp(cg, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont)));
+    // viterbi - process
+    viterbi_decoder.decode(emit_score.data(), sent_len, *p_predict_tag_seq);
 }
 
 
@@ -1,10 +1,12 @@
 
+#include <memory>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 
 #include "utils/typedeclaration.h"
+#include "utils/reusable_graph.hpp"
 #include "bilstmcrf_modelhandler.h"
 
 using namespace std;
@@ -17,7 +19,7 @@ const std::string BILSTMCRFModelHandler::number_transform_str = "##";
 const size_t BILSTMCRFModelHandler::length_transform_str = number_transform_str.length();
 
 BILSTMCRFModelHandler::BILSTMCRFModelHandler(BILSTMCRFModel4POSTAG &dc_m) 
-    :dc_m(dc_m) , best_acc(0.f) , best_model_tmp_ss()
+    :dc_m(dc_m) , best_acc(0.f) , best_model_snapshot()
 {}
 
 
@@ -91,31 +93,34 @@ void BILSTMCRFModelHandler::read_devel_data(istream &is, vector<IndexSeq> &sents
 
 void BILSTMCRFModelHandler::read_test_data(istream &is, vector<Seq> &raw_test_sents, vector<IndexSeq> &sents)
 {
-    assert(dc_m.word_dict.is_frozen() && dc_m.postag_dict.is_frozen());
     BOOST_LOG_TRIVIAL(info) << "read test data .";
     vector<Seq> tmp_raw_sents;
     vector<IndexSeq> tmp_sents;
     string line;
     while (getline(is, line))
     {
-        boost::trim(line);
-        vector<string> words_seq;
-        boost::split(words_seq, line, boost::is_any_of("\t"));
-        tmp_raw_sents.push_back(words_seq);
-        unsigned seq_len = words_seq.size();
-        tmp_sents.emplace_back(seq_len); // using constructor `vector(nr_num)` => push_back(vector<int>(nr_words)) 
-        IndexSeq &words_index_seq = tmp_sents.back();
-        for (unsigned i = 0; i < seq_len; ++i)
-        {
-            string number_transed_word = replace_number(words_seq[i]);
-            words_index_seq[i] = dc_m.word_dict.convert(number_transed_word);
-        }
-
+        tmp_raw_sents.emplace_back();
+        tmp_sents.emplace_back();
+        process_test_line(line, tmp_raw_sents.back(), tmp_sents.back());
     }
     swap(tmp_raw_sents, raw_test_sents);
     swap(tmp_sents, sents);
 }
 
+void BILSTMCRFModelHandler::process_test_line(string &line, Seq &raw_sent, IndexSeq &words_index_seq)
+{
+    assert(dc_m.word_dict.is_frozen() && dc_m.postag_dict.is_frozen());
+    boost::trim(line);
+    boost::split(raw_sent, line, boost::is_any_of("\t"));
+    unsigned seq_len = raw_sent.size();
+    words_index_seq.resize(seq_len);
+    for (unsigned i = 0; i < seq_len; ++i)
+    {
+        string number_transed_word = replace_number(raw_sent[i]);
+        words_index_seq[i] = dc_m.word_dict.convert(number_transed_word);
+    }
+}
+
 void BILSTMCRFModelHandler::finish_read_training_data(boost::program_options::variables_map &varmap)
 {
     // set param 
@@ -156,6 +161,9 @@ void BILSTMCRFModelHandler::train(const vector<IndexSeq> *p_sents,
     unsigned long line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq sent_after_replace_unk(SentMaxLen , 0);
+    // because at one scope , only one ComputationGraph is permited ,
+    // the training graph is released before develing (devel has its own graph).
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
     for (unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch)
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -176,10 +184,9 @@ void BILSTMCRFModelHandler::train(const vector<IndexSeq> *p_sents,
             // using negative_loglikelihood loss to build model
             const IndexSeq *p_sent = &p_sents->at(access_idx),
                 *p_tag_seq = &p_postag_seqs->at(access_idx);
-            ComputationGraph *cg = new ComputationGraph(); // because at one scope , only one ComputationGraph is permited .
-                                                           // so we have to declaring it as pointer and destroy it handly 
-                                                           // before develing.
-                                                           // transform low-frequent words to UNK according to the probability
+            if (!pgraph) pgraph.reset(new slnn::ReusableGraph());
+            ComputationGraph *cg = &pgraph->renew();
+            // transform low-frequent words to UNK according to the probability
             sent_after_replace_unk.resize(p_sent->size());
             for (size_t word_idx = 0; word_idx < p_sent->size(); ++word_idx)
             {
@@ -190,7 +197,6 @@ void BILSTMCRFModelHandler::train(const vector<IndexSeq> *p_sents,
             dynet::real E = as_scalar(cg->forward(loss_expr));
             cg->backward(loss_expr);
             sgd.update(1.0);
-            delete cg;
             
             if(do_train_stat) p_training_stat_per_report->loss += E ;
             else training_stat_per_epoch.loss += E ;
@@ -212,6 +218,7 @@ void BILSTMCRFModelHandler::train(const vector<IndexSeq> *p_sents,
             // If developing samples is available , do `devel` to get model training effect . 
             if (p_dev_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
             {
+                pgraph.reset();
                 float acc = devel(p_dev_sents, p_dev_postag_seqs);
                 if (acc > best_acc) save_current_best_model(acc);
                 line_cnt_for_devel = 0; // avoid overflow
@@ -249,6 +256,7 @@ void BILSTMCRFModelHandler::train(const vector<IndexSeq> *p_sents,
         if (p_dev_sents != nullptr)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float acc = devel(p_dev_sents , p_dev_postag_seqs);
             if (acc > best_acc) save_current_best_model(acc);
         }
@@ -267,10 +275,11 @@ float BILSTMCRFModelHandler::devel(const std::vector<IndexSeq> *p_sents,
     if (p_error_output_os) *p_error_output_os << "line_nr\tword_index\tword_at_dict\tpredict_tag\ttrue_tag\n";
     Stat acc_stat;
     acc_stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
     {
         ++line_cnt4error_output;
-        ComputationGraph cg;
+        ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq *p_sent = &p_sents->at(access_idx),
             *p_tag_seq = &p_postag_seqs->at(access_idx);
@@ -296,39 +305,47 @@ float BILSTMCRFModelHandler::devel(const std::vector<IndexSeq> *p_sents,
     return acc_stat.get_acc();
 }
 
+/**
+ * predict in streaming mode : read a line, predict and write it. 
+ * memory is constant and the input can be a pipe. output is flushed every `FlushLineNum` lines.
+ */
 void BILSTMCRFModelHandler::predict(std::istream &is, std::ostream &os)
 {
-    BOOST_LOG_TRIVIAL(info) << "do predict ";
+    constexpr unsigned FlushLineNum = 1024;
+    BOOST_LOG_TRIVIAL(info) << "do predict in streaming mode .";
     const string SPLIT_DELIMITER = "\t";
-    vector<Seq> raw_instances;
-    vector<IndexSeq> sents;
-    read_test_data(is,raw_instances,sents );
-    BOOST_LOG_TRIVIAL(info) << "read " << raw_instances.size() << " instance .";
     Stat time_stat;
     time_stat.start_time_stat();
-    for (unsigned int i = 0; i < raw_instances.size(); ++i)
+    string line;
+    Seq raw_sent;
+    IndexSeq sent;
+    unsigned long nr_instance = 0;
+    slnn::ReusableGraph graph;
+    while (getline(is, line))
     {
-        vector<string> *p_raw_sent = &raw_instances.at(i);
-        if (0 == p_raw_sent->size())
+        if (++nr_instance % FlushLineNum == 0) os.flush();
+        process_test_line(line, raw_sent, sent);
+        if (0 == raw_sent.size())
         {
             os << "\n";
             continue;
         }
-        IndexSeq *p_sent = &sents.at(i);
         IndexSeq predict_seq;
-        ComputationGraph cg;
-        dc_m.viterbi_predict(&cg, p_sent, &predict_seq);
+        ComputationGraph &cg = graph.renew();
+        dc_m.viterbi_predict(&cg, &sent, &predict_seq);
         // output the result directly
-        os << p_raw_sent->at(0) << "_" << dc_m.postag_dict.convert(predict_seq.at(0));
-        for (unsigned k = 1; k < p_raw_sent->size(); ++k)
+        os << raw_sent.at(0) << "_" << dc_m.postag_dict.convert(predict_seq.at(0));
+        for (unsigned k = 1; k < raw_sent.size(); ++k)
         {
             os << SPLIT_DELIMITER
-                << p_raw_sent->at(k) << "_" << dc_m.postag_dict.convert(predict_seq.at(k));
+                << raw_sent.at(k) << "_" << dc_m.postag_dict.convert(predict_seq.at(k));
         }
         os << "\n";
     }
+    os.flush();
     time_stat.end_time_stat();
-    BOOST_LOG_TRIVIAL(info) << "predicted done with time costing " << time_stat.get_time_cost_in_seconds() << " s .";
+    BOOST_LOG_TRIVIAL(info) << "predicted " << nr_instance << " instances done with time costing " 
+        << time_stat.get_time_cost_in_seconds() << " s .";
 }
 
 void BILSTMCRFModelHandler::save_model(std::ostream &os)
@@ -341,11 +358,9 @@ void BILSTMCRFModelHandler::save_model(std::ostream &os)
         << dc_m.postag_dict_size;
 
     to << dc_m.word_dict << dc_m.postag_dict;
-    if (best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail())
+    if (best_model_snapshot.restore(dc_m.m))
     {
-        boost::archive::text_iarchive ti(best_model_tmp_ss);
-        ti >> *dc_m.m;
-        ; // if best model is not save to the temporary stringstream , we should firstly save it !
+        ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     }
 
     to << *dc_m.m;
@@ -366,6 +381,7 @@ void BILSTMCRFModelHandler::load_model(std::istream &is)
         && dc_m.postag_dict_size == dc_m.postag_dict.size());
     dc_m.build_model_structure();
     ti >> *dc_m.m;
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     BOOST_LOG_TRIVIAL(info) << "load model done .";
 }
 
@@ -6,6 +6,7 @@
 #include "bilstmcrf.h"
 #include "utils/utf8processing.hpp"
 #include "utils/typedeclaration.h"
+#include "utils/parameter_snapshot.hpp"
 
 namespace slnn
 {
@@ -15,7 +16,7 @@ struct BILSTMCRFModelHandler
     
     // Saving temporal model
     float best_acc;
-    std::stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
 
     // others 
     static const std::string number_transform_str;
@@ -37,6 +38,7 @@ struct BILSTMCRFModelHandler
     void read_devel_data(std::istream &is, std::vector<IndexSeq> &sents,
         std::vector<IndexSeq> &postag_seqs);
     void read_test_data(std::istream &is, std::vector<Seq> &raw_test_sents, std::vector<IndexSeq> &sents);
+    void process_test_line(std::string &line, Seq &raw_sent, IndexSeq &sent);
     
     // After Reading Training data
     void finish_read_training_data(boost::program_options::variables_map &varmap);
@@ -98,9 +100,7 @@ void BILSTMCRFModelHandler::save_current_best_model(float acc)
 {
     BOOST_LOG_TRIVIAL(info) << "better model has been found . stash it .";
     best_acc = acc;
-    best_model_tmp_ss.str(""); // first , clear it's content !
-    boost::archive::text_oarchive to(best_model_tmp_ss);
-    to << *dc_m.m;
+    best_model_snapshot.take(dc_m.m);
 }
 
 } // end of namespace 
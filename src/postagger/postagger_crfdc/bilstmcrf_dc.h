@@ -16,6 +16,7 @@
 
 #include "utils/typedeclaration.h"
 #include "modelmodule/layers.h"
+#include "modelmodule/viterbi_decoder.h"
 #include "utils/utf8processing.hpp" 
 #include "utils/dict_wrapper.hpp"
 #include "utils/stat.hpp"
@@ -55,6 +56,7 @@ struct BILSTMCRFDCModel4POSTAG
     
     dynet::LookupParameter trans_score_lookup_param; // trans score , that is , TAG_A -> TAG_B 's score
     dynet::LookupParameter init_score_lookup_param; // init score , that is , the init TAG score
+    ViterbiDecoder viterbi_decoder; // score is cached until the next `viterbi_train`
 
 
     // Dict
@@ -71,6 +73,14 @@ struct BILSTMCRFDCModel4POSTAG
     void print_model_info();
 
 
+    // emit score of all the (time step, postag) pairs, a (postag_dict_size * sent_len) vector,
+    // flat index is `postag_idx + postag_dict_size * time_step`.
+    // the merge hidden layer is factorized: the input part is built once for every time step, the postag part once
+    // for every postag, then they are merged by broadcasted add, and scored by one nonlinear and one dense node.
+    dynet::expr::Expression build_emit_score_exp(dynet::ComputationGraph &cg,
+        const std::vector<dynet::expr::Expression> &l2r_lstm_output_exp_cont,
+        const std::vector<dynet::expr::Expression> &r2l_lstm_output_exp_cont);
+
     dynet::expr::Expression viterbi_train(dynet::ComputationGraph *p_cg, 
         const IndexSeq *p_dynamic_sent, const IndexSeq *p_fixed_sent, const IndexSeq *p_tag_seq,
         Stat *p_stat = nullptr);
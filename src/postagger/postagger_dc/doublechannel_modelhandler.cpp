@@ -1,10 +1,12 @@
 
+#include <memory>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 
 #include "utils/typedeclaration.h"
+#include "utils/reusable_graph.hpp"
 #include "doublechannel_modelhandler.h"
 
 using namespace std;
@@ -17,7 +19,7 @@ const std::string DoubleChannelModelHandler::number_transform_str = "##";
 const size_t DoubleChannelModelHandler::length_transform_str = number_transform_str.length();
 
 DoubleChannelModelHandler::DoubleChannelModelHandler(DoubleChannelModel4POSTAG &dc_m) 
-    :dc_m(dc_m) , best_acc(0.f) , best_model_tmp_ss()
+    :dc_m(dc_m) , best_acc(0.f) , best_model_snapshot()
 {}
 
 void DoubleChannelModelHandler::build_fixed_dict_from_word2vec_file(std::ifstream &is)
@@ -126,7 +128,6 @@ void DoubleChannelModelHandler::read_devel_data(istream &is, vector<IndexSeq> &d
 void DoubleChannelModelHandler::read_test_data(istream &is, vector<Seq> &raw_test_sents, vector<IndexSeq> &dynamic_sents,
     vector<IndexSeq> &fixed_sents)
 {
-    assert(dc_m.dynamic_dict.is_frozen() && dc_m.fixed_dict.is_frozen() && dc_m.postag_dict.is_frozen());
     BOOST_LOG_TRIVIAL(info) << "read test data .";
     vector<Seq> tmp_raw_sents;
     vector<IndexSeq> tmp_dynamic_sents,
@@ -134,28 +135,33 @@ void DoubleChannelModelHandler::read_test_data(istream &is, vector<Seq> &raw_tes
     string line;
     while (getline(is, line))
     {
-        boost::trim(line);
-        vector<string> words_seq;
-        boost::split(words_seq, line, boost::is_any_of("\t"));
-        tmp_raw_sents.push_back(words_seq);
-        unsigned seq_len = words_seq.size();
-        tmp_dynamic_sents.emplace_back(seq_len); // using constructor `vector(nr_num)` => push_back(vector<int>(nr_words)) 
-        tmp_fixed_sents.emplace_back(seq_len);
-        IndexSeq &dynamic_words_index_seq = tmp_dynamic_sents.back() ,
-            &fixed_words_index_seq = tmp_fixed_sents.back();
-        for (unsigned i = 0; i < seq_len; ++i)
-        {
-            string number_transed_word = replace_number(words_seq[i]);
-            dynamic_words_index_seq[i] = dc_m.dynamic_dict.convert(number_transed_word);
-            fixed_words_index_seq[i] = dc_m.fixed_dict.convert(number_transed_word);
-        }
-
+        tmp_raw_sents.emplace_back();
+        tmp_dynamic_sents.emplace_back();
+        tmp_fixed_sents.emplace_back();
+        process_test_line(line, tmp_raw_sents.back(), tmp_dynamic_sents.back(), tmp_fixed_sents.back());
     }
     swap(tmp_raw_sents, raw_test_sents);
     swap(tmp_dynamic_sents, dynamic_sents);
     swap(tmp_fixed_sents, fixed_sents);
 }
 
+void DoubleChannelModelHandler::process_test_line(string &line, Seq &raw_sent, IndexSeq &dynamic_words_index_seq,
+    IndexSeq &fixed_words_index_seq)
+{
+    assert(dc_m.dynamic_dict.is_frozen() && dc_m.fixed_dict.is_frozen() && dc_m.postag_dict.is_frozen());
+    boost::trim(line);
+    boost::split(raw_sent, line, boost::is_any_of("\t"));
+    unsigned seq_len = raw_sent.size();
+    dynamic_words_index_seq.resize(seq_len);
+    fixed_words_index_seq.resize(seq_len);
+    for (unsigned i = 0; i < seq_len; ++i)
+    {
+        string number_transed_word = replace_number(raw_sent[i]);
+        dynamic_words_index_seq[i] = dc_m.dynamic_dict.convert(number_transed_word);
+        fixed_words_index_seq[i] = dc_m.fixed_dict.convert(number_transed_word);
+    }
+}
+
 void DoubleChannelModelHandler::finish_read_training_data(boost::program_options::variables_map &varmap)
 {
     // set param 
@@ -233,6 +239,9 @@ void DoubleChannelModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, c
     unsigned long line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq dynamic_sent_after_replace_unk(SentMaxLen , 0);
+    // because at one scope , only one ComputationGraph is permited ,
+    // the training graph is released before develing (devel has its own graph).
+    std::unique_ptr<slnn::ReusableGraph> pgraph;
     for (unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch)
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -253,10 +262,9 @@ void DoubleChannelModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, c
             const IndexSeq *p_dynamic_sent = &p_dynamic_sents->at(access_idx),
                 *p_fixed_sent = &p_fixed_sents->at(access_idx) ,
                 *p_tag_seq = &p_postag_seqs->at(access_idx);
-            ComputationGraph *cg = new ComputationGraph(); // because at one scope , only one ComputationGraph is permited .
-                                                           // so we have to declaring it as pointer and destroy it handly 
-                                                           // before develing.
-                                                           // transform low-frequent words to UNK according to the probability
+            if (!pgraph) pgraph.reset(new slnn::ReusableGraph());
+            ComputationGraph *cg = &pgraph->renew();
+            // transform low-frequent words to UNK according to the probability
             dynamic_sent_after_replace_unk.resize(p_dynamic_sent->size());
             for (size_t word_idx = 0; word_idx < p_dynamic_sent->size(); ++word_idx)
             {
@@ -266,7 +274,6 @@ void DoubleChannelModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, c
             training_stat_per_report.loss += as_scalar(cg->forward(loss_expr));
             cg->backward(loss_expr);
             sgd.update(1.0);
-            delete cg;
 
             if (0 == (i + 1) % report_freq) // Report 
             {
@@ -286,6 +293,7 @@ void DoubleChannelModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, c
             // If developing samples is available , do `devel` to get model training effect . 
             if (p_dev_dynamic_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
             {
+                pgraph.reset();
                 float acc = devel(p_dev_dynamic_sents , p_dev_fixed_sents , p_dev_postag_seqs);
                 if (acc > best_acc) save_current_best_model(acc);
                 line_cnt_for_devel = 0; // avoid overflow
@@ -315,6 +323,7 @@ void DoubleChannelModelHandler::train(const vector<IndexSeq> *p_dynamic_sents, c
         if (p_dev_dynamic_sents != nullptr)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float acc = devel(p_dev_dynamic_sents , p_dev_fixed_sents , p_dev_postag_seqs);
             if (acc > best_acc) save_current_best_model(acc);
         }
@@ -333,10 +342,11 @@ float DoubleChannelModelHandler::devel(const std::vector<IndexSeq> *p_dynamic_se
     if (p_error_output_os) *p_error_output_os << "line_nr\tword_index\tword_at_dict\tpredict_tag\ttrue_tag\n";
     Stat acc_stat;
     acc_stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
     {
         ++line_cnt4error_output;
-        ComputationGraph cg;
+        ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq *p_dynamic_sent = &p_dynamic_sents->at(access_idx),
             *p_fixed_sent = &p_fixed_sents->at(access_idx) ,
@@ -363,35 +373,42 @@ float DoubleChannelModelHandler::devel(const std::vector<IndexSeq> *p_dynamic_se
     return acc_stat.get_acc();
 }
 
+/**
+ * predict in streaming mode : read a line, predict and write it. 
+ * memory is constant and the input can be a pipe. output is flushed every `FlushLineNum` lines.
+ */
 void DoubleChannelModelHandler::predict(std::istream &is, std::ostream &os)
 {
+    constexpr unsigned FlushLineNum = 1024;
     const string SPLIT_DELIMITER = "\t";
-    vector<Seq> raw_instances;
-    vector<IndexSeq> dynamic_sents,
-        fixed_sents;
-    read_test_data(is,raw_instances,dynamic_sents ,fixed_sents);
-    for (unsigned int i = 0; i < raw_instances.size(); ++i)
+    string line;
+    Seq raw_sent;
+    IndexSeq dynamic_sent,
+        fixed_sent;
+    unsigned long nr_instance = 0;
+    slnn::ReusableGraph graph;
+    while (getline(is, line))
     {
-        vector<string> *p_raw_sent = &raw_instances.at(i);
-        if (0 == p_raw_sent->size())
+        if (++nr_instance % FlushLineNum == 0) os.flush();
+        process_test_line(line, raw_sent, dynamic_sent, fixed_sent);
+        if (0 == raw_sent.size())
         {
             os << "\n";
             continue;
         }
-        IndexSeq *p_dynamic_sent = &dynamic_sents.at(i) ,
-            *p_fixed_sent = &fixed_sents.at(i);
         IndexSeq predict_seq;
-        ComputationGraph cg;
-        dc_m.do_predict(&cg, p_dynamic_sent, p_fixed_sent , &predict_seq);
+        ComputationGraph &cg = graph.renew();
+        dc_m.do_predict(&cg, &dynamic_sent, &fixed_sent , &predict_seq);
         // output the result directly
-        os << p_raw_sent->at(0) << "_" << dc_m.postag_dict.convert(predict_seq.at(0));
-        for (unsigned k = 1; k < p_raw_sent->size(); ++k)
+        os << raw_sent.at(0) << "_" << dc_m.postag_dict.convert(predict_seq.at(0));
+        for (unsigned k = 1; k < raw_sent.size(); ++k)
         {
             os << SPLIT_DELIMITER
-                << p_raw_sent->at(k) << "_" << dc_m.postag_dict.convert(predict_seq.at(k));
+                << raw_sent.at(k) << "_" << dc_m.postag_dict.convert(predict_seq.at(k));
         }
         os << "\n";
     }
+    os.flush();
 }
 
 void DoubleChannelModelHandler::save_model(std::ostream &os)
@@ -404,12 +421,7 @@ void DoubleChannelModelHandler::save_model(std::ostream &os)
         << dc_m.tag_layer_output_dim;
 
     to << dc_m.dynamic_dict << dc_m.fixed_dict << dc_m.postag_dict;
-    if (best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail())
-    {
-        boost::archive::text_iarchive ti(best_model_tmp_ss);
-        ti >> *dc_m.m;
-        ; // if best model is not save to the temporary stringstream , we should firstly save it !
-    }
+    best_model_snapshot.restore(dc_m.m);
 
     to << *dc_m.m;
     BOOST_LOG_TRIVIAL(info) << "save model done .";
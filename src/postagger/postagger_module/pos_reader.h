@@ -2,6 +2,8 @@
 #define POS_POS_MODULE_POS_READER_HPP_
 
 #include <fstream>
+#include <cassert>
+#include <cstring>
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
@@ -20,6 +22,10 @@ public:
     POSReader(std::istream &is);
     bool readline(Seq &sent, Seq &postag); // training data
     bool readline(Seq &sent); // devel data
+private:
+    static bool is_pos_data_delimiter(char c){ return c != '\0' && std::strchr(PosDataDelimiter, c) != nullptr; }
+private:
+    std::vector<TokenSpan> span_buf;
 };
 
 
@@ -28,41 +34,42 @@ POSReader::POSReader(std::istream &is)
     :Reader(is)
 {}
 
+/**
+ * the line is split in the block (@see Reader::readline_view), the strings of `sent` and `postag_seq`
+ * are reused, so the reading doesn't allocate when the caller reuses the output.
+ */
 inline
 bool POSReader::readline(Seq &sent, Seq &postag_seq)
 {
-    using std::swap;
-    Seq tmp_sent,
-        tmp_tag_seq;
-    std::string line;
-    if( !getline(is, line) ){ return false; } 
-    std::vector<std::string> strpair_cont;
-    boost::algorithm::split(strpair_cont, line, boost::is_any_of(PosDataDelimiter));
-    size_t pair_len = strpair_cont.size();
-    tmp_sent.resize(pair_len);
-    tmp_tag_seq.resize(pair_len);
+    const char *line = nullptr;
+    std::size_t len = 0;
+    if( !readline_view(line, len) ){ return false; }
+    split_to_spans(line, len, is_pos_data_delimiter, span_buf);
+    size_t pair_len = span_buf.size();
+    sent.resize(pair_len);
+    postag_seq.resize(pair_len);
     for( size_t i = 0; i < pair_len; ++i )
     {
-        const std::string &str_pair = strpair_cont[i];
-        std::string::size_type  delim_pos = str_pair.rfind(WordPosDelimiter);
-        assert(delim_pos != std::string::npos);
-        tmp_sent[i] = str_pair.substr(0, delim_pos);
-        tmp_tag_seq[i] = str_pair.substr(delim_pos + 1);
+        const char *str_pair = line + span_buf[i].first;
+        std::size_t pair_sz = span_buf[i].second,
+            delim_pos = pair_sz;
+        while( delim_pos > 0 && str_pair[delim_pos - 1] != *WordPosDelimiter ){ --delim_pos; }
+        assert(delim_pos > 0);
+        sent[i].assign(str_pair, delim_pos - 1);
+        postag_seq[i].assign(str_pair + delim_pos, pair_sz - delim_pos);
     }
-    swap(sent, tmp_sent);
-    swap(postag_seq, tmp_tag_seq);
     return true ;
 }
 
 inline
 bool POSReader::readline(Seq &sent)
 {
-    using std::swap;
-    Seq word_cont;
-    std::string line;
-    if( !getline(is, line) ){ return false;  } ;
-    boost::algorithm::split(word_cont, line, boost::is_any_of(PosDataDelimiter));
-    swap(sent, word_cont);
+    const char *line = nullptr;
+    std::size_t len = 0;
+    if( !readline_view(line, len) ){ return false;  } ;
+    split_to_spans(line, len, is_pos_data_delimiter, span_buf);
+    sent.resize(span_buf.size());
+    for( size_t i = 0; i < span_buf.size(); ++i ){ sent[i].assign(line + span_buf[i].first, span_buf[i].second); }
     return true;
 }
 
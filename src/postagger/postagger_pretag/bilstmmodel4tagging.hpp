@@ -13,6 +13,7 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <memory>
 #include <string>
 #include <chrono>
 #include <functional>
@@ -28,9 +29,12 @@
 #include <boost/program_options.hpp>
 
 #include "modelmodule/layers.h"
+#include "modelmodule/beam_search_decoder.h"
 #include "utils/utf8processing.hpp"
 #include "utils/dict_wrapper.hpp"
 #include "utils/stat.hpp"
+#include "utils/parameter_snapshot.hpp"
+#include "utils/reusable_graph.hpp"
 
 using namespace std;
 using namespace dynet;
@@ -66,9 +70,12 @@ struct BILSTMModel4Tagging
     unsigned TAG_OUTPUT_DIM; // it my be not equal to TAG_DICT_SIZE
     unsigned WORD_DICT_SIZE;
 
+    // decoding
+    BeamSearchDecoder beam_decoder; // beam size 1 (greedy) by default
+
     // model saving
     float best_acc;
-    stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
 
     // others 
     dynet::Dict word_dict;
@@ -82,7 +89,7 @@ struct BILSTMModel4Tagging
 
     BILSTMModel4Tagging() :
         m(nullptr), bilstm_builder(nullptr) , merge_bilstm_and_pretag_layer(nullptr),
-        tag_output_linear_layer(nullptr) , best_acc(0.), best_model_tmp_ss() ,
+        tag_output_linear_layer(nullptr) , best_acc(0.), best_model_snapshot() ,
         word_dict_wrapper(word_dict)
     {}
 
@@ -194,24 +201,28 @@ struct BILSTMModel4Tagging
         string line;
         while (getline(is, line))
         {
-            boost::trim(line);
-            vector<string> words_seq;
-            boost::split(words_seq, line, boost::is_any_of("\t"));
-            tmp_raw_sents.push_back(words_seq);
-            unsigned seq_len = words_seq.size();
-            tmp_sents.emplace_back(seq_len); // using constructor `vector(nr_num)` => push_back(vector<int>(nr_words)) 
-            IndexSeq &words_index_seq = tmp_sents.back();
-            for (unsigned i = 0; i < seq_len; ++i)
-            {
-                string number_transed_word = replace_number(words_seq[i]);
-                words_index_seq[i] = word_dict.convert(number_transed_word);
-            }
-                
+            tmp_raw_sents.emplace_back();
+            tmp_sents.emplace_back();
+            process_test_line(line, &tmp_raw_sents.back(), &tmp_sents.back());
         }
         swap(*test_sents, tmp_sents);
         swap(*raw_test_sents, tmp_raw_sents);
     }
 
+    void process_test_line(string &line, vector<string> *p_raw_sent, IndexSeq *p_sent)
+    {
+        // the dict should be frozen (done by `read_test_data`, or by the caller of streaming predict)
+        boost::trim(line);
+        boost::split(*p_raw_sent, line, boost::is_any_of("\t"));
+        unsigned seq_len = p_raw_sent->size();
+        p_sent->resize(seq_len);
+        for (unsigned i = 0; i < seq_len; ++i)
+        {
+            string number_transed_word = replace_number(p_raw_sent->at(i));
+            p_sent->at(i) = word_dict.convert(number_transed_word);
+        }
+    }
+
     /*************************MODEL HANDLER***********************************/
 
     /* Function : add_special_flag_and_freeze_dict_and_model_parameters
@@ -323,12 +334,7 @@ struct BILSTMModel4Tagging
             << TAG_EMBEDDING_DIM << TAG_DICT_SIZE ; // ADD for PRE_TAG
 
         to << word_dict << tag_dict;
-        if (0 != best_model_tmp_ss.rdbuf()->in_avail())
-        {
-            boost::archive::text_iarchive ti(best_model_tmp_ss);
-            ti >> *m;
-            ; // if best model is not save to the temporary stringstream , we should firstly save it !
-        }
+        best_model_snapshot.restore(m);
         
         to << *m; 
         BOOST_LOG_TRIVIAL(info) << "saving model done .";
@@ -467,34 +473,26 @@ struct BILSTMModel4Tagging
         // 2. calc Expression of every timestep of BI-LSTM
 
         bilstm_builder->build_graph(word_lookup_exp_cont, l2r_lstm_output_exp_cont, r2l_lstm_output_exp_cont);
-        // 3. set previous tag lookup expression
-
-        Expression pretag_lookup_exp = parameter(cg , TAG_SOS_param);
-
-        // build tag network , calc loss Expression of every timestep 
-        for (unsigned i = 0; i < sent_len; ++i)
+        // 3. decode by beam search, the hypotheses of the beam are scored in one forward at every timestep
+        auto score_func = [&](size_t i, const IndexSeq &pretag_list, vector<dynet::real> &score_list)
         {
-            Expression merge_bilstm_pretag_exp = merge_bilstm_and_pretag_layer->build_graph(l2r_lstm_output_exp_cont[i],
-                r2l_lstm_output_exp_cont[i], pretag_lookup_exp);
-            Expression tag_hidden_layer_output_at_timestep_t = dynet::expr::rectify(merge_bilstm_pretag_exp); 
-            auto loss_expr = tag_output_linear_layer->build_graph(tag_hidden_layer_output_at_timestep_t);
-            vector<float> output_values = as_vector(cg.incremental_forward(loss_expr));
-            float max_value = output_values[0];
-            unsigned tag_id_with_max_value = 0;
-            for (unsigned i = 1; i < TAG_OUTPUT_DIM; ++i)
+            vector<Expression> output_exp_cont(pretag_list.size());
+            for (size_t k = 0; k < pretag_list.size(); ++k)
             {
-                if (max_value < output_values[i])
-                {
-                    max_value = output_values[i];
-                    tag_id_with_max_value = i;
-                }
+                Expression pretag_lookup_exp = pretag_list[k] < 0 ? parameter(cg, TAG_SOS_param) :
+                    lookup(cg, tags_lookup_param, pretag_list[k]);
+                Expression merge_bilstm_pretag_exp = merge_bilstm_and_pretag_layer->build_graph(l2r_lstm_output_exp_cont[i],
+                    r2l_lstm_output_exp_cont[i], pretag_lookup_exp);
+                Expression tag_hidden_layer_output_at_timestep_t = dynet::expr::rectify(merge_bilstm_pretag_exp);
+                output_exp_cont[k] = tag_output_linear_layer->build_graph(tag_hidden_layer_output_at_timestep_t);
             }
-            p_predict_tag_seq->push_back(tag_id_with_max_value);
-            // set pretag_lookup_exp for next timestep 
-            pretag_lookup_exp = lookup(cg, tags_lookup_param, tag_id_with_max_value);
-        }
+            score_list = as_vector(cg.incremental_forward(concatenate(output_exp_cont)));
+        };
+        beam_decoder.decode(sent_len, TAG_OUTPUT_DIM, score_func, *p_predict_tag_seq);
     }
 
+    void set_beam_size(unsigned beam_size){ beam_decoder.set_beam_size(beam_size); }
+
     void train(const vector<InstancePair> *p_samples, unsigned max_epoch, const vector<InstancePair> *p_dev_samples = nullptr,
         const unsigned long do_devel_freq=50000)
     {
@@ -509,6 +507,9 @@ struct BILSTMModel4Tagging
         unsigned long line_cnt_for_devel = 0;
         unsigned long long total_time_cost_in_seconds = 0ULL ;
         IndexSeq sent_after_replace_unk(256 , 0) ;
+        // because at one scope , only one ComputationGraph is permited ,
+        // the training graph is released before develing (devel has its own graph).
+        std::unique_ptr<slnn::ReusableGraph> pgraph;
         for (unsigned nr_epoch = 0; nr_epoch < max_epoch; ++nr_epoch)
         {
             BOOST_LOG_TRIVIAL(info) << "Epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -528,9 +529,8 @@ struct BILSTMModel4Tagging
                 // using negative_loglikelihood loss to build model
                 const IndexSeq *p_sent = &instance_pair.first , 
                     *p_tag_seq = &instance_pair.second;
-                ComputationGraph *cg = new ComputationGraph(); // because at one scope , only one ComputationGraph is permited .
-                                                               // so we have to declaring it as pointer and destroy it handly 
-                                                               // before develing.
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                ComputationGraph *cg = &pgraph->renew();
                 // transform low-frequent words to UNK according to the probability
                 sent_after_replace_unk.resize(p_sent->size());
                 for (size_t word_idx = 0; word_idx < p_sent->size(); ++word_idx)
@@ -541,7 +541,6 @@ struct BILSTMModel4Tagging
                 training_stat_per_report.loss += as_scalar(cg->forward(loss_expr));
                 cg->backward(loss_expr);
                 sgd.update(1.0);
-                delete cg;
 
                 if (0 == (i + 1) % report_freq) // Report 
                 {
@@ -561,14 +560,13 @@ struct BILSTMModel4Tagging
                 // If developing samples is available , do `devel` to get model training effect . 
                 if (p_dev_samples != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
                 {
+                    pgraph.reset();
                     float acc = devel(p_dev_samples);
                     if (acc > best_acc)
                     {
                         BOOST_LOG_TRIVIAL(info) << "Better model found . stash it .";
                         best_acc = acc;
-                        best_model_tmp_ss.str(""); // first , clear it's content !
-                        boost::archive::text_oarchive to(best_model_tmp_ss);
-                        to << *m;
+                        best_model_snapshot.take(m);
                     }
                     line_cnt_for_devel = 0; // avoid overflow
                 }
@@ -597,14 +595,13 @@ struct BILSTMModel4Tagging
             if (p_dev_samples != nullptr)
             {
                 BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+                pgraph.reset();
                 float acc = devel(p_dev_samples);
                 if (acc > best_acc)
                 {
                     BOOST_LOG_TRIVIAL(info) << "Better model found . stash it .";
                     best_acc = acc;
-                    best_model_tmp_ss.str(""); // first , clear it's content !
-                    boost::archive::text_oarchive to(best_model_tmp_ss);
-                    to << *m;
+                    best_model_snapshot.take(m);
                 }
             }
 
@@ -620,10 +617,11 @@ struct BILSTMModel4Tagging
         if (p_error_output_os) *p_error_output_os << "line_nr\tword_index\tword_at_dict\tpredict_tag\ttrue_tag\n";
         Stat acc_stat;
         acc_stat.start_time_stat();
+        slnn::ReusableGraph graph;
         for (const InstancePair &instance_pair : *dev_samples)
         {
             ++line_cnt4error_output;
-            ComputationGraph cg;
+            ComputationGraph &cg = graph.renew();
             IndexSeq predict_tag_seq;
             const IndexSeq &sent = instance_pair.first,
                 &tag_seq = instance_pair.second;
@@ -649,34 +647,44 @@ struct BILSTMModel4Tagging
         return acc_stat.get_acc();
     }
 
+    /**
+     * predict in streaming mode : read a line, predict and write it. 
+     * memory is constant and the input can be a pipe. output is flushed every `FlushLineNum` lines.
+     */
     void predict(istream &is, ostream &os)
     {
+        constexpr unsigned FlushLineNum = 1024;
         const string SPLIT_DELIMITER = "\t";
-        vector<vector<string>> raw_instances;
-        vector<IndexSeq> index_instances;
-        read_test_data(is, &raw_instances, &index_instances);
-        assert(raw_instances.size() == index_instances.size());
-        for (unsigned int i = 0; i < raw_instances.size(); ++i)
+        if (!word_dict.is_frozen() && !tag_dict.is_frozen()) add_special_flag_and_freeze_dict();
+        BOOST_LOG_TRIVIAL(info) << "do prediction in streaming mode .";
+        string line;
+        vector<string> raw_sent;
+        IndexSeq sent;
+        unsigned long nr_instance = 0;
+        slnn::ReusableGraph graph;
+        while (getline(is, line))
         {
-            vector<string> *p_raw_sent = &raw_instances.at(i);
-            if (0 == p_raw_sent->size())
+            if (++nr_instance % FlushLineNum == 0) os.flush();
+            process_test_line(line, &raw_sent, &sent);
+            if (0 == raw_sent.size())
             {
                 os << "\n";
                 continue;
             }
-            IndexSeq *p_sent = &index_instances.at(i);
             IndexSeq predict_seq;
-            ComputationGraph cg;
-            do_predict(p_sent, &cg, &predict_seq);
+            ComputationGraph &cg = graph.renew();
+            do_predict(&sent, &cg, &predict_seq);
             // output the result directly
-            os << p_raw_sent->at(0) << "_" << tag_dict.convert(predict_seq.at(0));
-            for (unsigned k = 1; k < p_raw_sent->size(); ++k)
+            os << raw_sent.at(0) << "_" << tag_dict.convert(predict_seq.at(0));
+            for (unsigned k = 1; k < raw_sent.size(); ++k)
             {
                 os << SPLIT_DELIMITER
-                    << p_raw_sent->at(k) << "_" << tag_dict.convert(predict_seq.at(k));
+                    << raw_sent.at(k) << "_" << tag_dict.convert(predict_seq.at(k));
             }
             os << "\n";
         }
+        os.flush();
+        BOOST_LOG_TRIVIAL(info) << "predicted instance : " << nr_instance ;
     }
 };
 
@@ -74,6 +74,7 @@ int train_process(int argc, char *argv[] , const string &program_name)
                                                                              "be replace in this probability")
         ("logging_verbose", po::value<int>()->default_value(0), "The switch for logging trace . If 0 , trace will be ignored ,"
                                                                 "else value leads to output trace info.")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc,argv).options(op_des).allow_unregistered().run(), var_map);
@@ -126,6 +127,7 @@ int train_process(int argc, char *argv[] , const string &program_name)
     // Init 
     dynet::initialize(argc , argv , 1234); // 
     BILSTMModel4Tagging tagging_model;
+    tagging_model.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // reading traing data , get word dict size and output tag number
     // -> set replace frequency for word_dict_wrapper
@@ -199,6 +201,7 @@ int devel_process(int argc, char *argv[] , const string &program_name)
         ("devel_data", po::value<string>(&devel_data_path), "The path to validation data .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
         ("error_output", po::value<string>(&error_output_path), "Specify the file path to storing the predict error infomation . Empty to discard.")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc , argv).options(op_des).allow_unregistered().run(), var_map);
@@ -225,6 +228,7 @@ int devel_process(int argc, char *argv[] , const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234);
     BILSTMModel4Tagging tagging_model;
+    tagging_model.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // Load model 
     ifstream is(model_path);
@@ -281,6 +285,7 @@ int predict_process(int argc, char *argv[] , const string &program_name)
         ("raw_data", po::value<string>(), "The path to raw data(It should be segmented) .")
         ("output" , po::value<string>() , "The path to storing result . using `stdout` if not specified ." )
         ("model", po::value<string>(), "Use to specify the model name(path)")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc , argv).options(op_des).allow_unregistered().run(), var_map);
@@ -319,6 +324,7 @@ int predict_process(int argc, char *argv[] , const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234);
     BILSTMModel4Tagging tagging_model;
+    tagging_model.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // load model 
     ifstream is(model_path);
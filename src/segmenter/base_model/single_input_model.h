@@ -15,6 +15,7 @@
 #include "utils/typedeclaration.h"
 #include "utils/dict_wrapper.hpp"
 #include "modelmodule/hyper_layers.h"
+#include "modelmodule/viterbi_decoder.h"
 #include "segmenter/cws_module/cws_tagging_system.h"
 namespace slnn{
 
@@ -43,7 +44,7 @@ public :
     dynet::Model *get_dynet_model(){ return m ; } ;
     CWSTaggingSystem& get_tag_sys(){ return tag_sys ; }
 
-    void set_dynet_model(std::istream &mis){ boost::archive::text_iarchive ti(mis) ; ti >> *m ; } 
+    void set_dynet_model(std::istream &mis){ boost::archive::text_iarchive ti(mis) ; ti >> *m ; ViterbiDecoder::clear_all_score() ; } 
 
     template <typename Archive>
     void save(Archive &ar, const unsigned versoin) const; 
@@ -41,6 +41,7 @@ int train_process(int argc, char *argv[], const string &program_name)
         ("tag_layer_hidden_dim", po::value<unsigned>()->default_value(32), "The dimension for tag hidden layer.")
         ("logging_verbose", po::value<int>()->default_value(0), "The switch for logging trace . If 0 , trace will be ignored ,"
                     "else value leads to output trace info.")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -100,6 +101,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234); 
     Input2ModelHandler<CWSDoublePretagModel> model_handler;
+    model_handler.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // reading traing data , get word dict size and output tag number
     // -> set replace frequency for word_dict_wrapper
@@ -181,6 +183,7 @@ int devel_process(int argc, char *argv[], const string &program_name)
     op_des.add_options()
         ("devel_data", po::value<string>(&devel_data_path), "The path to validation data .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -198,6 +201,7 @@ int devel_process(int argc, char *argv[], const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234);
     Input2ModelHandler<CWSDoublePretagModel> model_handler;
+    model_handler.set_beam_size(var_map["beam_size"].as<unsigned>());
     // Load model 
     ifstream model_is(model_path);
     if (!model_is)
@@ -234,6 +238,7 @@ int predict_process(int argc, char *argv[], const string &program_name)
         ("raw_data", po::value<string>(&raw_data_path), "The path to raw data(It should be segmented) .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)")
+        ("beam_size", po::value<unsigned>()->default_value(1), "The beam size for decoding . 1 for greedy decoding .")
         ("help,h", "Show help information.");
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(op_des).allow_unregistered().run(), var_map);
@@ -258,6 +263,7 @@ int predict_process(int argc, char *argv[], const string &program_name)
     // Init 
     dynet::initialize(argc, argv, 1234);
     Input2ModelHandler<CWSDoublePretagModel> model_handler ;
+    model_handler.set_beam_size(var_map["beam_size"].as<unsigned>());
 
     // load model 
     ifstream is(model_path);
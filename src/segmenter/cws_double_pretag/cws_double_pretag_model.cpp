@@ -4,7 +4,8 @@
 namespace slnn{
 
 CWSDoublePretagModel::CWSDoublePretagModel()
-    :Input2Model()
+    :Input2Model(),
+    beam_size(1U)
 {}
 
 CWSDoublePretagModel::~CWSDoublePretagModel(){}
@@ -21,6 +22,13 @@ void CWSDoublePretagModel::build_model_structure()
     input_layer = new Input2(m, dynamic_dict_size, dynamic_word_dim , fixed_dict_size , fixed_word_dim , lstm_x_dim) ;
     bilstm_layer = new BILSTMLayer(m, lstm_nr_stacked_layer, lstm_x_dim, lstm_h_dim, dropout_rate) ;
     output_layer = new CWSPretagOutput(m, tag_dim, lstm_h_dim, lstm_h_dim, hidden_dim, output_dim , tag_sys) ;
+    set_beam_size(beam_size) ;
+}
+
+void CWSDoublePretagModel::set_beam_size(unsigned beam_size)
+{
+    this->beam_size = beam_size ;
+    if( output_layer ){ static_cast<CWSPretagOutput*>(output_layer)->set_beam_size(beam_size) ; }
 }
 
 void CWSDoublePretagModel::print_model_info()
@@ -26,6 +26,8 @@ public:
     void set_model_param(const boost::program_options::variables_map &var_map) ;
     void build_model_structure() ;
     void print_model_info() ;
+    // decoding option (not saved), can be set before or after building the model structure.
+    void set_beam_size(unsigned beam_size) ;
     
     template <typename Archive>
     void save(Archive &ar, const unsigned version) const ;
@@ -35,6 +37,7 @@ public:
 
 public:
     unsigned tag_dim;
+    unsigned beam_size;
 };
 
 /*************  Template Implementation *****************/
@@ -33,6 +33,8 @@ int train_process(int argc, char *argv[], const string &program_name)
     file_op.add_options()
         ("training_data", po::value<string>(), "[required] The path to training data")
         ("devel_data", po::value<string>(), "The path to developing data . For validation duration training . Empty for discarding .")
+        ("corpus_cache_dir", po::value<string>(), "The directory for the featurized corpus cache. the cache is reused "
+            "when the data and the token dictionary are not changed. Empty for no cache.")
         ("model", po::value<string>(), "Use to specify the model name(path)");
 
     po::options_description training_op("training options");
@@ -44,7 +46,20 @@ int train_process(int argc, char *argv[], const string &program_name)
         ("training_update_scale", po::value<float>()->default_value(1.f), "The scale for backward updating.")
         ("scale_half_decay_period", po::value<unsigned>()->default_value(numeric_limits<unsigned>::max()), "The training update scale half decay period.")
         ("training_update_method", po::value<string>()->default_value("sgd"), "The update method, support list: "
-            "sgd, adagrad, momentum, adadelta, rmsprop, adam")
+            "sgd, adagrad, momentum, adadelta, rmsprop, adam, "
+            "sparse_adagrad, sparse_momentum, sparse_adam (only the touched rows of lookup parameters are updated)")
+        ("batch_size", po::value<unsigned>()->default_value(1), "The number of instances built in one graph and "
+            "updated at once(losses are summed). instances of a batch have similar length.")
+        ("batch_tokens", po::value<unsigned>()->default_value(0), "The max padded token number (instance number * "
+            "max length) of a batch, 0 for no limit. `batch_size` is still the instance limit of a batch.")
+        ("nr_worker", po::value<unsigned>()->default_value(1), "The number of hogwild(lock-free asynchronous) training "
+            "workers. only for sgd (the optimizer state can't be shared among workers), others train in serial.")
+        ("deterministic", po::value<bool>()->default_value(false), "Train sequentially in one worker for reproducible result, "
+            "`nr_worker` will be ignored.")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process), every worker "
+            "predicts a part of devel data.")
+        ("async_devel", po::value<bool>()->default_value(false), "Go on training while devel workers predict by the "
+            "parameters at devel time. the devel result is applied a devel period later. disabled for hogwild training.")
         ("trivial_report_freq", po::value<unsigned>()->default_value(5000), "Trace frequent during training process");
 
     po::options_description model_op("model options");
@@ -127,6 +142,12 @@ int train_process(int argc, char *argv[], const string &program_name)
         unsigned do_devel_freq;
         unsigned max_epoch;
         unsigned trivial_report_freq;
+        unsigned batch_size;
+        unsigned max_batch_tokens;
+        unsigned nr_worker;
+        bool is_deterministic;
+        unsigned nr_devel_worker;
+        bool is_async_devel;
     };
     TrainingOpts opts;
     string training_data_path, devel_data_path ;
@@ -155,6 +176,12 @@ int train_process(int argc, char *argv[], const string &program_name)
     opts.scale_half_decay_period = var_map["scale_half_decay_period"].as<unsigned>();
     opts.training_update_method = var_map["training_update_method"].as<string>();
     opts.trivial_report_freq = var_map["trivial_report_freq"].as<unsigned>();
+    opts.batch_size = std::max(var_map["batch_size"].as<unsigned>(), 1U);
+    opts.max_batch_tokens = var_map["batch_tokens"].as<unsigned>();
+    opts.nr_worker = std::max(var_map["nr_worker"].as<unsigned>(), 1U);
+    opts.is_deterministic = var_map["deterministic"].as<bool>();
+    opts.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
+    opts.is_async_devel = var_map["async_devel"].as<bool>();
     // check model path
     string model_path;
     varmap_key_fatal_check(var_map, "model",
@@ -178,22 +205,33 @@ int train_process(int argc, char *argv[], const string &program_name)
     std::shared_ptr<MlpInput1All>  mia = MlpInput1All::create_new_model(argc, argv, rng_seed);
 
     // pre-open model file, avoid fail after a long time training
-    ofstream model_os(model_path);
+    ofstream model_os(model_path, ios::binary);
     if( !model_os ) fatal_error("failed to open model path at '" + model_path + "'") ;
 
     // before read training data.
     mia->set_model_structure_param_from_outer(var_map);
 
     // build lexicon data if necessary, read training data.
-    ifstream train_is(training_data_path);
-    if (!train_is) {
-        fatal_error("Error : failed to open training: `" + training_data_path + "` .");
+    string corpus_cache_dir = var_map.count("corpus_cache_dir") ? var_map["corpus_cache_dir"].as<string>() : "";
+    MlpInput1All::AnnotatedDatasetT training_data;
+    if( !corpus_cache_dir.empty() )
+    {
+        if( !FileUtils::exists(training_data_path) )
+        {
+            fatal_error("Error : failed to open training: `" + training_data_path + "` .");
+        }
+        modelhandler::read_training_data_with_cache(training_data_path, corpus_cache_dir, *mia, training_data);
+    }
+    else
+    {
+        ifstream train_is(training_data_path);
+        if (!train_is) {
+            fatal_error("Error : failed to open training: `" + training_data_path + "` .");
+        }
+        mia->get_token_module()->build_lexicon_if_necessary(train_is);
+        modelhandler::read_training_data(train_is, *mia, training_data);
+        train_is.close();
     }
-    mia->get_token_module()->build_lexicon_if_necessary(train_is);
-
-    vector<MlpInput1All::AnnotatedDataProcessedT> training_data;
-    modelhandler::read_training_data(train_is, *mia, training_data);
-    train_is.close();
 
     mia->finish_read_training_data();
     
@@ -201,13 +239,21 @@ int train_process(int argc, char *argv[], const string &program_name)
     mia->build_model_structure();
 
     // reading developing data
-    vector<MlpInput1All::AnnotatedDataProcessedT> devel_data;
-    std::ifstream devel_is(devel_data_path);
-    if (!devel_is) {
+    MlpInput1All::AnnotatedDatasetT devel_data;
+    if( !FileUtils::exists(devel_data_path) )
+    {
         fatal_error("Error : failed to open devel file: `" + devel_data_path + "`");
     }
-    modelhandler::read_devel_data(devel_is, *mia, devel_data);
-    devel_is.close();
+    if( !corpus_cache_dir.empty() )
+    {
+        modelhandler::read_devel_data_with_cache(devel_data_path, corpus_cache_dir, *mia, devel_data);
+    }
+    else
+    {
+        std::ifstream devel_is(devel_data_path);
+        modelhandler::read_devel_data(devel_is, *mia, devel_data);
+        devel_is.close();
+    }
     // Train
     auto devel_record_list = modelhandler::train(*mia, training_data, devel_data, opts);
 
@@ -249,11 +295,16 @@ int devel_process(int argc, char *argv[], const string &program_name)
     po::options_description file_op("file options");
     file_op.add_options()
         ("devel_data", po::value<string>(&devel_data_path), "The path to developing data . For validation duration training . Empty for discarding .")
+        ("corpus_cache_dir", po::value<string>(), "The directory for the featurized corpus cache. Empty for no cache.")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)");
 
+    po::options_description devel_op("devel options");
+    devel_op.add_options()
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process).");
+
     po::options_description all_op = po::options_description(description);
     // set params to receive the arguments 
-    all_op.add(generic_op).add(dynet_op).add(file_op);
+    all_op.add(generic_op).add(dynet_op).add(file_op).add(devel_op);
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(all_op).allow_unregistered().run(), var_map);
     po::notify(var_map);
@@ -288,23 +339,28 @@ int devel_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
 
     // Load model 
-    ifstream model_is(model_path);
-    if (!model_is)
+    if( !FileUtils::exists(model_path) )
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' .");
     }
-    std::shared_ptr<MlpInput1All> mia = MlpInput1All::load_and_build_model(model_is, dynet_argc, dynet_argv_ptr);
-    model_is.close();
+    std::shared_ptr<MlpInput1All> mia = MlpInput1All::load_and_build_model(model_path, dynet_argc, dynet_argv_ptr);
 
     // read devel data
-    ifstream devel_is(devel_data_path) ;
-    if( !devel_is ) fatal_error("Error : failed to open devel data at `" + devel_data_path + "`") ;
-    vector<MlpInput1All::AnnotatedDataProcessedT> devel_data;
-    modelhandler::read_devel_data(devel_is, *mia, devel_data);
-    devel_is.close();
+    MlpInput1All::AnnotatedDatasetT devel_data;
+    if( var_map.count("corpus_cache_dir") && !var_map["corpus_cache_dir"].as<string>().empty() )
+    {
+        modelhandler::read_devel_data_with_cache(devel_data_path, var_map["corpus_cache_dir"].as<string>(), *mia, devel_data);
+    }
+    else
+    {
+        ifstream devel_is(devel_data_path) ;
+        if( !devel_is ) fatal_error("Error : failed to open devel data at `" + devel_data_path + "`") ;
+        modelhandler::read_devel_data(devel_is, *mia, devel_data);
+        devel_is.close();
+    }
 
     // devel
-    modelhandler::devel(*mia, devel_data); 
+    modelhandler::devel(*mia, devel_data, var_map["devel_worker"].as<unsigned>()); 
     return 0;
 }
 
@@ -326,13 +382,28 @@ int predict_process(int argc, char *argv[], const string &program_name)
     string raw_data_path, output_path, model_path;
     po::options_description file_op("file options");
     file_op.add_options()
-        ("input", po::value<string>(&raw_data_path), "The path to input data.")
+        ("input", po::value<string>(&raw_data_path), "The path to input data. using `stdin` if not specified or is `-` .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)");
 
+    unsigned chunk_size, nr_thread, precompute_top_k;
+    string socket_path;
+    po::options_description predict_op("predict options");
+    predict_op.add_options()
+        ("chunk_size", po::value<unsigned>(&chunk_size)->default_value(modelhandler::DefaultPredictChunkSize),
+            "Line number to read, predict and write at a time in streaming prediction.")
+        ("precompute_top_k", po::value<unsigned>(&precompute_top_k)->default_value(0),
+            "Precompute the first hidden layer for the top-k frequent unigrams and bigrams (0 for disable). "
+            "only for `concat` window processing with mlp hidden layer. memory: ~ 2 * k * window_size * hidden_dim * 4 bytes.")
+        ("threads", po::value<unsigned>(&nr_thread)->default_value(1),
+            "Number of prediction workers (processes sharing the loaded model).")
+        ("socket", po::value<string>(&socket_path), 
+            "Serve on the unix socket instead of predicting input. a client writes raw lines, "
+            "shuts down writing, then reads the result.");
+
     po::options_description all_op = po::options_description(description);
     // set params to receive the arguments 
-    all_op.add(generic_op).add(dynet_op).add(file_op);
+    all_op.add(generic_op).add(dynet_op).add(file_op).add(predict_op);
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(all_op).allow_unregistered().run(), var_map);
     po::notify(var_map);
@@ -359,8 +430,6 @@ int predict_process(int argc, char *argv[], const string &program_name)
 
     //set params 
 
-    varmap_key_fatal_check(var_map, "input", "input data path should be specified .");
-
     if (output_path == "")
     {
         BOOST_LOG_TRIVIAL(info) << "no output is specified . using stdout .";
@@ -377,49 +446,125 @@ int predict_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
 
     // load model 
-    ifstream is(model_path);
-    if (!is)
+    if( !FileUtils::exists(model_path) )
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' . ");
     }
-    shared_ptr<MlpInput1All> mia = MlpInput1All::load_and_build_model(is, dynet_argc, dynet_argv_ptr);
-    is.close();
+    shared_ptr<MlpInput1All> mia = MlpInput1All::load_and_build_model(model_path, dynet_argc, dynet_argv_ptr);
+    if( precompute_top_k > 0 && !enable_precomputation(*mia, precompute_top_k) )
+    {
+        BOOST_LOG_TRIVIAL(warning) << "precomputation is not supported by the model structure , ignored .";
+    }
+
+    if( var_map.count("socket") )
+    {
+        modelhandler::serve(*mia, socket_path, nr_thread, chunk_size);
+        return 0;
+    }
 
     // open raw_data
-    ifstream raw_is(raw_data_path);
-    if (!raw_is)
+    ifstream raw_fis;
+    if( raw_data_path != "" && raw_data_path != "-" )
+    {
+        raw_fis.open(raw_data_path);
+        if( !raw_fis )
+        {
+            fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        }
+    }
+    else
     {
-        fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        BOOST_LOG_TRIVIAL(info) << "no input is specified . using stdin .";
     }
+    istream &raw_is = raw_fis.is_open() ? static_cast<istream&>(raw_fis) : cin;
 
     // open output 
     if ("" == output_path)
     {
-        modelhandler::predict(*mia, raw_is, cout); // using `cout` as output stream 
-        raw_is.close();
+        modelhandler::predict_in_parallel(*mia, raw_is, cout, nr_thread, chunk_size); // using `cout` as output stream 
+        raw_fis.close();
     }
     else
     {
         ofstream os(output_path);
         if (!os)
         {
-            raw_is.close();
+            raw_fis.close();
             fatal_error("Error : failed open output file at : `" +  output_path + "`.");
         }
-        modelhandler::predict(*mia, raw_is, os);
+        modelhandler::predict_in_parallel(*mia, raw_is, os, nr_thread, chunk_size);
         os.close();
     }
     return 0;
 }
 
 
+int convert_process(int argc, char *argv[], const string &program_name)
+{
+    string description = PROGRAM_HEADER + "\n"
+        "Convert process ."
+        "using `" + program_name + " convert <options>` to convert the text archive model to binary model.";
+
+    po::options_description dynet_op("dynet options");
+    dynet_op.add_options()
+        ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) .");
+
+    string model_path, output_path;
+    po::options_description file_op("file options");
+    file_op.add_options()
+        ("model", po::value<string>(&model_path), "The path to the text archive model.")
+        ("output", po::value<string>(&output_path), "The path to storing the binary model.")
+        ("help,h", "Show help information.");
+
+    po::options_description all_op = po::options_description(description);
+    all_op.add(dynet_op).add(file_op);
+    po::variables_map var_map;
+    po::store(po::command_line_parser(argc, argv).options(all_op).allow_unregistered().run(), var_map);
+    po::notify(var_map);
+    if (var_map.count("help"))
+    {
+        cerr << all_op << endl;
+        return 0;
+    }
+    varmap_key_fatal_check(var_map, "model", "Error : model path should be specified ! ");
+    varmap_key_fatal_check(var_map, "output", "Error : output path should be specified ! ");
+    if (FileUtils::exists(output_path))
+    {
+        fatal_error("Error : output file `" + output_path + "` has already exists .");
+    }
+    // Init 
+    int dynet_argc;
+    shared_ptr<char *> dynet_argv;
+    unsigned dynet_mem = 0 ;
+    if( var_map.count("dynet-mem") != 0 ){ dynet_mem = var_map["dynet-mem"].as<unsigned>();}
+    build_dynet_parameters(program_name, dynet_mem, dynet_argc, dynet_argv);
+    char **dynet_argv_ptr = dynet_argv.get();
+
+    ifstream is(model_path);
+    if (!is)
+    {
+        fatal_error("Error : failed to open model path at '" + model_path + "' . ");
+    }
+    shared_ptr<MlpInput1All> mia = MlpInput1All::load_and_build_model(is, dynet_argc, dynet_argv_ptr);
+    is.close();
+    ofstream os(output_path, ios::binary);
+    if (!os)
+    {
+        fatal_error("Error : failed open output file at : `" +  output_path + "`.");
+    }
+    mia->save_model(os);
+    os.close();
+    cerr << "+ Convert done.\n";
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     ostringstream oss;
     string program_name = argv[0];
     oss << PROGRAM_HEADER << "\n"
         << "usage     : " << program_name << " [task] [options]" << "\n\n"
-        << "task      : [ train, devel, predict ] , one of the list is optional\n"
+        << "task      : [ train, devel, predict, convert ] , one of the list is optional\n"
         << "options   : options for specific task and model .\n"
         << "            using '" << program_name << " [task] -h' for details" ;
     string usage = oss.str();
@@ -434,7 +579,7 @@ int main(int argc, char *argv[])
     }
     string task = string(argv[1]);
     int ret_status ;
-    const string TrainTask = "train", DevelTask = "devel", PredictTask = "predict";
+    const string TrainTask = "train", DevelTask = "devel", PredictTask = "predict", ConvertTask = "convert";
     if( TrainTask == task )
     {
         ret_status = train_process(argc - 1, argv + 1, program_name); 
@@ -447,6 +592,10 @@ int main(int argc, char *argv[])
     {
         ret_status = predict_process(argc - 1, argv + 1, program_name); 
     }
+    else if( ConvertTask == task )
+    {
+        ret_status = convert_process(argc - 1, argv + 1, program_name);
+    }
     else
     {
         cerr << "unknown task : " << task << "\n"
@@ -42,7 +42,20 @@ int train_process(int argc, char *argv[], const string &program_name)
         ("training_update_scale", po::value<float>()->default_value(1.f), "The scale for backward updating.")
         ("scale_half_decay_period", po::value<unsigned>()->default_value(5), "The training update scale half decay period.")
         ("training_update_method", po::value<string>()->default_value("sgd"), "The update method, support list: "
-        "sgd, adagrad, momentum, adadelta, rmsprop, adam")
+        "sgd, adagrad, momentum, adadelta, rmsprop, adam, "
+            "sparse_adagrad, sparse_momentum, sparse_adam (only the touched rows of lookup parameters are updated)")
+        ("batch_size", po::value<unsigned>()->default_value(1), "The number of instances built in one graph and "
+            "updated at once(losses are summed). instances of a batch have similar length.")
+        ("batch_tokens", po::value<unsigned>()->default_value(0), "The max padded token number (instance number * "
+            "max length) of a batch, 0 for no limit. `batch_size` is still the instance limit of a batch.")
+        ("nr_worker", po::value<unsigned>()->default_value(1), "The number of hogwild(lock-free asynchronous) training "
+            "workers. only for sgd (the optimizer state can't be shared among workers), others train in serial.")
+        ("deterministic", po::value<bool>()->default_value(false), "Train sequentially in one worker for reproducible result, "
+            "`nr_worker` will be ignored.")
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process), every worker "
+            "predicts a part of devel data.")
+        ("async_devel", po::value<bool>()->default_value(false), "Go on training while devel workers predict by the "
+            "parameters at devel time. the devel result is applied a devel period later. disabled for hogwild training.")
         ("trivial_report_freq", po::value<unsigned>()->default_value(5000), "Trace frequent during training process");
 
     po::options_description model_op("model options");
@@ -109,6 +122,12 @@ int train_process(int argc, char *argv[], const string &program_name)
         unsigned do_devel_freq;
         unsigned max_epoch;
         unsigned trivial_report_freq;
+        unsigned batch_size;
+        unsigned max_batch_tokens;
+        unsigned nr_worker;
+        bool is_deterministic;
+        unsigned nr_devel_worker;
+        bool is_async_devel;
     };
     TrainingOpts opts;
     string training_data_path, devel_data_path ;
@@ -137,6 +156,12 @@ int train_process(int argc, char *argv[], const string &program_name)
     opts.scale_half_decay_period = var_map["scale_half_decay_period"].as<unsigned>();
     opts.training_update_method = var_map["training_update_method"].as<string>();
     opts.trivial_report_freq = var_map["trivial_report_freq"].as<unsigned>();
+    opts.batch_size = std::max(var_map["batch_size"].as<unsigned>(), 1U);
+    opts.max_batch_tokens = var_map["batch_tokens"].as<unsigned>();
+    opts.nr_worker = std::max(var_map["nr_worker"].as<unsigned>(), 1U);
+    opts.is_deterministic = var_map["deterministic"].as<bool>();
+    opts.nr_devel_worker = std::max(var_map["devel_worker"].as<unsigned>(), 1U);
+    opts.is_async_devel = var_map["async_devel"].as<bool>();
     // check model path
     string model_path;
     varmap_key_fatal_check(var_map, "model",
@@ -160,7 +185,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     std::shared_ptr<MlpInput1Bigram>  mi1 = MlpInput1Bigram::create_new_model(argc, argv, rng_seed);
 
     // pre-open model file, avoid fail after a long time training
-    ofstream model_os(model_path);
+    ofstream model_os(model_path, ios::binary);
     if( !model_os ) fatal_error("failed to open model path at '" + model_path + "'") ;
 
     mi1->set_model_structure_param_from_outer(var_map);
@@ -170,7 +195,7 @@ int train_process(int argc, char *argv[], const string &program_name)
         fatal_error("Error : failed to open training: `" + training_data_path + "` .");
     }
 
-    vector<MlpInput1Bigram::AnnotatedDataProcessedT> training_data;
+    MlpInput1Bigram::AnnotatedDatasetT training_data;
     modelhandler::read_training_data(train_is, *mi1, training_data);
     train_is.close();
     
@@ -179,7 +204,7 @@ int train_process(int argc, char *argv[], const string &program_name)
     mi1->build_model_structure();
 
     // reading developing data
-    vector<MlpInput1Bigram::AnnotatedDataProcessedT> devel_data;
+    MlpInput1Bigram::AnnotatedDatasetT devel_data;
     std::ifstream devel_is(devel_data_path);
     if (!devel_is) {
         fatal_error("Error : failed to open devel file: `" + devel_data_path + "`");
@@ -230,9 +255,13 @@ int devel_process(int argc, char *argv[], const string &program_name)
         ("devel_data", po::value<string>(&devel_data_path), "The path to developing data . For validation duration training . Empty for discarding .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)");
 
+    po::options_description devel_op("devel options");
+    devel_op.add_options()
+        ("devel_worker", po::value<unsigned>()->default_value(1), "The number of devel worker(process).");
+
     po::options_description all_op = po::options_description(description);
     // set params to receive the arguments 
-    all_op.add(generic_op).add(dynet_op).add(file_op);
+    all_op.add(generic_op).add(dynet_op).add(file_op).add(devel_op);
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(all_op).allow_unregistered().run(), var_map);
     po::notify(var_map);
@@ -267,23 +296,21 @@ int devel_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
     
     // Load model 
-    ifstream model_is(model_path);
-    if (!model_is)
+    if( !FileUtils::exists(model_path) )
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' .");
     }
-    std::shared_ptr<MlpInput1Bigram> mi1 = MlpInput1Bigram::load_and_build_model(model_is, dynet_argc, dynet_argv_ptr);
-    model_is.close();
+    std::shared_ptr<MlpInput1Bigram> mi1 = MlpInput1Bigram::load_and_build_model(model_path, dynet_argc, dynet_argv_ptr);
 
     // read devel data
     ifstream devel_is(devel_data_path) ;
     if( !devel_is ) fatal_error("Error : failed to open devel data at `" + devel_data_path + "`") ;
-    vector<MlpInput1Bigram::AnnotatedDataProcessedT> devel_data;
+    MlpInput1Bigram::AnnotatedDatasetT devel_data;
     modelhandler::read_devel_data(devel_is, *mi1, devel_data);
     devel_is.close();
 
     // devel
-    modelhandler::devel(*mi1, devel_data); 
+    modelhandler::devel(*mi1, devel_data, var_map["devel_worker"].as<unsigned>()); 
     return 0;
 }
 
@@ -305,13 +332,25 @@ int predict_process(int argc, char *argv[], const string &program_name)
     string raw_data_path, output_path, model_path;
     po::options_description file_op("file options");
     file_op.add_options()
-        ("input", po::value<string>(&raw_data_path), "The path to input data.")
+        ("input", po::value<string>(&raw_data_path), "The path to input data. using `stdin` if not specified or is `-` .")
         ("output", po::value<string>(&output_path), "The path to storing result . using `stdout` if not specified .")
         ("model", po::value<string>(&model_path), "Use to specify the model name(path)");
+
+    unsigned chunk_size, nr_thread;
+    string socket_path;
+    po::options_description predict_op("predict options");
+    predict_op.add_options()
+        ("chunk_size", po::value<unsigned>(&chunk_size)->default_value(modelhandler::DefaultPredictChunkSize),
+            "Line number to read, predict and write at a time in streaming prediction.")
+        ("threads", po::value<unsigned>(&nr_thread)->default_value(1),
+            "Number of prediction workers (processes sharing the loaded model).")
+        ("socket", po::value<string>(&socket_path), 
+            "Serve on the unix socket instead of predicting input. a client writes raw lines, "
+            "shuts down writing, then reads the result.");
     
     po::options_description all_op = po::options_description(description);
     // set params to receive the arguments 
-    all_op.add(generic_op).add(dynet_op).add(file_op);
+    all_op.add(generic_op).add(dynet_op).add(file_op).add(predict_op);
     po::variables_map var_map;
     po::store(po::command_line_parser(argc, argv).options(all_op).allow_unregistered().run(), var_map);
     po::notify(var_map);
@@ -338,8 +377,6 @@ int predict_process(int argc, char *argv[], const string &program_name)
 
     //set params 
 
-    varmap_key_fatal_check(var_map, "input", "input data path should be specified .");
-
     if (output_path == "")
     {
         BOOST_LOG_TRIVIAL(info) << "no output is specified . using stdout .";
@@ -356,49 +393,121 @@ int predict_process(int argc, char *argv[], const string &program_name)
     char **dynet_argv_ptr = dynet_argv.get();
 
     // load model 
-    ifstream is(model_path);
-    if (!is)
+    if( !FileUtils::exists(model_path) )
     {
         fatal_error("Error : failed to open model path at '" + model_path + "' . ");
     }
-    shared_ptr<MlpInput1Bigram> mi1 = MlpInput1Bigram::load_and_build_model(is, dynet_argc, dynet_argv_ptr);
-    is.close();
+    shared_ptr<MlpInput1Bigram> mi1 = MlpInput1Bigram::load_and_build_model(model_path, dynet_argc, dynet_argv_ptr);
+
+    if( var_map.count("socket") )
+    {
+        modelhandler::serve(*mi1, socket_path, nr_thread, chunk_size);
+        return 0;
+    }
 
     // open raw_data
-    ifstream raw_is(raw_data_path);
-    if (!raw_is)
+    ifstream raw_fis;
+    if( raw_data_path != "" && raw_data_path != "-" )
+    {
+        raw_fis.open(raw_data_path);
+        if( !raw_fis )
+        {
+            fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        }
+    }
+    else
     {
-        fatal_error("Error : failed to open raw data at '" + raw_data_path + "'");
+        BOOST_LOG_TRIVIAL(info) << "no input is specified . using stdin .";
     }
+    istream &raw_is = raw_fis.is_open() ? static_cast<istream&>(raw_fis) : cin;
 
     // open output 
     if ("" == output_path)
     {
-        modelhandler::predict(*mi1, raw_is, cout); // using `cout` as output stream 
-        raw_is.close();
+        modelhandler::predict_in_parallel(*mi1, raw_is, cout, nr_thread, chunk_size); // using `cout` as output stream 
+        raw_fis.close();
     }
     else
     {
         ofstream os(output_path);
         if (!os)
         {
-            raw_is.close();
+            raw_fis.close();
             fatal_error("Error : failed open output file at : `" +  output_path + "`.");
         }
-        modelhandler::predict(*mi1, raw_is, os);
+        modelhandler::predict_in_parallel(*mi1, raw_is, os, nr_thread, chunk_size);
         os.close();
     }
     return 0;
 }
 
 
+int convert_process(int argc, char *argv[], const string &program_name)
+{
+    string description = PROGRAM_HEADER + "\n"
+        "Convert process ."
+        "using `" + program_name + " convert <options>` to convert the text archive model to binary model.";
+
+    po::options_description dynet_op("dynet options");
+    dynet_op.add_options()
+        ("dynet-mem", po::value<unsigned>(), "pre-allocated memory pool for DyNet library (MB) .");
+
+    string model_path, output_path;
+    po::options_description file_op("file options");
+    file_op.add_options()
+        ("model", po::value<string>(&model_path), "The path to the text archive model.")
+        ("output", po::value<string>(&output_path), "The path to storing the binary model.")
+        ("help,h", "Show help information.");
+
+    po::options_description all_op = po::options_description(description);
+    all_op.add(dynet_op).add(file_op);
+    po::variables_map var_map;
+    po::store(po::command_line_parser(argc, argv).options(all_op).allow_unregistered().run(), var_map);
+    po::notify(var_map);
+    if (var_map.count("help"))
+    {
+        cerr << all_op << endl;
+        return 0;
+    }
+    varmap_key_fatal_check(var_map, "model", "Error : model path should be specified ! ");
+    varmap_key_fatal_check(var_map, "output", "Error : output path should be specified ! ");
+    if (FileUtils::exists(output_path))
+    {
+        fatal_error("Error : output file `" + output_path + "` has already exists .");
+    }
+    // Init 
+    int dynet_argc;
+    shared_ptr<char *> dynet_argv;
+    unsigned dynet_mem = 0 ;
+    if( var_map.count("dynet-mem") != 0 ){ dynet_mem = var_map["dynet-mem"].as<unsigned>();}
+    build_dynet_parameters(program_name, dynet_mem, dynet_argc, dynet_argv);
+    char **dynet_argv_ptr = dynet_argv.get();
+
+    ifstream is(model_path);
+    if (!is)
+    {
+        fatal_error("Error : failed to open model path at '" + model_path + "' . ");
+    }
+    shared_ptr<MlpInput1Bigram> mi1 = MlpInput1Bigram::load_and_build_model(is, dynet_argc, dynet_argv_ptr);
+    is.close();
+    ofstream os(output_path, ios::binary);
+    if (!os)
+    {
+        fatal_error("Error : failed open output file at : `" +  output_path + "`.");
+    }
+    mi1->save_model(os);
+    os.close();
+    cerr << "+ Convert done.\n";
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     ostringstream oss;
     string program_name = argv[0];
     oss << PROGRAM_HEADER << "\n"
         << "usage     : " << program_name << " [task] [options]" << "\n\n"
-        << "task      : [ train, devel, predict ] , one of the list is optional\n"
+        << "task      : [ train, devel, predict, convert ] , one of the list is optional\n"
         << "options   : options for specific task and model .\n"
         << "            using '" << program_name << " [task] -h' for details" ;
     string usage = oss.str();
@@ -413,7 +522,7 @@ int main(int argc, char *argv[])
     }
     string task = string(argv[1]);
     int ret_status ;
-    const string TrainTask = "train", DevelTask = "devel", PredictTask = "predict";
+    const string TrainTask = "train", DevelTask = "devel", PredictTask = "predict", ConvertTask = "convert";
     if( TrainTask == task )
     {
         ret_status = train_process(argc - 1, argv + 1, program_name); 
@@ -426,6 +535,10 @@ int main(int argc, char *argv[])
     {
         ret_status = predict_process(argc - 1, argv + 1, program_name); 
     }
+    else if( ConvertTask == task )
+    {
+        ret_status = convert_process(argc - 1, argv + 1, program_name);
+    }
     else
     {
         cerr << "unknown task : " << task << "\n"
@@ -43,6 +43,17 @@ using MlpInput1All = SegmenterMlpInput1Template<
     structure_param_module::ParamSegmenterMlpInput1All,
     nn_module::NnSegmenterMlpInput1All>;
 
+/**
+ * precompute the first hidden layer for the `top_k` most frequent unigrams and bigrams (inference only).
+ * @see NnSegmenterMlpInput1All::enable_precomputation
+ */
+inline
+bool enable_precomputation(MlpInput1All &m, std::size_t top_k)
+{
+    return m.get_nn()->enable_precomputation(m.get_token_module()->get_frequent_unigram_index_list(top_k),
+        m.get_token_module()->get_frequent_bigram_index_list(top_k));
+}
+
 } // enf of namespace mlp-input1
 } // enf of namespace segmenter
 } // end of namespace slnn
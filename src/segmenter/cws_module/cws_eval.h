@@ -63,8 +63,10 @@ public:
     EvalResultT end_eval();
     // batch
     EvalResultT eval(const std::vector<std::vector<Index>> &gold_tagseq_set, const std::vector<std::vector<Index>> &pred_tagseq);
-private:
+    // partial result, for parallel eval: every worker evals a part by `eval_one`, the results are merged.
     eval_inner::EvalTempResultT eval_one(const std::vector<Index> &gold_tagseq, const std::vector<Index> &pred_tagseq);
+    const eval_inner::EvalTempResultT& get_temp_result() const { return tmp_result4iter; }
+    void merge_temp_result(const eval_inner::EvalTempResultT &other){ tmp_result4iter += other; }
 private:
     eval_inner::EvalTempResultT tmp_result4iter;
 };
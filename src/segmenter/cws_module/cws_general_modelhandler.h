@@ -6,14 +6,25 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <random>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
 #include <boost/program_options/variables_map.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
 #include "utils/stat.hpp"
+#include "utils/parallel_predictor.hpp"
+#include "utils/batch_scheduler.hpp"
+#include "utils/parallel_reduce.hpp"
 #include "cws_reader_unicode.h"
 #include "cws_writer.h"
 #include "token_module/cws_tag_definition.h"
 #include "cws_eval.h"
 #include "cws_stat.h"
+#include "cws_hogwild_trainer.h"
 #include "trivial/charcode/charcode_detector.h"
+#include "trivial/corpus_cache/corpus_cache.h"
 #include "utils/typedeclaration.h"
 namespace slnn{
 namespace segmenter{
@@ -23,13 +34,31 @@ namespace modelhandler_inner{
 
 template <typename SLModel>
 unsigned read_annotated_data(std::istream &is, SLModel &slm, 
-    std::vector<typename SLModel::AnnotatedDataProcessedT> &out_ann_processed_data);
+    typename SLModel::AnnotatedDatasetT &out_ann_processed_data);
 
 template <typename SLModel>
 unsigned read_unannotated_data(std::istream &is, SLModel &slm, 
     std::vector<typename SLModel::UnannotatedDataProcessedT> &out_unann_processed_data,
     std::vector<typename SLModel::UnannotatedDataRawT> &out_unann_raw_data);
 
+template <typename SLModel>
+unsigned read_unannotated_data_chunk(reader::SegmentorUnicodeReader &reader_ins, SLModel &slm, unsigned chunk_size,
+    std::vector<typename SLModel::UnannotatedDataProcessedT> &out_unann_processed_data,
+    std::vector<typename SLModel::UnannotatedDataRawT> &out_unann_raw_data);
+
+template <typename SLModel>
+unsigned long predict_stream(SLModel &slm, std::istream &is, std::ostream &os, charcode::EncodingType encoding,
+    unsigned chunk_size, BasicStat &stat);
+
+template <typename SLModel>
+std::string serialize_token_module(const SLModel &slm);
+
+std::string get_corpus_cache_path(const std::string &cache_dir, const std::string &data_path, std::uint64_t key);
+
+template <typename AnnotatedDatasetT>
+void write_corpus_cache(const std::string &cache_path, std::uint64_t key, const std::string &dict_bytes,
+    const AnnotatedDatasetT &dataset);
+
 void write_record_list(std::ostream &os, const std::vector<std::tuple<float, int, int>> &record_list);
 
 class TrainingUpdateRecorder
@@ -54,6 +83,39 @@ private:
     std::vector<std::tuple<float, int, int>> record_list;
 };
 
+/**
+ * devel runner.
+ * when forked, the devel data is predicted by `nr_worker` processes (see `utils::AsyncParallelReduce`),
+ * each worker pulls instances (in length order) and evals them, the partial eval results are merged at `finish`.
+ * the workers predict by the parameters at `start`, so the training can go on before `finish` (asynchronous devel).
+ * when not forked, the devel is done in `start`.
+ */
+template <typename SLModel>
+class DevelRunner
+{
+public:
+    DevelRunner(SLModel &slm, const typename SLModel::AnnotatedDatasetT &devel_data, unsigned nr_worker, bool is_forked);
+    void start();
+    bool is_running() const { return is_started; }
+    /**
+     * wait for the devel and report the result.
+     * @return F1
+     */
+    float finish();
+private:
+    void devel_one(unsigned idx, eval::eval_inner::EvalTempResultT &result);
+private:
+    SLModel &slm;
+    const typename SLModel::AnnotatedDatasetT &devel_data;
+    unsigned nr_worker;
+    bool is_forked;
+    bool is_started;
+    std::vector<unsigned> access_order;
+    eval::SegmenterEval eval_ins;
+    stat::SegmentorStat stat;
+    utils::AsyncParallelReduce<eval::eval_inner::EvalTempResultT> reducer;
+};
+
 } // end of namespace modelhandler-inner
 
 using modelhandler_inner::write_record_list;
@@ -72,10 +134,25 @@ template <typename SLModel>
 void set_model_structure_param(SLModel &slm, const boost::program_options::variables_map &args);
 
 template <typename SLModel>
-void read_training_data(std::istream &is, SLModel &slm, std::vector<typename SLModel::AnnotatedDataProcessedT> &out_training_processed_data);
+void read_training_data(std::istream &is, SLModel &slm, typename SLModel::AnnotatedDatasetT &out_training_processed_data);
 
 template <typename SLModel>
-void read_devel_data(std::istream &is, SLModel &slm, std::vector<typename SLModel::AnnotatedDataProcessedT> &out_devel_processed_data);
+void read_devel_data(std::istream &is, SLModel &slm, typename SLModel::AnnotatedDatasetT &out_devel_processed_data);
+
+/**
+ * read the data through the corpus cache in `cache_dir`.
+ * the cache is keyed by the data file identity and the token module (dictionary) state, a matched cache is used
+ * instead of parsing and featurizing the text, else the text is read and the cache is (re-)written.
+ * for training data, lexicon is built here (no need to call `build_lexicon_if_necessary`) and the token module
+ * after reading is stored in the cache too.
+ */
+template <typename SLModel>
+void read_training_data_with_cache(const std::string &training_data_path, const std::string &cache_dir, SLModel &slm,
+    typename SLModel::AnnotatedDatasetT &out_training_processed_data);
+
+template <typename SLModel>
+void read_devel_data_with_cache(const std::string &devel_data_path, const std::string &cache_dir, SLModel &slm,
+    typename SLModel::AnnotatedDatasetT &out_devel_processed_data);
 
 template <typename SLModel>
 void read_test_data(std::istream &is, SLModel &slm, 
@@ -88,18 +165,35 @@ void build_model(SLModel &slm);
 template <typename SLModel, typename TrainingOpts>
 std::vector<std::tuple<float, int, int>>
 train(SLModel &slm,
-    const std::vector<typename SLModel::AnnotatedDataProcessedT> &training_data,
-    const std::vector<typename SLModel::AnnotatedDataProcessedT> &devel_data,
+    const typename SLModel::AnnotatedDatasetT &training_data,
+    const typename SLModel::AnnotatedDatasetT &devel_data,
     const TrainingOpts &opts);
 
 template <typename SLModel>
 float devel(SLModel &slm,
-    const std::vector<typename SLModel::AnnotatedDataProcessedT> &devel_data);
+    const typename SLModel::AnnotatedDatasetT &devel_data,
+    unsigned nr_worker=1);
+
+constexpr unsigned DefaultPredictChunkSize = 1024U;
 
 template <typename SLModel>
 void predict(SLModel &slm,
     std::istream &is,
-    std::ostream &os);
+    std::ostream &os,
+    unsigned chunk_size=DefaultPredictChunkSize);
+
+template <typename SLModel>
+void predict_in_parallel(SLModel &slm,
+    std::istream &is,
+    std::ostream &os,
+    unsigned nr_worker,
+    unsigned chunk_size=DefaultPredictChunkSize);
+
+template <typename SLModel>
+void serve(SLModel &slm,
+    const std::string &socket_path,
+    unsigned nr_worker,
+    unsigned chunk_size=DefaultPredictChunkSize);
 
 
 /*********************************************************
@@ -109,12 +203,12 @@ void predict(SLModel &slm,
 namespace modelhandler_inner{
 
 template <typename SLModel>
-unsigned read_annotated_data(std::istream &is, SLModel &slm, std::vector<typename SLModel::AnnotatedDataProcessedT> &out_ann_processed_data)
+unsigned read_annotated_data(std::istream &is, SLModel &slm, typename SLModel::AnnotatedDatasetT &out_ann_processed_data)
 {
     using std::swap;
     reader::SegmentorUnicodeReader reader_ins(is,
         charcode::EncodingDetector::get_detector()->detect_and_set_encoding(is));
-    std::vector<typename SLModel::AnnotatedDataProcessedT> dataset;
+    typename SLModel::AnnotatedDatasetT dataset;
     unsigned detected_line_cnt = reader_ins.count_line();
     dataset.reserve(detected_line_cnt);
     typename SLModel::AnnotatedDataRawT wordseq;
@@ -123,15 +217,14 @@ unsigned read_annotated_data(std::istream &is, SLModel &slm, std::vector<typenam
     while( reader_ins.read_segmented_line(wordseq) )
     {
         if( wordseq.empty() ){ continue; }
-        typename SLModel::AnnotatedDataProcessedT processed_data;
-        slm.get_token_module()->process_annotated_data(wordseq, processed_data);
-        dataset.push_back(std::move(processed_data));
+        slm.get_token_module()->append_annotated_data(wordseq, dataset);
         ++readline_cnt;
         if( report_cnt && readline_cnt % report_cnt == 0 )
         {
             std::cerr << "- read instance : " << readline_cnt << " [" << readline_cnt / report_cnt << "/5]\n";
         }
     }
+    dataset.shrink_to_fit();
     swap(out_ann_processed_data, dataset);
     return readline_cnt;
 }
@@ -170,6 +263,190 @@ unsigned read_unannotated_data(std::istream &is, SLModel &slm,
 }
 
 
+/**
+ * read at most `chunk_size` lines from the reader (streaming, no line counting).
+ * the output buffers are cleared first, so they can be reused among chunks.
+ * return : line number read, 0 for end of input.
+ */
+template <typename SLModel>
+unsigned read_unannotated_data_chunk(reader::SegmentorUnicodeReader &reader_ins, SLModel &slm, unsigned chunk_size,
+    std::vector<typename SLModel::UnannotatedDataProcessedT> &out_unann_processed_data,
+    std::vector<typename SLModel::UnannotatedDataRawT> &out_unann_raw_data)
+{
+    out_unann_processed_data.resize(chunk_size);
+    out_unann_raw_data.resize(chunk_size);
+    unsigned readline_cnt = 0;
+    while( readline_cnt < chunk_size && reader_ins.readline(out_unann_raw_data[readline_cnt]) )
+    {
+        // empty line is written back directly, no need to process.
+        if( !out_unann_raw_data[readline_cnt].empty() )
+        {
+            slm.get_token_module()->process_unannotated_data(out_unann_raw_data[readline_cnt],
+                out_unann_processed_data[readline_cnt]);
+        }
+        ++readline_cnt;
+    }
+    out_unann_processed_data.resize(readline_cnt);
+    out_unann_raw_data.resize(readline_cnt);
+    return readline_cnt;
+}
+
+
+/**
+ * predict all lines of `is` to `os`, chunk by chunk, without logging.
+ * `encoding` is given by the caller (not detected here): the streams of the workers are chunks or sockets,
+ * on which the detector would fall back to the console encoding and overwrite the detected one of the process.
+ * return : instance number.
+ */
+template <typename SLModel>
+unsigned long predict_stream(SLModel &slm, std::istream &is, std::ostream &os, charcode::EncodingType encoding,
+    unsigned chunk_size, BasicStat &stat)
+{
+    reader::SegmentorUnicodeReader reader_ins(is, encoding);
+    writer::SegmentorWriter writer_ins(os, encoding, WordOutputDelimiter());
+    std::vector<typename SLModel::UnannotatedDataProcessedT> test_data;
+    std::vector<typename SLModel::UnannotatedDataRawT> test_raw_data;
+    std::vector<std::vector<Index>> pred_tagseq_list;
+    utils::BatchScheduler batch_scheduler(chunk_size, 0U);
+    unsigned long nr_instance = 0;
+    while( read_unannotated_data_chunk(reader_ins, slm, chunk_size, test_data, test_raw_data) > 0 )
+    {
+        // predict the chunk in length order, then write in the input order.
+        batch_scheduler.schedule_for_inference(utils::BatchScheduler::get_length_list(test_raw_data));
+        pred_tagseq_list.resize(test_data.size());
+        for( const utils::BatchScheduler::BatchT &batch : batch_scheduler )
+        {
+            for( unsigned i : batch )
+            {
+                if( test_raw_data[i].empty() ){ pred_tagseq_list[i].clear(); }
+                else{ pred_tagseq_list[i] = slm.predict(test_data[i]); }
+            }
+        }
+        for( unsigned i = 0; i < test_data.size(); ++i )
+        {
+            if( test_raw_data[i].empty() )
+            {
+                writer_ins.write({}, {});
+                continue;
+            }
+            writer_ins.write(test_raw_data[i], pred_tagseq_list[i]);
+            stat.total_tags += pred_tagseq_list[i].size();
+        }
+        nr_instance += test_data.size();
+        os.flush();
+    }
+    return nr_instance;
+}
+
+
+template <typename SLModel>
+std::string serialize_token_module(const SLModel &slm)
+{
+    std::ostringstream oss;
+    {
+        boost::archive::binary_oarchive to(oss);
+        to << *slm.get_token_module();
+    }
+    return oss.str();
+}
+
+inline
+std::string get_corpus_cache_path(const std::string &cache_dir, const std::string &data_path, std::uint64_t key)
+{
+    std::string::size_type split_pos = data_path.find_last_of("/\\");
+    std::string base_name = split_pos == std::string::npos ? data_path : data_path.substr(split_pos + 1);
+    std::ostringstream oss;
+    oss << cache_dir << "/" << base_name << "." << std::hex << std::setw(16) << std::setfill('0') << key << ".corpus";
+    return oss.str();
+}
+
+/**
+ * write the corpus arenas to the cache (only for the dataset in structure-of-arrays layout).
+ */
+template <typename AnnotatedDatasetT>
+void write_corpus_cache(const std::string &cache_path, std::uint64_t key, const std::string &dict_bytes,
+    const AnnotatedDatasetT &dataset)
+{
+    if( trivial::corpus_cache::write_corpus_cache_file(cache_path, key, dict_bytes,
+        dataset.get_channel_corpus().get_channel_builder_list()) )
+    {
+        std::cerr << "- corpus cache written to '" << cache_path << "'\n";
+    }
+    else{ std::cerr << "- failed to write corpus cache to '" << cache_path << "', ignored.\n"; }
+}
+
+template <typename SLModel>
+DevelRunner<SLModel>::DevelRunner(SLModel &slm, const typename SLModel::AnnotatedDatasetT &devel_data,
+    unsigned nr_worker, bool is_forked)
+    :slm(slm),
+    devel_data(devel_data),
+    nr_worker(std::max(nr_worker, 1U)),
+    is_forked(is_forked && utils::is_parallel_reduce_supported()),
+    is_started(false),
+    stat(true)
+{
+    // length order, the neighbouring instances are similar in size, and the long ones are not left at the end.
+    utils::BatchScheduler batch_scheduler(DefaultPredictChunkSize, 0U);
+    batch_scheduler.schedule_for_inference(utils::BatchScheduler::get_length_list(devel_data));
+    access_order.reserve(devel_data.size());
+    for( const utils::BatchScheduler::BatchT &batch : batch_scheduler )
+    {
+        access_order.insert(access_order.end(), batch.cbegin(), batch.cend());
+    }
+}
+
+template <typename SLModel>
+void DevelRunner<SLModel>::start()
+{
+    if( is_started ){ throw std::logic_error("devel runner: the last devel is not finished."); }
+    std::cerr << "+ Validation at " << devel_data.size() << " instances"
+        << (is_forked ? " by " + std::to_string(nr_worker) + " worker" : std::string()) << ".\n";
+    stat.start_time_stat();
+    eval_ins.start_eval();
+    unsigned nr_samples = static_cast<unsigned>(access_order.size());
+    if( is_forked )
+    {
+        reducer.start(nr_worker, 0U, nr_samples, [this](unsigned idx, eval::eval_inner::EvalTempResultT &result)
+        {
+            devel_one(idx, result);
+        });
+    }
+    else
+    {
+        eval::eval_inner::EvalTempResultT result;
+        for( unsigned idx = 0; idx < nr_samples; ++idx ){ devel_one(idx, result); }
+        eval_ins.merge_temp_result(result);
+    }
+    is_started = true;
+}
+
+template <typename SLModel>
+void DevelRunner<SLModel>::devel_one(unsigned idx, eval::eval_inner::EvalTempResultT &result)
+{
+    unsigned access_idx = access_order[idx];
+    std::vector<Index> pred_tagseq = slm.predict(
+        slm.get_token_module()->extract_unannotated_data_from_annotated_data(devel_data[access_idx]));
+    result += eval_ins.eval_one(devel_data[access_idx].get_tagseq(), pred_tagseq);
+}
+
+template <typename SLModel>
+float DevelRunner<SLModel>::finish()
+{
+    if( !is_started ){ throw std::logic_error("devel runner: no devel is started."); }
+    is_started = false;
+    if( is_forked ){ eval_ins.merge_temp_result(reducer.wait()); }
+    stat.end_time_stat();
+    eval::EvalResultT eval_result = eval_ins.end_eval();
+    stat.nr_token_predict = eval_result.nr_token_predict;
+    stat.total_tags = eval_result.nr_tag;
+    std::ostringstream tmp_sos;
+    tmp_sos << "= Validation finished. \n"
+        << "| Acc = " << eval_result.acc << "% , P = " << eval_result.p 
+        << "% , R = " << eval_result.r << "% , F1 = " << eval_result.f1 << "%";
+    std::cerr << stat.get_stat_str(tmp_sos.str()) << "\n";
+    return eval_result.f1;
+}
+
 inline
 void TrainingUpdateRecorder::set_train_error_threshold(float error_threshold)
 {
@@ -224,7 +501,7 @@ void set_model_structure_param(SLModel &slm, const boost::program_options::varia
 }
 
 template <typename SLModel>
-void read_training_data(std::istream &is, SLModel &slm, std::vector<typename SLModel::AnnotatedDataProcessedT> &out_training_processed_data)
+void read_training_data(std::istream &is, SLModel &slm, typename SLModel::AnnotatedDatasetT &out_training_processed_data)
 {
     std::cerr << "+ Process training data.\n";
     unsigned line_cnt = modelhandler_inner::read_annotated_data(is, slm, out_training_processed_data);
@@ -233,7 +510,7 @@ void read_training_data(std::istream &is, SLModel &slm, std::vector<typename SLM
 }
 
 template <typename SLModel>
-void read_devel_data(std::istream &is, SLModel &slm, std::vector<typename SLModel::AnnotatedDataProcessedT> &out_devel_processed_data)
+void read_devel_data(std::istream &is, SLModel &slm, typename SLModel::AnnotatedDatasetT &out_devel_processed_data)
 {
     std::cerr << "+ Process devel data.\n";
     unsigned line_cnt = modelhandler_inner::read_annotated_data(is, slm, out_devel_processed_data);
@@ -241,6 +518,64 @@ void read_devel_data(std::istream &is, SLModel &slm, std::vector<typename SLMode
         << out_devel_processed_data.size() << ")\n";
 }
 
+template <typename SLModel>
+void read_training_data_with_cache(const std::string &training_data_path, const std::string &cache_dir, SLModel &slm,
+    typename SLModel::AnnotatedDatasetT &out_training_processed_data)
+{
+    namespace cc = trivial::corpus_cache;
+    // key: data file + token module before reading (feature switches, thresholds).
+    std::string file_identity = cc::get_file_identity(training_data_path);
+    std::string module_bytes = modelhandler_inner::serialize_token_module(slm);
+    std::uint64_t key = cc::hash_bytes(file_identity.data(), file_identity.size());
+    key = cc::hash_bytes(module_bytes.data(), module_bytes.size(), key);
+    std::string cache_path = modelhandler_inner::get_corpus_cache_path(cache_dir, training_data_path, key);
+    std::shared_ptr<const cc::MappedCorpusCache> cache = cc::open_corpus_cache(cache_path, key);
+    if( cache )
+    {
+        std::cerr << "+ Load training data from corpus cache '" << cache_path << "'.\n";
+        std::istringstream dict_is(std::string(cache->get_dict_data(), cache->get_dict_size()));
+        {
+            boost::archive::binary_iarchive ti(dict_is);
+            ti >> *slm.get_token_module();
+        }
+        // the dataset is the view of the mapped cache, no copy.
+        out_training_processed_data = typename SLModel::AnnotatedDatasetT(cache);
+        std::cerr << "= Training data loaded. (instance number: " << out_training_processed_data.size() << ")\n";
+        return;
+    }
+    std::ifstream is(training_data_path);
+    if( !is ){ throw std::runtime_error("failed to open training data: '" + training_data_path + "'"); }
+    slm.get_token_module()->build_lexicon_if_necessary(is);
+    read_training_data(is, slm, out_training_processed_data);
+    modelhandler_inner::write_corpus_cache(cache_path, key, modelhandler_inner::serialize_token_module(slm),
+        out_training_processed_data);
+}
+
+template <typename SLModel>
+void read_devel_data_with_cache(const std::string &devel_data_path, const std::string &cache_dir, SLModel &slm,
+    typename SLModel::AnnotatedDatasetT &out_devel_processed_data)
+{
+    namespace cc = trivial::corpus_cache;
+    // key: data file + the frozen dictionary.
+    std::string file_identity = cc::get_file_identity(devel_data_path);
+    std::string module_bytes = modelhandler_inner::serialize_token_module(slm);
+    std::uint64_t key = cc::hash_bytes(file_identity.data(), file_identity.size());
+    key = cc::hash_bytes(module_bytes.data(), module_bytes.size(), key);
+    std::string cache_path = modelhandler_inner::get_corpus_cache_path(cache_dir, devel_data_path, key);
+    std::shared_ptr<const cc::MappedCorpusCache> cache = cc::open_corpus_cache(cache_path, key);
+    if( cache )
+    {
+        std::cerr << "+ Load devel data from corpus cache '" << cache_path << "'.\n";
+        out_devel_processed_data = typename SLModel::AnnotatedDatasetT(cache);
+        std::cerr << "= Devel data loaded. (instance number: " << out_devel_processed_data.size() << ")\n";
+        return;
+    }
+    std::ifstream is(devel_data_path);
+    if( !is ){ throw std::runtime_error("failed to open devel data: '" + devel_data_path + "'"); }
+    read_devel_data(is, slm, out_devel_processed_data);
+    modelhandler_inner::write_corpus_cache(cache_path, key, std::string(), out_devel_processed_data);
+}
+
 template <typename SLModel>
 void read_test_data(std::istream &is, SLModel &slm, 
     std::vector<typename SLModel::UnannotatedDataProcessedT> &out_test_processed_data,
@@ -261,8 +596,8 @@ void build_model(SLModel &slm)
 template <typename SLModel, typename TrainingOpts>
 std::vector<std::tuple<float, int, int>>
 train(SLModel &slm,
-    const std::vector<typename SLModel::AnnotatedDataProcessedT> &training_data,
-    const std::vector<typename SLModel::AnnotatedDataProcessedT> &devel_data,
+    const typename SLModel::AnnotatedDatasetT &training_data,
+    const typename SLModel::AnnotatedDatasetT &devel_data,
     const TrainingOpts &opts)
 {
     unsigned nr_samples = training_data.size();
@@ -272,15 +607,60 @@ train(SLModel &slm,
         << "|  learning rate(" << opts.learning_rate << ") eta decay(" << opts.eta_decay << "_\n"
         << "|  training update scale(" << opts.training_update_scale << "), "
         << "half decay period (" <<  opts.scale_half_decay_period  << " epochs)\n"
-        << "|  max epoch(" << opts.max_epoch << "), devel frequence(" << opts.do_devel_freq << ")\n"
+        << "|  max epoch(" << opts.max_epoch << "), devel frequence(" << opts.do_devel_freq << "), "
+        << "batch size(" << opts.batch_size << "), batch tokens(" << opts.max_batch_tokens << ")\n"
+        << "|  worker number(" << opts.nr_worker << "), deterministic(" << std::boolalpha << opts.is_deterministic
+        << std::noboolalpha << ")\n"
+        << "|  devel worker number(" << opts.nr_devel_worker << "), asynchronous devel(" << std::boolalpha
+        << opts.is_async_devel << std::noboolalpha << ")\n"
         << "== - - - - -\n";
     slm.get_nn()->set_update_method(opts.training_update_method);
     slm.get_nn()->set_optimizer_params(opts.learning_rate, opts.eta_decay);
     modelhandler_inner::TrainingUpdateRecorder update_recorder;
-    auto do_devel_in_training = [&devel_data, &slm, &update_recorder](int nr_epoch, int nr_devel_order) 
+    // parallel training, the devel and stash are still done in current process.
+    bool is_hogwild = opts.nr_worker > 1 && !opts.is_deterministic && hogwild::is_supported();
+    if( is_hogwild && !hogwild::is_update_method_supported(opts.training_update_method) )
+    {
+        std::cerr << "- hogwild training supports only the sgd update method (the optimizer state of '"
+            << opts.training_update_method << "' can't be shared by the worker processes), train in serial.\n";
+        is_hogwild = false;
+    }
+    // asynchronous devel needs a parameter copy for the devel workers, which is not the case for shared parameters.
+    bool is_async_devel = opts.is_async_devel && !is_hogwild && utils::is_parallel_reduce_supported();
+    if( opts.is_async_devel && !is_async_devel )
+    {
+        std::cerr << "- asynchronous devel is disabled (hogwild training or not supported platform).\n";
+    }
+    modelhandler_inner::DevelRunner<SLModel> devel_runner(slm, devel_data, opts.nr_devel_worker,
+        is_async_devel || opts.nr_devel_worker > 1);
+    int pending_epoch = 0,
+        pending_devel_order = 0;
+    auto finish_pending_devel = [&devel_runner, &slm, &update_recorder, &pending_epoch, &pending_devel_order]()
     {
+        if( !devel_runner.is_running() ){ return; }
+        float f1 = devel_runner.finish();
+        slm.get_nn()->stash_pending_model_when_best(f1);
+        update_recorder.update_training_state(f1, pending_epoch, pending_devel_order);
+    };
+    auto do_devel_in_training = [&](int nr_epoch, int nr_devel_order) 
+    {
+        // the devel (and the stashed model) sees the pending update of the skipped rows (sparse update methods).
+        slm.get_nn()->flush_lazy_update();
+        if( is_async_devel )
+        {
+            // finish the last devel, and start devel on the current parameters, which is pending for stash.
+            // so the training state is updated a devel period later.
+            finish_pending_devel();
+            if( !update_recorder.is_training_ok() ){ return; }
+            slm.get_nn()->stash_pending_model();
+            pending_epoch = nr_epoch;
+            pending_devel_order = nr_devel_order;
+            devel_runner.start();
+            return;
+        }
         // function : 1. devel; 2. stash model when best; 3. update training  state.
-        float f1 = devel(slm, devel_data);
+        devel_runner.start();
+        float f1 = devel_runner.finish();
         slm.get_nn()->stash_model_when_best(f1);
         update_recorder.update_training_state(f1, nr_epoch, nr_devel_order);
     };
@@ -292,46 +672,70 @@ train(SLModel &slm,
         std::cerr << "-- Update epoch. learning rate currently is " << slm.get_nn()->get_current_learning_rate()
             << "\n";
     };
-    // for randomly select instance
-    std::vector<unsigned> access_order(nr_samples);
-    for( unsigned i = 0; i < nr_samples; ++i ) access_order[i] = i;
+    // one graph, one update for a batch.
+    auto train_batch = [&slm, &training_data, &actual_scale](const std::vector<unsigned> &batch, 
+        hogwild::WorkerReport &report)
+    {
+        typename SLModel::NnExprT loss_expr = slm.build_batch_training_graph(training_data, batch);
+        slnn::type::real loss = slm.get_nn()->as_scalar(slm.get_nn()->forward(loss_expr));
+        slm.get_nn()->backward(loss_expr);
+        slm.get_nn()->update(actual_scale);
+        report.loss += loss;
+        for( unsigned access_idx : batch ){ report.nr_tag += training_data[access_idx].size(); }
+        report.nr_instance += batch.size();
+    };
+    if( is_hogwild ){ slm.get_nn()->share_parameters_among_processes(); }
+    // batches of instances with similar length, under the token budget.
+    utils::BatchScheduler batch_scheduler(opts.batch_size, opts.max_batch_tokens);
+    std::vector<std::size_t> length_list = utils::BatchScheduler::get_length_list(training_data);
 
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     for( unsigned nr_epoch = 1; nr_epoch <= opts.max_epoch ; ++nr_epoch )
     {
         std::cerr << "++ Epoch " << nr_epoch << "/" << opts.max_epoch << " start. \n";
-        // shuffle samples by random access order
-        std::shuffle(access_order.begin(), access_order.end(), *slm.get_mt19937_rng());
-
         // For loss , accuracy , time cost report
         BasicStat training_stat_per_epoch;
         training_stat_per_epoch.start_time_stat();
 
         int nr_devel_order = 0; // for record
+        unsigned nr_trained_instance = 0;
+        // shuffle batches (bucketed by length) by random access order
+        batch_scheduler.schedule_for_training(length_list, *slm.get_mt19937_rng());
+        const std::vector<utils::BatchScheduler::BatchT> &batch_list = batch_scheduler.get_batch_list();
         // train for every Epoch 
-        for( unsigned i = 0; i < nr_samples; ++i )
+        for( unsigned batch_idx = 0; batch_idx < batch_list.size(); )
         {
-            unsigned access_idx = access_order[i];
-            const  typename SLModel::AnnotatedDataProcessedT &instance = training_data[access_idx];
-            // GO
-            typename SLModel::NnExprT loss_expr = slm.build_training_graph(instance);
-            slnn::type::real loss = slm.get_nn()->as_scalar(slm.get_nn()->forward(loss_expr));
-            slm.get_nn()->backward(loss_expr);
-            slm.get_nn()->update(actual_scale);
-            // record loss
-            training_stat_per_epoch.loss += loss;
-            training_stat_per_epoch.total_tags += instance.size() ;
-            if( 0 == (i + 1) % opts.trivial_report_freq && false) // Report 
+            // a segment ends at the next devel point (or the end of the epoch)
+            unsigned segment_end = batch_idx;
+            while( segment_end < batch_list.size() && line_cnt_for_devel < opts.do_devel_freq )
             {
-                std::string trivial_header = std::to_string(i + 1) + " instances have been trained.";
-                std::cerr << training_stat_per_epoch.get_stat_str(trivial_header) << "\n";
+                line_cnt_for_devel += batch_list[segment_end++].size();
             }
-            ++line_cnt_for_devel;
+            hogwild::WorkerReport segment_report;
+            if( is_hogwild )
+            {
+                segment_report = hogwild::train_in_parallel(opts.nr_worker, batch_idx, segment_end,
+                    [&train_batch, &batch_list](unsigned idx, hogwild::WorkerReport &report)
+                {
+                    train_batch(batch_list[idx], report);
+                });
+                // the parameters are updated by the workers, the scores cached in the current process are stale.
+                slm.get_nn()->notify_parameters_changed();
+            }
+            else
+            {
+                for( unsigned idx = batch_idx; idx < segment_end; ++idx ){ train_batch(batch_list[idx], segment_report); }
+            }
+            // record loss
+            training_stat_per_epoch.loss += segment_report.loss;
+            training_stat_per_epoch.total_tags += segment_report.nr_tag;
+            nr_trained_instance += segment_report.nr_instance;
+            batch_idx = segment_end;
             // do devel at every `do_devel_freq` and if update error, just exit the current process
-            if( 0 == line_cnt_for_devel % opts.do_devel_freq )
+            if( line_cnt_for_devel >= opts.do_devel_freq )
             {
-                line_cnt_for_devel = 0; // clear
+                line_cnt_for_devel %= opts.do_devel_freq;
                 do_devel_in_training(nr_epoch, ++nr_devel_order);
                 if( !update_recorder.is_training_ok() ){ break;  }
             }
@@ -345,7 +749,11 @@ train(SLModel &slm,
         // 3. output info at end of every eopch
         std::ostringstream tmp_sos;
         tmp_sos << "-- Epoch " << nr_epoch << "/" << opts.max_epoch << " finished .\n";
-        std::cerr << training_stat_per_epoch.get_stat_str(tmp_sos.str()) << "\n";
+        std::cerr << training_stat_per_epoch.get_stat_str(tmp_sos.str()) << "\n"
+            << "| Speed(sentence) = " << nr_trained_instance / std::max(1.f, 
+                static_cast<float>(training_stat_per_epoch.get_time_cost_in_seconds()))
+            << " sentences/s (batch size " << opts.batch_size << ", "
+            << (is_hogwild ? opts.nr_worker : 1U) << " worker)\n";
         total_time_cost_in_seconds += training_stat_per_epoch.get_time_cost_in_seconds();
         // do validation at every ends of epoch
         if( update_recorder.is_training_ok() )
@@ -356,6 +764,7 @@ train(SLModel &slm,
         // check angin! (previous devel process may change the state.)
         if( !update_recorder.is_training_ok() ){ break; }
     }
+    finish_pending_devel();
     if( !update_recorder.is_training_ok() )
     { 
         std::cerr << "! Gradient may have been updated error ! Exit ahead of time.\n" ; 
@@ -368,62 +777,94 @@ train(SLModel &slm,
     return update_recorder.get_record_list();
 }
 
+/**
+ * devel by `nr_worker` processes (in current process if `nr_worker` <= 1).
+ * @return F1
+ */
 template <typename SLModel>
-float devel(SLModel &slm, const std::vector<typename SLModel::AnnotatedDataProcessedT> &devel_data)
+float devel(SLModel &slm, const typename SLModel::AnnotatedDatasetT &devel_data, unsigned nr_worker)
 {
-    unsigned nr_samples = devel_data.size();
-    std::cerr << "+ Validation at " << nr_samples << " instances.\n";
-
-    stat::SegmentorStat stat(true);
-    stat.start_time_stat();
-    eval::SegmenterEval eval_ins;
-    eval_ins.start_eval();
-    for( unsigned access_idx = 0; access_idx < nr_samples; ++access_idx )
-    {
-        const typename SLModel::AnnotatedDataProcessedT &instance = devel_data[access_idx];
-        std::vector<Index> pred_tagseq = slm.predict(
-            slm.get_token_module()->extract_unannotated_data_from_annotated_data(instance));
-        eval_ins.eval_iteratively(*instance.ptagseq, pred_tagseq);
-    }
-    stat.end_time_stat();
-    eval::EvalResultT eval_result = eval_ins.end_eval();
-    stat.nr_token_predict = eval_result.nr_token_predict;
-    stat.total_tags = eval_result.nr_tag;
-    std::ostringstream tmp_sos;
-    tmp_sos << "= Validation finished. \n"
-        << "| Acc = " << eval_result.acc << "% , P = " << eval_result.p 
-        << "% , R = " << eval_result.r << "% , F1 = " << eval_result.f1 << "%";
-    std::cerr << stat.get_stat_str(tmp_sos.str()) << "\n";
-    return eval_result.f1;
+    modelhandler_inner::DevelRunner<SLModel> devel_runner(slm, devel_data, nr_worker, nr_worker > 1);
+    devel_runner.start();
+    return devel_runner.finish();
 }
 
+/**
+ * predict in streaming mode.
+ * read `chunk_size` lines, predict and write them, then the next chunk. so the memory is bounded by the chunk size,
+ * the input can be a pipe (stdin), and the output of every chunk is flushed as soon as it is ready.
+ */
 template <typename SLModel>
 void predict(SLModel &slm,
     std::istream &is,
-    std::ostream &os)
+    std::ostream &os,
+    unsigned chunk_size)
 {
-    std::vector<typename SLModel::UnannotatedDataProcessedT> test_data;
-    std::vector<typename SLModel::UnannotatedDataRawT> test_raw_data;
-    read_test_data(is, slm, test_data, test_raw_data);
-    std::cerr << "+ Do prediction on " << test_data.size() << " instances .\n";
+    chunk_size = std::max(chunk_size, 1U);
+    std::cerr << "+ Do prediction in streaming mode (chunk size " << chunk_size << ") .\n";
     BasicStat stat(true);
     stat.start_time_stat();
-    writer::SegmentorWriter writer_ins(os, charcode::EncodingDetector::get_detector()->get_encoding(), WordOutputDelimiter());
-    for (unsigned int i = 0; i < test_data.size(); ++i)
+    charcode::EncodingType encoding = charcode::EncodingDetector::get_detector()->detect_and_set_encoding(is);
+    unsigned long nr_instance = modelhandler_inner::predict_stream(slm, is, os, encoding, chunk_size, stat);
+    stat.end_time_stat();
+    std::cerr << "+ Predicted instance : " << nr_instance << "\n";
+    std::cerr << stat.get_stat_str("+ Predict done.") << "\n";
+}
+
+/**
+ * streaming predict by `nr_worker` processes (see `utils::predict_in_parallel`).
+ * the model is loaded once and shared by the workers. chunks are predicted in parallel and written in input order.
+ */
+template <typename SLModel>
+void predict_in_parallel(SLModel &slm,
+    std::istream &is,
+    std::ostream &os,
+    unsigned nr_worker,
+    unsigned chunk_size)
+{
+    chunk_size = std::max(chunk_size, 1U);
+    if( nr_worker <= 1 || !utils::is_parallel_predict_supported() )
     {
-        typename SLModel::UnannotatedDataRawT &raw_instance = test_raw_data[i];
-        typename SLModel::UnannotatedDataProcessedT &instance = test_data[i];
-        if (0 == raw_instance.size())
-        {
-            writer_ins.write({}, {});
-            continue;
-        }
-        std::vector<Index> pred_tagseq = slm.predict(instance);
-        writer_ins.write(raw_instance, pred_tagseq);
-        stat.total_tags += pred_tagseq.size() ;
+        predict(slm, is, os, chunk_size);
+        return;
     }
-    stat.end_time_stat() ;
-    std::cerr << stat.get_stat_str("+ Predict done.") << "\n" ;
+    std::cerr << "+ Do prediction by " << nr_worker << " workers (chunk size " << chunk_size << ") .\n";
+    // detected once on the input, every chunk is read in the same encoding.
+    charcode::EncodingType encoding = charcode::EncodingDetector::get_detector()->detect_and_set_encoding(is);
+    auto predict_func = [&slm, encoding, chunk_size](std::istream &chunk_is, std::ostream &chunk_os)
+    {
+        BasicStat stat(true);
+        modelhandler_inner::predict_stream(slm, chunk_is, chunk_os, encoding, chunk_size, stat);
+    };
+    auto start_time = std::chrono::high_resolution_clock::now();
+    unsigned long nr_instance = utils::predict_in_parallel(is, os, predict_func, nr_worker, chunk_size);
+    double time_cost = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+    std::cerr << "+ Predicted instance : " << nr_instance << "\n"
+        << "+ Predict done.\n"
+        << "| Time cost = " << time_cost << " s\n"
+        << "| Speed = " << (time_cost > 0. ? nr_instance / time_cost : 0.) << " sentences/s\n"
+        << "= - - - - -\n";
+}
+
+/**
+ * long-running predict service on unix socket `socket_path`, served by `nr_worker` processes.
+ * a connection is a stream of raw lines (the client shuts down writing when done), the response is the segmented lines.
+ */
+template <typename SLModel>
+void serve(SLModel &slm,
+    const std::string &socket_path,
+    unsigned nr_worker,
+    unsigned chunk_size)
+{
+    chunk_size = std::max(chunk_size, 1U);
+    // clients talk as the console does.
+    charcode::EncodingType encoding = charcode::EncodingDetector::get_console_encoding();
+    auto predict_func = [&slm, encoding, chunk_size](std::istream &conn_is, std::ostream &conn_os)
+    {
+        BasicStat stat(true);
+        modelhandler_inner::predict_stream(slm, conn_is, conn_os, encoding, chunk_size, stat);
+    };
+    utils::serve_on_unix_socket(socket_path, predict_func, std::max(nr_worker, 1U));
 }
 
 
@@ -0,0 +1,81 @@
+#ifndef SLNN_SEGMENTER_CWS_MODULE_CWS_HOGWILD_TRAINER_H_
+#define SLNN_SEGMENTER_CWS_MODULE_CWS_HOGWILD_TRAINER_H_
+#include <string>
+#include <cctype>
+#include "utils/parallel_reduce.hpp"
+namespace slnn{
+namespace segmenter{
+namespace modelhandler{
+namespace hogwild{
+
+/**
+ * Hogwild style parallel training.
+ * DyNet allows only one ComputationGraph in a process, so the workers are processes instead of threads:
+ * 1. the model parameters are moved to shared memory (see `share_parameters_among_processes`) before training;
+ * 2. for a range of batches, `nr_worker` processes are forked (see `utils::reduce_in_parallel`). every worker
+ *    owns its graph, pulls batch index from a shared atomic cursor and updates the shared parameters without lock;
+ * 3. the coordinating process waits for all the workers, then it can do devel / stash on the updated parameters.
+ * the updates from different workers interleave, so the training is not deterministic.
+ * not available with the CUDA backend, the parameters in device memory can't be shared this way.
+ */
+
+struct WorkerReport
+{
+    double loss;
+    unsigned long nr_tag;
+    unsigned long nr_instance;
+    WorkerReport() : loss(0.), nr_tag(0UL), nr_instance(0UL){}
+    WorkerReport& operator+=(const WorkerReport &other)
+    {
+        loss += other.loss;
+        nr_tag += other.nr_tag;
+        nr_instance += other.nr_instance;
+        return *this;
+    }
+};
+
+inline
+bool is_supported()
+{
+    return utils::is_parallel_reduce_supported();
+}
+
+/**
+ * the optimizer state (momentum, squared gradient sum, moments ...) lives in every worker process and is dropped
+ * when the worker exits at the end of a range, so only the stateless update method (plain sgd) is supported.
+ */
+inline
+bool is_update_method_supported(const std::string &update_method)
+{
+    std::string name(update_method);
+    for( char &c : name ){ c = ::tolower(c); }
+    return name == "sgd";
+}
+
+/**
+ * train batches in [batch_begin, batch_end) by `nr_worker` processes.
+ * @param train_batch callable as `void(unsigned batch_idx, WorkerReport &report)`, called in worker processes.
+ * @return the merged report of all workers.
+ */
+template <typename TrainBatchFunc>
+WorkerReport train_in_parallel(unsigned nr_worker, unsigned batch_begin, unsigned batch_end,
+    TrainBatchFunc train_batch);
+
+
+/**************************************
+ * Template Implementation
+ **************************************/
+
+template <typename TrainBatchFunc>
+WorkerReport train_in_parallel(unsigned nr_worker, unsigned batch_begin, unsigned batch_end,
+    TrainBatchFunc train_batch)
+{
+    return utils::reduce_in_parallel<WorkerReport>(nr_worker, batch_begin, batch_end, train_batch);
+}
+
+} // end of namespace hogwild
+} // end of namespace modelhandler
+} // end of namespace segmenter
+} // end of namespace slnn
+
+#endif
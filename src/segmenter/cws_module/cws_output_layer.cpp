@@ -26,14 +26,19 @@ void CWSSimpleOutput::build_output(const std::vector<dynet::expr::Expression> &e
     }
     std::vector<Index> tmp_pred_out(len);
     Index pre_tag_id = -1 ;
+    // the hidden states of the first (len - 1) positions are stacked as columns,
+    // so the score matrix is built by one merge, one nonlinear and one dense node, and fetched at once.
+    std::vector<dynet::expr::Expression> scored_expr_cont1(expr_cont1.begin(), expr_cont1.end() - 1),
+        scored_expr_cont2(expr_cont2.begin(), expr_cont2.begin() + (len - 1));
+    dynet::expr::Expression merge_out_expr = hidden_layer.build_graph_on_cols(scored_expr_cont1, scored_expr_cont2);
+    dynet::expr::Expression nonlinear_expr = nonlinear_func(merge_out_expr);
+    std::vector<dynet::real> score_list = dynet::as_vector(pcg->get_value(
+        dynet::expr::colwise_add(output_layer.w_exp * nonlinear_expr, output_layer.b_exp)));
+    size_t output_dim = score_list.size() / (len - 1);
     for (size_t i = 0; i < len - 1; ++i)
     {
-        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph(expr_cont1[i], expr_cont2[i]);
-        dynet::expr::Expression nonlinear_expr = nonlinear_func(merge_out_expr);
-        dynet::expr::Expression out_expr = output_layer.build_graph(nonlinear_expr);
-        std::vector<dynet::real> out_probs = dynet::as_vector(pcg->get_value(out_expr));
-        
-        Index max_prob_tag_in_constrain = select_pred_tag_in_constrain(out_probs , i , pre_tag_id );
+        Index max_prob_tag_in_constrain = select_pred_tag_in_constrain(score_list.data() + i * output_dim,
+            output_dim, i , pre_tag_id );
         tmp_pred_out[i] = max_prob_tag_in_constrain ;
         pre_tag_id = max_prob_tag_in_constrain ;
     }
@@ -42,12 +47,12 @@ void CWSSimpleOutput::build_output(const std::vector<dynet::expr::Expression> &e
     std::swap(pred_out_seq, tmp_pred_out);
 }
 
-Index CWSSimpleOutput::select_pred_tag_in_constrain(std::vector<dynet::real> &dist, size_t pos , Index pre_tag_id)
+Index CWSSimpleOutput::select_pred_tag_in_constrain(const dynet::real *dist, size_t tag_num, size_t pos , Index pre_tag_id)
 {
     // dist value must bigger than zero
     dynet::real max_prob = std::numeric_limits<dynet::real>::lowest() ;
     Index selected_tag = -1 ;
-    for( size_t cur_tag_id = 0 ; cur_tag_id < dist.size() ; ++cur_tag_id )
+    for( size_t cur_tag_id = 0 ; cur_tag_id < tag_num ; ++cur_tag_id )
     {
         if( !tag_sys.can_emit(pos, cur_tag_id) ) continue ;
         if( pos > 0 && !tag_sys.can_trans(pre_tag_id, cur_tag_id) ) continue ;
@@ -85,45 +90,30 @@ void CWSPretagOutput::build_output(const std::vector<dynet::expr::Expression> &e
         pred_seq = { tag_sys.S_ID } ;
         return ;
     }
-    IndexSeq tmp_pred(len) ;
-    dynet::expr::Expression pretag_exp = parameter(*pcg, TAG_SOS) ;
-    Index pre_tag_id = -1 ;
-    for( size_t i = 0; i < len-1; ++i )
+    // the last tag is determined by the previous tag, so only the first (len - 1) tags are decoded.
+    auto score_func = [this, &expr_cont1, &expr_cont2](size_t i, const IndexSeq &pretag_list, std::vector<dynet::real> &score_list)
     {
-        dynet::expr::Expression merge_out_expr = hidden_layer.build_graph(expr_cont1[i], expr_cont2[i], pretag_exp);
+        std::vector<dynet::expr::Expression> pretag_part_expr_list(pretag_list.size());
+        for( size_t k = 0; k < pretag_list.size(); ++k ){ pretag_part_expr_list[k] = get_pretag_part_expr(pretag_list[k]); }
+        dynet::expr::Expression merge_out_expr = dynet::expr::colwise_add(dynet::expr::concatenate_cols(pretag_part_expr_list),
+            hidden_layer.build_graph_except_last(expr_cont1[i], expr_cont2[i]));
         dynet::expr::Expression nonlinear_expr = (*nonlinear_func)(merge_out_expr);
-        dynet::expr::Expression out_expr = output_layer.build_graph(nonlinear_expr);
-        std::vector<dynet::real> dist = as_vector(pcg->get_value(out_expr)) ;
-        Index id_of_constrained_max_prob = select_pred_tag_in_constrain(dist, i, pre_tag_id) ;
-        tmp_pred[i] = id_of_constrained_max_prob ;
-        pretag_exp = lookup(*pcg, tag_lookup_param,id_of_constrained_max_prob) ;
-        pre_tag_id = id_of_constrained_max_prob ;
-    }
-    // the last tag has already been determined . (pre_tag can't be -1 ! assert in `select_pred_tag_in_constrain` has ensured it !)
+        score_list = as_vector(pcg->get_value(output_layer.build_graph_on_matrix(nonlinear_expr))) ;
+    };
+    auto is_valid = [this](size_t pos, Index pre_tag_id, Index cur_tag_id)
+    {
+        return tag_sys.can_emit(pos, cur_tag_id) && ( pos == 0 || tag_sys.can_trans(pre_tag_id, cur_tag_id) ) ;
+    };
+    IndexSeq tmp_pred ;
+    beam_decoder.decode(len - 1, tag_num, score_func, is_valid, tmp_pred) ;
+    Index pre_tag_id = tmp_pred.back() ;
+    tmp_pred.resize(len) ;
+    // the last tag has already been determined . (pre_tag can't be -1 ! the decoder only selects the valid tag .)
     if( pre_tag_id == tag_sys.B_ID || pre_tag_id == tag_sys.M_ID ){ tmp_pred[len - 1] = tag_sys.E_ID ; }
     else { tmp_pred[len - 1] = tag_sys.S_ID ; }
     std::swap(pred_seq, tmp_pred) ;
 }
 
-Index CWSPretagOutput::select_pred_tag_in_constrain(std::vector<dynet::real> &dist, size_t pos , Index pre_tag_id)
-{
-    // dist value must bigger than zero
-    dynet::real max_prob = std::numeric_limits<dynet::real>::lowest() ;
-    Index selected_tag = -1 ;
-    for( size_t cur_tag_id = 0 ; cur_tag_id < dist.size() ; ++cur_tag_id )
-    {
-        if( !tag_sys.can_emit(pos, cur_tag_id) ) continue ;
-        if( pos > 0 && !tag_sys.can_trans(pre_tag_id, cur_tag_id) ) continue ;
-        if( dist[cur_tag_id] > max_prob )
-        {
-            max_prob = dist[cur_tag_id] ;
-            selected_tag = cur_tag_id ;
-        }
-    }
-    assert(selected_tag != -1) ;
-    return selected_tag ;
-}
-
 /************** CWS CRF OUTPUT *****************/
 
 CWSCRFOutput::CWSCRFOutput(dynet::Model *m,
@@ -144,7 +134,6 @@ CWSCRFOutput::build_output_loss(const std::vector<dynet::expr::Expression> &expr
 {
     size_t len = expr_cont1.size() ;
     // viterbi data preparation
-    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
     std::vector<dynet::expr::Expression> init_score(tag_num);
     std::vector<dynet::expr::Expression> trans_score(tag_num * tag_num);
     std::vector<std::vector<dynet::expr::Expression>> emit_score(len,
@@ -152,10 +141,9 @@ CWSCRFOutput::build_output_loss(const std::vector<dynet::expr::Expression> &expr
     std::vector<dynet::expr::Expression> cur_score_expr_cont(tag_num),
         pre_score_expr_cont(tag_num);
     std::vector<dynet::expr::Expression> gold_score_expr_cont(len) ;
-    // init tag expr , init score
+    // init score
     for( size_t i = 0; i < tag_num ; ++i )
     {
-        all_tag_expr_cont[i] = dynet::expr::lookup(*pcg, tag_lookup_param, i);
         init_score[i] = dynet::expr::lookup(*pcg, init_score_lookup_param, i);
     }
     // init translation score
@@ -169,16 +157,13 @@ CWSCRFOutput::build_output_loss(const std::vector<dynet::expr::Expression> &expr
         }
     }
     // init emit score
+    dynet::expr::Expression emit_score_expr = build_emit_score_expr(expr_cont1, expr_cont2, true);
     for( size_t time_step = 0; time_step < len; ++time_step )
     {
         for( size_t i = 0; i < tag_num; ++i )
         {
             if( !tag_sys.can_emit(time_step, i) ) continue ;
-            dynet::expr::Expression hidden_out_expr = hidden_layer.build_graph(expr_cont1[time_step],
-                                                                             expr_cont2[time_step], all_tag_expr_cont[i]);
-            dynet::expr::Expression non_linear_expr = (*nonlinear_func)(hidden_out_expr) ;
-            dynet::expr::Expression dropout_expr = dropout(non_linear_expr, dropout_rate) ;
-            emit_score[time_step][i] = emit_layer.build_graph(dropout_expr);
+            emit_score[time_step][i] = dynet::expr::pick(emit_score_expr, i + tag_num * time_step);
         }
     }
     // viterbi docoding
@@ -242,7 +227,6 @@ void CWSCRFOutput::build_output(const std::vector<dynet::expr::Expression> &expr
         return ;
     }
     // viterbi data preparation
-    std::vector<dynet::expr::Expression> all_tag_expr_cont(tag_num);
     std::vector<dynet::real> init_score(tag_num , std::numeric_limits<dynet::real>::min());
     std::vector < dynet::real> trans_score(tag_num * tag_num);
     std::vector<std::vector<dynet::real>> emit_score(len, std::vector<dynet::real>(tag_num));
@@ -264,21 +248,14 @@ void CWSCRFOutput::build_output(const std::vector<dynet::expr::Expression> &expr
             trans_score[flat_idx] = dynet::as_scalar(pcg->get_value(trans_score_expr)) ;
         }
     }
-    // get emit score
-    for( size_t i = 0; i < tag_num ; ++i )
-    {
-        all_tag_expr_cont[i] = dynet::expr::lookup(*pcg, tag_lookup_param, i);
-    }
+    // get emit score, in one fetch
+    std::vector<dynet::real> flat_emit_score = dynet::as_vector(pcg->get_value(build_emit_score_expr(expr_cont1, expr_cont2, false)));
     for( size_t time_step = 0; time_step < len; ++time_step )
     {
         for( size_t i = 0; i < tag_num; ++i )
         {
             if( !tag_sys.can_emit(time_step, i) ) continue ;
-            dynet::expr::Expression hidden_out_expr = hidden_layer.build_graph(expr_cont1[time_step],
-                                                                             expr_cont2[time_step], all_tag_expr_cont[i]);
-            dynet::expr::Expression non_linear_expr = (*nonlinear_func)(hidden_out_expr) ;
-            dynet::expr::Expression emit_expr = emit_layer.build_graph(non_linear_expr);
-            emit_score[time_step][i] = dynet::as_scalar( pcg->get_value(emit_expr) );
+            emit_score[time_step][i] = flat_emit_score[i + tag_num * time_step];
         }
     }
     // viterbi - process
@@ -22,7 +22,7 @@ struct CWSSimpleOutput : SimpleOutput
                       IndexSeq &pred_out_seq);
 
 protected :
-    Index select_pred_tag_in_constrain(std::vector<dynet::real> &dist, size_t pos , Index pre_tag) ;
+    Index select_pred_tag_in_constrain(const dynet::real *dist, size_t tag_num, size_t pos , Index pre_tag) ;
 
 };
 
@@ -39,8 +39,6 @@ struct CWSPretagOutput : PretagOutput
     void build_output(const std::vector<dynet::expr::Expression> &expr_1,
                       const std::vector<dynet::expr::Expression> &expr_2,
                       IndexSeq &pred_out_seq) ;
-protected :
-    Index select_pred_tag_in_constrain(std::vector<dynet::real> &dist, size_t pos , Index pre_tag) ;
 };
 
 struct CWSCRFOutput : CRFOutput
@@ -6,31 +6,67 @@ namespace reader{
 SegmentorUnicodeReader::SegmentorUnicodeReader(std::istream &is, charcode::EncodingType f_encoding, predicateT pred_func)
     :Reader(is),
     conv(charcode::CharcodeConvertor::create_convertor(f_encoding)),
-    pred_func(pred_func)
-{}
+    pred_func(pred_func),
+    is_utf8(f_encoding == charcode::EncodingType::UTF8)
+{
+    using DelimiterFuncT = bool(*)(char32_t);
+    const DelimiterFuncT *pfunc = this->pred_func.target<DelimiterFuncT>();
+    is_default_delimiter = pfunc && *pfunc == reader_inner::is_seg_delimiter;
+}
+
+/**
+ * read a line and decode it to `out_line` (the capacity is reused).
+ * UTF8 is decoded from the block directly; other encodings go through the convertor.
+ */
+bool SegmentorUnicodeReader::read_and_decode_line(std::u32string &out_line)
+{
+    const char *line = nullptr;
+    std::size_t len = 0;
+    if( !readline_view(line, len) ){ return false; }
+    if( is_utf8 )
+    {
+        std::size_t nr_invalid = charcode::utf8::decode(line, len, out_line);
+        if( nr_invalid > 0 )
+        {
+            std::cerr << "At UTF8 string : \n" << std::string(line, len) << "\n"
+                << nr_invalid << " invalid byte(s) skipped.\n";
+        }
+    }
+    else{ out_line = conv->decode(std::string(line, len)); }
+    return true;
+}
+
+void SegmentorUnicodeReader::split_line(const std::u32string &line, std::vector<TokenSpan> &out_span_list) const
+{
+    if( is_default_delimiter ){ split_to_spans(line.data(), line.size(), reader_inner::is_seg_delimiter, out_span_list); }
+    else{ split_to_spans(line.data(), line.size(), pred_func, out_span_list); }
+}
 
 bool SegmentorUnicodeReader::read_segmented_line(std::vector<std::u32string> &out_wordseq)
 {
-    using std::swap;
-    std::string line;
-    if( !getline(is, line) ){ return false; }
-    std::u32string uline = conv->decode(line);
-    std::vector<std::u32string> wordseq;
-    boost::split(wordseq, uline, pred_func);
-    swap(out_wordseq, wordseq);
+    if( !read_and_decode_line(line_buf) ){ return false; }
+    split_line(line_buf, span_buf);
+    // assign to the existing strings, so the caller reusing `out_wordseq` doesn't allocate.
+    out_wordseq.resize(span_buf.size());
+    for( std::size_t i = 0; i < span_buf.size(); ++i )
+    {
+        out_wordseq[i].assign(line_buf, span_buf[i].first, span_buf[i].second);
+    }
     return true;
 }
 
-bool SegmentorUnicodeReader::readline(std::u32string &out_charseq)
+bool SegmentorUnicodeReader::read_segmented_line(std::u32string &out_line, std::vector<TokenSpan> &out_word_span_list)
 {
-    using std::swap;
-    std::string line;
-    if( !getline(is, line) ){ return false; }
-    std::u32string uline = conv->decode(line);
-    swap(out_charseq, uline);
+    if( !read_and_decode_line(out_line) ){ return false; }
+    split_line(out_line, out_word_span_list);
     return true;
 }
 
+bool SegmentorUnicodeReader::readline(std::u32string &out_charseq)
+{
+    return read_and_decode_line(out_charseq);
+}
+
 } // end of namespace reader
 } // end of namespace segmenter
 } // end of namespace slnn
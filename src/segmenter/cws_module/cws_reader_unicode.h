@@ -3,11 +3,10 @@
 #include <functional>
 #include <memory>
 #include <vector>
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/classification.hpp>
 #include "utils/reader.hpp"
 #include "trivial/charcode/charcode_base.hpp"
 #include "trivial/charcode/charcode_convertor.h"
+#include "trivial/charcode/utf8_decoder.h"
 namespace slnn{
 namespace segmenter{
 namespace reader{
@@ -31,10 +30,20 @@ public:
         charcode::EncodingType file_encoding=charcode::EncodingType::UTF8, 
         predicateT pred_func=reader_inner::is_seg_delimiter);
     bool read_segmented_line(std::vector<std::u32string> &out_wordseq);
+    // the words are the spans of the line, no string per word.
+    bool read_segmented_line(std::u32string &out_line, std::vector<TokenSpan> &out_word_span_list);
     bool readline(std::u32string &out_charseq);
+private:
+    bool read_and_decode_line(std::u32string &out_line);
+    void split_line(const std::u32string &line, std::vector<TokenSpan> &out_span_list) const;
 private:
     std::shared_ptr<charcode::CharcodeConvertor> conv;
     predicateT pred_func;
+    bool is_utf8;
+    bool is_default_delimiter;
+    // reused buffers
+    std::u32string line_buf;
+    std::vector<TokenSpan> span_buf;
 };
 
 } // end of namespace reader
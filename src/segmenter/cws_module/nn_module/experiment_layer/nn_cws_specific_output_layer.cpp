@@ -27,11 +27,15 @@ build_output(const std::vector<dynet::expr::Expression> &input_expr_seq, std::ve
     }
     std::vector<Index> tmp_pred_out(len);
     Index pre_tag_id = segmenter::Tag::TAG_NONE_ID;
+    // the last tag is determined by the previous one, so only (output_dim x (len - 1)) score matrix is needed.
+    // it is built and fetched at once.
+    std::vector<dynet::expr::Expression> scored_expr_seq(input_expr_seq.begin(), input_expr_seq.end() - 1);
+    std::vector<dynet::real> score_list = dynet::as_vector(pcg->get_value(softmax_layer.build_graph_on_cols(scored_expr_seq)));
+    std::size_t output_dim = score_list.size() / (len - 1);
     for (std::size_t i = 0; i < len - 1; ++i) // select first and middle tags
     {
-        dynet::expr::Expression out_expr = softmax_layer.build_graph(input_expr_seq[i]) ;
-        std::vector<dynet::real> out_probs = dynet::as_vector(pcg->get_value(out_expr));
-        Index max_prob_tag_in_constrain = segmenter::token_module::select_best_tag_constrained(out_probs , i , pre_tag_id );
+        Index max_prob_tag_in_constrain = segmenter::token_module::select_best_tag_constrained(
+            score_list.data() + i * output_dim, i, pre_tag_id);
         tmp_pred_out[i] = max_prob_tag_in_constrain ;
         pre_tag_id = max_prob_tag_in_constrain ;
     }
@@ -9,20 +9,29 @@ NnSegmenterInput1MlpAbstract::NnSegmenterInput1MlpAbstract(int argc, char **argv
     NeuralNetworkCommonInterfaceDynetImpl(argc, argv, seed)
 {}
 
-dynet::expr::Expression 
-NnSegmenterInput1MlpAbstract::build_training_graph_impl(const std::vector<Index> &charseq, 
-    const std::vector<Index> &tagseq)
+void NnSegmenterInput1MlpAbstract::new_graph()
 {
-    //clear_cg(); // !! ATTENTION !!
-    reset_cg();
+    clear_cg();
     word_expr_layer->new_graph(*get_cg());
     window_expr_generate_layer->new_graph(*get_cg());
     window_expr_processing_layer->new_graph(*get_cg());
     mlp_hidden_layer->new_graph(*get_cg());
     output_layer->new_graph(*get_cg()) ;
-    
+}
+
+dynet::expr::Expression 
+NnSegmenterInput1MlpAbstract::build_training_graph_impl(const std::vector<Index> &charseq, 
+    const std::vector<Index> &tagseq)
+{
+    new_graph();
     mlp_hidden_layer->enable_dropout();
-    
+    return build_loss_on_current_graph(charseq, tagseq);
+}
+
+dynet::expr::Expression 
+NnSegmenterInput1MlpAbstract::build_loss_on_current_graph(const std::vector<Index> &charseq, 
+    const std::vector<Index> &tagseq)
+{
     unsigned sent_len = charseq.size();
 
     std::vector<dynet::expr::Expression> word_exprs(sent_len);
@@ -41,14 +50,7 @@ NnSegmenterInput1MlpAbstract::build_training_graph_impl(const std::vector<Index>
 std::vector<Index> 
 NnSegmenterInput1MlpAbstract::predict_impl(const std::vector<Index> &charseq)
 {
-
-    reset_cg();
-    //clear_cg(); // !!!!
-    word_expr_layer->new_graph(*get_cg());
-    window_expr_generate_layer->new_graph(*get_cg());
-    window_expr_processing_layer->new_graph(*get_cg());
-    mlp_hidden_layer->new_graph(*get_cg());
-    output_layer->new_graph(*get_cg()) ;
+    new_graph();
     mlp_hidden_layer->disable_dropout();
 
     unsigned sent_len = charseq.size();
@@ -1,6 +1,8 @@
 #ifndef SLNN_SEGMENTER_CWS_MODULE_NN_MODULE_CWS_MLP_INPUT1_ABSTRACT_H_
 #define SLNN_SEGMENTER_CWS_MODULE_NN_MODULE_CWS_MLP_INPUT1_ABSTRACT_H_
 #include <functional>
+#include <vector>
+#include <stdexcept>
 #include "utils/typedeclaration.h"
 #include "segmenter/cws_module/nn_module/nn_common_interface_dynet_impl.h"
 #include "segmenter/cws_module/token_module/cws_tag_definition.h"
@@ -20,11 +22,16 @@ public:
     void build_model_structure(const StructureParamT &param);
     template <typename AnnotatedDataProcessedT>
     dynet::expr::Expression build_training_graph(const AnnotatedDataProcessedT &ann_processed_data);
+    // build all the instances of a batch in one graph, return the summed loss.
+    template <typename AnnotatedDataProcessedT>
+    dynet::expr::Expression build_batch_training_graph(const std::vector<AnnotatedDataProcessedT> &ann_processed_data_batch);
     template <typename UnannotatedDataProcessedT>
     std::vector<Index> predict(const UnannotatedDataProcessedT &unann_processed_data);
 protected:
     dynet::expr::Expression build_training_graph_impl(const std::vector<Index> &charseq, const std::vector<Index> &tagseq);
     std::vector<Index> predict_impl(const std::vector<Index> &charseq);
+    void new_graph();
+    dynet::expr::Expression build_loss_on_current_graph(const std::vector<Index> &charseq, const std::vector<Index> &tagseq);
 protected:
     std::shared_ptr<Index2ExprLayer> word_expr_layer;
     std::shared_ptr<WindowExprGenerateLayer> window_expr_generate_layer;
@@ -64,6 +71,22 @@ NnSegmenterInput1MlpAbstract::build_training_graph(const AnnotatedDataProcessedT
     return build_training_graph_impl(*ann_processed_data.pcharseq, *ann_processed_data.ptagseq);
 }
 
+template <typename AnnotatedDataProcessedT>
+dynet::expr::Expression 
+NnSegmenterInput1MlpAbstract::build_batch_training_graph(const std::vector<AnnotatedDataProcessedT> &ann_processed_data_batch)
+{
+    new_graph();
+    mlp_hidden_layer->enable_dropout();
+    std::vector<dynet::expr::Expression> loss_list;
+    loss_list.reserve(ann_processed_data_batch.size());
+    for( const AnnotatedDataProcessedT &ann_processed_data : ann_processed_data_batch )
+    {
+        loss_list.push_back(build_loss_on_current_graph(*ann_processed_data.pcharseq, *ann_processed_data.ptagseq));
+    }
+    if( loss_list.empty() ){ throw std::invalid_argument("empty batch for building training graph."); }
+    return loss_list.size() == 1 ? loss_list.front() : dynet::expr::sum(loss_list);
+}
+
 
 template <typename UnannotatedDataProcessedT>
 inline
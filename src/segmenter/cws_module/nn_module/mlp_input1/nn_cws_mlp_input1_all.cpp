@@ -4,6 +4,32 @@ namespace slnn{
 namespace segmenter{
 namespace nn_module{
 
+namespace mlp_input1_all_inner{
+
+/**
+ * out += W[:, col_begin : col_begin + dim] * e
+ * W is the column-major (hidden_dim x input_dim) parameter, so every column is continuous.
+ */
+inline
+void add_block_product(const dynet::real *w, unsigned hidden_dim, unsigned col_begin,
+    const dynet::real *e, unsigned dim, dynet::real *out)
+{
+    for( unsigned k = 0; k < dim; ++k )
+    {
+        const dynet::real *col = w + static_cast<std::size_t>(col_begin + k) * hidden_dim;
+        dynet::real ek = e[k];
+        for( unsigned j = 0; j < hidden_dim; ++j ){ out[j] += ek * col[j]; }
+    }
+}
+
+inline
+void add_vector(const dynet::real *v, unsigned dim, dynet::real *out)
+{
+    for( unsigned j = 0; j < dim; ++j ){ out[j] += v[j]; }
+}
+
+} // end of namespace mlp_input1_all_inner
+
 NnSegmenterMlpInput1All::NnSegmenterMlpInput1All(int argc, char* argv[], unsigned seed)
     :NeuralNetworkCommonInterfaceDynetImpl(argc, argv, seed)
 {}
@@ -11,7 +37,7 @@ NnSegmenterMlpInput1All::NnSegmenterMlpInput1All(int argc, char* argv[], unsigne
 
 void NnSegmenterMlpInput1All::new_graph()
 {
-    reset_cg();
+    clear_cg();
     if( unigram_embed_layer ){ unigram_embed_layer->new_graph(*get_cg()); }
     if( bigram_embed_layer ){ bigram_embed_layer->new_graph(*get_cg()); }
     if( lexicon_embed_layer_group )
@@ -30,10 +56,10 @@ void NnSegmenterMlpInput1All::new_graph()
 
 std::vector<dynet::expr::Expression> NnSegmenterMlpInput1All::concat_all_feature_as_expr(
     unsigned seq_len,
-    const std::shared_ptr<std::vector<Index>>& punigram_seq,
-    const std::shared_ptr<std::vector<Index>>& pbigram_seq,
-    const std::shared_ptr<std::vector<std::vector<Index>>>& plexicon_seq,
-    const std::shared_ptr<std::vector<Index>>& ptype_seq)
+    const trivial::corpus_cache::IndexSpan &unigram_seq,
+    const trivial::corpus_cache::IndexSpan &bigram_seq,
+    const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq,
+    const trivial::corpus_cache::IndexSpan &type_seq)
 {
     std::vector<std::vector<dynet::expr::Expression>> all_feature_list(seq_len);
     auto append_feature = [&all_feature_list, seq_len](const std::vector<dynet::expr::Expression>& feature_list)
@@ -46,13 +72,13 @@ std::vector<dynet::expr::Expression> NnSegmenterMlpInput1All::concat_all_feature
     if( unigram_embed_layer )
     {
         std::vector<dynet::expr::Expression> unigram_feature_list;
-        unigram_embed_layer->index_seq2expr_seq(*punigram_seq, unigram_feature_list);
+        unigram_embed_layer->index_seq2expr_seq(unigram_seq.data, unigram_seq.size, unigram_feature_list);
         append_feature(unigram_feature_list);
     }
     if( bigram_embed_layer )
     {
         std::vector<dynet::expr::Expression> bigram_feature_list;
-        bigram_embed_layer->index_seq2expr_seq(*pbigram_seq, bigram_feature_list);
+        bigram_embed_layer->index_seq2expr_seq(bigram_seq.data, bigram_seq.size, bigram_feature_list);
         append_feature(bigram_feature_list);
     }
     if( lexicon_embed_layer_group )
@@ -60,14 +86,14 @@ std::vector<dynet::expr::Expression> NnSegmenterMlpInput1All::concat_all_feature
         for( unsigned i = 0; i < lexicon_embed_layer_group->size(); ++i )
         {
             std::vector<dynet::expr::Expression> lexicon_feature_list;
-            (*lexicon_embed_layer_group)[i].index_seq2expr_seq((*plexicon_seq)[i], lexicon_feature_list);
+            (*lexicon_embed_layer_group)[i].index_seq2expr_seq(lexicon_seq[i].data, lexicon_seq[i].size, lexicon_feature_list);
             append_feature(lexicon_feature_list);
         }
     }
     if( type_embed_layer )
     {
         std::vector<dynet::expr::Expression> type_feature_list;
-        type_embed_layer->index_seq2expr_seq(*ptype_seq, type_feature_list);
+        type_embed_layer->index_seq2expr_seq(type_seq.data, type_seq.size, type_feature_list);
         append_feature(type_feature_list);
     }
     std::vector<dynet::expr::Expression> all_feature_concat_list(seq_len);
@@ -79,18 +105,26 @@ std::vector<dynet::expr::Expression> NnSegmenterMlpInput1All::concat_all_feature
 }
 
 
-dynet::expr::Expression NnSegmenterMlpInput1All::build_training_graph_impl(const std::shared_ptr<std::vector<Index>>& punigram_seq,
-    const std::shared_ptr<std::vector<Index>>& pbigram_seq,
-    const std::shared_ptr<std::vector<std::vector<Index>>>& plexicon_seq,
-    const std::shared_ptr<std::vector<Index>>& ptype_seq,
-    const std::shared_ptr<std::vector<Index>>& ptag_seq)
+dynet::expr::Expression NnSegmenterMlpInput1All::build_training_graph_impl(const trivial::corpus_cache::IndexSpan &unigram_seq,
+    const trivial::corpus_cache::IndexSpan &bigram_seq,
+    const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq,
+    const trivial::corpus_cache::IndexSpan &type_seq,
+    const trivial::corpus_cache::IndexSpan &tag_seq)
 {
     new_graph();
     if( mlp_hidden_layer ){ mlp_hidden_layer->enable_dropout(); }
+    return build_loss_on_current_graph(unigram_seq, bigram_seq, lexicon_seq, type_seq, tag_seq);
+}
 
-    unsigned seq_len = ptag_seq->size();
+dynet::expr::Expression NnSegmenterMlpInput1All::build_loss_on_current_graph(const trivial::corpus_cache::IndexSpan &unigram_seq,
+    const trivial::corpus_cache::IndexSpan &bigram_seq,
+    const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq,
+    const trivial::corpus_cache::IndexSpan &type_seq,
+    const trivial::corpus_cache::IndexSpan &tag_seq)
+{
+    unsigned seq_len = tag_seq.size;
     std::vector<dynet::expr::Expression> all_feature_concat_expr_list = concat_all_feature_as_expr(seq_len,
-        punigram_seq, pbigram_seq, plexicon_seq, ptype_seq);
+        unigram_seq, bigram_seq, lexicon_seq, type_seq);
 
     // generate window expr
     std::vector<std::vector<dynet::expr::Expression>> input_window_expr_list =
@@ -101,23 +135,27 @@ dynet::expr::Expression NnSegmenterMlpInput1All::build_training_graph_impl(const
     std::vector<dynet::expr::Expression> output_exprs;
     if( mlp_hidden_layer ){ mlp_hidden_layer->build_graph(input_exprs, output_exprs); }
     else{ output_exprs = std::move(input_exprs); }
-    return output_layer->build_output_loss(output_exprs, *ptag_seq);
+    return output_layer->build_output_loss(output_exprs, std::vector<Index>(tag_seq.begin(), tag_seq.end()));
 }
 
-std::vector<Index> NnSegmenterMlpInput1All::predict_impl(const std::shared_ptr<std::vector<Index>>& punigram_seq,
-    const std::shared_ptr<std::vector<Index>>& pbigram_seq,
-    const std::shared_ptr<std::vector<std::vector<Index>>>& plexicon_seq,
-    const std::shared_ptr<std::vector<Index>>& ptype_seq)
+std::vector<Index> NnSegmenterMlpInput1All::predict_impl(const trivial::corpus_cache::IndexSpan &unigram_seq,
+    const trivial::corpus_cache::IndexSpan &bigram_seq,
+    const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq,
+    const trivial::corpus_cache::IndexSpan &type_seq)
 {
     new_graph();
-    if( mlp_hidden_layer ){ mlp_hidden_layer->enable_dropout(); }
+    if( mlp_hidden_layer ){ mlp_hidden_layer->disable_dropout(); }
 
     unsigned seq_len = 0;
-    if( punigram_seq ){ seq_len = punigram_seq->size(); }
-    else if( pbigram_seq ){ seq_len = pbigram_seq->size(); }
+    if( !unigram_seq.empty() ){ seq_len = unigram_seq.size; }
+    else if( !bigram_seq.empty() ){ seq_len = bigram_seq.size; }
     else{ throw std::logic_error("at least one of {unigram, bigram} should be enable."); }
+    if( precomputation )
+    { 
+        return predict_with_precomputation(seq_len, unigram_seq, bigram_seq, lexicon_seq, type_seq); 
+    }
     std::vector<dynet::expr::Expression> all_feature_concat_expr_list = concat_all_feature_as_expr(seq_len,
-        punigram_seq, pbigram_seq, plexicon_seq, ptype_seq);
+        unigram_seq, bigram_seq, lexicon_seq, type_seq);
 
     // generate window expr
     std::vector<std::vector<dynet::expr::Expression>> input_window_expr_list =
@@ -133,6 +171,167 @@ std::vector<Index> NnSegmenterMlpInput1All::predict_impl(const std::shared_ptr<s
     return pred_tagseq;
 }
 
+bool NnSegmenterMlpInput1All::enable_precomputation(const std::vector<Index> &unigram_id_list,
+    const std::vector<Index> &bigram_id_list)
+{
+    using namespace mlp_input1_all_inner;
+    precomputation.reset();
+#if HAVE_CUDA
+    // the tables are built and summed on the host from the parameter memory, which is on device with CUDA.
+    return false;
+#endif
+    if( !mlp_hidden_layer ||
+        !dynamic_cast<experiment::WindowExprConcatLayer*>(window_expr_processing_layer.get()) )
+    {
+        return false;
+    }
+    std::shared_ptr<Precomputation> pre(new Precomputation());
+    pre->window_sz = window_expr_generate_layer->window_sz;
+    dynet::ParameterStorage *w_storage = mlp_hidden_layer->get_w_param(0).get();
+    pre->hidden_dim = w_storage->dim.rows();
+    pre->unit_dim = w_storage->dim.cols() / pre->window_sz;
+    const dynet::real *w = w_storage->values.v;
+    unsigned hidden_dim = pre->hidden_dim,
+        slot_value_sz = pre->window_sz * hidden_dim;
+    // feature tables in the order of `concat_all_feature_as_expr`
+    unsigned offset = 0;
+    auto add_table = [&pre, &offset](Index2ExprLayer &layer, const std::vector<Index> *id_list)
+    {
+        PrecomputedFeatureTable table;
+        table.lookup_param = layer.get_lookup_param();
+        dynet::LookupParameterStorage *storage = table.lookup_param.get();
+        table.offset = offset;
+        table.dim = storage->dim.rows();
+        table.id2row.assign(storage->values.size(), -1);
+        int nr_row = 0;
+        if( id_list )
+        {
+            for( Index id : *id_list )
+            {
+                if( id >= 0 && static_cast<std::size_t>(id) < table.id2row.size() && table.id2row[id] < 0 )
+                {
+                    table.id2row[id] = nr_row++;
+                }
+            }
+        }
+        else
+        {
+            for( int &row : table.id2row ){ row = nr_row++; }
+        }
+        offset += table.dim;
+        pre->feature_table_list.push_back(std::move(table));
+    };
+    if( unigram_embed_layer ){ add_table(*unigram_embed_layer, &unigram_id_list); }
+    if( bigram_embed_layer ){ add_table(*bigram_embed_layer, &bigram_id_list); }
+    if( lexicon_embed_layer_group )
+    {
+        for( Index2ExprLayer &layer : *lexicon_embed_layer_group ){ add_table(layer, nullptr); }
+    }
+    if( type_embed_layer ){ add_table(*type_embed_layer, nullptr); }
+    if( offset != pre->unit_dim ){ throw std::logic_error("precomputation: feature dim is not matched with hidden layer."); }
+    // fill W_{slot, feature} * E[id]
+    for( PrecomputedFeatureTable &table : pre->feature_table_list )
+    {
+        dynet::LookupParameterStorage *storage = table.lookup_param.get();
+        std::size_t nr_row = 0;
+        for( int row : table.id2row ){ if( row >= 0 ){ ++nr_row; } }
+        table.value.assign(nr_row * slot_value_sz, 0.f);
+        for( std::size_t id = 0; id < table.id2row.size(); ++id )
+        {
+            int row = table.id2row[id];
+            if( row < 0 ){ continue; }
+            for( unsigned slot = 0; slot < pre->window_sz; ++slot )
+            {
+                add_block_product(w, hidden_dim, slot * pre->unit_dim + table.offset, storage->values[id].v, table.dim,
+                    &table.value[row * slot_value_sz + slot * hidden_dim]);
+            }
+        }
+    }
+    // padding (the whole unit embedding)
+    pre->sos_value.assign(slot_value_sz, 0.f);
+    pre->eos_value.assign(slot_value_sz, 0.f);
+    const dynet::real *sos = window_expr_generate_layer->sos_param.get()->values.v,
+        *eos = window_expr_generate_layer->eos_param.get()->values.v;
+    for( unsigned slot = 0; slot < pre->window_sz; ++slot )
+    {
+        add_block_product(w, hidden_dim, slot * pre->unit_dim, sos, pre->unit_dim, &pre->sos_value[slot * hidden_dim]);
+        add_block_product(w, hidden_dim, slot * pre->unit_dim, eos, pre->unit_dim, &pre->eos_value[slot * hidden_dim]);
+    }
+    precomputation = pre;
+    return true;
+}
+
+std::vector<Index> NnSegmenterMlpInput1All::predict_with_precomputation(unsigned seq_len,
+    const trivial::corpus_cache::IndexSpan &unigram_seq,
+    const trivial::corpus_cache::IndexSpan &bigram_seq,
+    const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq,
+    const trivial::corpus_cache::IndexSpan &type_seq)
+{
+    using namespace mlp_input1_all_inner;
+    const Precomputation &pre = *precomputation;
+    unsigned hidden_dim = pre.hidden_dim,
+        window_sz = pre.window_sz,
+        slot_value_sz = window_sz * hidden_dim;
+    const dynet::real *w = mlp_hidden_layer->get_w_param(0).get()->values.v,
+        *b = mlp_hidden_layer->get_b_param(0).get()->values.v;
+    first_net_value_list.resize(seq_len);
+    for( std::vector<dynet::real> &net_value : first_net_value_list ){ net_value.assign(b, b + hidden_dim); }
+    // id sequences in the order of feature tables
+    std::vector<const trivial::corpus_cache::IndexSpan*> id_seq_list;
+    if( unigram_embed_layer ){ id_seq_list.push_back(&unigram_seq); }
+    if( bigram_embed_layer ){ id_seq_list.push_back(&bigram_seq); }
+    if( lexicon_embed_layer_group )
+    {
+        for( unsigned i = 0; i < lexicon_embed_layer_group->size(); ++i ){ id_seq_list.push_back(&lexicon_seq[i]); }
+    }
+    if( type_embed_layer ){ id_seq_list.push_back(&type_seq); }
+    for( std::size_t f = 0; f < id_seq_list.size(); ++f )
+    {
+        if( id_seq_list[f]->size < seq_len ){ throw std::out_of_range("feature sequence is shorter than the sentence."); }
+    }
+    // take the window layout from the generator, so the first net is the same as the one of the graph.
+    std::vector<std::vector<int>> window_unit_index_list = 
+        WindowExprGenerateLayer::generate_window_unit_index_list(seq_len, window_sz);
+    for( unsigned i = 0; i < seq_len; ++i )
+    {
+        dynet::real *out = first_net_value_list[i].data();
+        for( unsigned slot = 0; slot < window_sz; ++slot )
+        {
+            int unit_index = window_unit_index_list[i][slot];
+            if( unit_index == WindowExprGenerateLayer::SosUnitIndex )
+            { 
+                add_vector(&pre.sos_value[slot * hidden_dim], hidden_dim, out); 
+                continue;
+            }
+            if( unit_index == WindowExprGenerateLayer::EosUnitIndex )
+            { 
+                add_vector(&pre.eos_value[slot * hidden_dim], hidden_dim, out); 
+                continue;
+            }
+            for( std::size_t f = 0; f < id_seq_list.size(); ++f )
+            {
+                const PrecomputedFeatureTable &table = pre.feature_table_list[f];
+                Index id = (*id_seq_list[f])[unit_index];
+                int row = table.id2row.at(id);
+                if( row >= 0 ){ add_vector(&table.value[row * slot_value_sz + slot * hidden_dim], hidden_dim, out); }
+                else
+                {
+                    add_block_product(w, hidden_dim, slot * pre.unit_dim + table.offset,
+                        table.lookup_param.get()->values[id].v, table.dim, out);
+                }
+            }
+        }
+    }
+    std::vector<dynet::expr::Expression> output_exprs(seq_len);
+    for( unsigned i = 0; i < seq_len; ++i )
+    {
+        dynet::expr::Expression first_net_expr = dynet::expr::input(*get_cg(), { hidden_dim }, &first_net_value_list[i]);
+        output_exprs[i] = mlp_hidden_layer->build_graph_from_first_net(first_net_expr);
+    }
+    std::vector<Index> pred_tagseq;
+    output_layer->build_output(output_exprs, pred_tagseq);
+    return pred_tagseq;
+}
 
 } // end of namespace nn-module
 } // end of namespace segmenter
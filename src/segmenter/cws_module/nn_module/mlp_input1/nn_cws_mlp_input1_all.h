@@ -1,11 +1,14 @@
 #ifndef SLNN_SEGMENTER_CWS_MODULE_NN_MODULE_MLP_INPUT1_ALL_H_
 #define SLNN_SEGMNETER_CWS_MODULE_NN_MODULE_MLP_INPUT1_ALL_H_
 #include <vector>
+#include <array>
+#include <stdexcept>
 #include "dynet/expr.h"
 #include "segmenter/cws_module/nn_module/nn_common_interface_dynet_impl.h"
 #include "segmenter/cws_module/cws_output_layer.h"
 #include "segmenter/cws_module/nn_module/experiment_layer/nn_window_expr_processing_layer.h"
 #include "segmenter/cws_module/nn_module/experiment_layer/nn_cws_specific_output_layer.h"
+#include "trivial/corpus_cache/corpus_cache.h"
 #include "utils/typedeclaration.h"
 #include "utils/nn_utility.h"
 namespace slnn{
@@ -20,25 +23,49 @@ public:
     void build_model_structure(const StructureParamT &param);
     template <typename AnnotatedDataProcessedT>
     dynet::expr::Expression build_training_graph(const AnnotatedDataProcessedT &ann_processed_data);
+    // build all the instances of a batch in one graph, return the summed loss.
+    template <typename AnnotatedDataProcessedT>
+    dynet::expr::Expression build_batch_training_graph(const std::vector<AnnotatedDataProcessedT> &ann_processed_data_batch);
     template <typename UnannotatedDataProcessedT>
     std::vector<Index> predict(const UnannotatedDataProcessedT &unann_processed_data);
+    /**
+     * inference-time precomputation (Chen and Manning, 2014).
+     * with `concat` window processing, the first hidden layer net is  b + sum_{slot, feature} W_{slot, feature} * E[id],
+     * so W_{slot, feature} * E[id] is cached for the given unigram and bigram ids (and all the lexicon and type ids,
+     * whose dicts are tiny), then prediction sums the cached vectors instead of doing the big matrix multiplication.
+     * call it after the parameters are loaded; the cache is not updated by training.
+     * @return false if not supported by the model structure (no mlp hidden layer, or not concat window processing),
+     *         or with the CUDA backend (the tables are computed on host memory).
+     */
+    bool enable_precomputation(const std::vector<Index> &unigram_id_list, const std::vector<Index> &bigram_id_list);
+    void disable_precomputation(){ precomputation.reset(); }
 protected:
-    dynet::expr::Expression build_training_graph_impl(const std::shared_ptr<std::vector<Index>>& punigram_seq,
-        const std::shared_ptr<std::vector<Index>>& pbigram_seq,
-        const std::shared_ptr<std::vector<std::vector<Index>>>& plexicon_seq, 
-        const std::shared_ptr<std::vector<Index>>& ptype_seq, 
-        const std::shared_ptr<std::vector<Index>>& ptag_seq);
-    std::vector<Index> predict_impl(const std::shared_ptr<std::vector<Index>>& punigram_seq,
-        const std::shared_ptr<std::vector<Index>>& pbigram_seq,
-        const std::shared_ptr<std::vector<std::vector<Index>>>& plexicon_seq, 
-        const std::shared_ptr<std::vector<Index>>& ptype_seq);
+    dynet::expr::Expression build_training_graph_impl(const trivial::corpus_cache::IndexSpan &unigram_seq,
+        const trivial::corpus_cache::IndexSpan &bigram_seq,
+        const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq, 
+        const trivial::corpus_cache::IndexSpan &type_seq, 
+        const trivial::corpus_cache::IndexSpan &tag_seq);
+    std::vector<Index> predict_impl(const trivial::corpus_cache::IndexSpan &unigram_seq,
+        const trivial::corpus_cache::IndexSpan &bigram_seq,
+        const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq, 
+        const trivial::corpus_cache::IndexSpan &type_seq);
 private:
     void new_graph();
+    dynet::expr::Expression build_loss_on_current_graph(const trivial::corpus_cache::IndexSpan &unigram_seq,
+        const trivial::corpus_cache::IndexSpan &bigram_seq,
+        const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq, 
+        const trivial::corpus_cache::IndexSpan &type_seq, 
+        const trivial::corpus_cache::IndexSpan &tag_seq);
+    std::vector<Index> predict_with_precomputation(unsigned seq_len,
+        const trivial::corpus_cache::IndexSpan &unigram_seq,
+        const trivial::corpus_cache::IndexSpan &bigram_seq,
+        const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq,
+        const trivial::corpus_cache::IndexSpan &type_seq);
     std::vector<dynet::expr::Expression> concat_all_feature_as_expr(unsigned seq_len,
-        const std::shared_ptr<std::vector<Index>>& punigram_seq,
-        const std::shared_ptr<std::vector<Index>>& pbigram_seq,
-        const std::shared_ptr<std::vector<std::vector<Index>>>& plexicon_seq,
-        const std::shared_ptr<std::vector<Index>>& ptype_seq);
+        const trivial::corpus_cache::IndexSpan &unigram_seq,
+        const trivial::corpus_cache::IndexSpan &bigram_seq,
+        const std::array<trivial::corpus_cache::IndexSpan, 3> &lexicon_seq,
+        const trivial::corpus_cache::IndexSpan &type_seq);
 private:
     std::shared_ptr<Index2ExprLayer> unigram_embed_layer;
     std::shared_ptr<Index2ExprLayer> bigram_embed_layer;
@@ -50,6 +77,26 @@ private:
 
     std::shared_ptr<MLPHiddenLayer> mlp_hidden_layer;
     std::shared_ptr<BareOutputBase> output_layer;
+
+    struct PrecomputedFeatureTable
+    {
+        dynet::LookupParameter lookup_param;
+        unsigned offset; // offset in the unit (all features concatenated) embedding
+        unsigned dim;
+        std::vector<int> id2row; // -1 for not cached
+        std::vector<dynet::real> value; // [row][slot][hidden_dim]
+    };
+    struct Precomputation
+    {
+        std::vector<PrecomputedFeatureTable> feature_table_list; // in the concatenation order
+        std::vector<dynet::real> sos_value; // [slot][hidden_dim]
+        std::vector<dynet::real> eos_value;
+        unsigned unit_dim;
+        unsigned hidden_dim;
+        unsigned window_sz;
+    };
+    std::shared_ptr<Precomputation> precomputation;
+    std::vector<std::vector<dynet::real>> first_net_value_list; // input values of the graph, should live until forward
 };
 
 
@@ -107,16 +154,33 @@ void NnSegmenterMlpInput1All::build_model_structure(const StructureParamT& param
 template <typename AnnotatedDataProcessedT>
 dynet::expr::Expression NnSegmenterMlpInput1All::build_training_graph(const AnnotatedDataProcessedT &ann_processed_data)
 {
-    return build_training_graph_impl(ann_processed_data.punigramseq, ann_processed_data.pbigramseq,
-        ann_processed_data.plexiconseq, ann_processed_data.ptypeseq, ann_processed_data.ptagseq);
+    return build_training_graph_impl(ann_processed_data.unigramseq, ann_processed_data.bigramseq,
+        ann_processed_data.lexiconseq, ann_processed_data.typeseq, ann_processed_data.tagseq);
+}
+
+template <typename AnnotatedDataProcessedT>
+dynet::expr::Expression 
+NnSegmenterMlpInput1All::build_batch_training_graph(const std::vector<AnnotatedDataProcessedT> &ann_processed_data_batch)
+{
+    new_graph();
+    if( mlp_hidden_layer ){ mlp_hidden_layer->enable_dropout(); }
+    std::vector<dynet::expr::Expression> loss_list;
+    loss_list.reserve(ann_processed_data_batch.size());
+    for( const AnnotatedDataProcessedT &ann_processed_data : ann_processed_data_batch )
+    {
+        loss_list.push_back(build_loss_on_current_graph(ann_processed_data.unigramseq, ann_processed_data.bigramseq,
+            ann_processed_data.lexiconseq, ann_processed_data.typeseq, ann_processed_data.tagseq));
+    }
+    if( loss_list.empty() ){ throw std::invalid_argument("empty batch for building training graph."); }
+    return loss_list.size() == 1 ? loss_list.front() : dynet::expr::sum(loss_list);
 }
 
 
 template <typename UnannotatedDataProcessedT>
 std::vector<Index> NnSegmenterMlpInput1All::predict(const UnannotatedDataProcessedT &unann_processed_data)
 {
-    return predict_impl(unann_processed_data.punigramseq, unann_processed_data.pbigramseq,
-        unann_processed_data.plexiconseq, unann_processed_data.ptypeseq);
+    return predict_impl(unann_processed_data.unigramseq, unann_processed_data.bigramseq,
+        unann_processed_data.lexiconseq, unann_processed_data.typeseq);
 }
 
 } // end of namespace nn module
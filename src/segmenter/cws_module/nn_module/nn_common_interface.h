@@ -28,6 +28,7 @@ public:
     void set_update_method(const std::string &optmization_name);
     void update(slnn::type::real scale);
     void update_epoch();
+    void flush_lazy_update();
     const NnValueT& forward(const NnExprType&);
     slnn::type::real as_scalar(const NnValueT&);
     std::vector<slnn::type::real> as_vector(const NnValueT&);
@@ -36,6 +37,8 @@ public:
     void stash_model();
     bool stash_model_when_best(slnn::type::real current_score);
     bool reset2stashed_model();
+    void stash_pending_model();
+    bool stash_pending_model_when_best(slnn::type::real pending_score);
 };
 
 } // end of namespace nn-module
@@ -1,10 +1,27 @@
 #include <iostream>
+#include <cstring>
+#include <stdexcept>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 #include "nn_common_interface_dynet_impl.h"
 
 namespace slnn{
 namespace segmenter{
 namespace nn_module{
 
+NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
+~NeuralNetworkCommonInterface()
+{
+    delete trainer;
+    delete sparse_trainer;
+    delete pgraph;
+    delete dynet_model;
+#ifndef _WIN32
+    if( shared_param_mem ){ munmap(shared_param_mem, shared_param_mem_sz); }
+#endif
+}
+
 void 
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 set_update_method(const std::string &optmization_name)
@@ -35,12 +52,101 @@ set_update_method(const std::string &optmization_name)
     {
         trainer = new dynet::AdamTrainer(dynet_model);
     }
+    // only the touched rows of lookup parameters are updated, @see slnn::LazySparseTrainer
+    else if( opt_norm_name == "sparse_momentum" )
+    {
+        sparse_trainer = new slnn::LazySparseTrainer(dynet_model, slnn::LazySparseTrainer::Method::Momentum);
+    }
+    else if( opt_norm_name == "sparse_adagrad" )
+    {
+        sparse_trainer = new slnn::LazySparseTrainer(dynet_model, slnn::LazySparseTrainer::Method::Adagrad);
+    }
+    else if( opt_norm_name == "sparse_adam" )
+    {
+        sparse_trainer = new slnn::LazySparseTrainer(dynet_model, slnn::LazySparseTrainer::Method::Adam);
+    }
     else
     {
         throw std::invalid_argument(std::string("un-supported optimization method : '") + optmization_name + std::string("'"));
     }
 }
 
+/**
+ * move all the parameter values of the model to an anonymous shared memory block,
+ * so processes forked after this call read and update the same parameters (gradients are still process-local).
+ * should be called after the model structure has been built.
+ */
+void
+NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
+share_parameters_among_processes()
+{
+#if HAVE_CUDA
+    // the parameters live in device memory, which can't be mapped into the shared host block.
+    throw std::logic_error("sharing parameters among processes is not supported with the CUDA backend.");
+#elif !defined(_WIN32)
+    if( is_parameters_shared() ){ return; }
+    if( sparse_trainer )
+    {
+        // the lazy update state is allocated and flushed in every worker, the pending updates would be lost.
+        throw std::logic_error("sparse update methods can't be used with shared (hogwild) parameters.");
+    }
+    // keep every tensor 32 bytes aligned, as dynet's memory pool does.
+    auto aligned_sz = [](const dynet::Tensor &t) -> std::size_t
+    {
+        return (t.d.size() * sizeof(float) + 31U) / 32U * 32U;
+    };
+    std::size_t total_sz = 0;
+    for( dynet::ParameterStorage *p : dynet_model->parameters_list() ){ total_sz += aligned_sz(p->values); }
+    for( dynet::LookupParameterStorage *p : dynet_model->lookup_parameters_list() )
+    {
+        for( const dynet::Tensor &t : p->values ){ total_sz += aligned_sz(t); }
+    }
+    if( total_sz == 0 ){ return; }
+    void *mem = mmap(nullptr, total_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if( mem == MAP_FAILED ){ throw std::runtime_error("failed to map shared memory for parameters."); }
+    char *cur = static_cast<char*>(mem);
+    auto move2shared = [&cur, &aligned_sz](dynet::Tensor &t)
+    {
+        std::memcpy(cur, t.v, t.d.size() * sizeof(float));
+        t.v = reinterpret_cast<float*>(cur);
+        cur += aligned_sz(t);
+    };
+    for( dynet::ParameterStorage *p : dynet_model->parameters_list() ){ move2shared(p->values); }
+    for( dynet::LookupParameterStorage *p : dynet_model->lookup_parameters_list() )
+    {
+        for( dynet::Tensor &t : p->values ){ move2shared(t); }
+    }
+    shared_param_mem = mem;
+    shared_param_mem_sz = total_sz;
+#else
+    throw std::logic_error("sharing parameters among processes is not supported on this platform.");
+#endif
+}
+
+/**
+ * write the binary model container, parameter tensors are in model order:
+ * all parameters, then every row of all lookup parameters.
+ */
+void
+NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
+write_binary_model(std::ostream &os, const std::string &dict_bytes) const
+{
+    dynet_binary_model::write_binary_model(os, dict_bytes, dynet_model);
+}
+
+/**
+ * use the parameter data in the mapped binary model in place (no copy).
+ * the model structure should have been built, and the tensor order is the same as `write_binary_model`.
+ */
+void
+NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
+bind_parameters(std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_file)
+{
+    dynet_binary_model::bind_parameters(dynet_model, *mapped_file);
+    mapped_model_file = mapped_file;
+    notify_parameters_changed();
+}
+
 } // end of namespace nn-module
 } // end of namespace segmenter
 } // end of namespace slnn
\ No newline at end of file
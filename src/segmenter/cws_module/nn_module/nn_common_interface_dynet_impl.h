@@ -1,12 +1,20 @@
 #ifndef SLNN_SEGMENTER_CWS_MODULE_NN_MODULE_NN_COMMON_INTERFACE_CNN_IMPL_H_
 #define SLNN_SEGMENTER_CWS_MODULE_NN_MODULE_NN_COMMON_INTERFACE_CNN_IMPL_H_
 #include <sstream>
+#include <memory>
+#include <utility>
 #include <boost/log/trivial.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/serialization/access.hpp>
 #include "dynet/dynet.h"
 #include "dynet/training.h"
+#include "trivial/model_container/binary_model_container.h"
+#include "utils/dynet_binary_model.hpp"
+#include "utils/parameter_snapshot.hpp"
+#include "utils/lazy_sparse_trainer.hpp"
+#include "utils/reusable_graph.hpp"
+#include "modelmodule/viterbi_decoder.h"
 #include "nn_common_interface.h"
 namespace slnn{
 namespace segmenter{
@@ -27,9 +35,11 @@ public:
     // training
     void set_update_method(const std::string &optmization_name);
     void set_optimizer_params(float learning_rate, float eta_decay);
-    float get_current_learning_rate(){ return trainer->eta; };
+    float get_current_learning_rate(){ return sparse_trainer ? sparse_trainer->eta : trainer->eta; };
     void update(slnn::type::real scale);
     void update_epoch();
+    // apply the pending update of the lookup parameter rows skipped by the sparse trainer (no-op for the others).
+    void flush_lazy_update(){ if( sparse_trainer ){ sparse_trainer->flush(); } }
     const NnValueT& forward(const NnExprT&);
     slnn::type::real as_scalar(const NnValueT&);
     std::vector<slnn::type::real> as_vector(const NnValueT&);
@@ -38,22 +48,39 @@ public:
     void stash_model();
     bool stash_model_when_best(slnn::type::real current_score);
     bool reset2stashed_model();
+    // asynchronous devel: the parameters at devel time are pending, they are stashed when the devel score is the best.
+    void stash_pending_model();
+    bool stash_pending_model_when_best(slnn::type::real pending_score);
+    // parallel(hogwild) training
+    void share_parameters_among_processes();
+    bool is_parameters_shared() const { return shared_param_mem != nullptr; }
+    // binary model
+    void write_binary_model(std::ostream &os, const std::string &dict_bytes) const;
+    void bind_parameters(std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_file);
+    // should be called after the parameters are overwritten out of `update` (restore, load, bind, hogwild workers),
+    // to drop the score cached from the old parameters (CRF transition and init score).
+    void notify_parameters_changed(){ ViterbiDecoder::clear_all_score(); }
 public:
-    void clear_cg(){ pcg->clear(); }; // ! BUG: using clear() will cause Error -> DyNet get dim error!(BUG for it.)
-    void reset_cg(){ delete pcg; pcg = new dynet::ComputationGraph(); }
+    // drop the last graph, the graph (and its memory) is reused. @see slnn::ReusableGraph
+    void clear_cg(){ pgraph->renew(); }
 protected:
-    dynet::ComputationGraph* get_cg(){ return pcg; }
+    dynet::ComputationGraph* get_cg(){ return &pgraph->get(); }
     dynet::Model* get_dynet_model(){ return dynet_model; }
 private:
     template <typename Archive>
     void serialize(Archive &ar, const unsigned version);
 private:
     slnn::type::real best_score;
-    std::stringstream best_model_tmp_ss;
+    slnn::ParameterSnapshot best_model_snapshot;
+    slnn::ParameterSnapshot pending_model_snapshot;
     dynet::Trainer *trainer;
-    dynet::ComputationGraph *pcg;
+    slnn::LazySparseTrainer *sparse_trainer; // for the `sparse_*` update methods, `trainer` is nullptr then.
+    slnn::ReusableGraph *pgraph;
     dynet::Model *dynet_model;
     unsigned dynet_rng_seed;
+    void *shared_param_mem;
+    std::size_t shared_param_mem_sz;
+    std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_model_file;
 };
 
 using NeuralNetworkCommonInterfaceDynetImpl = NeuralNetworkCommonInterface<nn_framework::NN_DyNet, 
@@ -67,21 +94,15 @@ inline
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 NeuralNetworkCommonInterface(int argc, char **argv, unsigned seed)
     :best_score(0.f),
-    best_model_tmp_ss(""),
     trainer(nullptr),
-    pcg(new dynet::ComputationGraph()),
-    dynet_model(new dynet::Model())
+    sparse_trainer(nullptr),
+    pgraph(nullptr),
+    dynet_model(new dynet::Model()),
+    shared_param_mem(nullptr),
+    shared_param_mem_sz(0)
 {
     dynet::initialize(argc, argv, seed); 
-}
-
-inline
-NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
-~NeuralNetworkCommonInterface()
-{
-    delete trainer;
-    delete pcg;
-    delete dynet_model;
+    pgraph = new slnn::ReusableGraph(); // checkpoint needs the initialized device
 }
 
 inline
@@ -89,8 +110,16 @@ void
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 set_optimizer_params(float learning_rate, float eta_decay)
 {
-    trainer->eta0 = learning_rate;
-    trainer->eta_decay = eta_decay;
+    if( sparse_trainer )
+    {
+        sparse_trainer->eta0 = sparse_trainer->eta = learning_rate;
+        sparse_trainer->eta_decay = eta_decay;
+    }
+    else
+    {
+        trainer->eta0 = learning_rate;
+        trainer->eta_decay = eta_decay;
+    }
 }
 
 
@@ -99,7 +128,8 @@ void
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 update(slnn::type::real scale)
 {
-    trainer->update(scale);
+    if( sparse_trainer ){ sparse_trainer->update(scale); }
+    else{ trainer->update(scale); }
 }
 
 inline
@@ -107,7 +137,8 @@ void
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 update_epoch()
 {
-    trainer->update_epoch();
+    if( sparse_trainer ){ sparse_trainer->update_epoch(); }
+    else{ trainer->update_epoch(); }
 }
 
 inline
@@ -115,7 +146,7 @@ const NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expressi
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 forward(const NnExprT& expr)
 {
-    return pcg->incremental_forward(expr);
+    return pgraph->get().incremental_forward(expr);
 }
 
 inline
@@ -139,7 +170,7 @@ void
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 backward(const NnExprT& expr)
 {
-    pcg->backward(expr);
+    pgraph->get().backward(expr);
 }
 
 inline 
@@ -147,9 +178,7 @@ void
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 stash_model()
 {
-    best_model_tmp_ss.str(""); // first , clear it's content !
-    boost::archive::text_oarchive to(best_model_tmp_ss); // to construct a text_oarchive using stringstream
-    to << *dynet_model;
+    best_model_snapshot.take(dynet_model);
 }
 
 inline 
@@ -172,10 +201,29 @@ bool
 NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
 reset2stashed_model()
 {
-    if( best_model_tmp_ss.rdbuf()->in_avail() != 0 )
+    bool is_restored = best_model_snapshot.restore(dynet_model);
+    if( is_restored ){ notify_parameters_changed(); }
+    return is_restored;
+}
+
+inline 
+void 
+NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
+stash_pending_model()
+{
+    pending_model_snapshot.take(dynet_model);
+}
+
+inline 
+bool 
+NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dynet::Tensor>::
+stash_pending_model_when_best(slnn::type::real pending_score)
+{
+    if( pending_score > best_score )
     {
-        boost::archive::text_iarchive ti(best_model_tmp_ss);
-        ti >> *dynet_model;
+        best_score = pending_score;
+        std::swap(best_model_snapshot, pending_model_snapshot); // the buffer of the old best is reused as pending
+        std::cerr << " * better model found and stashed done.\n";
         return true;
     }
     else { return false; }
@@ -188,6 +236,7 @@ NeuralNetworkCommonInterface<nn_framework::NN_DyNet, dynet::expr::Expression, dy
 serialize(Archive &ar, const unsigned version)
 {
     ar & *dynet_model;
+    if( Archive::is_loading::value ){ notify_parameters_changed(); }
 }
 
 } // end of namespace nn-module
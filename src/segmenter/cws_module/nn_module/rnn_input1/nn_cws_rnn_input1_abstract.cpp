@@ -9,17 +9,27 @@ NnSegmenterRnnInput1Abstract::NnSegmenterRnnInput1Abstract(int argc, char **argv
     NeuralNetworkCommonInterfaceDynetImpl(argc, argv, seed)
 {}
 
-dynet::expr::Expression 
-NnSegmenterRnnInput1Abstract::build_training_graph_impl(const std::vector<Index> &charseq, 
-    const std::vector<Index> &tagseq)
+void NnSegmenterRnnInput1Abstract::new_graph()
 {
-    //clear_cg(); // !! ATTENTION !! dynet's implementation is not successful. so abandon it.
-    reset_cg();
+    clear_cg();
     word_expr_layer->new_graph(*get_cg());
     birnn_layer->new_graph(*get_cg());
     output_layer->new_graph(*get_cg()) ;
-    
+}
+
+dynet::expr::Expression 
+NnSegmenterRnnInput1Abstract::build_training_graph_impl(const std::vector<Index> &charseq, 
+    const std::vector<Index> &tagseq)
+{
+    new_graph();
     birnn_layer->set_dropout();
+    return build_loss_on_current_graph(charseq, tagseq);
+}
+
+dynet::expr::Expression 
+NnSegmenterRnnInput1Abstract::build_loss_on_current_graph(const std::vector<Index> &charseq, 
+    const std::vector<Index> &tagseq)
+{
     birnn_layer->start_new_sequence();
 
     unsigned sent_len = charseq.size();
@@ -41,12 +51,7 @@ NnSegmenterRnnInput1Abstract::build_training_graph_impl(const std::vector<Index>
 std::vector<Index> 
 NnSegmenterRnnInput1Abstract::predict_impl(const std::vector<Index> &charseq)
 {
-    //clear_cg(); // !!!!
-    reset_cg();
-    word_expr_layer->new_graph(*get_cg());
-    birnn_layer->new_graph(*get_cg());
-    output_layer->new_graph(*get_cg()) ;
-    
+    new_graph();
     birnn_layer->disable_dropout();
     birnn_layer->start_new_sequence();
 
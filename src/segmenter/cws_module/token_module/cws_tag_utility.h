@@ -15,8 +15,12 @@ namespace token_module{
 /****************************************************
  * Inline Implementation
  ****************************************************/
+/**
+ * select the tag with max score which is valid at `time` after `pre_time_tag_id`.
+ * `dist` points to the (at least TAG_SIZE) scores of the time, e.g. a column of the score matrix.
+ */
 inline
-Index select_best_tag_constrained(const std::vector<dynet::real> &dist, size_t time, Index pre_time_tag_id)
+Index select_best_tag_constrained(const dynet::real *dist, size_t time, Index pre_time_tag_id)
 {
     dynet::real max_prob = std::numeric_limits<dynet::real>::lowest();
     Index tag_with_max_prob = Tag::TAG_NONE_ID;
@@ -35,6 +39,12 @@ Index select_best_tag_constrained(const std::vector<dynet::real> &dist, size_t t
     return tag_with_max_prob;
 }
 
+inline
+Index select_best_tag_constrained(const std::vector<dynet::real> &dist, size_t time, Index pre_time_tag_id)
+{
+    return select_best_tag_constrained(dist.data(), time, pre_time_tag_id);
+}
+
 }
 }
 } // end of namespace slnn
@@ -8,7 +8,7 @@ std::u32string TokenSegmenterInput1All::EOS_REPR = U"<EOS>";
 
 TokenSegmenterInput1All::TokenSegmenterInput1All(unsigned seed) noexcept
     :unigram_dict(seed),
-    bigram_dict(seed),
+    bigram_dict(EOS_REPR, seed),
     lexicon_feat(),
     state()
 {}
@@ -1,7 +1,12 @@
 #ifndef SLNN_SEGMENTER_CWS_MODULE_TOKEN_MODULE_INPUT1_ALL_H_
 #define SLNN_SEGMENTER_CWS_MODULE_TOKEN_MODULE_INPUT1_ALL_H_
 #include <numeric>
+#include <algorithm>
+#include <array>
+#include <type_traits>
 #include "trivial/lookup_table/lookup_table.h"
+#include "trivial/lookup_table/bigram_lookup_table.h"
+#include "trivial/corpus_cache/channel_corpus.h"
 #include "segmenter/cws_module/token_module/cws_tag_definition.h"
 #include "trivial/charcode/charcode_convertor.h"
 #include "utils/typedeclaration.h"
@@ -43,6 +48,36 @@ void TokenModuleState::serialize(Archive &ar, const unsigned int)
         &tag_dict_sz;
 }
 
+/**
+ * the `top_k` most frequent (in training data) indices of the dict, in frequency decreasing order.
+ * unk index (if set) is always appended, since it is frequent in prediction.
+ */
+template <typename LookupTableT>
+std::vector<Index> get_frequent_index_list(const LookupTableT &dict, std::size_t top_k)
+{
+    std::vector<Index> index_list(dict.size_without_unk());
+    std::iota(index_list.begin(), index_list.end(), 0);
+    top_k = std::min(top_k, index_list.size());
+    std::partial_sort(index_list.begin(), index_list.begin() + top_k, index_list.end(),
+        [&dict](Index lhs, Index rhs){ return dict.count_ban_unk(lhs) > dict.count_ban_unk(rhs); });
+    index_list.resize(top_k);
+    if( dict.has_set_unk() ){ index_list.push_back(dict.get_unk_idx()); }
+    return index_list;
+}
+
+// channels of the corpus, lexicon feature has 3 channels. the disabled feature has empty channel.
+enum CorpusChannel : std::size_t
+{
+    UnigramChannel = 0,
+    BigramChannel,
+    LexiconChannel,
+    TypeChannel = LexiconChannel + 3,
+    TagChannel,
+    CorpusChannelNum
+};
+
+static_assert(std::is_same<Index, std::int32_t>::value, "corpus arena stores Index as int32.");
+
 } // end of namespace input1_all_token_module_inner
 
 /**
@@ -68,39 +103,50 @@ class TokenSegmenterInput1All
 {
     friend class boost::serialization::access;
 public:
-    struct AnnotatedDataProcessedT
+    /**
+     * processed data are span views, the disabled feature has empty span.
+     * the sequences of annotated data are in the arenas of `AnnotatedCorpus`, the others (unannotated data,
+     * unk-replaced data) are in `pbuffer`, so copying the data is cheap.
+     */
+    struct UnannotatedDataProcessedT
     {
-        std::shared_ptr<std::vector<Index>> punigramseq;
-        std::shared_ptr<std::vector<Index>> pbigramseq;
-        std::shared_ptr<std::vector<std::vector<int>>> plexiconseq;
-        std::shared_ptr<std::vector<Index>> ptypeseq;
-        std::shared_ptr<std::vector<Index>> ptagseq;
-        AnnotatedDataProcessedT() : punigramseq(nullptr), pbigramseq(nullptr), 
-            plexiconseq(nullptr), ptypeseq(nullptr), ptagseq(nullptr){}
-        std::size_t size() const 
-        { 
-            if( punigramseq ){ return punigramseq->size(); }
-            else if( pbigramseq ){ return pbigramseq->size(); }
-            else{ throw std::logic_error("at least one of {unigram, bigram} should be enable."); }
-        }
+        trivial::corpus_cache::IndexSpan unigramseq;
+        trivial::corpus_cache::IndexSpan bigramseq;
+        std::array<trivial::corpus_cache::IndexSpan, 3> lexiconseq;
+        trivial::corpus_cache::IndexSpan typeseq;
+        std::shared_ptr<const std::vector<Index>> pbuffer;
+        UnannotatedDataProcessedT() : unigramseq(), bigramseq(), lexiconseq(), typeseq(), pbuffer(nullptr){}
+        std::size_t size() const { return std::max(unigramseq.size, bigramseq.size); }
     };
-    using AnnotatedDataRawT = std::vector<std::u32string>;
-    struct UnannotatedDataProcessedT
+    struct AnnotatedDataProcessedT : public UnannotatedDataProcessedT
     {
-        std::shared_ptr<std::vector<Index>> punigramseq;
-        std::shared_ptr<std::vector<Index>> pbigramseq;
-        std::shared_ptr<std::vector<std::vector<int>>> plexiconseq;
-        std::shared_ptr<std::vector<Index>> ptypeseq;
-        UnannotatedDataProcessedT() : punigramseq(nullptr), pbigramseq(nullptr), 
-            plexiconseq(nullptr), ptypeseq(nullptr){}
-        std::size_t size() const
-        {
-            if( punigramseq ){ return punigramseq->size(); }
-            else if( pbigramseq ){ return pbigramseq->size(); }
-            else{ throw std::logic_error("at least one of {unigram, bigram} should be enable."); }
-        }
+        trivial::corpus_cache::IndexSpan tagseq;
+        AnnotatedDataProcessedT() : UnannotatedDataProcessedT(), tagseq(){}
+        std::size_t size() const { return tagseq.size; }
+        std::vector<Index> get_tagseq() const { return std::vector<Index>(tagseq.begin(), tagseq.end()); }
     };
+    using AnnotatedDataRawT = std::vector<std::u32string>;
     using UnannotatedDataRawT = std::u32string;
+    /**
+     * annotated data set in structure-of-arrays layout (@see trivial::corpus_cache::ChannelCorpus),
+     * `operator[]` gives the span view of an instance.
+     */
+    class AnnotatedCorpus
+    {
+    public:
+        AnnotatedCorpus() : corpus(input1_all_token_module_inner::CorpusChannelNum){}
+        explicit AnnotatedCorpus(std::shared_ptr<const trivial::corpus_cache::MappedCorpusCache> cache);
+        std::size_t size() const { return corpus.size(); }
+        bool empty() const { return corpus.empty(); }
+        AnnotatedDataProcessedT operator[](std::size_t idx) const;
+        void reserve(std::size_t nr_instance){ corpus.reserve(nr_instance); }
+        void shrink_to_fit(){ corpus.shrink_to_fit(); }
+        const trivial::corpus_cache::ChannelCorpus& get_channel_corpus() const { return corpus; }
+        trivial::corpus_cache::ChannelCorpus& get_channel_corpus() { return corpus; }
+    private:
+        trivial::corpus_cache::ChannelCorpus corpus;
+    };
+    using AnnotatedDatasetT = AnnotatedCorpus;
 public:
     explicit TokenSegmenterInput1All(unsigned seed) noexcept;
 
@@ -108,14 +154,10 @@ public:
     // DATA TRANSLATING
     UnannotatedDataProcessedT
         extract_unannotated_data_from_annotated_data(const AnnotatedDataProcessedT &ann_data) const;
-    // WE DO NOT use current class-defined data structure. 
-    // ideally, we'll process the derived class-defined data.
-    template <typename ProcessedAnnotatedDataT> 
-    ProcessedAnnotatedDataT replace_low_freq_token2unk(const ProcessedAnnotatedDataT & in_data) const;
-    template <typename ProcessedAnnotatedDataT>
-    void process_annotated_data(const std::vector<std::u32string> &raw_in, ProcessedAnnotatedDataT &out);
-    template <typename ProcessedUnannotatedDataT>
-    void process_unannotated_data(const std::u32string &raw_in, ProcessedUnannotatedDataT &out) const;
+    AnnotatedDataProcessedT replace_low_freq_token2unk(const AnnotatedDataProcessedT &in_data) const;
+    // process and append to the corpus arenas
+    void append_annotated_data(const std::vector<std::u32string> &raw_in, AnnotatedCorpus &out_corpus);
+    void process_unannotated_data(const std::u32string &raw_in, UnannotatedDataProcessedT &out) const;
 
     // PARAM INTERFACE (only for training)
     template <typename StructureParamT>
@@ -126,6 +168,10 @@ public:
     // MODULE INFO
     std::string get_module_info() const noexcept;
     const input1_all_token_module_inner::TokenModuleState& get_token_state() const noexcept { return state; }
+    std::vector<Index> get_frequent_unigram_index_list(std::size_t top_k) const
+    { return input1_all_token_module_inner::get_frequent_index_list(unigram_dict, top_k); }
+    std::vector<Index> get_frequent_bigram_index_list(std::size_t top_k) const
+    { return input1_all_token_module_inner::get_frequent_index_list(bigram_dict, top_k); }
 
 protected:
     void set_unk_replace_threshold(unsigned cnt_threshold, float prob_threshold) noexcept;
@@ -136,8 +182,8 @@ private:
 
 private:
     slnn::trivial::LookupTableWithReplace<char32_t>  unigram_dict;
-    static std::u32string EOS_REPR;
-    slnn::trivial::LookupTableWithReplace<std::u32string> bigram_dict;
+    static std::u32string EOS_REPR; // only for the serialization of the end-of-sentence bigram
+    slnn::trivial::BigramLookupTableWithReplace bigram_dict;
     TokenLexicon lexicon_feat;
     // TokenChartype is a static class
     input1_all_token_module_inner::TokenModuleState state;
@@ -148,50 +194,74 @@ private:
  * Inline/Template Implementation
  *******************/
 
+inline
+TokenSegmenterInput1All::AnnotatedCorpus::AnnotatedCorpus(
+    std::shared_ptr<const trivial::corpus_cache::MappedCorpusCache> cache)
+    :corpus(cache)
+{
+    if( corpus.get_channel_num() != input1_all_token_module_inner::CorpusChannelNum )
+    {
+        throw std::runtime_error("corpus cache: channel number is not matched with the token module.");
+    }
+}
+
+inline
+TokenSegmenterInput1All::AnnotatedDataProcessedT
+TokenSegmenterInput1All::AnnotatedCorpus::operator[](std::size_t idx) const
+{
+    using namespace input1_all_token_module_inner;
+    AnnotatedDataProcessedT ann_data;
+    ann_data.unigramseq = corpus.get_span(UnigramChannel, idx);
+    ann_data.bigramseq = corpus.get_span(BigramChannel, idx);
+    for( std::size_t row = 0; row < 3U; ++row ){ ann_data.lexiconseq[row] = corpus.get_span(LexiconChannel + row, idx); }
+    ann_data.typeseq = corpus.get_span(TypeChannel, idx);
+    ann_data.tagseq = corpus.get_span(TagChannel, idx);
+    return ann_data;
+}
+
 inline
 TokenSegmenterInput1All::UnannotatedDataProcessedT
 TokenSegmenterInput1All::extract_unannotated_data_from_annotated_data(const AnnotatedDataProcessedT &ann_data) const
 {
-    UnannotatedDataProcessedT unann_data;
-    unann_data.punigramseq = ann_data.punigramseq;
-    unann_data.pbigramseq = ann_data.pbigramseq;
-    unann_data.plexiconseq = ann_data.plexiconseq;
-    unann_data.ptypeseq = ann_data.ptypeseq;
-    return unann_data;
+    return ann_data; // just the feature part of the view
 }
 
-template <typename ProcessedAnnotatedDataT> 
-ProcessedAnnotatedDataT 
-TokenSegmenterInput1All::replace_low_freq_token2unk(const ProcessedAnnotatedDataT & in_data) const
+/**
+ * replaced unigram and bigram sequences are in a new buffer, the others are still the views of the input.
+ * the input should be the view of corpus (whose owner lives longer).
+ */
+inline
+TokenSegmenterInput1All::AnnotatedDataProcessedT
+TokenSegmenterInput1All::replace_low_freq_token2unk(const AnnotatedDataProcessedT &in_data) const
 {
-    ProcessedAnnotatedDataT rep_data(in_data);
-    unsigned seqlen = in_data.size();
-    if(rep_data.punigramseq)
+    using trivial::corpus_cache::IndexSpan;
+    AnnotatedDataProcessedT rep_data(in_data);
+    std::shared_ptr<std::vector<Index>> pbuffer =
+        std::make_shared<std::vector<Index>>(in_data.unigramseq.size + in_data.bigramseq.size);
+    Index *cur = pbuffer->data();
+    if( !in_data.unigramseq.empty() )
     {
-        rep_data.punigramseq = std::shared_ptr<std::vector<Index>>(new std::vector<Index>(*in_data.punigramseq));
-        for( unsigned i = 0; i < seqlen; ++i )
-        {
-            Index &uni_idx = (*rep_data.punigramseq)[i];
-            uni_idx = unigram_dict.unk_replace_in_probability(uni_idx);
-        }
+        std::size_t seqlen = in_data.unigramseq.size;
+        for( std::size_t i = 0; i < seqlen; ++i ){ cur[i] = unigram_dict.unk_replace_in_probability(in_data.unigramseq[i]); }
+        rep_data.unigramseq = IndexSpan{ cur, seqlen };
+        cur += seqlen;
     }
-    if(rep_data.pbigramseq)
+    if( !in_data.bigramseq.empty() )
     {
-        rep_data.pbigramseq = std::shared_ptr<std::vector<Index>>(new std::vector<Index>(*in_data.pbigramseq));
-        for(unsigned i = 0; i < seqlen; ++i)
-        {
-            Index &bi_idx = (*rep_data.pbigramseq)[i];
-            bi_idx = bigram_dict.unk_replace_in_probability(bi_idx);
-        }
+        std::size_t seqlen = in_data.bigramseq.size;
+        for( std::size_t i = 0; i < seqlen; ++i ){ cur[i] = bigram_dict.unk_replace_in_probability(in_data.bigramseq[i]); }
+        rep_data.bigramseq = IndexSpan{ cur, seqlen };
     }
+    rep_data.pbuffer = pbuffer;
     return rep_data;
 }
 
 
-template <typename ProcessedAnnotatedDataT>
-void 
-TokenSegmenterInput1All::process_annotated_data(const std::vector<std::u32string>& wordseq, ProcessedAnnotatedDataT &ann_data)
+inline
+void TokenSegmenterInput1All::append_annotated_data(const std::vector<std::u32string>& wordseq, AnnotatedCorpus &corpus)
 {
+    using namespace input1_all_token_module_inner;
+    trivial::corpus_cache::ChannelCorpus &channel_corpus = corpus.get_channel_corpus();
     unsigned charseq_len = std::accumulate(wordseq.begin(), wordseq.end(), 0,
     [](const unsigned &lhs_len, const std::u32string& rhs)
     {
@@ -204,79 +274,105 @@ TokenSegmenterInput1All::process_annotated_data(const std::vector<std::u32string
     {
         for( char32_t uc : word ){ charseq[pos++] = uc; }
     }
+    // every sequence is appended to its channel arena, through one reused buffer.
+    std::vector<Index> seq(charseq_len);
     // unigram seq
     if( state.enable_unigram )
     {
-        std::shared_ptr<std::vector<Index>> &puni_seq = ann_data.punigramseq;
-        puni_seq.reset(new std::vector<Index>(charseq_len));
         for( pos = 0; pos < charseq_len; ++pos )
         {
-            (*puni_seq)[pos] = unigram_dict.convert(charseq[pos]);
+            seq[pos] = unigram_dict.convert(charseq[pos]);
         }
+        channel_corpus.get_channel_builder(UnigramChannel).append(seq);
     }
+    else{ channel_corpus.get_channel_builder(UnigramChannel).append_empty(); }
     // bigram seq
     if( state.enable_bigram )
     {
-        std::shared_ptr<std::vector<Index>> &pbi_seq = ann_data.pbigramseq;
-        pbi_seq.reset(new std::vector<Index>(charseq_len));
         for( pos = 0; pos < charseq_len - 1; ++pos )
         {
-            (*pbi_seq)[pos] = bigram_dict.convert(charseq.substr(pos, 2));
+            seq[pos] = bigram_dict.convert(charseq[pos], charseq[pos + 1]);
         }
-        pbi_seq->back() = bigram_dict.convert(charseq.back() + EOS_REPR);
+        seq.back() = bigram_dict.convert(charseq.back(), trivial::BigramLookupTableWithReplace::EosChar);
+        channel_corpus.get_channel_builder(BigramChannel).append(seq);
     }
+    else{ channel_corpus.get_channel_builder(BigramChannel).append_empty(); }
     // lexicon seq
     if( state.enable_lexicon )
     {
-        ann_data.plexiconseq = lexicon_feat.extract(charseq);
+        std::shared_ptr<std::vector<std::vector<Index>>> plexicon_seq = lexicon_feat.extract(charseq);
+        for( std::size_t row = 0; row < 3U; ++row )
+        {
+            channel_corpus.get_channel_builder(LexiconChannel + row).append((*plexicon_seq)[row]);
+        }
+    }
+    else
+    {
+        for( std::size_t row = 0; row < 3U; ++row ){ channel_corpus.get_channel_builder(LexiconChannel + row).append_empty(); }
     }
     // type seq
     if( state.enable_type )
     {
-        ann_data.ptypeseq = TokenChartype::extract(charseq);
+        TokenChartype::extract(charseq, seq.data());
+        channel_corpus.get_channel_builder(TypeChannel).append(seq);
     }
+    else{ channel_corpus.get_channel_builder(TypeChannel).append_empty(); }
     // tag seq
-    ann_data.ptagseq.reset(new std::vector<Index>(charseq_len));
-    generate_tagseq_from_wordseq2preallocated_space(wordseq, *ann_data.ptagseq);
+    generate_tagseq_from_wordseq2preallocated_space(wordseq, seq);
+    channel_corpus.get_channel_builder(TagChannel).append(seq);
 }
 
 
-template <typename ProcessedUnannotatedDataT>
-void 
-TokenSegmenterInput1All::process_unannotated_data(const std::u32string &charseq, ProcessedUnannotatedDataT &unann_data) const
+inline
+void TokenSegmenterInput1All::process_unannotated_data(const std::u32string &charseq, UnannotatedDataProcessedT &unann_data) const
 {
+    using trivial::corpus_cache::IndexSpan;
     unsigned charseq_len = charseq.length();
+    // all the enabled sequences are in one buffer
+    unsigned nr_seq = static_cast<unsigned>(state.enable_unigram) + static_cast<unsigned>(state.enable_bigram) +
+        (state.enable_lexicon ? 3U : 0U) + static_cast<unsigned>(state.enable_type);
+    std::shared_ptr<std::vector<Index>> pbuffer = std::make_shared<std::vector<Index>>(nr_seq * charseq_len);
+    Index *cur = pbuffer->data();
+    unann_data = UnannotatedDataProcessedT();
     // unigram seq
     if( state.enable_unigram )
     {
-        std::shared_ptr<std::vector<Index>> &puni_seq = unann_data.punigramseq;
-        puni_seq.reset(new std::vector<Index>(charseq_len));
         for(unsigned pos = 0; pos < charseq_len; ++pos )
         {
-            (*puni_seq)[pos] = unigram_dict.convert(charseq[pos]);
+            cur[pos] = unigram_dict.convert(charseq[pos]);
         }
+        unann_data.unigramseq = IndexSpan{ cur, charseq_len };
+        cur += charseq_len;
     }
     // bigram seq
     if( state.enable_bigram )
     {
-        std::shared_ptr<std::vector<Index>> &pbi_seq = unann_data.pbigramseq;
-        pbi_seq.reset(new std::vector<Index>(charseq_len));
         for(unsigned pos = 0; pos < charseq_len - 1; ++pos )
         {
-            (*pbi_seq)[pos] = bigram_dict.convert(charseq.substr(pos, 2));
+            cur[pos] = bigram_dict.convert(charseq[pos], charseq[pos + 1]);
         }
-        pbi_seq->back() = bigram_dict.convert(charseq.back() + EOS_REPR);
+        cur[charseq_len - 1] = bigram_dict.convert(charseq.back(), trivial::BigramLookupTableWithReplace::EosChar);
+        unann_data.bigramseq = IndexSpan{ cur, charseq_len };
+        cur += charseq_len;
     }
     // lexicon seq
     if( state.enable_lexicon )
     {
-        unann_data.plexiconseq = lexicon_feat.extract(charseq);
+        std::shared_ptr<std::vector<std::vector<Index>>> plexicon_seq = lexicon_feat.extract(charseq);
+        for( std::size_t row = 0; row < 3U; ++row )
+        {
+            std::copy((*plexicon_seq)[row].begin(), (*plexicon_seq)[row].end(), cur);
+            unann_data.lexiconseq[row] = IndexSpan{ cur, charseq_len };
+            cur += charseq_len;
+        }
     }
     // type seq
     if( state.enable_type )
     {
-        unann_data.ptypeseq = TokenChartype::extract(charseq);
+        TokenChartype::extract(charseq, cur);
+        unann_data.typeseq = IndexSpan{ cur, charseq_len };
     }
+    unann_data.pbuffer = pbuffer;
 }
 
 inline
@@ -47,10 +47,12 @@ public:
         std::shared_ptr<std::vector<Index>> ptagseq;
         AnnotatedDataProcessedT() : pcharseq(nullptr), ptagseq(nullptr){}
         std::size_t size() const { return pcharseq ? pcharseq->size() : 0UL; }
+        const std::vector<Index>& get_tagseq() const { return *ptagseq; }
     };
     using AnnotatedDataRawT = std::vector<std::u32string>;
     using UnannotatedDataProcessedT = std::shared_ptr<std::vector<Index>>;
     using UnannotatedDataRawT = std::u32string;
+    using AnnotatedDatasetT = std::vector<AnnotatedDataProcessedT>;
 public:
 
     explicit TokenSegmenterInput1Unigram(unsigned seed) noexcept;
@@ -68,6 +70,7 @@ public:
     void process_annotated_data(const std::vector<std::u32string> &raw_in, ProcessedAnnotatedDataT &out);
     template <typename ProcessedUnannotatedDataT>
     void process_unannotated_data(const std::u32string &raw_in, ProcessedUnannotatedDataT &out) const;
+    void append_annotated_data(const std::vector<std::u32string> &raw_in, AnnotatedDatasetT &out_dataset);
 
     // DICT INTERFACE
     void finish_read_training_data();
@@ -122,6 +125,19 @@ Index TokenSegmenterInput1Unigram::unk_replace_in_probability(Index idx) const
 }
 
 
+/**
+ * process annotated data and append to the dataset.
+ * @param raw_in word sequence
+ * @param out_dataset dataset
+ */
+inline
+void TokenSegmenterInput1Unigram::append_annotated_data(const std::vector<std::u32string> &raw_in, AnnotatedDatasetT &out_dataset)
+{
+    AnnotatedDataProcessedT processed_data;
+    process_annotated_data(raw_in, processed_data);
+    out_dataset.push_back(std::move(processed_data));
+}
+
 /**
  * extract unannotated data from annotated data.
  * @param ann_data annotated data
@@ -1,45 +0,0 @@
-#include "token_chartype.h"
-
-namespace slnn{
-namespace segmenter{
-namespace token_module{
-
-const std::unordered_set<char32_t> TokenChartype::DigitTypeCharDict = {
-    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 
-    0xff10, 0xff11, 0xff12, 0xff13, 0xff14, 0xff15, 0xff16, 0xff17, 0xff18, 
-    0xff19, 0xff10, 0x58f9, 0x8d30, 0x53c1, 0x8086, 0x4f0d, 0x9646, 0x67d2, 0x634c, 
-    0x7396, 0x62fe, 0x4f70, 0x4edf
-};
-
-const std::unordered_set<char32_t> TokenChartype::LetterTypeCharDict = {
-
-    0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 
-    0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
-    0x79, 0x7a, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a,
-    0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56,
-    0x57, 0x58, 0x59, 0x5a, 0xff41, 0xff42, 0xff43, 0xff44, 0xff45, 0xff46,
-    0xff47, 0xff48, 0xff49, 0xff4a, 0xff4b, 0xff4c, 0xff4d, 0xff4e, 0xff4f,
-    0xff50, 0xff51, 0xff52, 0xff53, 0xff54, 0xff55, 0xff56, 0xff57, 0xff58, 
-    0xff59, 0xff5a, 0xff21, 0xff22, 0xff23, 0xff24, 0xff25, 0xff26, 0xff27,
-    0xff28, 0xff29, 0xff2a, 0xff2b, 0xff2c, 0xff2d, 0xff2e, 0xff2f, 0xff30,
-    0xff31, 0xff32, 0xff33, 0xff34, 0xff35, 0xff36, 0xff37, 0xff38, 0xff39, 
-    0xff3a
-};
-
-const std::unordered_set<char32_t> TokenChartype::PuncTypeCharDict = {
-    0xff0c, 0x3002, 0xff1f, 0xff01, 0xff1a, 0xff1b, 0x3001, 0x2026, 0x2026, 
-    0xff5e, 0xff06, 0xff20, 0xff03, 0x2c, 0x2e, 0x3f, 0x21, 0x3a, 0x3b, 0xb7, 
-    0x2026, 0x7e, 0x26, 0x40, 0x23, 0x201c, 0x201d, 0x2018, 0x2019, 0x301d, 0x301e, 
-    0x20, 0x27, 0x22, 0xff02, 0xff07, 0xb4, 0xff07, 0xff08, 0xff09, 0x3010, 0x3011, 
-    0x300a, 0x300b, 0xff1c, 0xff1e, 0xfe5d, 0xfe5e, 0x3c, 0x3e, 0x28, 0x29, 0x5b, 0x5d, 
-    0xab, 0xbb, 0x2039, 0x203a, 0x3014, 0x3015, 0x3008, 0x3009, 0x7b, 0x7d, 0xff3b, 0xff3d, 
-    0x300c, 0x300d, 0xff5b, 0xff5d, 0x3016, 0x3017, 0x300e, 0x300f, 0xfe35, 0xfe37, 0xfe39,
-    0xfe3f, 0xfe3d, 0xfe41, 0xfe43, 0xfe3b, 0xfe17, 0x2f, 0x7c, 0x5c, 0xfe36, 0xfe38, 0xfe3a, 
-    0xfe40, 0xfe3e, 0xfe42, 0xfe44, 0xfe3c, 0xfe18, 0xff0f, 0xff5c, 0xff3c, 0x2ca, 0xa8, 
-    0xad, 0x5e, 0xa1, 0xa6, 0x60, 0xfe4e, 0xfe4d, 0xfe4f, 0xff3f, 0x5f, 0xaf, 0xffe3, 
-    0xfe4b, 0xfe49, 0xfe4a, 0x2cb, 0xfe34, 0xbf, 0x2c7, 0x3000
-};
-
-} // end of namespace token_module
-} // end of namespace segmenter
-} // end of namespace slnn
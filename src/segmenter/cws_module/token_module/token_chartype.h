@@ -1,9 +1,10 @@
 #ifndef SLNN_SEGMENTER_CWS_MODULE_TOKEN_MODULE_TOKEN_CHARTYPE_H_
 #define SLNN_SEGMNETER_CWS_MODULE_TOKEN_MODULE_TOKEN_CHARTYPE_H_
-#include <unordered_set>
 #include <vector>
 #include <memory>
+#include <string>
 #include "utils/typedeclaration.h"
+#include "trivial/charcode/chartype_table.h"
 namespace slnn{
 namespace segmenter{
 namespace token_module{
@@ -18,34 +19,37 @@ public:
     static constexpr Index LetterType = 3;
 public:
     static std::shared_ptr<std::vector<Index>> extract(const std::u32string& charseq);
-private:
-    static const std::unordered_set<char32_t> DigitTypeCharDict;
-    static const std::unordered_set<char32_t> PuncTypeCharDict;
-    static const std::unordered_set<char32_t> LetterTypeCharDict;
+    // extract to the pre-allocated space (charseq.size())
+    static void extract(const std::u32string& charseq, Index *type_seq) noexcept;
 public:
-    static bool isDigit(char32_t uc) { return DigitTypeCharDict.count(uc) > 0; }
-    static bool isPunc(char32_t uc) { return PuncTypeCharDict.count(uc) > 0; }
-    static bool isLetter(char32_t uc) { return LetterTypeCharDict.count(uc) > 0; }
+    static bool isDigit(char32_t uc) { return get_table().type_of(uc) == charcode::CharTypeTable::DigitType; }
+    static bool isPunc(char32_t uc) { return get_table().type_of(uc) == charcode::CharTypeTable::PuncType; }
+    static bool isLetter(char32_t uc) { return get_table().type_of(uc) == charcode::CharTypeTable::LetterType; }
+private:
+    static const charcode::CharTypeTable& get_table() { return charcode::CharTypeTable::get_table(); }
 };
 
-inline 
+static_assert(TokenChartype::size() == charcode::CharTypeTable::TypeNum &&
+    TokenChartype::DigitType == charcode::CharTypeTable::DigitType &&
+    TokenChartype::PuncType == charcode::CharTypeTable::PuncType &&
+    TokenChartype::LetterType == charcode::CharTypeTable::LetterType, "chartype is not matched with the table.");
+
+inline
 std::shared_ptr<std::vector<Index>> TokenChartype::extract(const std::u32string& charseq)
 {
     std::shared_ptr<std::vector<Index>> type_feat(new std::vector<Index>(charseq.size()));
-    
-    for(unsigned i = 0; i < charseq.size(); ++i )
-    {
-        auto uc = charseq[i];
-        if( isPunc(uc) ){ type_feat->at(i) = PuncType; }
-        else if( isDigit(uc) ){ type_feat->at(i) = DigitType; }
-        else if( isLetter(uc) ){ type_feat->at(i) = LetterType; }
-        else{ type_feat->at(i) = DefaultType; }
-    }
+    extract(charseq, type_feat->data());
     return type_feat;
 }
 
+inline
+void TokenChartype::extract(const std::u32string& charseq, Index *type_seq) noexcept
+{
+    get_table().classify(charseq.data(), charseq.data() + charseq.size(), type_seq);
+}
+
 } // end of namespace token_module
 } // end of namespace segmenter
 } // end of namespace slnn
 
-#endif
\ No newline at end of file
+#endif
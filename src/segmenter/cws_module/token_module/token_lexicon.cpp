@@ -8,7 +8,9 @@ namespace segmenter{
 namespace token_module{
 
 TokenLexicon::TokenLexicon(unsigned maxlen4feature)
-    :maxlen4feature(maxlen4feature)
+    :maxlen4feature(maxlen4feature),
+    word_maxlen_in_lexicon(0),
+    freq_threshold(0)
 {}
 
 void TokenLexicon::build_inner_lexicon_from_training_data(std::ifstream &training_is)
@@ -18,10 +20,16 @@ void TokenLexicon::build_inner_lexicon_from_training_data(std::ifstream &trainin
     reader::SegmentorUnicodeReader reader_ins(training_is,
         charcode::EncodingDetector::get_detector()->detect_and_set_encoding(training_is));
     std::unordered_map<std::u32string, unsigned> word_cnt;
-    std::vector<std::u32string> wordseq;
-    while( reader_ins.read_segmented_line(wordseq) )
+    std::u32string line,
+        word;
+    std::vector<TokenSpan> word_span_list;
+    while( reader_ins.read_segmented_line(line, word_span_list) )
     {
-        for( const std::u32string& word : wordseq ){ ++word_cnt[word]; }
+        for( const TokenSpan &word_span : word_span_list )
+        {
+            word.assign(line, word_span.first, word_span.second);
+            ++word_cnt[word];
+        }
     }
     // copy from LTP
     std::vector<unsigned> freq_list(word_cnt.size());
@@ -44,6 +52,7 @@ void TokenLexicon::build_inner_lexicon_from_training_data(std::ifstream &trainin
     }
     // move word with at least 2 character and freqency greater than freq_threshold to lexicon
     word_maxlen_in_lexicon = 0;
+    std::vector<std::u32string> lexicon_word_list;
     for( auto iter = word_cnt.cbegin(); iter != word_cnt.cend(); ++iter )
     {
         if( iter->second >= freq_threshold )
@@ -52,11 +61,12 @@ void TokenLexicon::build_inner_lexicon_from_training_data(std::ifstream &trainin
             if( num_char > 1U) 
             {
                 // at least 2 characters
-                inner_lexicon.insert(std::move(iter->first));
+                lexicon_word_list.push_back(iter->first);
                 word_maxlen_in_lexicon = std::max(word_maxlen_in_lexicon, num_char);
             }
         }
     }
+    inner_lexicon.build(lexicon_word_list);
     // restore the training file state
     training_is.clear();
     training_is.seekg(f_pos);
@@ -71,18 +81,17 @@ std::shared_ptr<std::vector<std::vector<Index>>> TokenLexicon::extract(const std
         // 3 row, every row is the feature-abstracted sequence corresponding to the feature.
         new std::vector<std::vector<Index>>(3, std::vector<Index>(seq_len, 0))
     );
+    // chars are encoded once, then the longest word from every position is got by one trie walk.
+    std::vector<trivial::trie::DoubleArrayTrie::CodeT> codeseq;
+    inner_lexicon.encode(charseq, codeseq);
     // Max Match
     // this lexicon feature can be look as fusion Max Match Result
     for( unsigned i = 0; i < seq_len; ++i ) // index increasing one by one , instead of doing like MM which skip word 
     {
-        // Attention, substr(pos, cnt) automatically processing the situation where `pos + cnt >= len(str)`
-        std::u32string test_word = charseq.substr(i, word_maxlen_in_lexicon);
-        while( test_word.length() > 1 )
-        {
-            if( inner_lexicon.count(test_word) > 0 ){ break; }
-            test_word.pop_back();
-        }
-        unsigned wordlen = test_word.size();
+        unsigned match_end = std::min(seq_len, i + word_maxlen_in_lexicon);
+        // single char is not in lexicon, it is the default word.
+        unsigned wordlen = std::max<unsigned>(
+            inner_lexicon.longest_prefix_match(codeseq.data() + i, codeseq.data() + match_end), 1U);
         // set feature value
         // 1. word start
         (*lexicon_feat)[0][i] = wordlen - 1; // wordlen >= 1, translate to feature, we minus 1. 
@@ -1,6 +1,5 @@
 #ifndef SLNN_SEGMENTER_CWS_MODULE_TOKEN_MODULE_TOKEN_LEXICON_H_
 #define SLNN_SEGMNETER_CWS_MODULE_TOKEN_MODULE_TOKEN_LEXICON_H_
-#include <unordered_set>
 #include <string>
 #include <vector>
 #include <fstream>
@@ -8,7 +7,9 @@
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 #include "utils/typedeclaration.h"
+#include "trivial/trie/double_array_trie.h"
 namespace slnn{
 namespace segmenter{
 namespace token_module{
@@ -33,7 +34,7 @@ private:
 private:
     unsigned maxlen4feature; // pre-define.
     unsigned word_maxlen_in_lexicon; // calc according to final lexicon
-    std::unordered_set<std::u32string> inner_lexicon; // can't serialize directly
+    trivial::trie::DoubleArrayTrie inner_lexicon; // compiled lexicon for prefix matching
     unsigned freq_threshold; // the frequent threshold to dethermine where an token is a word.  (For DEBUG)
 };
 
@@ -53,35 +54,43 @@ std::string TokenLexicon::get_lexicon_feature_info() const
     return oss.str();
 }
 
+/**
+ * version 0: word list (the trie is built when loading).
+ * version 1: the compiled trie.
+ */
 template <class Archive>
 void TokenLexicon::save(Archive &ar, const unsigned int) const
 {
-    ar &maxlen4feature &word_maxlen_in_lexicon;
-    unsigned lexicon_sz = inner_lexicon.size();
-    ar &lexicon_sz;
-    for( const std::u32string& word : inner_lexicon )
-    {
-        std::vector<unsigned> unicode_pnt_list(word.begin(), word.end());
-        ar &unicode_pnt_list;
-    }
+    ar &maxlen4feature &word_maxlen_in_lexicon &freq_threshold;
+    ar &inner_lexicon;
 }
 
 template <class Archive>
-void TokenLexicon::load(Archive &ar, const unsigned int)
+void TokenLexicon::load(Archive &ar, const unsigned int version)
 {
     ar &maxlen4feature &word_maxlen_in_lexicon;
+    if( version >= 1 )
+    {
+        ar &freq_threshold;
+        ar &inner_lexicon;
+        return;
+    }
     unsigned lexicon_sz;
     ar &lexicon_sz;
+    std::vector<std::u32string> word_list(lexicon_sz);
     for( unsigned i = 0; i < lexicon_sz; ++i )
     {
         std::vector<unsigned> unicode_pnt_list;
         ar &unicode_pnt_list;
-        inner_lexicon.emplace(unicode_pnt_list.begin(), unicode_pnt_list.end());
+        word_list[i].assign(unicode_pnt_list.begin(), unicode_pnt_list.end());
     }
+    inner_lexicon.build(word_list);
 }
 
 } // end of namespace token_module
 } // end of namespace segmenter
 } // end of namespace slnn
 
+BOOST_CLASS_VERSION(slnn::segmenter::token_module::TokenLexicon, 1)
+
 #endif
\ No newline at end of file
@@ -1,23 +1,24 @@
 #ifndef SLNN_SEGMENTER_CWS_MODULE_TYPE_FEATURE_H_
 #define SLNN_SEGMENTER_CWS_MODULE_TYPE_FEATURE_H_
-#include <unordered_set>
 #include <string>
+#include <sstream>
 #include <boost/serialization/access.hpp>
 #include "utils/typedeclaration.h"
+#include "trivial/charcode/chartype_table.h"
 namespace slnn{
 
 namespace slnn_char_type{
 
+// UTF8 view of the shared char type table
 class Utf8CharTypeDict
 {
-private:
-    static const std::unordered_set<std::string> DigitTypeCharDict;
-    static const std::unordered_set<std::string> PuncTypeCharDict;
-    static const std::unordered_set<std::string> LetterTypeCharDict;
 public:
-    bool isDigit(const std::string& u8char) const { return DigitTypeCharDict.count(u8char) > 0; }
-    bool isPunc(const std::string& u8char) const { return PuncTypeCharDict.count(u8char) > 0; }
-    bool isLetter(const std::string& u8char) const { return LetterTypeCharDict.count(u8char) > 0; }
+    using TypeT = charcode::CharTypeTable::TypeT;
+    TypeT type_of(const std::string& u8char) const
+    { return charcode::CharTypeTable::get_table().type_of_u8(u8char.data(), u8char.size()); }
+    bool isDigit(const std::string& u8char) const { return type_of(u8char) == charcode::CharTypeTable::DigitType; }
+    bool isPunc(const std::string& u8char) const { return type_of(u8char) == charcode::CharTypeTable::PuncType; }
+    bool isLetter(const std::string& u8char) const { return type_of(u8char) == charcode::CharTypeTable::LetterType; }
 };
 
 } // end of namespcae slnn_char_type 
@@ -57,16 +58,12 @@ inline
 void CharTypeFeature::extract(const Seq &char_seq, IndexSeq &chartype_feature_seq) const
 {
     using std::swap;
+    static_assert(DigitType() == charcode::CharTypeTable::DigitType && PuncType() == charcode::CharTypeTable::PuncType &&
+        LetterType() == charcode::CharTypeTable::LetterType, "chartype is not matched with the table.");
     size_t len = char_seq.size();
     IndexSeq tmp_feature_seq(len);
-    for( size_t i = 0; i < len; ++i )
-    {
-        const std::string &u8char = char_seq.at(i);
-        if( getCharTypeDict().isDigit(u8char) ){ tmp_feature_seq[i] = DigitType(); }
-        else if( getCharTypeDict().isPunc(u8char) ){ tmp_feature_seq[i] = PuncType(); }
-        else if( getCharTypeDict().isLetter(u8char) ){ tmp_feature_seq[i] = LetterType(); }
-        else { tmp_feature_seq[i] = DefaultType(); }
-    }
+    const slnn_char_type::Utf8CharTypeDict &chartype_dict = getCharTypeDict();
+    for( size_t i = 0; i < len; ++i ){ tmp_feature_seq[i] = chartype_dict.type_of(char_seq[i]); }
     swap(chartype_feature_seq, tmp_feature_seq);
 }
 
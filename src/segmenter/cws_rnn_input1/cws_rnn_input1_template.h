@@ -1,9 +1,16 @@
 #ifndef SLNN_SEGMENTER_CWS_RNN_INPUT1_TEMPLATE_H_
 #define SLNN_SEGMENTER_CWS_RNN_INPUT1_TEMPLATE_H_
 #include <random>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 #include <boost/program_options/variables_map.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include "trivial/model_container/binary_model_container.h"
 #include "segmenter/cws_module/token_module/cws_tag_definition.h"
 #include "dynet/expr.h"
 namespace slnn{
@@ -19,6 +26,7 @@ public:
     using AnnotatedDataRawT = typename TokenModuleT::AnnotatedDataRawT;
     using UnannotatedDataProcessedT = typename TokenModuleT::UnannotatedDataProcessedT;
     using UnannotatedDataRawT = typename TokenModuleT::UnannotatedDataRawT;
+    using AnnotatedDatasetT = typename TokenModuleT::AnnotatedDatasetT;
     using NnExprT = typename NnModuleT::NnExprT;
     using NnValueT = typename NnModuleT::NnValueT;
 public:
@@ -39,13 +47,17 @@ public:
 public:
     static std::shared_ptr<SegmenterRnnInput1Template> create_new_model(int argc, char**argv, unsigned seed);
     static void save_model(std::ostream &os, SegmenterRnnInput1Template &m);
+    // load the model saved in text archive (the format before binary model container)
     static std::shared_ptr<SegmenterRnnInput1Template> load_and_build_model(std::istream &is, int argc, char **argv);
+    // load the model by path, binary model container will be mapped, text archive is also supported.
+    static std::shared_ptr<SegmenterRnnInput1Template> load_and_build_model(const std::string &model_path, int argc, char **argv);
     void save_model(std::ostream &os) { save_model(os, *this); }
 public:
     void set_model_structure_param_from_outer(const boost::program_options::variables_map &args);
     void finish_read_training_data();
     void build_model_structure();
     NnExprT build_training_graph(const AnnotatedDataProcessedT& ann_processed_data);
+    NnExprT build_batch_training_graph(const AnnotatedDatasetT &dataset, const std::vector<unsigned> &batch);
     std::vector<Index> predict(const UnannotatedDataProcessedT& unann_processed_data);
 private:
     TokenModuleT token_module;
@@ -81,18 +93,19 @@ void
 SegmenterRnnInput1Template<TokenModuleT, StructureParamT, NnModuleT>::
 save_model(std::ostream &os, SegmenterRnnInput1Template &m)
 {
-    boost::archive::text_oarchive to(os);
-    // 1. first save the seed.
-    unsigned seed = m.get_rng_seed();
-    to << seed; // boost can't directly serialize r-value ?
-    // 2. save param
-    to << *(m.get_param());
-    // 3. save token module
-    to << *(m.get_token_module());
-    // 4. save nn
+    // 1. dict section: seed, structure param and token module
+    std::ostringstream dict_os;
+    {
+        boost::archive::binary_oarchive to(dict_os);
+        unsigned seed = m.get_rng_seed();
+        to << seed;
+        to << *(m.get_param());
+        to << *(m.get_token_module());
+    }
+    // 2. parameter section
     //  - OH! DON't forget to reset the model to it's best state. (BUG FIX.)
     m.get_nn()->reset2stashed_model();
-    to << *(m.get_nn());
+    m.get_nn()->write_binary_model(os, dict_os.str());
 }
 
 template <typename TokenModuleT, typename StructureParamT, typename NnModuleT>
@@ -117,6 +130,34 @@ load_and_build_model(std::istream &is, int argc, char **argv)
     return m;
 }
 
+template <typename TokenModuleT, typename StructureParamT, typename NnModuleT>
+std::shared_ptr<SegmenterRnnInput1Template<TokenModuleT, StructureParamT, NnModuleT>> 
+SegmenterRnnInput1Template<TokenModuleT, StructureParamT, NnModuleT>::
+load_and_build_model(const std::string &model_path, int argc, char **argv)
+{
+    if( !trivial::model_container::is_binary_model(model_path) )
+    {
+        std::ifstream is(model_path);
+        if( !is ){ throw std::runtime_error("failed to open model: '" + model_path + "'"); }
+        return load_and_build_model(is, argc, argv);
+    }
+    std::shared_ptr<const trivial::model_container::MappedModelFile> mapped_file =
+        std::make_shared<const trivial::model_container::MappedModelFile>(model_path);
+    std::istringstream dict_is(std::string(mapped_file->get_dict_data(), mapped_file->get_dict_size()));
+    boost::archive::binary_iarchive ti(dict_is);
+    // 1. read seed, create model by the seed
+    unsigned seed;
+    ti >> seed;
+    std::shared_ptr<SegmenterRnnInput1Template> m = create_new_model(argc, argv, seed);
+    // 2. read structure param and token module
+    ti >> *m->get_param();
+    ti >> *m->get_token_module();
+    // 3. build structure, use the mapped parameters in place.
+    m->build_model_structure();
+    m->get_nn()->bind_parameters(mapped_file);
+    return m;
+}
+
 
 template <typename TokenModuleT, typename StructureParamT, typename NnModuleT>
 inline
@@ -158,6 +199,21 @@ build_training_graph(const AnnotatedDataProcessedT& ann_processed_data)
     return nn.build_training_graph(data_after_unk_replace);
 }
 
+template <typename TokenModuleT, typename StructureParamT, typename NnModuleT>
+inline
+typename SegmenterRnnInput1Template<TokenModuleT, StructureParamT, NnModuleT>::NnExprT
+SegmenterRnnInput1Template<TokenModuleT, StructureParamT, NnModuleT>::
+build_batch_training_graph(const AnnotatedDatasetT &dataset, const std::vector<unsigned> &batch)
+{
+    std::vector<AnnotatedDataProcessedT> data_after_unk_replace_batch;
+    data_after_unk_replace_batch.reserve(batch.size());
+    for( unsigned idx : batch )
+    {
+        data_after_unk_replace_batch.push_back(token_module.replace_low_freq_token2unk(dataset[idx]));
+    }
+    return nn.build_batch_training_graph(data_after_unk_replace_batch);
+}
+
 template <typename TokenModuleT, typename StructureParamT, typename NnModuleT>
 inline
 std::vector<Index> SegmenterRnnInput1Template<TokenModuleT, StructureParamT, NnModuleT>::
@@ -5,6 +5,7 @@ namespace slnn{
 
 CWSSinglePretagModel::CWSSinglePretagModel()
     :SingleInputModel() ,
+    beam_size(1U) ,
     word_dict(input_dict) ,
     tag_dict(output_dict)
 {}
@@ -23,6 +24,13 @@ void CWSSinglePretagModel::build_model_structure()
     input_layer = new Input1(m, word_dict_size, word_embedding_dim) ;
     bilstm_layer = new BILSTMLayer(m, lstm_nr_stacked_layer, word_embedding_dim, lstm_h_dim, dropout_rate) ;
     output_layer = new CWSPretagOutput(m, tag_embedding_dim, lstm_h_dim, lstm_h_dim, hidden_dim, output_dim, tag_sys) ; 
+    set_beam_size(beam_size) ;
+}
+
+void CWSSinglePretagModel::set_beam_size(unsigned beam_size)
+{
+    this->beam_size = beam_size ;
+    if( output_layer ){ static_cast<CWSPretagOutput*>(output_layer)->set_beam_size(beam_size) ; }
 }
 
 void CWSSinglePretagModel::print_model_info()
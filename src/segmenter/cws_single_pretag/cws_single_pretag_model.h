@@ -16,6 +16,7 @@ class CWSSinglePretagModel : public SingleInputModel
     friend class boost::serialization::access;
 public:
     unsigned tag_embedding_dim ;
+    unsigned beam_size ;
     
     dynet::Dict &word_dict ;
     dynet::Dict &tag_dict ;
@@ -26,6 +27,8 @@ public:
     void set_model_param(const boost::program_options::variables_map &var_map) ;
     void build_model_structure() ;
     void print_model_info() ;
+    // decoding option (not saved), can be set before or after building the model structure.
+    void set_beam_size(unsigned beam_size) ;
 
     template<typename Archive>
     void serialize(Archive &ar, const unsigned version);
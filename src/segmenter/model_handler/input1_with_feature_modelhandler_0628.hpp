@@ -2,12 +2,14 @@
 #define SLNN_SEGMENTER_INPUT1_WITH_FEATURE_MODELHANDLER_0628_H_
 
 #include <sstream>
+#include <memory>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include "segmenter/base_model/input1_with_feature_model_0628.hpp"
 #include "segmenter/cws_module/cws_feature.h"
 #include "segmenter/cws_module/cws_tagging_system.h"
 #include "utils/stat.hpp"
+#include "utils/reusable_graph.hpp"
 #include "utils/stash_model.hpp"
 #include "segmenter/cws_module/cws_reader.h"
 namespace slnn{
@@ -249,6 +251,7 @@ void CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::train(const std::vec
     };
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for( unsigned nr_epoch = 0; nr_epoch < max_epoch ; ++nr_epoch )
     {
         BOOST_LOG_TRIVIAL(info) << "++ Epoch " << nr_epoch + 1 << "/" << max_epoch << " start ";
@@ -267,9 +270,10 @@ void CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::train(const std::vec
             const IndexSeq &sent = sents.at(access_idx),
                 &tag_seq = tag_seqs.at(access_idx);
             const CWSFeatureDataSeq &cws_feature_seq = cws_feature_seqs.at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 IndexSeq replaced_sent;
                 CWSFeatureDataSeq replaced_feature_data;
                 i1m->replace_word_with_unk(sent, cws_feature_seq, replaced_sent, replaced_feature_data);
@@ -290,6 +294,7 @@ void CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::train(const std::vec
             // do devel at every `do_devel_freq`
             if( 0 == line_cnt_for_devel % do_devel_freq )
             {
+                pgraph.reset();
                 do_devel_in_training(model_stash);
                 if( !model_stash.is_training_ok() ){ break;  }
             }
@@ -310,6 +315,7 @@ void CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::train(const std::vec
         if( model_stash.is_training_ok() )
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             do_devel_in_training(model_stash);
         }
         if( !model_stash.is_training_ok() ){ break; }
@@ -329,9 +335,10 @@ float CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::devel(const std::ve
     CWSStatNew stat(true);
     stat.start_time_stat();
     std::vector<IndexSeq> predict_tag_seqs(tag_seqs.size());
+    slnn::ReusableGraph graph;
     for( unsigned access_idx = 0; access_idx < nr_samples; ++access_idx )
     {
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         const IndexSeq &sent = sents.at(access_idx);
         const CWSFeatureDataSeq &feature_seq = cws_feature_seqs.at(access_idx);
         i1m->predict(cg, sent, feature_seq, predict_tag_seqs[access_idx]);
@@ -361,6 +368,7 @@ void CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::predict(std::istream
     BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
     BasicStat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for (unsigned int i = 0; i < raw_instances.size(); ++i)
     {
         Seq &raw_sent = raw_instances.at(i);
@@ -372,7 +380,7 @@ void CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::predict(std::istream
         IndexSeq &sent = sents.at(i) ;
         CWSFeatureDataSeq &cws_feature_seq = cws_feature_seqs.at(i);
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         i1m->predict(cg, sent, cws_feature_seq, pred_tag_seq);
         Seq words ;
         CWSTaggingSystem::static_parse_chars_indextag2word_seq(raw_sent, pred_tag_seq, words) ;
@@ -401,6 +409,7 @@ void CWSInput1WithFeatureModelHandler<RNNDerived, I1Model>::load_model(std::istr
     BOOST_LOG_TRIVIAL(info) << "loading model ...";
     boost::archive::text_iarchive ti(is) ;
     ti >> *(static_cast<I1Model*>(i1m));
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     i1m->print_model_info() ;
 }
 
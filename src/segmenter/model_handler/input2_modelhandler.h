@@ -2,6 +2,7 @@
 #define SLNN_SEGMENTER_MODEL_HANDLER_INPUT2_MODELHANDLER_H
 
 #include <sstream>
+#include <memory>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -9,6 +10,8 @@
 #include "segmenter/cws_module/cws_tagging_system.h"
 
 #include "utils/stat.hpp"
+#include "utils/parameter_snapshot.hpp"
+#include "utils/reusable_graph.hpp"
 namespace slnn{
 
 template <typename I2Model>
@@ -59,6 +62,8 @@ public :
     float devel(const std::vector<IndexSeq> *p_dynamic_sents, const std::vector<IndexSeq> *p_fixed_sents,
                 const std::vector<IndexSeq> *p_tag_seqs );
     void predict(std::istream &is, std::ostream &os);
+    // decoding option, only for the model with beam search decoding (pretag)
+    void set_beam_size(unsigned beam_size){ static_cast<I2Model*>(i2m)->set_beam_size(beam_size); }
 
     // Save & Load
     void save_model(std::ostream &os);
@@ -71,7 +76,7 @@ protected :
 protected :
     Input2Model *i2m ;
     float best_F1;
-    std::stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
 };
 
 } // end of namespace slnn
@@ -95,7 +100,7 @@ template <typename I2Model>
 Input2ModelHandler<I2Model>::Input2ModelHandler()
     : i2m(new I2Model()) ,
     best_F1(0.f) ,
-    best_model_tmp_ss()
+    best_model_snapshot()
 {}
 
 template <typename I2Model>
@@ -110,9 +115,7 @@ void Input2ModelHandler<I2Model>::save_current_best_model(float F1)
 {
     BOOST_LOG_TRIVIAL(info) << "better model has been found . stash it .";
     best_F1 = F1;
-    best_model_tmp_ss.str(""); // first , clear it's content !
-    boost::archive::text_oarchive to(best_model_tmp_ss);
-    to << *i2m->get_dynet_model();
+    best_model_snapshot.take(i2m->get_dynet_model());
 }
 
 template <typename I2Model>
@@ -389,6 +392,7 @@ void Input2ModelHandler<I2Model>::train(const std::vector<IndexSeq> *p_dsents,
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq dynamic_sent_after_replace_unk(SentMaxLen, 0);
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for( unsigned nr_epoch = 0; nr_epoch < max_epoch && is_train_ok; ++nr_epoch )
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -407,9 +411,10 @@ void Input2ModelHandler<I2Model>::train(const std::vector<IndexSeq> *p_dsents,
             const IndexSeq &dsent = p_dsents->at(access_idx),
                 &fsent = p_fsents->at(access_idx),
                 &tag_seq = p_tag_seqs->at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 dynamic_sent_after_replace_unk.resize(dsent.size());
                 for( size_t word_idx = 0; word_idx < dsent.size(); ++word_idx )
                 {
@@ -434,6 +439,7 @@ void Input2ModelHandler<I2Model>::train(const std::vector<IndexSeq> *p_dsents,
             // If developing samples is available , do `devel` to get model training effect . 
             if( p_dev_dsents != nullptr && 0 == line_cnt_for_devel % do_devel_freq )
             {
+                pgraph.reset();
                 float F1 = devel(p_dev_dsents, p_dev_fsents, p_dev_tag_seqs);
                 if( F1 > best_F1 ) save_current_best_model(F1);
                 line_cnt_for_devel = 0; // avoid overflow
@@ -460,6 +466,7 @@ void Input2ModelHandler<I2Model>::train(const std::vector<IndexSeq> *p_dsents,
         if( p_dev_dsents != nullptr && is_train_ok)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float F1 = devel(p_dev_dsents, p_dev_fsents, p_dev_tag_seqs);
             if( F1 > best_F1 ) save_current_best_model(F1);
             if( is_train_error_occurs(F1) )
@@ -485,9 +492,10 @@ float Input2ModelHandler<I2Model>::devel(const std::vector<IndexSeq> *p_dsents,
     CWSStat stat(i2m->get_tag_sys() , true);
     stat.start_time_stat();
     std::vector<IndexSeq> predict_tag_seqs(p_tag_seqs->size());
+    slnn::ReusableGraph graph;
     for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
     {
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq &dsent = p_dsents->at(access_idx),
             &fsent = p_fsents->at(access_idx);
@@ -519,6 +527,7 @@ void Input2ModelHandler<I2Model>::predict(std::istream &is, std::ostream &os)
     BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
     BasicStat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for (unsigned int i = 0; i < raw_instances.size(); ++i)
     {
         Seq &raw_sent = raw_instances.at(i);
@@ -530,7 +539,7 @@ void Input2ModelHandler<I2Model>::predict(std::istream &is, std::ostream &os)
         IndexSeq &dsent = dsents.at(i),
             &fsent = fsents.at(i);
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         i2m->predict(cg, dsent, fsent, pred_tag_seq);
         Seq words ;
         i2m->get_tag_sys().parse_word_tag2words(raw_sent, pred_tag_seq, words) ;
@@ -547,10 +556,10 @@ template <typename I2Model>
 void Input2ModelHandler<I2Model>::save_model(std::ostream &os)
 {
     BOOST_LOG_TRIVIAL(info) << "saving model ...";
-    if( best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail() )
+    if( best_model_snapshot.restore(i2m->get_dynet_model()) )
     {
         BOOST_LOG_TRIVIAL(info) << "fetch best model ...";
-        i2m->set_dynet_model(best_model_tmp_ss) ;
+        ViterbiDecoder::clear_all_score() ; // drop the decoder score of the old parameters
     }
     boost::archive::text_oarchive to(os);
     to << *(static_cast<I2Model*>(i2m)) ;
@@ -563,6 +572,7 @@ void Input2ModelHandler<I2Model>::load_model(std::istream &is)
     BOOST_LOG_TRIVIAL(info) << "loading model ...";
     boost::archive::text_iarchive ti(is) ;
     ti >> *(static_cast<I2Model*>(i2m)) ;
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     i2m->print_model_info() ;
 }
 
@@ -2,12 +2,15 @@
 #define SLNN_SEGMENTER_CWS_SINGLE_CLASSIFICATION_SINGLE_INPUT_MODELHANDLER_H
 
 #include <sstream>
+#include <memory>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include "segmenter/base_model/single_input_model.h"
 #include "segmenter/cws_module/cws_tagging_system.h"
 
 #include "utils/stat.hpp"
+#include "utils/parameter_snapshot.hpp"
+#include "utils/reusable_graph.hpp"
 namespace slnn{
 
 template <typename SIModel>
@@ -17,7 +20,7 @@ public :
     SingleInputModel *sim ;
 
     float best_F1;
-    std::stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
 
     static const size_t SentMaxLen = 256;
     static const size_t MaxSentNum = 0x8000; // 32k
@@ -50,6 +53,8 @@ public :
                unsigned trivial_report_freq);
     float devel(const std::vector<IndexSeq> *p_sents, const std::vector<IndexSeq> *p_tag_seqs );
     void predict(std::istream &is, std::ostream &os);
+    // decoding option, only for the model with beam search decoding (pretag)
+    void set_beam_size(unsigned beam_size){ static_cast<SIModel*>(sim)->set_beam_size(beam_size); }
 
     // Save & Load
     void save_model(std::ostream &os);
@@ -80,7 +85,7 @@ template <typename SIModel>
 SingleInputModelHandler<SIModel>::SingleInputModelHandler()
     : sim(new SIModel()) ,
     best_F1(0.f) ,
-    best_model_tmp_ss()
+    best_model_snapshot()
 {}
 
 template <typename SIModel>
@@ -95,9 +100,7 @@ void SingleInputModelHandler<SIModel>::save_current_best_model(float F1)
 {
     BOOST_LOG_TRIVIAL(info) << "better model has been found . stash it .";
     best_F1 = F1;
-    best_model_tmp_ss.str(""); // first , clear it's content !
-    boost::archive::text_oarchive to(best_model_tmp_ss);
-    to << *sim->get_dynet_model();
+    best_model_snapshot.take(sim->get_dynet_model());
 }
 
 template <typename SIModel>
@@ -250,6 +253,7 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
     unsigned line_cnt_for_devel = 0;
     unsigned long long total_time_cost_in_seconds = 0ULL;
     IndexSeq dynamic_sent_after_replace_unk(SentMaxLen , 0);
+    std::unique_ptr<slnn::ReusableGraph> pgraph; // the training graph
     for (unsigned nr_epoch = 0; nr_epoch < max_epoch && is_train_ok; ++nr_epoch)
     {
         BOOST_LOG_TRIVIAL(info) << "epoch " << nr_epoch + 1 << "/" << max_epoch << " for train ";
@@ -267,9 +271,10 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
             // using negative_loglikelihood loss to build model
             const IndexSeq &sent = p_sents->at(access_idx),
                 &tag_seq = p_tag_seqs->at(access_idx);
-            { // new scope , for only one Computatoin Graph can be exists in one scope at the same time .
-              // devel will creat another Computation Graph , so we need to create new scoce to release it before devel .
-                dynet::ComputationGraph cg ;
+            { // the training graph is reused for every instance , and released before devel
+              // (only one Computation Graph can exist at the same time , devel has its own) .
+                if( !pgraph ){ pgraph.reset(new slnn::ReusableGraph()); }
+                dynet::ComputationGraph &cg = pgraph->renew();
                 dynamic_sent_after_replace_unk.resize(sent.size());
                 for( size_t word_idx = 0; word_idx < sent.size(); ++word_idx )
                 {
@@ -294,6 +299,7 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
             // If developing samples is available , do `devel` to get model training effect . 
             if (p_dev_sents != nullptr && 0 == line_cnt_for_devel % do_devel_freq)
             {
+                pgraph.reset();
                 float F1 = devel(p_dev_sents  , p_dev_tag_seqs);
                 if (F1 > best_F1) save_current_best_model(F1);
                 line_cnt_for_devel = 0; // avoid overflow
@@ -320,6 +326,7 @@ void SingleInputModelHandler<SIModel>::train(const std::vector<IndexSeq> *p_sent
         if (p_dev_sents != nullptr && is_train_ok)
         {
             BOOST_LOG_TRIVIAL(info) << "do validation at every ends of epoch .";
+            pgraph.reset();
             float F1 = devel(p_dev_sents , p_dev_tag_seqs);
             if (F1 > best_F1) save_current_best_model(F1);
             if( is_train_error_occurs(F1) )
@@ -344,9 +351,10 @@ float SingleInputModelHandler<SIModel>::devel(const std::vector<IndexSeq> *p_sen
     CWSStat stat(sim->get_tag_sys() , true);
     stat.start_time_stat();
     std::vector<IndexSeq> predict_tag_seqs(p_tag_seqs->size());
+    slnn::ReusableGraph graph;
     for (unsigned access_idx = 0; access_idx < nr_samples; ++access_idx)
     {
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         IndexSeq predict_tag_seq;
         const IndexSeq &sent = p_sents->at(access_idx);
         sim->predict(cg, sent,predict_tag_seq);
@@ -376,6 +384,7 @@ void SingleInputModelHandler<SIModel>::predict(std::istream &is, std::ostream &o
     BOOST_LOG_TRIVIAL(info) << "do prediction on " << raw_instances.size() << " instances .";
     BasicStat stat(true);
     stat.start_time_stat();
+    slnn::ReusableGraph graph;
     for (unsigned int i = 0; i < raw_instances.size(); ++i)
     {
         Seq &raw_sent = raw_instances.at(i);
@@ -386,7 +395,7 @@ void SingleInputModelHandler<SIModel>::predict(std::istream &is, std::ostream &o
         }
         IndexSeq &sent = sents.at(i) ;
         IndexSeq pred_tag_seq;
-        dynet::ComputationGraph cg;
+        dynet::ComputationGraph &cg = graph.renew();
         sim->predict(cg, sent, pred_tag_seq);
         Seq words ;
         sim->get_tag_sys().parse_word_tag2words(raw_sent, pred_tag_seq, words) ;
@@ -403,10 +412,10 @@ template <typename SIModel>
 void SingleInputModelHandler<SIModel>::save_model(std::ostream &os)
 {
     BOOST_LOG_TRIVIAL(info) << "saving model ...";
-    if( best_model_tmp_ss && 0 != best_model_tmp_ss.rdbuf()->in_avail() )
+    if( best_model_snapshot.restore(sim->get_dynet_model()) )
     {
         BOOST_LOG_TRIVIAL(info) << "fetch best model ...";
-        sim->set_dynet_model(best_model_tmp_ss) ;
+        ViterbiDecoder::clear_all_score() ; // drop the decoder score of the old parameters
     }
     boost::archive::text_oarchive to(os);
     to << *(static_cast<SIModel*>(sim));
@@ -419,6 +428,7 @@ void SingleInputModelHandler<SIModel>::load_model(std::istream &is)
     BOOST_LOG_TRIVIAL(info) << "loading model ...";
     boost::archive::text_iarchive ti(is) ;
     ti >> *(static_cast<SIModel*>(sim));
+    ViterbiDecoder::clear_all_score(); // drop the decoder score of the old parameters
     sim->print_model_info() ;
 }
 
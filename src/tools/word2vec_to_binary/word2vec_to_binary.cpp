@@ -0,0 +1,54 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+
+#include "utils/word2vec_embedding_helper.h"
+#include "utils/general.hpp"
+
+using namespace std;
+using namespace slnn;
+namespace po = boost::program_options;
+
+const string PROGRAM_DESCRIPTION = "Convert word2vec text embedding to the binary format (one-time conversion).\n"
+    "the binary embedding can be used anywhere the text embedding is used, and is loaded without parsing.";
+
+int main(int argc, char *argv[])
+{
+    string input_path,
+        output_path;
+    po::options_description op_des = po::options_description(PROGRAM_DESCRIPTION);
+    op_des.add_options()
+        ("input", po::value<string>(&input_path), "[required] The path to word2vec embedding in text format.")
+        ("output", po::value<string>(&output_path), "[required] The path to the output binary embedding.")
+        ("vocab_filter", po::value<string>(), "Only convert the words in this file (white-space separated words, "
+            "e.g. the word list of training and test data). Empty for all words.")
+        ("help,h", "Show help information.");
+    po::variables_map var_map;
+    po::store(po::command_line_parser(argc, argv).options(op_des).run(), var_map);
+    po::notify(var_map);
+    if( var_map.count("help") )
+    {
+        cerr << op_des << endl;
+        return 0;
+    }
+    varmap_key_fatal_check(var_map, "input", "Error : input text embedding should be specified !");
+    varmap_key_fatal_check(var_map, "output", "Error : output path should be specified !");
+    unordered_set<string> vocab_filter;
+    if( var_map.count("vocab_filter") && !var_map["vocab_filter"].as<string>().empty() )
+    {
+        ifstream vocab_is(var_map["vocab_filter"].as<string>());
+        if( !vocab_is ){ fatal_error("Error : failed to open vocabulary filter at `" + var_map["vocab_filter"].as<string>() + "`"); }
+        Word2vecEmbeddingHelper::read_vocabulary(vocab_is, vocab_filter);
+        BOOST_LOG_TRIVIAL(info) << "vocabulary filter with " << vocab_filter.size() << " words .";
+    }
+    ifstream text_is(input_path);
+    if( !text_is ){ fatal_error("Error : failed to open text embedding at `" + input_path + "`"); }
+    ofstream binary_os(output_path, ios::binary);
+    if( !binary_os ){ fatal_error("Error : failed to open output path at `" + output_path + "`"); }
+    Word2vecEmbeddingHelper::convert_to_binary(text_is, binary_os, vocab_filter.empty() ? nullptr : &vocab_filter);
+    return 0;
+}
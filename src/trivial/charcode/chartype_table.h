@@ -0,0 +1,166 @@
+#ifndef SLNN_TRIVIAL_CHARCODE_CHARTYPE_TABLE_H_
+#define SLNN_TRIVIAL_CHARCODE_CHARTYPE_TABLE_H_
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <utility>
+#include <algorithm>
+namespace slnn{
+namespace charcode{
+
+/*
+    Character type (digit, punctuation, letter, other) table, shared by all the char type features.
+
+    BMP is covered by a two-level table: the high byte of the code point selects a 256-entry block,
+    and the low byte selects the type in the block. blocks without any classified char share the default block,
+    so the table is small (a few KB) and stays in cache. the type is got by two indexed loads, no hash.
+    the (few) classified chars out of BMP are in a sorted list (binary search).
+*/
+
+class CharTypeTable
+{
+public:
+    using TypeT = std::uint8_t;
+    // enum (not static constexpr member), so no out-of-class definition is needed for the header-only table.
+    enum : TypeT { DefaultType = 0, DigitType = 1, PuncType = 2, LetterType = 3, TypeNum = 4 };
+public:
+    static const CharTypeTable& get_table();
+    TypeT type_of(char32_t uc) const noexcept
+    {
+        if( uc <= 0xFFFF ){ return block_list[(static_cast<std::size_t>(block_idx_list[uc >> 8]) << 8) | (uc & 0xFF)]; }
+        else{ return type_of_supplementary(uc); }
+    }
+    /**
+     * type of an UTF8 char. the string which is not exactly one (valid) UTF8 char is DefaultType.
+     */
+    TypeT type_of_u8(const char *u8char, std::size_t len) const noexcept;
+    /**
+     * classify [begin, end) to out, out[i] = type_of(begin[i]).
+     */
+    template <typename OutputT>
+    void classify(const char32_t *begin, const char32_t *end, OutputT *out) const noexcept
+    {
+        for( ; begin != end; ++begin, ++out ){ *out = static_cast<OutputT>(type_of(*begin)); }
+    }
+private:
+    CharTypeTable();
+    CharTypeTable(const CharTypeTable&) = delete;
+    CharTypeTable& operator=(const CharTypeTable&) = delete;
+    void set_type(char32_t uc, TypeT type);
+    TypeT type_of_supplementary(char32_t uc) const noexcept;
+private:
+    std::array<std::uint8_t, 256> block_idx_list;
+    std::vector<TypeT> block_list; // block 0 is the default block
+    std::vector<std::pair<char32_t, TypeT>> supplementary_list; // sorted by code point
+};
+
+
+/**************************************
+ * Inline Implementation
+ **************************************/
+
+inline
+const CharTypeTable& CharTypeTable::get_table()
+{
+    static const CharTypeTable table;
+    return table;
+}
+
+inline
+CharTypeTable::CharTypeTable()
+    :block_list(256U, DefaultType)
+{
+    block_idx_list.fill(0U);
+    // digit: ASCII and full-width 0-9, Chinese financial numerals (the ambiguous common numerals are not used)
+    static const char32_t digit_list[] = {
+        0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+        0xff10, 0xff11, 0xff12, 0xff13, 0xff14, 0xff15, 0xff16, 0xff17, 0xff18,
+        0xff19, 0x58f9, 0x8d30, 0x53c1, 0x8086, 0x4f0d, 0x9646, 0x67d2, 0x634c,
+        0x7396, 0x62fe, 0x4f70, 0x4edf
+    };
+    // letter: ASCII and full-width a-z, A-Z
+    static const char32_t letter_list[] = {
+        0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c,
+        0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+        0x79, 0x7a, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a,
+        0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56,
+        0x57, 0x58, 0x59, 0x5a, 0xff41, 0xff42, 0xff43, 0xff44, 0xff45, 0xff46,
+        0xff47, 0xff48, 0xff49, 0xff4a, 0xff4b, 0xff4c, 0xff4d, 0xff4e, 0xff4f,
+        0xff50, 0xff51, 0xff52, 0xff53, 0xff54, 0xff55, 0xff56, 0xff57, 0xff58,
+        0xff59, 0xff5a, 0xff21, 0xff22, 0xff23, 0xff24, 0xff25, 0xff26, 0xff27,
+        0xff28, 0xff29, 0xff2a, 0xff2b, 0xff2c, 0xff2d, 0xff2e, 0xff2f, 0xff30,
+        0xff31, 0xff32, 0xff33, 0xff34, 0xff35, 0xff36, 0xff37, 0xff38, 0xff39,
+        0xff3a
+    };
+    // punctuation (including the space)
+    static const char32_t punc_list[] = {
+        0xff0c, 0x3002, 0xff1f, 0xff01, 0xff1a, 0xff1b, 0x3001, 0x2026,
+        0xff5e, 0xff06, 0xff20, 0xff03, 0x2c, 0x2e, 0x3f, 0x21, 0x3a, 0x3b, 0xb7,
+        0x7e, 0x26, 0x40, 0x23, 0x201c, 0x201d, 0x2018, 0x2019, 0x301d, 0x301e,
+        0x20, 0x27, 0x22, 0xff02, 0xff07, 0xb4, 0xff08, 0xff09, 0x3010, 0x3011,
+        0x300a, 0x300b, 0xff1c, 0xff1e, 0xfe5d, 0xfe5e, 0x3c, 0x3e, 0x28, 0x29, 0x5b, 0x5d,
+        0xab, 0xbb, 0x2039, 0x203a, 0x3014, 0x3015, 0x3008, 0x3009, 0x7b, 0x7d, 0xff3b, 0xff3d,
+        0x300c, 0x300d, 0xff5b, 0xff5d, 0x3016, 0x3017, 0x300e, 0x300f, 0xfe35, 0xfe37, 0xfe39,
+        0xfe3f, 0xfe3d, 0xfe41, 0xfe43, 0xfe3b, 0xfe17, 0x2f, 0x7c, 0x5c, 0xfe36, 0xfe38, 0xfe3a,
+        0xfe40, 0xfe3e, 0xfe42, 0xfe44, 0xfe3c, 0xfe18, 0xff0f, 0xff5c, 0xff3c, 0x2ca, 0xa8,
+        0xad, 0x5e, 0xa1, 0xa6, 0x60, 0xfe4e, 0xfe4d, 0xfe4f, 0xff3f, 0x5f, 0xaf, 0xffe3,
+        0xfe4b, 0xfe49, 0xfe4a, 0x2cb, 0xfe34, 0xbf, 0x2c7, 0x3000
+    };
+    for( char32_t uc : digit_list ){ set_type(uc, DigitType); }
+    for( char32_t uc : letter_list ){ set_type(uc, LetterType); }
+    for( char32_t uc : punc_list ){ set_type(uc, PuncType); }
+    std::sort(supplementary_list.begin(), supplementary_list.end());
+}
+
+inline
+void CharTypeTable::set_type(char32_t uc, TypeT type)
+{
+    if( uc > 0xFFFF )
+    {
+        supplementary_list.emplace_back(uc, type);
+        return;
+    }
+    std::size_t high = uc >> 8;
+    if( block_idx_list[high] == 0U )
+    {
+        // copy on write of the default block
+        block_idx_list[high] = static_cast<std::uint8_t>(block_list.size() >> 8);
+        block_list.resize(block_list.size() + 256U, DefaultType);
+    }
+    block_list[(static_cast<std::size_t>(block_idx_list[high]) << 8) | (uc & 0xFF)] = type;
+}
+
+inline
+CharTypeTable::TypeT CharTypeTable::type_of_supplementary(char32_t uc) const noexcept
+{
+    auto iter = std::lower_bound(supplementary_list.begin(), supplementary_list.end(), uc,
+        [](const std::pair<char32_t, TypeT> &item, char32_t key){ return item.first < key; });
+    return (iter != supplementary_list.end() && iter->first == uc) ? iter->second : DefaultType;
+}
+
+inline
+CharTypeTable::TypeT CharTypeTable::type_of_u8(const char *u8char, std::size_t len) const noexcept
+{
+    const unsigned char *s = reinterpret_cast<const unsigned char*>(u8char);
+    if( len == 0 ){ return DefaultType; }
+    std::size_t nr_trail;
+    char32_t uc;
+    if( s[0] < 0x80 ){ nr_trail = 0; uc = s[0]; }
+    else if( s[0] >= 0xC2 && s[0] <= 0xDF ){ nr_trail = 1; uc = s[0] & 0x1F; }
+    else if( s[0] >= 0xE0 && s[0] <= 0xEF ){ nr_trail = 2; uc = s[0] & 0x0F; }
+    else if( s[0] >= 0xF0 && s[0] <= 0xF4 ){ nr_trail = 3; uc = s[0] & 0x07; }
+    else{ return DefaultType; }
+    if( len != nr_trail + 1 ){ return DefaultType; }
+    for( std::size_t k = 1; k <= nr_trail; ++k )
+    {
+        if( (s[k] & 0xC0) != 0x80 ){ return DefaultType; }
+        uc = (uc << 6) | (s[k] & 0x3F);
+    }
+    return type_of(uc);
+}
+
+} // end of namespace charcode
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SLNN_TRIVIAL_CHARCODE_UTF8_DECODER_H_
+#define SLNN_TRIVIAL_CHARCODE_UTF8_DECODER_H_
+#include <cstdint>
+#include <cstring>
+#include <string>
+namespace slnn{
+namespace charcode{
+namespace utf8{
+
+/*
+    Validating UTF8 decoder for the readers.
+
+    different from NUnicode (unsafe), the continuation bytes, overlong encoding, surrogates and
+    out-of-range code points are checked, and the invalid bytes are skipped (one by one).
+    ASCII runs are processed 8 bytes at a time (word-at-a-time test of the high bits), which is
+    the common case for the digits, letters and delimiters in the corpus.
+*/
+
+constexpr std::uint64_t HighBitMask = 0x8080808080808080ULL;
+
+/**
+ * decode UTF8 bytes and append the code points to `out` (the capacity of `out` is reused).
+ * @param bytes UTF8 bytes
+ * @param len length of bytes
+ * @param out output unicode string
+ * @return number of skipped invalid bytes
+ */
+inline
+std::size_t decode_append(const char *bytes, std::size_t len, std::u32string &out)
+{
+    const unsigned char *s = reinterpret_cast<const unsigned char*>(bytes);
+    std::size_t out_begin = out.size();
+    out.resize(out_begin + len); // code points number <= bytes number
+    char32_t *o = &out[0] + out_begin;
+    std::size_t i = 0,
+        nr_out = 0,
+        nr_invalid = 0;
+    while( i < len )
+    {
+        // ASCII run
+        while( i + 8U <= len )
+        {
+            std::uint64_t word;
+            std::memcpy(&word, s + i, 8U);
+            if( word & HighBitMask ){ break; }
+            for( std::size_t k = 0; k < 8U; ++k ){ o[nr_out + k] = s[i + k]; }
+            i += 8U;
+            nr_out += 8U;
+        }
+        if( i >= len ){ break; }
+        unsigned char lead = s[i];
+        if( lead < 0x80 )
+        {
+            o[nr_out++] = lead;
+            ++i;
+            continue;
+        }
+        std::size_t nr_trail;
+        char32_t cp,
+            min_cp;
+        if( lead >= 0xC2 && lead <= 0xDF ){ nr_trail = 1; cp = lead & 0x1F; min_cp = 0x80; }
+        else if( lead >= 0xE0 && lead <= 0xEF ){ nr_trail = 2; cp = lead & 0x0F; min_cp = 0x800; }
+        else if( lead >= 0xF0 && lead <= 0xF4 ){ nr_trail = 3; cp = lead & 0x07; min_cp = 0x10000; }
+        else{ ++nr_invalid; ++i; continue; }
+        bool is_valid = i + nr_trail < len;
+        for( std::size_t k = 1; is_valid && k <= nr_trail; ++k )
+        {
+            unsigned char trail = s[i + k];
+            if( (trail & 0xC0) != 0x80 ){ is_valid = false; }
+            else{ cp = (cp << 6) | (trail & 0x3F); }
+        }
+        if( !is_valid || cp < min_cp || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF )
+        {
+            ++nr_invalid;
+            ++i;
+            continue;
+        }
+        o[nr_out++] = cp;
+        i += nr_trail + 1;
+    }
+    out.resize(out_begin + nr_out);
+    return nr_invalid;
+}
+
+/**
+ * decode UTF8 bytes to `out` (cleared first, the capacity is reused).
+ * @return number of skipped invalid bytes
+ */
+inline
+std::size_t decode(const char *bytes, std::size_t len, std::u32string &out)
+{
+    out.clear();
+    return decode_append(bytes, len, out);
+}
+
+} // end of namespace utf8
+} // end of namespace charcode
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SLNN_TRIVIAL_CORPUS_CACHE_CHANNEL_CORPUS_H_
+#define SLNN_TRIVIAL_CORPUS_CACHE_CHANNEL_CORPUS_H_
+#include <memory>
+#include <vector>
+#include <stdexcept>
+#include "corpus_cache.h"
+namespace slnn{
+namespace trivial{
+namespace corpus_cache{
+
+/**
+ * structure-of-arrays corpus.
+ * every feature channel of all the instances is stored in one contiguous arena (flat data + offset table),
+ * so an instance is just a group of span views, no allocation per instance.
+ * the arenas are built in memory instance by instance, or are the mapped corpus cache (no copy).
+ */
+class ChannelCorpus
+{
+public:
+    explicit ChannelCorpus(std::size_t nr_channel = 0) : channel_list(nr_channel){}
+    explicit ChannelCorpus(std::shared_ptr<const MappedCorpusCache> cache) : mapped_cache(cache){}
+public:
+    std::size_t size() const;
+    bool empty() const { return size() == 0; }
+    std::size_t get_channel_num() const { return mapped_cache ? mapped_cache->get_channel_num() : channel_list.size(); }
+    IndexSpan get_span(std::size_t channel, std::size_t instance) const;
+    bool is_mapped() const { return static_cast<bool>(mapped_cache); }
+    // building, only for the in-memory corpus
+    CorpusChannelBuilder& get_channel_builder(std::size_t channel);
+    const std::vector<CorpusChannelBuilder>& get_channel_builder_list() const { return channel_list; }
+    void reserve(std::size_t nr_instance){ for( CorpusChannelBuilder &channel : channel_list ){ channel.reserve(nr_instance); } }
+    void shrink_to_fit(){ for( CorpusChannelBuilder &channel : channel_list ){ channel.shrink_to_fit(); } }
+private:
+    std::vector<CorpusChannelBuilder> channel_list;
+    std::shared_ptr<const MappedCorpusCache> mapped_cache;
+};
+
+
+/**********************
+ * Inline Implementation
+ **********************/
+
+inline
+std::size_t ChannelCorpus::size() const
+{
+    if( mapped_cache ){ return mapped_cache->get_instance_num(); }
+    return channel_list.empty() ? 0U : channel_list.front().get_instance_num();
+}
+
+inline
+IndexSpan ChannelCorpus::get_span(std::size_t channel, std::size_t instance) const
+{
+    return mapped_cache ? mapped_cache->get_span(channel, instance) : channel_list[channel].get_span(instance);
+}
+
+inline
+CorpusChannelBuilder& ChannelCorpus::get_channel_builder(std::size_t channel)
+{
+    if( mapped_cache ){ throw std::logic_error("channel corpus: the mapped corpus is read-only."); }
+    return channel_list.at(channel);
+}
+
+} // end of namespace corpus_cache
+} // end of namespace trivial
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,245 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include <sys/stat.h>
+#include "corpus_cache.h"
+
+namespace slnn{
+namespace trivial{
+namespace corpus_cache{
+
+namespace inner{
+
+const char Magic[8] = { 'S', 'L', 'N', 'N', 'C', 'P', 'S', '\0' };
+constexpr std::uint32_t EndianTag = 0x01020304U;
+
+inline
+std::uint64_t align_offset(std::uint64_t offset)
+{
+    return (offset + SectionAlignment - 1U) / SectionAlignment * SectionAlignment;
+}
+
+inline
+void write_padding(std::ostream &os, std::uint64_t from, std::uint64_t to)
+{
+    static const char zeros[SectionAlignment] = {};
+    os.write(zeros, static_cast<std::streamsize>(to - from));
+}
+
+} // end of namespace inner
+
+std::uint64_t hash_bytes(const char *data, std::size_t sz, std::uint64_t seed)
+{
+    constexpr std::uint64_t Prime = 1099511628211ULL;
+    std::uint64_t h = seed;
+    for( std::size_t i = 0; i < sz; ++i )
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= Prime;
+    }
+    return h;
+}
+
+std::string get_file_identity(const std::string &path)
+{
+    struct stat file_stat;
+    if( stat(path.c_str(), &file_stat) != 0 ){ return std::string(); }
+    std::ostringstream oss;
+    oss << file_stat.st_size << ":" << file_stat.st_mtime;
+    return oss.str();
+}
+
+void write_corpus_cache(std::ostream &os, std::uint64_t key, const std::string &dict_bytes,
+    const std::vector<CorpusChannelBuilder> &channel_list)
+{
+    std::uint64_t nr_instance = channel_list.empty() ? 0U : channel_list.front().get_instance_num();
+    for( const CorpusChannelBuilder &channel : channel_list )
+    {
+        if( channel.get_instance_num() != nr_instance )
+        {
+            throw std::logic_error("corpus cache: instance number of channels is not matched.");
+        }
+    }
+    CorpusCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, inner::Magic, sizeof(header.magic));
+    header.version = FormatVersion;
+    header.endian_tag = inner::EndianTag;
+    header.key = key;
+    header.dict_offset = inner::align_offset(sizeof(CorpusCacheHeader));
+    header.dict_size = dict_bytes.size();
+    header.channel_table_offset = inner::align_offset(header.dict_offset + header.dict_size);
+    header.nr_channel = channel_list.size();
+    header.nr_instance = nr_instance;
+    // channel table: (offset table offset, data offset)
+    std::vector<std::uint64_t> channel_table;
+    std::uint64_t cur = inner::align_offset(header.channel_table_offset + header.nr_channel * 2U * sizeof(std::uint64_t));
+    for( const CorpusChannelBuilder &channel : channel_list )
+    {
+        channel_table.push_back(cur);
+        cur = inner::align_offset(cur + channel.get_offset_list().size() * sizeof(std::uint64_t));
+        channel_table.push_back(cur);
+        cur = inner::align_offset(cur + channel.get_data().size() * sizeof(std::int32_t));
+    }
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    inner::write_padding(os, sizeof(header), header.dict_offset);
+    os.write(dict_bytes.data(), static_cast<std::streamsize>(dict_bytes.size()));
+    inner::write_padding(os, header.dict_offset + header.dict_size, header.channel_table_offset);
+    os.write(reinterpret_cast<const char*>(channel_table.data()),
+        static_cast<std::streamsize>(channel_table.size() * sizeof(std::uint64_t)));
+    cur = header.channel_table_offset + channel_table.size() * sizeof(std::uint64_t);
+    for( std::size_t i = 0; i < channel_list.size(); ++i )
+    {
+        const std::vector<std::uint64_t> &offset_list = channel_list[i].get_offset_list();
+        const std::vector<std::int32_t> &data = channel_list[i].get_data();
+        inner::write_padding(os, cur, channel_table[2 * i]);
+        os.write(reinterpret_cast<const char*>(offset_list.data()),
+            static_cast<std::streamsize>(offset_list.size() * sizeof(std::uint64_t)));
+        cur = channel_table[2 * i] + offset_list.size() * sizeof(std::uint64_t);
+        inner::write_padding(os, cur, channel_table[2 * i + 1]);
+        os.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(std::int32_t)));
+        cur = channel_table[2 * i + 1] + data.size() * sizeof(std::int32_t);
+    }
+    if( !os ){ throw std::runtime_error("failed to write corpus cache."); }
+}
+
+bool write_corpus_cache_file(const std::string &path, std::uint64_t key, const std::string &dict_bytes,
+    const std::vector<CorpusChannelBuilder> &channel_list)
+{
+    std::ostringstream tmp_path_oss;
+#ifndef _WIN32
+    tmp_path_oss << path << ".tmp." << getpid();
+#else
+    tmp_path_oss << path << ".tmp";
+#endif
+    std::string tmp_path = tmp_path_oss.str();
+    try
+    {
+        std::ofstream os(tmp_path, std::ios::binary);
+        if( !os ){ return false; }
+        write_corpus_cache(os, key, dict_bytes, channel_list);
+        os.close();
+        if( !os ){ throw std::runtime_error("failed to close corpus cache."); }
+    }
+    catch( const std::runtime_error & )
+    {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    catch( ... )
+    {
+        // bad input (logic_error) or allocation failure: don't leave the partial file, and let the caller know.
+        std::remove(tmp_path.c_str());
+        throw;
+    }
+    std::remove(path.c_str()); // rename fails on Windows if the target exists
+    if( std::rename(tmp_path.c_str(), path.c_str()) != 0 )
+    {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+MappedCorpusCache::MappedCorpusCache(const std::string &path)
+    :base(nullptr),
+    file_sz(0),
+    is_mapped(false)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if( fd < 0 ){ throw std::runtime_error("failed to open corpus cache: '" + path + "'"); }
+    struct stat file_stat;
+    if( fstat(fd, &file_stat) != 0 ){ close(fd); throw std::runtime_error("failed to stat corpus cache: '" + path + "'"); }
+    file_sz = static_cast<std::size_t>(file_stat.st_size);
+    void *mem = file_sz > 0 ? mmap(nullptr, file_sz, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if( mem == MAP_FAILED ){ throw std::runtime_error("failed to map corpus cache: '" + path + "'"); }
+    base = static_cast<char*>(mem);
+    is_mapped = true;
+#else
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    if( !is ){ throw std::runtime_error("failed to open corpus cache: '" + path + "'"); }
+    file_sz = static_cast<std::size_t>(is.tellg());
+    base = static_cast<char*>(::operator new(file_sz));
+    is.seekg(0);
+    is.read(base, file_sz);
+#endif
+    auto fail = [this, &path](const std::string &reason)
+    {
+        this->release();
+        throw std::runtime_error("invalid corpus cache '" + path + "': " + reason);
+    };
+    if( file_sz < sizeof(CorpusCacheHeader) ){ fail("file is too small"); }
+    std::memcpy(&header, base, sizeof(header));
+    if( std::memcmp(header.magic, inner::Magic, sizeof(header.magic)) != 0 ){ fail("magic is not matched"); }
+    if( header.endian_tag != inner::EndianTag ){ fail("byte order is not matched"); }
+    if( header.version > FormatVersion ){ fail("version " + std::to_string(header.version) + " is not supported"); }
+    if( header.dict_offset + header.dict_size > file_sz ||
+        header.channel_table_offset + header.nr_channel * 2U * sizeof(std::uint64_t) > file_sz )
+    {
+        fail("section out of file range");
+    }
+    const std::uint64_t *channel_table = reinterpret_cast<const std::uint64_t*>(base + header.channel_table_offset);
+    for( std::uint64_t i = 0; i < header.nr_channel; ++i )
+    {
+        std::uint64_t offset_table_offset = channel_table[2 * i],
+            data_offset = channel_table[2 * i + 1];
+        if( offset_table_offset + (header.nr_instance + 1U) * sizeof(std::uint64_t) > file_sz ){ fail("channel out of file range"); }
+        const std::uint64_t *offset_list = reinterpret_cast<const std::uint64_t*>(base + offset_table_offset);
+        // offsets should be increasing, then checking the last one is enough for the range.
+        if( offset_list[0] != 0U ){ fail("broken offset table"); }
+        for( std::uint64_t j = 0; j < header.nr_instance; ++j )
+        {
+            if( offset_list[j] > offset_list[j + 1] ){ fail("broken offset table"); }
+        }
+        if( data_offset + offset_list[header.nr_instance] * sizeof(std::int32_t) > file_sz ){ fail("channel out of file range"); }
+        channel_offset_list.push_back(offset_list);
+        channel_data_list.push_back(reinterpret_cast<const std::int32_t*>(base + data_offset));
+    }
+}
+
+MappedCorpusCache::~MappedCorpusCache()
+{
+    release();
+}
+
+void MappedCorpusCache::release() noexcept
+{
+    if( !base ){ return; }
+#ifndef _WIN32
+    if( is_mapped ){ munmap(base, file_sz); }
+#else
+    ::operator delete(base);
+#endif
+    base = nullptr;
+}
+
+std::shared_ptr<const MappedCorpusCache> open_corpus_cache(const std::string &path, std::uint64_t key)
+{
+    std::ifstream is(path, std::ios::binary);
+    if( !is ){ return nullptr; }
+    is.close();
+    std::shared_ptr<const MappedCorpusCache> cache;
+    try
+    {
+        cache = std::make_shared<const MappedCorpusCache>(path);
+    }
+    catch( const std::runtime_error & )
+    {
+        return nullptr;
+    }
+    return cache->get_key() == key ? cache : nullptr;
+}
+
+} // end of namespace corpus_cache
+} // end of namespace trivial
+} // end of namespace slnn
@@ -0,0 +1,157 @@
+#ifndef SLNN_TRIVIAL_CORPUS_CACHE_CORPUS_CACHE_H_
+#define SLNN_TRIVIAL_CORPUS_CACHE_CORPUS_CACHE_H_
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <memory>
+namespace slnn{
+namespace trivial{
+namespace corpus_cache{
+
+/**
+ * Binary cache of a featurized (tokenized and indexed) corpus.
+ * every instance has one int32 index sequence in every feature channel (unigram, bigram, tag, ...).
+ * file layout:
+ *   1. header (fixed size, see `CorpusCacheHeader`)
+ *   2. dict section: bytes of the token module after reading the corpus (may be empty).
+ *   3. channel table: (offset table offset, data offset) of every channel (uint64)
+ *   4. for every channel: offset table (nr_instance + 1 uint64, in element), then the flat int32 data.
+ *      every section starts at `SectionAlignment` aligned offset.
+ * the cache is bound to the corpus and the dictionary by `key`, a mismatched key means the cache is stale.
+ * data is written in host byte order, `endian_tag` is checked when reading.
+ */
+
+constexpr std::uint32_t FormatVersion = 1U;
+constexpr std::size_t SectionAlignment = 64U;
+
+struct CorpusCacheHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint64_t key;
+    std::uint64_t dict_offset;
+    std::uint64_t dict_size;
+    std::uint64_t channel_table_offset;
+    std::uint64_t nr_channel;
+    std::uint64_t nr_instance;
+};
+
+/**
+ * read-only view of an index sequence.
+ */
+struct IndexSpan
+{
+    const std::int32_t *data;
+    std::size_t size;
+    const std::int32_t* begin() const { return data; }
+    const std::int32_t* end() const { return data + size; }
+    std::int32_t operator[](std::size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+/**
+ * one feature channel in building: sequences are appended instance by instance.
+ */
+class CorpusChannelBuilder
+{
+public:
+    CorpusChannelBuilder() : offset_list(1, 0U){}
+    template <typename Container>
+    void append(const Container &seq){ data.insert(data.end(), seq.begin(), seq.end()); offset_list.push_back(data.size()); }
+    // for the disabled feature
+    void append_empty(){ offset_list.push_back(data.size()); }
+    void reserve(std::size_t nr_instance){ offset_list.reserve(nr_instance + 1); }
+    void shrink_to_fit(){ offset_list.shrink_to_fit(); data.shrink_to_fit(); }
+    std::size_t get_instance_num() const { return offset_list.size() - 1; }
+    IndexSpan get_span(std::size_t instance) const
+    {
+        return IndexSpan{ data.data() + offset_list[instance],
+            static_cast<std::size_t>(offset_list[instance + 1] - offset_list[instance]) };
+    }
+    const std::vector<std::uint64_t>& get_offset_list() const { return offset_list; }
+    const std::vector<std::int32_t>& get_data() const { return data; }
+private:
+    std::vector<std::uint64_t> offset_list;
+    std::vector<std::int32_t> data;
+};
+
+/**
+ * FNV-1a hash, for building the cache key.
+ */
+std::uint64_t hash_bytes(const char *data, std::size_t sz, std::uint64_t seed = 14695981039346656037ULL);
+
+/**
+ * the identity (size, modification time) of a file, used to detect the change of the corpus without reading it.
+ * return empty string if the file is not found.
+ */
+std::string get_file_identity(const std::string &path);
+
+/**
+ * write the cache.
+ * all channels should have the same instance number.
+ */
+void write_corpus_cache(std::ostream &os, std::uint64_t key, const std::string &dict_bytes,
+    const std::vector<CorpusChannelBuilder> &channel_list);
+
+/**
+ * write the cache to a temporary file and rename it to `path`, so the concurrent readers never see partial file.
+ * return : bool, true if written.
+ */
+bool write_corpus_cache_file(const std::string &path, std::uint64_t key, const std::string &dict_bytes,
+    const std::vector<CorpusChannelBuilder> &channel_list);
+
+/**
+ * read-only mapped corpus cache. spans are valid during the life time of the object.
+ */
+class MappedCorpusCache
+{
+public:
+    explicit MappedCorpusCache(const std::string &path);
+    ~MappedCorpusCache();
+    MappedCorpusCache(const MappedCorpusCache&) = delete;
+    MappedCorpusCache& operator=(const MappedCorpusCache&) = delete;
+public:
+    std::uint64_t get_key() const { return header.key; }
+    const char* get_dict_data() const { return base + header.dict_offset; }
+    std::size_t get_dict_size() const { return static_cast<std::size_t>(header.dict_size); }
+    std::size_t get_channel_num() const { return static_cast<std::size_t>(header.nr_channel); }
+    std::size_t get_instance_num() const { return static_cast<std::size_t>(header.nr_instance); }
+    IndexSpan get_span(std::size_t channel, std::size_t instance) const;
+private:
+    void release() noexcept;
+private:
+    char *base;
+    std::size_t file_sz;
+    bool is_mapped;
+    CorpusCacheHeader header;
+    std::vector<const std::uint64_t*> channel_offset_list;
+    std::vector<const std::int32_t*> channel_data_list;
+};
+
+/**
+ * open the cache at `path` if it exists and its key is `key`.
+ * return : nullptr if it is not found, stale or broken.
+ */
+std::shared_ptr<const MappedCorpusCache> open_corpus_cache(const std::string &path, std::uint64_t key);
+
+
+/**********************
+ * Inline Implementation
+ **********************/
+
+inline
+IndexSpan MappedCorpusCache::get_span(std::size_t channel, std::size_t instance) const
+{
+    const std::uint64_t *offset_list = channel_offset_list[channel];
+    return IndexSpan{ channel_data_list[channel] + offset_list[instance],
+        static_cast<std::size_t>(offset_list[instance + 1] - offset_list[instance]) };
+}
+
+} // end of namespace corpus_cache
+} // end of namespace trivial
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,128 @@
+#include <sstream>
+#include "bigram_lookup_table.h"
+using namespace std;
+
+namespace slnn{
+namespace trivial{
+namespace lookup_table{
+
+constexpr char32_t BigramLookupTableWithReplace::EosChar;
+constexpr BigramLookupTableWithReplace::Index BigramLookupTableWithReplace::UnkUnsetValue;
+
+BigramLookupTableWithReplace::BigramLookupTableWithReplace(const u32string &eos_repr, size_t seed,
+    unsigned cnt_threshold, float prob_threshold)
+    :is_frozen(false),
+    unk_idx(UnkUnsetValue),
+    eos_repr(eos_repr),
+    prng(make_shared<mt19937>(seed)),
+    cnt_threshold(cnt_threshold),
+    prob_threshold(prob_threshold)
+{
+    rehash(16U);
+}
+
+BigramLookupTableWithReplace::Index
+BigramLookupTableWithReplace::add(KeyType key)
+{
+    // keep load factor <= 0.5, so the probing is short.
+    if( (idx2key.size() + 1U) * 2U > slot_list.size() ){ rehash(slot_list.size() * 2U); }
+    Index idx = static_cast<Index>(idx2key.size());
+    size_t mask = slot_list.size() - 1U;
+    size_t pos = slot_pos(key);
+    while( slot_list[pos].idx != UnkUnsetValue ){ pos = (pos + 1U) & mask; }
+    slot_list[pos] = Slot{ key, idx };
+    idx2key.push_back(key);
+    return idx;
+}
+
+void BigramLookupTableWithReplace::rehash(size_t nr_slot)
+{
+    unsigned log2_nr_slot = 0;
+    while( (static_cast<size_t>(1U) << log2_nr_slot) < nr_slot ){ ++log2_nr_slot; }
+    slot_list.assign(static_cast<size_t>(1U) << log2_nr_slot, Slot{ 0U, UnkUnsetValue });
+    slot_shift = 64U - log2_nr_slot;
+    size_t mask = slot_list.size() - 1U;
+    for( size_t idx = 0; idx < idx2key.size(); ++idx )
+    {
+        size_t pos = slot_pos(idx2key[idx]);
+        while( slot_list[pos].idx != UnkUnsetValue ){ pos = (pos + 1U) & mask; }
+        slot_list[pos] = Slot{ idx2key[idx], static_cast<Index>(idx) };
+    }
+}
+
+void BigramLookupTableWithReplace::set_unk()
+{
+    if( has_set_unk() ){ return; }
+    if( !has_frozen() ){ throw logic_error("before set unk, lookup table should be frozen firstly."); }
+    unk_idx = static_cast<Index>(idx2key.size());
+}
+
+BigramLookupTableWithReplace::Index
+BigramLookupTableWithReplace::get_unk_idx() const
+{
+    if( !has_set_unk() ){ throw logic_error("unk was not set."); }
+    return unk_idx;
+}
+
+size_t BigramLookupTableWithReplace::count_ban_unk(Index idx) const
+{
+    if( is_unk_idx(idx) ){ throw domain_error("unk index('" + to_string(idx) + "') was banned."); }
+    if( idx >= 0 && idx < static_cast<Index>(size_without_unk()) ){ return cnt[idx]; }
+    else{ return 0U; }
+}
+
+void BigramLookupTableWithReplace::reset() noexcept
+{
+    idx2key.clear();
+    cnt.clear();
+    rehash(16U);
+    is_frozen = false;
+    unk_idx = UnkUnsetValue;
+}
+
+void BigramLookupTableWithReplace::set_unk_replace_threshold(unsigned cnt_threshold, float prob_threshold) noexcept
+{
+    this->cnt_threshold = cnt_threshold;
+    this->prob_threshold = prob_threshold;
+}
+
+BigramLookupTableWithReplace::Index
+BigramLookupTableWithReplace::unk_replace_in_probability(Index idx) const
+{
+    if( !has_set_unk() ){ throw logic_error("unk was not set."); }
+    else if( idx == unk_idx ){ return idx; }
+    else if( idx >= 0 && idx < static_cast<Index>(size_without_unk()) )
+    {
+        if( cnt[idx] <= cnt_threshold && uniform_real_distribution<float>(0, 1)(*prng) <= prob_threshold ){ return unk_idx; }
+        else{ return idx; }
+    }
+    else
+    {
+        ostringstream oss;
+        oss << "index '" << idx << "' was out of range( size = " << size() << ")";
+        throw out_of_range(oss.str());
+    }
+}
+
+u32string BigramLookupTableWithReplace::key2ustr(KeyType key) const
+{
+    char32_t first = static_cast<char32_t>(key >> 32),
+        second = static_cast<char32_t>(key & 0xFFFFFFFFU);
+    if( second == EosChar ){ return first + eos_repr; }
+    else{ return u32string{ first, second }; }
+}
+
+BigramLookupTableWithReplace::KeyType
+BigramLookupTableWithReplace::ustr2key(const u32string &ustr) const
+{
+    if( ustr.size() == eos_repr.size() + 1U && ustr.compare(1U, u32string::npos, eos_repr) == 0 )
+    {
+        return make_key(ustr[0], EosChar);
+    }
+    else if( ustr.size() == 2U ){ return make_key(ustr[0], ustr[1]); }
+    else{ throw runtime_error("bigram lookup table: token (length " + to_string(ustr.size()) + ") is not a bigram."); }
+}
+
+} // end of namespace lookup_table
+} // end of namespace trivial
+} // end of namespace slnn
@@ -0,0 +1,224 @@
+/**
+ * BigramLookupTableWithReplace.
+ * LookupTableWithReplace for the character bigram, keyed by the packed 64-bit integer of the 2 chars.
+ */
+
+#ifndef SLNN_TRIVIAL_BIGRAM_LOOKUP_TABLE_H_
+#define SLNN_TRIVIAL_BIGRAM_LOOKUP_TABLE_H_
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <memory>
+#include <stdexcept>
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/split_member.hpp>
+namespace slnn{
+namespace trivial{
+namespace lookup_table{
+
+/**
+ * the same interface (and behavior) as LookupTableWithReplace<std::u32string> for the bigram,
+ * but the key is `(first << 32) | second`, stored in an open-addressing (linear probing) hash table,
+ * so no string is built (allocated) and hashed for every character.
+ * the end-of-sentence bigram has `EosChar` (not a valid code point) as the second char.
+ * serialization is the same as LookupTableWithReplace<std::u32string>: the bigram is saved as the 2-char string,
+ * and the end-of-sentence bigram as `first + eos_repr`. so the models with the string keyed dict are still loaded.
+ */
+class BigramLookupTableWithReplace
+{
+    friend class boost::serialization::access;
+public:
+    using Index = int;
+    using KeyType = std::uint64_t;
+    static constexpr char32_t EosChar = 0xFFFFFFFFU;
+public:
+    explicit BigramLookupTableWithReplace(const std::u32string &eos_repr, std::size_t seed = 1234,
+        unsigned cnt_threshold = 1, float prob_threshold = 0.2f);
+
+    static KeyType make_key(char32_t first, char32_t second) noexcept
+    { return (static_cast<KeyType>(first) << 32) | static_cast<KeyType>(second); }
+
+    /**
+     * convert bigram to index. if not frozen, add the bigram to dict when firstly occurring, and count it.
+     * @exception out_of_range, if frozen && bigram not in dict && !has_set_unk
+     */
+    Index convert(char32_t first, char32_t second);
+    // never add
+    Index convert(char32_t first, char32_t second) const;
+
+    void set_unk();
+    Index get_unk_idx() const;
+    Index get_unk_idx_without_throw() const noexcept { return unk_idx; }
+    bool has_set_unk() const noexcept { return unk_idx != UnkUnsetValue; }
+    bool is_unk_idx(Index idx) const noexcept { return has_set_unk() && idx == unk_idx; }
+
+    void freeze() noexcept { is_frozen = true; }
+    bool has_frozen() const noexcept { return is_frozen; }
+
+    // occurrence times
+    std::size_t count(char32_t first, char32_t second) const noexcept;
+    std::size_t count_ban_unk(Index idx) const;
+
+    void reset() noexcept;
+    std::size_t size() const noexcept { return has_set_unk() ? idx2key.size() + 1U : idx2key.size(); }
+    std::size_t size_without_unk() const noexcept { return idx2key.size(); }
+
+    int get_cnt_threshold(){ return cnt_threshold; }
+    float get_prob_threshold(){ return prob_threshold; }
+    void set_unk_replace_threshold(unsigned cnt_threshold, float prob_threshold) noexcept;
+    Index unk_replace_in_probability(Index idx) const;
+
+private:
+    struct Slot
+    {
+        KeyType key;
+        Index idx; // UnkUnsetValue for empty slot
+    };
+    std::size_t slot_pos(KeyType key) const noexcept;
+    Index find(KeyType key) const noexcept;
+    Index add(KeyType key);
+    void rehash(std::size_t nr_slot);
+    std::u32string key2ustr(KeyType key) const;
+    KeyType ustr2key(const std::u32string &ustr) const;
+
+private:
+    template<class Archive>
+    void save(Archive &ar, const unsigned int) const;
+    template <class Archive>
+    void load(Archive &ar, const unsigned int);
+    BOOST_SERIALIZATION_SPLIT_MEMBER();
+
+private:
+    static constexpr Index UnkUnsetValue = -1;
+    std::vector<Slot> slot_list; // size is power of 2, load factor <= 0.5
+    unsigned slot_shift; // 64 - log2(slot number)
+    std::vector<KeyType> idx2key;
+    std::vector<unsigned> cnt;
+    bool is_frozen;
+    Index unk_idx;
+    std::u32string eos_repr;
+    std::shared_ptr<std::mt19937> prng;
+    unsigned cnt_threshold;
+    float prob_threshold;
+};
+
+
+/*************************************
+ * Inline/Template Implementation
+ *************************************/
+
+inline
+std::size_t BigramLookupTableWithReplace::slot_pos(KeyType key) const noexcept
+{
+    // fibonacci hashing: the high bits of the product depend on all the bits of the key.
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> slot_shift);
+}
+
+inline
+BigramLookupTableWithReplace::Index
+BigramLookupTableWithReplace::find(KeyType key) const noexcept
+{
+    std::size_t mask = slot_list.size() - 1U;
+    for( std::size_t pos = slot_pos(key); ; pos = (pos + 1U) & mask )
+    {
+        const Slot &slot = slot_list[pos];
+        if( slot.idx == UnkUnsetValue || slot.key == key ){ return slot.idx; }
+    }
+}
+
+inline
+BigramLookupTableWithReplace::Index
+BigramLookupTableWithReplace::convert(char32_t first, char32_t second)
+{
+    KeyType key = make_key(first, second);
+    Index idx = find(key);
+    if( idx == UnkUnsetValue )
+    {
+        if( has_frozen() )
+        {
+            if( has_set_unk() ){ return unk_idx; }
+            else{ throw std::out_of_range("bigram was not in LookupTable."); }
+        }
+        idx = add(key);
+        cnt.push_back(1U);
+    }
+    else if( !has_frozen() ){ ++cnt[idx]; }
+    return idx;
+}
+
+inline
+BigramLookupTableWithReplace::Index
+BigramLookupTableWithReplace::convert(char32_t first, char32_t second) const
+{
+    Index idx = find(make_key(first, second));
+    if( idx != UnkUnsetValue ){ return idx; }
+    else if( has_set_unk() ){ return unk_idx; }
+    else{ throw std::out_of_range("bigram was not in LookupTable."); }
+}
+
+inline
+std::size_t BigramLookupTableWithReplace::count(char32_t first, char32_t second) const noexcept
+{
+    Index idx = find(make_key(first, second));
+    return idx == UnkUnsetValue ? 0U : cnt[idx];
+}
+
+template <class Archive>
+void BigramLookupTableWithReplace::save(Archive &ar, const unsigned int) const
+{
+    // the same sequence as LookupTableWithReplace<std::u32string>
+    ar &cnt_threshold &prob_threshold;
+    ar &cnt;
+    unsigned dict_sz = idx2key.size();
+    ar &dict_sz;
+    // token2idx
+    for( Index idx = 0; idx < static_cast<Index>(dict_sz); ++idx )
+    {
+        std::u32string ustr = key2ustr(idx2key[idx]);
+        std::vector<unsigned> equal_value(ustr.begin(), ustr.end());
+        ar &equal_value &idx;
+    }
+    // idx2token
+    for( KeyType key : idx2key )
+    {
+        std::u32string ustr = key2ustr(key);
+        std::vector<unsigned> equal_value(ustr.begin(), ustr.end());
+        ar &equal_value;
+    }
+    ar &is_frozen &unk_idx;
+}
+
+template <class Archive>
+void BigramLookupTableWithReplace::load(Archive &ar, const unsigned int)
+{
+    ar &cnt_threshold &prob_threshold;
+    ar &cnt;
+    unsigned dict_sz;
+    ar &dict_sz;
+    // token2idx, only to skip. idx2token is enough to re-build the hash table.
+    for( unsigned i = 0; i < dict_sz; ++i )
+    {
+        std::vector<unsigned> equal_value;
+        Index idx;
+        ar &equal_value &idx;
+    }
+    idx2key.clear();
+    rehash(16U);
+    for( unsigned i = 0; i < dict_sz; ++i )
+    {
+        std::vector<unsigned> unicode_pnt_list;
+        ar &unicode_pnt_list;
+        add(ustr2key(std::u32string(unicode_pnt_list.begin(), unicode_pnt_list.end())));
+    }
+    ar &is_frozen &unk_idx;
+    if( cnt.size() != idx2key.size() ){ throw std::runtime_error("bigram lookup table: count size is not matched."); }
+}
+
+} // end of namespace lookup_table
+using lookup_table::BigramLookupTableWithReplace;
+} // end of namespace trivial
+} // end of namespace slnn
+
+#endif
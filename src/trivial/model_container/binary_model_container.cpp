@@ -0,0 +1,155 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "binary_model_container.h"
+
+namespace slnn{
+namespace trivial{
+namespace model_container{
+
+namespace inner{
+
+const char Magic[8] = { 'S', 'L', 'N', 'N', 'B', 'I', 'N', '\0' };
+constexpr std::uint32_t EndianTag = 0x01020304U;
+
+inline
+std::uint64_t align_offset(std::uint64_t offset)
+{
+    return (offset + SectionAlignment - 1U) / SectionAlignment * SectionAlignment;
+}
+
+inline
+void write_padding(std::ostream &os, std::uint64_t from, std::uint64_t to)
+{
+    static const char zeros[SectionAlignment] = {};
+    os.write(zeros, static_cast<std::streamsize>(to - from));
+}
+
+} // end of namespace inner
+
+void write_binary_model(std::ostream &os, const std::string &dict_bytes, const std::vector<TensorView> &tensor_list)
+{
+    ModelFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, inner::Magic, sizeof(header.magic));
+    header.version = FormatVersion;
+    header.endian_tag = inner::EndianTag;
+    header.dict_offset = inner::align_offset(sizeof(ModelFileHeader));
+    header.dict_size = dict_bytes.size();
+    header.tensor_table_offset = inner::align_offset(header.dict_offset + header.dict_size);
+    header.nr_tensor = tensor_list.size();
+    header.param_offset = inner::align_offset(header.tensor_table_offset + header.nr_tensor * sizeof(std::uint64_t));
+    std::uint64_t param_end = header.param_offset;
+    for( const TensorView &t : tensor_list ){ param_end = inner::align_offset(param_end + t.size * sizeof(float)); }
+    header.param_size = param_end - header.param_offset;
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    inner::write_padding(os, sizeof(header), header.dict_offset);
+    os.write(dict_bytes.data(), static_cast<std::streamsize>(dict_bytes.size()));
+    inner::write_padding(os, header.dict_offset + header.dict_size, header.tensor_table_offset);
+    for( const TensorView &t : tensor_list )
+    {
+        std::uint64_t sz = t.size;
+        os.write(reinterpret_cast<const char*>(&sz), sizeof(sz));
+    }
+    std::uint64_t cur = header.tensor_table_offset + header.nr_tensor * sizeof(std::uint64_t);
+    inner::write_padding(os, cur, header.param_offset);
+    cur = header.param_offset;
+    for( const TensorView &t : tensor_list )
+    {
+        os.write(reinterpret_cast<const char*>(t.data), static_cast<std::streamsize>(t.size * sizeof(float)));
+        std::uint64_t next = inner::align_offset(cur + t.size * sizeof(float));
+        inner::write_padding(os, cur + t.size * sizeof(float), next);
+        cur = next;
+    }
+    if( !os ){ throw std::runtime_error("failed to write binary model."); }
+}
+
+bool is_binary_model(const std::string &path)
+{
+    std::ifstream is(path, std::ios::binary);
+    char magic[sizeof(inner::Magic)];
+    if( !is.read(magic, sizeof(magic)) ){ return false; }
+    return std::memcmp(magic, inner::Magic, sizeof(magic)) == 0;
+}
+
+MappedModelFile::MappedModelFile(const std::string &path)
+    :base(nullptr),
+    file_sz(0),
+    is_mapped(false)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if( fd < 0 ){ throw std::runtime_error("failed to open binary model: '" + path + "'"); }
+    struct stat file_stat;
+    if( fstat(fd, &file_stat) != 0 ){ close(fd); throw std::runtime_error("failed to stat binary model: '" + path + "'"); }
+    file_sz = static_cast<std::size_t>(file_stat.st_size);
+    void *mem = file_sz > 0 ? mmap(nullptr, file_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if( mem == MAP_FAILED ){ throw std::runtime_error("failed to map binary model: '" + path + "'"); }
+    base = static_cast<char*>(mem);
+    is_mapped = true;
+#else
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    if( !is ){ throw std::runtime_error("failed to open binary model: '" + path + "'"); }
+    file_sz = static_cast<std::size_t>(is.tellg());
+    // operator new gives the alignment for float; the section offsets are aligned relative to the start.
+    base = static_cast<char*>(::operator new(file_sz));
+    is.seekg(0);
+    is.read(base, file_sz);
+#endif
+    auto fail = [this, &path](const std::string &reason)
+    {
+        this->release();
+        throw std::runtime_error("invalid binary model '" + path + "': " + reason);
+    };
+    if( file_sz < sizeof(ModelFileHeader) ){ fail("file is too small"); }
+    std::memcpy(&header, base, sizeof(header));
+    if( std::memcmp(header.magic, inner::Magic, sizeof(header.magic)) != 0 ){ fail("magic is not matched"); }
+    if( header.endian_tag != inner::EndianTag ){ fail("byte order is not matched"); }
+    if( header.version > FormatVersion ){ fail("version " + std::to_string(header.version) + " is not supported"); }
+    if( header.dict_offset + header.dict_size > file_sz ||
+        header.tensor_table_offset + header.nr_tensor * sizeof(std::uint64_t) > file_sz ||
+        header.param_offset + header.param_size > file_sz )
+    {
+        fail("section out of file range");
+    }
+    const std::uint64_t *tensor_sz_list = reinterpret_cast<const std::uint64_t*>(base + header.tensor_table_offset);
+    std::uint64_t cur = header.param_offset,
+        param_end = header.param_offset + header.param_size;
+    tensor_list.reserve(header.nr_tensor);
+    for( std::uint64_t i = 0; i < header.nr_tensor; ++i )
+    {
+        std::uint64_t byte_sz = tensor_sz_list[i] * sizeof(float);
+        if( cur + byte_sz > param_end ){ fail("tensor out of parameter section"); }
+        tensor_list.push_back(TensorView{ reinterpret_cast<const float*>(base + cur),
+            static_cast<std::size_t>(tensor_sz_list[i]) });
+        cur = inner::align_offset(cur + byte_sz);
+    }
+}
+
+MappedModelFile::~MappedModelFile()
+{
+    release();
+}
+
+void MappedModelFile::release() noexcept
+{
+    if( !base ){ return; }
+#ifndef _WIN32
+    if( is_mapped ){ munmap(base, file_sz); }
+#else
+    ::operator delete(base);
+#endif
+    base = nullptr;
+}
+
+} // end of namespace model_container
+} // end of namespace trivial
+} // end of namespace slnn
@@ -0,0 +1,93 @@
+#ifndef SLNN_TRIVIAL_MODEL_CONTAINER_BINARY_MODEL_CONTAINER_H_
+#define SLNN_TRIVIAL_MODEL_CONTAINER_BINARY_MODEL_CONTAINER_H_
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+namespace slnn{
+namespace trivial{
+namespace model_container{
+
+/**
+ * Binary model container.
+ * file layout:
+ *   1. header (fixed size, see `ModelFileHeader`)
+ *   2. dict section: model meta info(seed, structure param, token dictionary), serialized by the model self.
+ *   3. tensor table: element number of every tensor (uint64)
+ *   4. parameter section: raw float data of every tensor, every tensor starts at `SectionAlignment` aligned offset.
+ * the parameter section is used in place after the file is mapped, so loading costs almost nothing and
+ * processes loading the same model share the page cache.
+ * data is written in host byte order, `endian_tag` is checked when reading.
+ */
+
+constexpr std::uint32_t FormatVersion = 1U;
+constexpr std::size_t SectionAlignment = 64U;
+
+struct ModelFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint64_t dict_offset;
+    std::uint64_t dict_size;
+    std::uint64_t tensor_table_offset;
+    std::uint64_t nr_tensor;
+    std::uint64_t param_offset;
+    std::uint64_t param_size;
+};
+
+struct TensorView
+{
+    const float *data;
+    std::size_t size; // element number
+};
+
+/**
+ * write the container.
+ * @param os output stream (should be opened in binary mode)
+ * @param dict_bytes dict section content
+ * @param tensor_list parameter tensors, the order should be the same when binding them back.
+ */
+void write_binary_model(std::ostream &os, const std::string &dict_bytes, const std::vector<TensorView> &tensor_list);
+
+/**
+ * check whether the file is a binary model container (by magic).
+ */
+bool is_binary_model(const std::string &path);
+
+/**
+ * read-only view of a binary model file.
+ * the file is mapped (copy-on-write private mapping, pages are shared until written),
+ * tensor data pointers are valid during the life time of the object.
+ */
+class MappedModelFile
+{
+public:
+    explicit MappedModelFile(const std::string &path);
+    ~MappedModelFile();
+    MappedModelFile(const MappedModelFile&) = delete;
+    MappedModelFile& operator=(const MappedModelFile&) = delete;
+public:
+    std::uint32_t get_version() const { return header.version; }
+    const char* get_dict_data() const { return base + header.dict_offset; }
+    std::size_t get_dict_size() const { return static_cast<std::size_t>(header.dict_size); }
+    std::size_t get_tensor_num() const { return tensor_list.size(); }
+    const TensorView& get_tensor(std::size_t i) const { return tensor_list.at(i); }
+    // the tensor data is writable (copy-on-write), for the frameworks which need non-const pointer.
+    float* get_mutable_tensor_data(std::size_t i) const { return const_cast<float*>(tensor_list.at(i).data); }
+private:
+    void release() noexcept;
+private:
+    char *base;
+    std::size_t file_sz;
+    bool is_mapped;
+    ModelFileHeader header;
+    std::vector<TensorView> tensor_list;
+};
+
+} // end of namespace model_container
+} // end of namespace trivial
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include "double_array_trie.h"
+
+namespace slnn{
+namespace trivial{
+namespace trie{
+
+namespace inner{
+
+constexpr std::int32_t FreeSlot = -1;
+constexpr std::int32_t RootCheck = -2; // root is not a child of any state
+// a free slot which has failed to be the first child so many times is dropped from the free list (retired),
+// to avoid scanning the holes in the dense area again and again (it wastes little space).
+// a retired slot is still free (check == FreeSlot), it can be taken as a child later without unlinking again.
+constexpr std::uint8_t MaxTryTimes = 8;
+
+} // end of namespace inner
+
+constexpr DoubleArrayTrie::CodeT DoubleArrayTrie::UnkCode;
+
+DoubleArrayTrie::DoubleArrayTrie()
+    :nr_word(0)
+{}
+
+void DoubleArrayTrie::clear()
+{
+    base.clear();
+    check.clear();
+    is_word_end.clear();
+    alphabet.clear();
+    char2code.clear();
+    nr_word = 0;
+    free_next.clear();
+    free_prev.clear();
+    try_cnt.clear();
+}
+
+void DoubleArrayTrie::build(const std::vector<std::u32string> &word_list)
+{
+    clear();
+    // 1. alphabet, code is assigned by char order.
+    for( const std::u32string &word : word_list ){ alphabet.insert(alphabet.end(), word.begin(), word.end()); }
+    std::sort(alphabet.begin(), alphabet.end());
+    alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+    build_alphabet_index();
+    // 2. sorted, unique code words. so the words with the same prefix is in a continuous range.
+    std::vector<std::vector<CodeT>> code_word_list;
+    code_word_list.reserve(word_list.size());
+    for( const std::u32string &word : word_list )
+    {
+        if( word.empty() ){ continue; }
+        std::vector<CodeT> code_word;
+        encode(word, code_word);
+        code_word_list.push_back(std::move(code_word));
+    }
+    std::sort(code_word_list.begin(), code_word_list.end());
+    code_word_list.erase(std::unique(code_word_list.begin(), code_word_list.end()), code_word_list.end());
+    nr_word = code_word_list.size();
+    // 3. states
+    free_next.assign(1, 0);
+    free_prev.assign(1, 0);
+    try_cnt.assign(1, 0);
+    ensure_size(std::max<std::size_t>(alphabet.size() + 2, 1024));
+    check[0] = inner::RootCheck;
+    base[0] = 1;
+    if( !code_word_list.empty() ){ insert_children(0, code_word_list, 0, code_word_list.size(), 0); }
+    // shrink the tail free slots
+    std::size_t used_sz = check.size();
+    while( used_sz > 1 && check[used_sz - 1] == inner::FreeSlot ){ --used_sz; }
+    base.resize(used_sz);
+    check.resize(used_sz);
+    is_word_end.resize(used_sz);
+    base.shrink_to_fit();
+    check.shrink_to_fit();
+    is_word_end.shrink_to_fit();
+    std::vector<std::int32_t>().swap(free_next);
+    std::vector<std::int32_t>().swap(free_prev);
+    std::vector<std::uint8_t>().swap(try_cnt);
+}
+
+void DoubleArrayTrie::encode(const std::u32string &charseq, std::vector<CodeT> &out_codeseq) const
+{
+    out_codeseq.resize(charseq.size());
+    for( std::size_t i = 0; i < charseq.size(); ++i ){ out_codeseq[i] = encode(charseq[i]); }
+}
+
+bool DoubleArrayTrie::contains(const std::u32string &word) const
+{
+    if( word.empty() ){ return false; }
+    std::vector<CodeT> code_word;
+    encode(word, code_word);
+    bool is_found = false;
+    std::size_t word_len = word.size();
+    prefix_search(code_word.data(), code_word.data() + word_len,
+        [&is_found, word_len](std::size_t len){ if( len == word_len ){ is_found = true; } });
+    return is_found;
+}
+
+void DoubleArrayTrie::build_alphabet_index()
+{
+    char2code.clear();
+    char2code.reserve(alphabet.size());
+    for( std::size_t i = 0; i < alphabet.size(); ++i ){ char2code[alphabet[i]] = static_cast<CodeT>(i + 1); }
+}
+
+void DoubleArrayTrie::ensure_size(std::size_t sz)
+{
+    if( sz <= check.size() ){ return; }
+    if( sz > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()) )
+    {
+        throw std::length_error("double array trie: too many states.");
+    }
+    std::size_t old_sz = check.size(),
+        new_sz = std::max(sz, old_sz * 2);
+    base.resize(new_sz, 0);
+    check.resize(new_sz, inner::FreeSlot);
+    is_word_end.resize(new_sz, 0);
+    // append the new slots to the tail of the free list
+    free_next.resize(new_sz);
+    free_prev.resize(new_sz);
+    try_cnt.resize(new_sz, 0);
+    for( std::size_t pos = std::max<std::size_t>(old_sz, 1); pos < new_sz; ++pos )
+    {
+        std::int32_t tail = free_prev[0];
+        free_next[tail] = static_cast<std::int32_t>(pos);
+        free_prev[pos] = tail;
+        free_next[pos] = 0;
+        free_prev[0] = static_cast<std::int32_t>(pos);
+    }
+}
+
+void DoubleArrayTrie::occupy(std::size_t pos)
+{
+    if( try_cnt[pos] >= inner::MaxTryTimes ){ return; } // retired, already out of the free list
+    unlink_free_slot(pos);
+}
+
+void DoubleArrayTrie::retire(std::size_t pos)
+{
+    unlink_free_slot(pos);
+    try_cnt[pos] = inner::MaxTryTimes;
+}
+
+void DoubleArrayTrie::unlink_free_slot(std::size_t pos)
+{
+    free_next[free_prev[pos]] = free_next[pos];
+    free_prev[free_next[pos]] = free_prev[pos];
+}
+
+/**
+ * place the children of `state`. words in [range_begin, range_end) share the prefix (length = depth) of `state`.
+ */
+void DoubleArrayTrie::insert_children(std::int32_t state, const std::vector<std::vector<CodeT>> &code_word_list,
+    std::size_t range_begin, std::size_t range_end, std::size_t depth)
+{
+    // the shortest word (if its length == depth) is the first one in sorted order.
+    if( code_word_list[range_begin].size() == depth )
+    {
+        is_word_end[state] = 1;
+        ++range_begin;
+    }
+    if( range_begin == range_end ){ return; }
+    // children codes and the corresponding ranges
+    std::vector<CodeT> child_code_list;
+    std::vector<std::size_t> child_range_begin_list;
+    for( std::size_t i = range_begin; i < range_end; ++i )
+    {
+        CodeT code = code_word_list[i][depth];
+        if( child_code_list.empty() || child_code_list.back() != code )
+        {
+            child_code_list.push_back(code);
+            child_range_begin_list.push_back(i);
+        }
+    }
+    child_range_begin_list.push_back(range_end);
+    // find base: all `base + code` slots should be free. try the free slots (in position order) for the first child.
+    CodeT first_code = child_code_list.front(),
+        last_code = child_code_list.back();
+    std::size_t state_base = 0;
+    std::size_t pos = static_cast<std::size_t>(free_next[0]);
+    while( true )
+    {
+        if( pos == 0 )
+        {
+            // no free slot fits, get new slots at the tail.
+            std::size_t tail_base = std::max<std::size_t>(check.size(), first_code + 1) - first_code;
+            ensure_size(tail_base + last_code + 1);
+            pos = tail_base + first_code;
+        }
+        if( pos > first_code )
+        {
+            state_base = pos - first_code;
+            ensure_size(state_base + last_code + 1);
+            bool is_fit = true;
+            for( CodeT code : child_code_list )
+            {
+                if( check[state_base + code] != inner::FreeSlot ){ is_fit = false; break; }
+            }
+            if( is_fit ){ break; }
+        }
+        std::size_t next_pos = static_cast<std::size_t>(free_next[pos]);
+        if( ++try_cnt[pos] >= inner::MaxTryTimes ){ retire(pos); }
+        pos = next_pos;
+    }
+    base[state] = static_cast<std::int32_t>(state_base);
+    for( CodeT code : child_code_list )
+    {
+        check[state_base + code] = state;
+        occupy(state_base + code);
+    }
+    for( std::size_t i = 0; i < child_code_list.size(); ++i )
+    {
+        insert_children(static_cast<std::int32_t>(state_base + child_code_list[i]), code_word_list,
+            child_range_begin_list[i], child_range_begin_list[i + 1], depth + 1);
+    }
+}
+
+} // end of namespace trie
+} // end of namespace trivial
+} // end of namespace slnn
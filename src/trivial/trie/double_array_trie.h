@@ -0,0 +1,137 @@
+/**
+ * DoubleArrayTrie, a static (build once) trie for unicode word set.
+ * transitions are stored in two flat int arrays (base, check): from state `s` by char code `c`,
+ * the next state is `t = base[s] + c`, which is valid only if `check[t] == s`.
+ * chars are mapped to dense codes (1 ~ alphabet size) before walking, so every prefix match
+ * from a position is got by one walk without allocation or hashing of strings.
+ */
+
+#ifndef SLNN_TRIVIAL_TRIE_DOUBLE_ARRAY_TRIE_H_
+#define SLNN_TRIVIAL_TRIE_DOUBLE_ARRAY_TRIE_H_
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/split_member.hpp>
+namespace slnn{
+namespace trivial{
+namespace trie{
+
+class DoubleArrayTrie
+{
+    friend class boost::serialization::access;
+public:
+    using CodeT = std::uint32_t;
+    static constexpr CodeT UnkCode = 0U; // char not in the alphabet, no transition for it.
+public:
+    DoubleArrayTrie();
+    /**
+     * build from word list (duplicated and empty words are allowed, they are ignored).
+     */
+    void build(const std::vector<std::u32string> &word_list);
+    void clear();
+    std::size_t size() const { return nr_word; }
+    std::size_t get_state_num() const { return check.size(); }
+    /**
+     * map the char sequence to code sequence, then using code sequence to do match.
+     */
+    void encode(const std::u32string &charseq, std::vector<CodeT> &out_codeseq) const;
+    CodeT encode(char32_t uc) const;
+    bool contains(const std::u32string &word) const;
+    /**
+     * call `on_match(len)` for every word which is the prefix of [code_begin, code_end), in length increasing order.
+     */
+    template <typename MatchFunc>
+    void prefix_search(const CodeT *code_begin, const CodeT *code_end, MatchFunc on_match) const;
+    /**
+     * @return length of the longest word which is the prefix of [code_begin, code_end), 0 if not found.
+     */
+    std::size_t longest_prefix_match(const CodeT *code_begin, const CodeT *code_end) const;
+private:
+    template <class Archive>
+    void save(Archive &ar, const unsigned int) const;
+    template <class Archive>
+    void load(Archive &ar, const unsigned int);
+    BOOST_SERIALIZATION_SPLIT_MEMBER();
+    void build_alphabet_index();
+    void ensure_size(std::size_t sz);
+    void occupy(std::size_t pos);
+    void retire(std::size_t pos);
+    void unlink_free_slot(std::size_t pos);
+    void insert_children(std::int32_t state, const std::vector<std::vector<CodeT>> &code_word_list,
+        std::size_t range_begin, std::size_t range_end, std::size_t depth);
+private:
+    std::vector<std::int32_t> base;
+    std::vector<std::int32_t> check;
+    std::vector<std::uint8_t> is_word_end;
+    std::vector<char32_t> alphabet; // alphabet[code - 1] = char
+    std::unordered_map<char32_t, CodeT> char2code;
+    std::size_t nr_word;
+    // circular list of free slots (only used in building), slot 0 (root) is the list head.
+    std::vector<std::int32_t> free_next;
+    std::vector<std::int32_t> free_prev;
+    std::vector<std::uint8_t> try_cnt;
+};
+
+
+/**********************
+ * Inline/template Implementation
+ **********************/
+
+inline
+DoubleArrayTrie::CodeT DoubleArrayTrie::encode(char32_t uc) const
+{
+    auto iter = char2code.find(uc);
+    return iter == char2code.end() ? UnkCode : iter->second;
+}
+
+template <typename MatchFunc>
+void DoubleArrayTrie::prefix_search(const CodeT *code_begin, const CodeT *code_end, MatchFunc on_match) const
+{
+    if( check.empty() ){ return; }
+    std::int32_t state = 0;
+    std::size_t state_num = check.size();
+    for( const CodeT *p = code_begin; p != code_end; ++p )
+    {
+        if( *p == UnkCode ){ return; }
+        std::size_t next = static_cast<std::size_t>(base[state]) + *p;
+        if( next >= state_num || check[next] != state ){ return; }
+        state = static_cast<std::int32_t>(next);
+        if( is_word_end[state] ){ on_match(static_cast<std::size_t>(p - code_begin + 1)); }
+    }
+}
+
+inline
+std::size_t DoubleArrayTrie::longest_prefix_match(const CodeT *code_begin, const CodeT *code_end) const
+{
+    std::size_t longest = 0;
+    prefix_search(code_begin, code_end, [&longest](std::size_t len){ longest = len; });
+    return longest;
+}
+
+template <class Archive>
+void DoubleArrayTrie::save(Archive &ar, const unsigned int) const
+{
+    std::vector<std::uint32_t> alphabet_pnt_list(alphabet.begin(), alphabet.end());
+    std::uint64_t word_num = nr_word;
+    ar &base &check &is_word_end &alphabet_pnt_list &word_num;
+}
+
+template <class Archive>
+void DoubleArrayTrie::load(Archive &ar, const unsigned int)
+{
+    std::vector<std::uint32_t> alphabet_pnt_list;
+    std::uint64_t word_num;
+    ar &base &check &is_word_end &alphabet_pnt_list &word_num;
+    alphabet.assign(alphabet_pnt_list.begin(), alphabet_pnt_list.end());
+    nr_word = static_cast<std::size_t>(word_num);
+    build_alphabet_index();
+}
+
+} // end of namespace trie
+} // end of namespace trivial
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * micro-benchmark for the lexicon maximum-match feature extraction.
+ * compare (longest lexicon word from every position):
+ *  1. substr + pop_back + unordered_set probing (the original `TokenLexicon::extract`).
+ *  2. DoubleArrayTrie: encode the sentence once, one trie walk from every position.
+ * the lexicon and the sentences are random, sentences are made of lexicon words and random chars.
+ * usage: benchmark_lexicon_trie [lexicon_size=300000] [nr_sentence=20000] [alphabet_size=6000]
+ */
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include "trivial/trie/double_array_trie.h"
+
+using namespace std;
+using slnn::trivial::trie::DoubleArrayTrie;
+
+void hash_set_longest_match(const unordered_set<u32string> &lexicon, unsigned word_maxlen,
+    const u32string &charseq, vector<unsigned> &wordlen_list)
+{
+    wordlen_list.resize(charseq.size());
+    for( unsigned i = 0; i < charseq.size(); ++i )
+    {
+        u32string test_word = charseq.substr(i, word_maxlen);
+        while( test_word.length() > 1 )
+        {
+            if( lexicon.count(test_word) > 0 ){ break; }
+            test_word.pop_back();
+        }
+        wordlen_list[i] = test_word.size();
+    }
+}
+
+void trie_longest_match(const DoubleArrayTrie &lexicon, unsigned word_maxlen,
+    const u32string &charseq, vector<DoubleArrayTrie::CodeT> &codeseq, vector<unsigned> &wordlen_list)
+{
+    unsigned seq_len = charseq.size();
+    wordlen_list.resize(seq_len);
+    lexicon.encode(charseq, codeseq);
+    for( unsigned i = 0; i < seq_len; ++i )
+    {
+        unsigned match_end = min(seq_len, i + word_maxlen);
+        wordlen_list[i] = max<unsigned>(lexicon.longest_prefix_match(codeseq.data() + i, codeseq.data() + match_end), 1U);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned lexicon_size = argc > 1 ? stoul(argv[1]) : 300000,
+        nr_sentence = argc > 2 ? stoul(argv[2]) : 20000,
+        alphabet_size = argc > 3 ? stoul(argv[3]) : 6000;
+    mt19937 rng(1234);
+    uniform_int_distribution<char32_t> char_dist(0x4E00, 0x4E00 + alphabet_size - 1);
+    discrete_distribution<unsigned> wordlen_dist({ 0., 0., 60., 20., 12., 5., 2., 1. }); // 2 ~ 7 chars
+    vector<u32string> word_list(lexicon_size);
+    unsigned word_maxlen = 0;
+    for( u32string &word : word_list )
+    {
+        unsigned len = wordlen_dist(rng);
+        for( unsigned i = 0; i < len; ++i ){ word.push_back(char_dist(rng)); }
+        word_maxlen = max<unsigned>(word_maxlen, len);
+    }
+    uniform_int_distribution<unsigned> word_idx_dist(0, lexicon_size - 1),
+        sentence_piece_dist(10, 30);
+    bernoulli_distribution is_word_dist(0.6);
+    vector<u32string> sentence_list(nr_sentence);
+    unsigned long nr_char = 0;
+    for( u32string &sentence : sentence_list )
+    {
+        unsigned nr_piece = sentence_piece_dist(rng);
+        for( unsigned i = 0; i < nr_piece; ++i )
+        {
+            if( is_word_dist(rng) ){ sentence += word_list[word_idx_dist(rng)]; }
+            else { sentence.push_back(char_dist(rng)); }
+        }
+        nr_char += sentence.size();
+    }
+    // build
+    auto start_time = chrono::high_resolution_clock::now();
+    unordered_set<u32string> hash_lexicon(word_list.begin(), word_list.end());
+    auto hash_build_time = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start_time).count();
+    start_time = chrono::high_resolution_clock::now();
+    DoubleArrayTrie trie_lexicon;
+    trie_lexicon.build(word_list);
+    auto trie_build_time = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start_time).count();
+    // match
+    vector<vector<unsigned>> hash_result(nr_sentence),
+        trie_result(nr_sentence);
+    start_time = chrono::high_resolution_clock::now();
+    for( unsigned i = 0; i < nr_sentence; ++i ){ hash_set_longest_match(hash_lexicon, word_maxlen, sentence_list[i], hash_result[i]); }
+    auto hash_time = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start_time).count();
+    vector<DoubleArrayTrie::CodeT> codeseq;
+    start_time = chrono::high_resolution_clock::now();
+    for( unsigned i = 0; i < nr_sentence; ++i ){ trie_longest_match(trie_lexicon, word_maxlen, sentence_list[i], codeseq, trie_result[i]); }
+    auto trie_time = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start_time).count();
+
+    unsigned nr_diff = 0;
+    for( unsigned i = 0; i < nr_sentence; ++i ){ if( hash_result[i] != trie_result[i] ){ ++nr_diff; } }
+    auto speed = [nr_char](long long us){ return us > 0 ? nr_char / (us / 1e6) / 1e6 : 0.; };
+    cout << "lexicon size: " << trie_lexicon.size() << ", trie states: " << trie_lexicon.get_state_num()
+        << ", sentences: " << nr_sentence << ", chars: " << nr_char << "\n"
+        << "build: hash set " << hash_build_time / 1000. << " ms, trie " << trie_build_time / 1000. << " ms\n"
+        << "hash set match: " << hash_time / 1000. << " ms (" << speed(hash_time) << " M chars/s)\n"
+        << "trie match: " << trie_time / 1000. << " ms (" << speed(trie_time) << " M chars/s)\n"
+        << "speed up: " << (trie_time > 0 ? static_cast<double>(hash_time) / trie_time : 0.) << "\n"
+        << "different result: " << nr_diff << "\n";
+    return nr_diff == 0 ? 0 : 1;
+}
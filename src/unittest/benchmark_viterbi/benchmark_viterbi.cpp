@@ -0,0 +1,128 @@
+/**
+ * micro-benchmark for the CRF viterbi decoding.
+ * compare:
+ *  1. per-scalar path: get every init / transition / emission score by `get_value` on the graph,
+ *     then decode on `std::vector<std::vector<>>` (the original implementation of the CRF output layers).
+ *  2. ViterbiDecoder: read init / transition score once, fetch all the emission score in one tensor.
+ * usage: benchmark_viterbi [tag_num=50] [seq_len=50] [nr_round=100]
+ */
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "dynet/dynet.h"
+#include "dynet/expr.h"
+#include "modelmodule/viterbi_decoder.h"
+
+using namespace std;
+
+void per_scalar_viterbi(dynet::ComputationGraph &cg,
+    dynet::LookupParameter init_score_lookup_param, dynet::LookupParameter trans_score_lookup_param,
+    const vector<dynet::real> &emission, unsigned tag_num, unsigned len,
+    vector<slnn::Index> &pred_seq)
+{
+    vector<dynet::real> init_score(tag_num);
+    vector<dynet::real> trans_score(tag_num * tag_num);
+    vector<vector<dynet::real>> emit_score(len, vector<dynet::real>(tag_num));
+    for( unsigned i = 0; i < tag_num; ++i )
+    {
+        init_score[i] = dynet::as_scalar(cg.get_value(dynet::expr::lookup(cg, init_score_lookup_param, i)));
+    }
+    for( unsigned flat_idx = 0; flat_idx < tag_num * tag_num; ++flat_idx )
+    {
+        trans_score[flat_idx] = dynet::as_scalar(cg.get_value(dynet::expr::lookup(cg, trans_score_lookup_param, flat_idx)));
+    }
+    dynet::expr::Expression emission_expr = dynet::expr::input(cg, dynet::Dim({ tag_num * len }), emission);
+    for( unsigned t = 0; t < len; ++t )
+    {
+        for( unsigned i = 0; i < tag_num; ++i )
+        {
+            emit_score[t][i] = dynet::as_scalar(cg.get_value(dynet::expr::pick(emission_expr, i + tag_num * t)));
+        }
+    }
+    vector<vector<size_t>> path_matrix(len, vector<size_t>(tag_num));
+    vector<dynet::real> current_scores(tag_num),
+        pre_timestep_scores(tag_num);
+    for( unsigned i = 0; i < tag_num; ++i ){ current_scores[i] = init_score[i] + emit_score[0][i]; }
+    for( unsigned t = 1; t < len; ++t )
+    {
+        swap(pre_timestep_scores, current_scores);
+        for( unsigned i = 0; i < tag_num; ++i )
+        {
+            size_t pre_tag_with_max_score = 0;
+            dynet::real max_score = pre_timestep_scores[0] + trans_score[i];
+            for( unsigned pre_i = 1; pre_i < tag_num; ++pre_i )
+            {
+                dynet::real score = pre_timestep_scores[pre_i] + trans_score[pre_i * tag_num + i];
+                if( score > max_score ){ pre_tag_with_max_score = pre_i; max_score = score; }
+            }
+            path_matrix[t][i] = pre_tag_with_max_score;
+            current_scores[i] = max_score + emit_score[t][i];
+        }
+    }
+    vector<slnn::Index> tmp_pred_seq(len);
+    slnn::Index tag = distance(current_scores.cbegin(), max_element(current_scores.cbegin(), current_scores.cend()));
+    tmp_pred_seq[len - 1] = tag;
+    for( unsigned t = len - 1; t >= 1; --t )
+    {
+        tag = path_matrix[t][tag];
+        tmp_pred_seq[t - 1] = tag;
+    }
+    swap(pred_seq, tmp_pred_seq);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned tag_num = argc > 1 ? stoul(argv[1]) : 50,
+        seq_len = argc > 2 ? stoul(argv[2]) : 50,
+        nr_round = argc > 3 ? stoul(argv[3]) : 100;
+    int dynet_argc = 1;
+    char **dynet_argv = argv;
+    dynet::initialize(dynet_argc, dynet_argv, 1234);
+    dynet::Model model;
+    dynet::LookupParameter init_score_lookup_param = model.add_lookup_parameters(tag_num, { 1 });
+    dynet::LookupParameter trans_score_lookup_param = model.add_lookup_parameters(tag_num * tag_num, { 1 });
+    // random emission score for every round, flat index is `tag + tag_num * t`
+    mt19937 rng(1234);
+    uniform_real_distribution<dynet::real> dist(-1.f, 1.f);
+    vector<vector<dynet::real>> emission_list(nr_round, vector<dynet::real>(tag_num * seq_len));
+    for( auto &emission : emission_list ){ for( auto &score : emission ){ score = dist(rng); } }
+
+    vector<vector<slnn::Index>> scalar_pred_list(nr_round),
+        decoder_pred_list(nr_round);
+    // 1. per-scalar path
+    auto start_time = chrono::high_resolution_clock::now();
+    for( unsigned r = 0; r < nr_round; ++r )
+    {
+        dynet::ComputationGraph cg;
+        per_scalar_viterbi(cg, init_score_lookup_param, trans_score_lookup_param,
+            emission_list[r], tag_num, seq_len, scalar_pred_list[r]);
+    }
+    auto scalar_time = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start_time).count();
+    // 2. decoder
+    start_time = chrono::high_resolution_clock::now();
+    slnn::ViterbiDecoder decoder;
+    vector<dynet::real> init_score(tag_num),
+        trans_score(tag_num * tag_num);
+    for( unsigned i = 0; i < tag_num; ++i ){ init_score[i] = dynet::as_scalar(init_score_lookup_param.get()->values[i]); }
+    for( unsigned i = 0; i < tag_num * tag_num; ++i ){ trans_score[i] = dynet::as_scalar(trans_score_lookup_param.get()->values[i]); }
+    decoder.set_score(init_score, trans_score);
+    for( unsigned r = 0; r < nr_round; ++r )
+    {
+        dynet::ComputationGraph cg;
+        dynet::expr::Expression emission_expr = dynet::expr::input(cg, dynet::Dim({ tag_num, seq_len }), emission_list[r]);
+        vector<dynet::real> emission = dynet::as_vector(cg.get_value(emission_expr));
+        decoder.decode(emission, decoder_pred_list[r]);
+    }
+    auto decoder_time = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start_time).count();
+
+    unsigned nr_diff = 0;
+    for( unsigned r = 0; r < nr_round; ++r ){ if( scalar_pred_list[r] != decoder_pred_list[r] ){ ++nr_diff; } }
+    cout << "tag num: " << tag_num << ", sequence length: " << seq_len << ", round: " << nr_round << "\n"
+        << "per-scalar path: " << scalar_time / 1000. << " ms\n"
+        << "viterbi decoder: " << decoder_time / 1000. << " ms\n"
+        << "speed up: " << (decoder_time > 0 ? static_cast<double>(scalar_time) / decoder_time : 0.) << "\n"
+        << "different prediction: " << nr_diff << "\n";
+    return nr_diff == 0 ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#define CATCH_CONFIG_MAIN
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "utils/batch_scheduler.hpp"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::utils::BatchScheduler;
+
+TEST_CASE("BatchScheduler", "[BatchScheduler]")
+{
+    vector<size_t> length_list = { 5, 1, 9, 3, 20, 2, 8, 4 };
+    mt19937 rng(1234);
+    SECTION("training batches cover all instances, every batch under the budget")
+    {
+        BatchScheduler scheduler(3, 16);
+        scheduler.schedule_for_training(length_list, rng);
+        vector<unsigned> all_idx;
+        for( const BatchScheduler::BatchT &batch : scheduler )
+        {
+            REQUIRE(batch.size() <= 3U);
+            size_t max_len = 0;
+            for( unsigned idx : batch ){ max_len = std::max(max_len, length_list[idx]); }
+            // the too long instance is a batch alone
+            REQUIRE((batch.size() * max_len <= 16U || batch.size() == 1U));
+            all_idx.insert(all_idx.end(), batch.begin(), batch.end());
+        }
+        sort(all_idx.begin(), all_idx.end());
+        REQUIRE(all_idx == vector<unsigned>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+    }
+    SECTION("inference batches are in length order")
+    {
+        BatchScheduler scheduler(2, 0);
+        scheduler.schedule_for_inference(length_list);
+        REQUIRE(scheduler.size() == 4U);
+        REQUIRE(scheduler[0] == vector<unsigned>({ 1, 5 }));
+        REQUIRE(scheduler[3] == vector<unsigned>({ 2, 4 }));
+    }
+    SECTION("no batching keeps every instance alone")
+    {
+        BatchScheduler scheduler(1, 0);
+        scheduler.schedule_for_training(length_list, rng);
+        REQUIRE(scheduler.size() == length_list.size());
+    }
+}
@@ -0,0 +1,58 @@
+#define CATCH_CONFIG_MAIN
+#include <vector>
+#include <cstddef>
+#include "modelmodule/beam_search_decoder.h"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::BeamSearchDecoder;
+using slnn::Index;
+using real = BeamSearchDecoder::real;
+
+namespace{
+
+// 2 tags, the score depends on the previous tag only:
+// from start: tag 0 is a little better; from tag 0: both tags are even; from tag 1: tag 1 is much better.
+// so the greedy path is 0-0-..., and the best path is 1-1-...
+void score_func(size_t, const vector<Index> &pretag_list, vector<real> &score_list)
+{
+    score_list.clear();
+    for( Index pretag : pretag_list )
+    {
+        if( pretag < 0 ){ score_list.insert(score_list.end(), { 0.1f, 0.f }); }
+        else if( pretag == 0 ){ score_list.insert(score_list.end(), { 0.f, 0.f }); }
+        else { score_list.insert(score_list.end(), { 0.f, 5.f }); }
+    }
+}
+
+} // end of anonymous namespace
+
+TEST_CASE("BeamSearchDecoder", "[BeamSearchDecoder]")
+{
+    vector<Index> pred_seq;
+    SECTION("beam size 1 is greedy")
+    {
+        BeamSearchDecoder decoder;
+        decoder.decode(3, 2, score_func, pred_seq);
+        REQUIRE(pred_seq == vector<Index>({ 0, 0, 0 }));
+    }
+    SECTION("wider beam finds the better path")
+    {
+        BeamSearchDecoder decoder(2);
+        decoder.decode(3, 2, score_func, pred_seq);
+        REQUIRE(pred_seq == vector<Index>({ 1, 1, 1 }));
+    }
+    SECTION("constraint")
+    {
+        BeamSearchDecoder decoder;
+        // tag 0 can't follow tag 0
+        decoder.decode(3, 2, score_func, [](size_t, Index pretag, Index tag){ return !(pretag == 0 && tag == 0); }, pred_seq);
+        REQUIRE(pred_seq == vector<Index>({ 0, 1, 1 }));
+    }
+    SECTION("empty sequence")
+    {
+        BeamSearchDecoder decoder(4);
+        decoder.decode(0, 2, score_func, pred_seq);
+        REQUIRE(pred_seq.empty());
+    }
+}
@@ -1,7 +1,16 @@
 #define CATCH_CONFIG_MAIN
 #include "trivial/charcode/naive_unicode.h"
+#include "trivial/charcode/utf8_decoder.h"
+#include "trivial/charcode/chartype_table.h"
+#include "utils/reader.hpp"
 #include "../3rdparty/catch/include/catch.hpp"
 #include <iostream>
+#include <sstream>
+#ifndef _WIN32
+#include <cstdio>
+#include <unistd.h>
+#include "utils/parallel_predictor.hpp" // FdStreamBuf
+#endif
 using namespace std;
 using namespace slnn::charcode::NUnicode;
 
@@ -142,3 +151,128 @@ TEST_CASE("charcode-2", "[UTF8-UNICODE]-RANGE_RANDOM")
     check_result &= u82unicode_check & unicode2u8_check;
     REQUIRE(check_result);
 }
+
+TEST_CASE("charcode-3", "[UTF8-DECODER]")
+{
+    u32string unicode_str = U"abcdefghij\u4E70\u0062\u20005 0123456789\u00E9";
+    string u8_str = encode2u8_bytes_unsafe(unicode_str);
+    u32string decoded = U"old content";
+    REQUIRE(slnn::charcode::utf8::decode(u8_str.data(), u8_str.size(), decoded) == 0U);
+    REQUIRE(decoded == unicode_str);
+    REQUIRE(decoded == decode_from_u8_bytes_unsafe(u8_str));
+    // invalid bytes are skipped: stray trail byte, overlong, surrogate, truncated
+    string invalid_str = string("a\x80") + "b\xC0\xAF" + "c\xED\xA0\x80" + "d\xE4\xB9";
+    REQUIRE(slnn::charcode::utf8::decode(invalid_str.data(), invalid_str.size(), decoded) == 8U);
+    REQUIRE(decoded == U"abcd");
+}
+
+TEST_CASE("chartype-1", "[CHARTYPE]")
+{
+    using slnn::charcode::CharTypeTable;
+    const CharTypeTable &table = CharTypeTable::get_table();
+    u32string unicode_str = U"9\uFF19\u4F0Dz\uFF3A,\u3002 \u4E70\u00E9\U0002000B";
+    vector<unsigned> type_list(unicode_str.size());
+    table.classify(unicode_str.data(), unicode_str.data() + unicode_str.size(), type_list.data());
+    REQUIRE(type_list == vector<unsigned>({ 1, 1, 1, 3, 3, 2, 2, 2, 0, 0, 0 }));
+    for( size_t i = 0; i < unicode_str.size(); ++i )
+    {
+        REQUIRE(table.type_of_u8(unicode2u8_unsafe(unicode_str[i]).data(), unicode2u8_unsafe(unicode_str[i]).size()) == type_list[i]);
+    }
+    // not exactly one char
+    REQUIRE(table.type_of_u8("12", 2U) == CharTypeTable::DefaultType);
+    REQUIRE(table.type_of_u8("\xEF\xBC", 2U) == CharTypeTable::DefaultType);
+    REQUIRE(table.type_of_u8("", 0U) == CharTypeTable::DefaultType);
+}
+
+TEST_CASE("reader-1", "[READER]")
+{
+    // a line longer than the block
+    string long_line(slnn::Reader::BlockSize + 10, 'x');
+    istringstream iss("a\tb\n\n" + long_line + "\nlast");
+    slnn::Reader reader(iss);
+    vector<string> line_list;
+    const char *line = nullptr;
+    size_t len = 0;
+    while( reader.readline_view(line, len) ){ line_list.emplace_back(line, len); }
+    REQUIRE(line_list == vector<string>({ "a\tb", "", long_line, "last" }));
+    vector<slnn::TokenSpan> span_list;
+    slnn::split_to_spans(line_list[0].data(), line_list[0].size(), [](char c){ return c == '\t'; }, span_list);
+    REQUIRE(span_list == vector<slnn::TokenSpan>({ { 0, 1 }, { 2, 1 } }));
+    slnn::split_to_spans(line_list[1].data(), line_list[1].size(), [](char c){ return c == '\t'; }, span_list);
+    REQUIRE(span_list.size() == 1U);
+}
+
+#ifndef _WIN32
+namespace{
+
+// pipe stream buffer counting the `read`s.
+class CountingFdStreamBuf : public slnn::utils::parallel_predictor_inner::FdStreamBuf
+{
+public:
+    explicit CountingFdStreamBuf(int fd) : FdStreamBuf(fd), nr_underflow(0) {}
+    unsigned nr_underflow;
+protected:
+    int_type underflow() override
+    {
+        if( gptr() == egptr() ){ ++nr_underflow; }
+        return FdStreamBuf::underflow();
+    }
+};
+
+// write the text to a new pipe (it should fit in the pipe buffer) and return the read end.
+int make_filled_pipe(const string &text)
+{
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    REQUIRE(::write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+    ::close(fds[1]);
+    return fds[0];
+}
+
+} // end of anonymous namespace
+
+TEST_CASE("reader-2", "[READER]")
+{
+    // from a pipe, nothing is available before reading, the reader should still read by block, not by byte.
+    string text;
+    vector<string> expected_line_list;
+    for( unsigned i = 0; i < 1000; ++i )
+    {
+        expected_line_list.push_back("line " + to_string(i) + "\tfrom pipe");
+        text += expected_line_list.back() + "\n";
+    }
+    vector<string> line_list;
+    const char *line = nullptr;
+    size_t len = 0;
+    SECTION("pipe stream buffer")
+    {
+        int fd = make_filled_pipe(text);
+        CountingFdStreamBuf buf(fd);
+        istream pipe_is(&buf);
+        slnn::Reader reader(pipe_is);
+        while( reader.readline_view(line, len) ){ line_list.emplace_back(line, len); }
+        ::close(fd);
+        REQUIRE(line_list == expected_line_list);
+        REQUIRE(buf.nr_underflow <= 2U); // data and EOF
+    }
+    SECTION("stdin from pipe")
+    {
+        // std::cin is synchronized with stdio (no buffer).
+        int fd = make_filled_pipe(text);
+        int stdin_backup = ::dup(STDIN_FILENO);
+        REQUIRE(::dup2(fd, STDIN_FILENO) == STDIN_FILENO);
+        ::close(fd);
+        std::clearerr(stdin);
+        cin.clear();
+        {
+            slnn::Reader reader(cin);
+            while( reader.readline_view(line, len) ){ line_list.emplace_back(line, len); }
+        }
+        ::dup2(stdin_backup, STDIN_FILENO);
+        ::close(stdin_backup);
+        std::clearerr(stdin);
+        cin.clear();
+        REQUIRE(line_list == expected_line_list);
+    }
+}
+#endif
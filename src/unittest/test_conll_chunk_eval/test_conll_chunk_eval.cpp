@@ -0,0 +1,70 @@
+#define CATCH_CONFIG_MAIN
+#include <vector>
+#include <string>
+#include "utils/conll_chunk_eval.hpp"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::ConllChunkEval;
+using slnn::IndexSeq;
+
+namespace{
+
+struct FakeTagDict
+{
+    vector<string> tag_list;
+    size_t size() const { return tag_list.size(); }
+    const string& convert(int idx) const { return tag_list.at(idx); }
+};
+
+enum : int { O = 0, B_PER, I_PER, B_LOC, I_LOC, E_PER, S_PER, S_LOC };
+
+const FakeTagDict tag_dict{ { "O", "B-PER", "I-PER", "B-LOC", "I-LOC", "E-PER", "S-PER", "S-LOC" } };
+
+} // end of anonymous namespace
+
+TEST_CASE("ConllChunkEval", "[ConllChunkEval]")
+{
+    ConllChunkEval chunk_eval(tag_dict);
+    SECTION("BIO: chunk with wrong type")
+    {
+        array<float, 4> score = chunk_eval.eval({ { B_PER, I_PER, O, B_LOC } }, { { B_PER, I_PER, O, B_PER } });
+        REQUIRE(score[0] == Approx(75.f));
+        REQUIRE(score[1] == Approx(50.f));
+        REQUIRE(score[2] == Approx(50.f));
+        REQUIRE(score[3] == Approx(50.f));
+    }
+    SECTION("IOB1: I after O starts a chunk, sequence end closes the chunk")
+    {
+        array<float, 4> score = chunk_eval.eval({ { I_PER, I_PER }, { I_LOC } }, { { B_PER, I_PER }, { I_LOC } });
+        REQUIRE(score[0] == Approx(200.f / 3.f));
+        REQUIRE(score[1] == Approx(100.f));
+        REQUIRE(score[3] == Approx(100.f));
+    }
+    SECTION("BIOES: single chunks are not merged")
+    {
+        ConllChunkEval::EvalTempResultT result = chunk_eval.eval_one({ S_PER, S_PER, S_LOC }, { B_PER, E_PER, S_LOC });
+        REQUIRE(result.nr_chunk_gold == 3U);
+        REQUIRE(result.nr_chunk_predict == 2U);
+        REQUIRE(result.nr_chunk_right == 1U);
+        REQUIRE(result.nr_token_right == 1U);
+    }
+    SECTION("iterative eval equals batch eval, temp results can be merged")
+    {
+        vector<IndexSeq> gold = { { B_PER, E_PER, O }, { S_LOC, O, B_LOC, I_LOC } },
+            pred = { { B_PER, E_PER, O }, { S_LOC, O, B_LOC, O } };
+        chunk_eval.start_eval();
+        chunk_eval.eval_iteratively(gold[0], pred[0]);
+        ConllChunkEval other(tag_dict);
+        other.start_eval();
+        other.eval_iteratively(gold[1], pred[1]);
+        chunk_eval.merge_temp_result(other.get_temp_result());
+        REQUIRE(chunk_eval.end_eval() == chunk_eval.eval(gold, pred));
+        REQUIRE(chunk_eval.get_temp_result().nr_chunk_right == 2U);
+    }
+    SECTION("invalid input")
+    {
+        REQUIRE_THROWS(chunk_eval.eval_one({ O, O }, { O }));
+        REQUIRE_THROWS(chunk_eval.eval_one({ 100 }, { O }));
+    }
+}
@@ -0,0 +1,96 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "trivial/corpus_cache/corpus_cache.h"
+#include "trivial/corpus_cache/channel_corpus.h"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using namespace slnn::trivial::corpus_cache;
+
+TEST_CASE("CorpusCache", "[CorpusCache]")
+{
+    const string path = "test_corpus_cache.bin";
+    const string dict_bytes("token module\0dict", 17);
+    vector<vector<int>> unigram_list = { { 1, 2, 3 }, { 4 }, {} , { 5, 6 } };
+    vector<CorpusChannelBuilder> channel_list(2);
+    for( const vector<int> &seq : unigram_list )
+    {
+        channel_list[0].append(seq);
+        channel_list[1].append_empty();
+    }
+    REQUIRE(write_corpus_cache_file(path, 42U, dict_bytes, channel_list) == true);
+    {
+        MappedCorpusCache cache(path);
+        REQUIRE(cache.get_key() == 42U);
+        REQUIRE(string(cache.get_dict_data(), cache.get_dict_size()) == dict_bytes);
+        REQUIRE(cache.get_channel_num() == 2U);
+        REQUIRE(cache.get_instance_num() == unigram_list.size());
+        for( size_t i = 0; i < unigram_list.size(); ++i )
+        {
+            IndexSpan span = cache.get_span(0, i);
+            REQUIRE(vector<int>(span.begin(), span.end()) == unigram_list[i]);
+            REQUIRE(cache.get_span(1, i).empty());
+        }
+    }
+    REQUIRE(open_corpus_cache(path, 42U) != nullptr);
+    // stale key
+    REQUIRE(open_corpus_cache(path, 43U) == nullptr);
+    // channels with different instance number
+    channel_list[1].append_empty();
+    REQUIRE_THROWS_AS(write_corpus_cache_file(path, 42U, dict_bytes, channel_list), logic_error);
+#ifndef _WIN32
+    // the temporary file is removed
+    REQUIRE_FALSE(ifstream(path + ".tmp." + to_string(getpid())).good());
+#endif
+    // not a cache
+    {
+        ofstream os(path);
+        os << "not a corpus cache";
+    }
+    REQUIRE_THROWS_AS(MappedCorpusCache{ path }, runtime_error);
+    REQUIRE(open_corpus_cache(path, 42U) == nullptr);
+    std::remove(path.c_str());
+    REQUIRE(open_corpus_cache(path, 42U) == nullptr);
+}
+
+TEST_CASE("ChannelCorpus", "[CorpusCache]")
+{
+    const string path = "test_channel_corpus.bin";
+    vector<vector<int>> unigram_list = { { 1, 2, 3 }, {}, { 4, 5 } };
+    ChannelCorpus corpus(2);
+    corpus.reserve(unigram_list.size());
+    for( const vector<int> &seq : unigram_list )
+    {
+        corpus.get_channel_builder(0).append(seq);
+        corpus.get_channel_builder(1).append(vector<int>(seq.size(), 7));
+    }
+    corpus.shrink_to_fit();
+    REQUIRE(corpus.size() == unigram_list.size());
+    REQUIRE(corpus.get_channel_num() == 2U);
+    for( size_t i = 0; i < unigram_list.size(); ++i )
+    {
+        IndexSpan span = corpus.get_span(0, i);
+        REQUIRE(vector<int>(span.begin(), span.end()) == unigram_list[i]);
+        REQUIRE(corpus.get_span(1, i).size == unigram_list[i].size());
+    }
+    REQUIRE(write_corpus_cache_file(path, 1U, string(), corpus.get_channel_builder_list()) == true);
+    {
+        ChannelCorpus mapped_corpus(open_corpus_cache(path, 1U));
+        REQUIRE(mapped_corpus.is_mapped());
+        REQUIRE(mapped_corpus.size() == unigram_list.size());
+        for( size_t i = 0; i < unigram_list.size(); ++i )
+        {
+            IndexSpan span = mapped_corpus.get_span(0, i);
+            REQUIRE(vector<int>(span.begin(), span.end()) == unigram_list[i]);
+        }
+        REQUIRE_THROWS_AS(mapped_corpus.get_channel_builder(0), logic_error);
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,64 @@
+#define CATCH_CONFIG_MAIN
+#include <vector>
+#include <random>
+#include <cmath>
+#include "utils/lazy_sparse_trainer.hpp"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::LazySparseTrainer;
+using real = dynet::real;
+
+namespace{
+
+// catch_up(k) + update_dense(g)  vs.  k dense steps with zero gradient + update_dense(g)
+void check_catch_up(LazySparseTrainer::Method method)
+{
+    const size_t sz = 8;
+    // only the row kernels are used, no model is needed.
+    LazySparseTrainer trainer(nullptr, method);
+    trainer.eta = 0.05f;
+    mt19937 rng(7);
+    uniform_real_distribution<real> dist(-1.f, 1.f);
+    for( unsigned long nr_skipped : { 0UL, 1UL, 3UL, 10UL } )
+    {
+        vector<real> w(sz), s1(sz), g(sz), zero_g(sz, 0.f);
+        for( size_t i = 0; i < sz; ++i )
+        {
+            w[i] = dist(rng);
+            g[i] = dist(rng);
+            s1[i] = method == LazySparseTrainer::Method::Adagrad ? std::abs(dist(rng)) : dist(rng); // squared gradient sum is not negative
+        }
+        vector<real> dense_w(w), dense_s1(s1);
+        for( unsigned long k = 0; k < nr_skipped; ++k )
+        {
+            trainer.update_dense(dense_w.data(), zero_g.data(), sz, dense_s1.data(), nullptr, 1.f);
+        }
+        trainer.update_dense(dense_w.data(), g.data(), sz, dense_s1.data(), nullptr, 1.f);
+
+        vector<real> lazy_w(w), lazy_s1(s1);
+        trainer.catch_up(lazy_w.data(), sz, lazy_s1.data(), nullptr, nr_skipped);
+        trainer.update_dense(lazy_w.data(), g.data(), sz, lazy_s1.data(), nullptr, 1.f);
+
+        INFO("skipped steps: " << nr_skipped);
+        for( size_t i = 0; i < sz; ++i )
+        {
+            REQUIRE(lazy_w[i] == Approx(dense_w[i]).epsilon(1e-4));
+            REQUIRE(lazy_s1[i] == Approx(dense_s1[i]).epsilon(1e-4));
+        }
+    }
+}
+
+} // end of anonymous namespace
+
+TEST_CASE("LazySparseTrainer catch up", "[LazySparseTrainer]")
+{
+    SECTION("momentum")
+    {
+        check_catch_up(LazySparseTrainer::Method::Momentum);
+    }
+    SECTION("adagrad")
+    {
+        check_catch_up(LazySparseTrainer::Method::Adagrad);
+    }
+}
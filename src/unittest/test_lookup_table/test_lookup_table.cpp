@@ -3,6 +3,7 @@
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include "trivial/lookup_table/lookup_table.h"
+#include "trivial/lookup_table/bigram_lookup_table.h"
 #include "../3rdparty/catch/include/catch.hpp"
 
 using namespace std;
@@ -217,3 +218,58 @@ TEST_CASE("LookupTableWithReplace", "[LookupTable]")
     boost::archive::text_iarchive tii(sss); // Boost (<= 1.58) does not support de-serialization char32_t defautly!
     tii & lookup_table_32t;
 }
+
+
+TEST_CASE("BigramLookupTableWithReplace", "[LookupTable]")
+{
+    const u32string eos_repr = U"<EOS>";
+    const char32_t eos = BigramLookupTableWithReplace::EosChar;
+    BigramLookupTableWithReplace lookup_table(eos_repr);
+    // the same index as the string keyed dict
+    LookupTableWithReplace<u32string> str_lookup_table;
+    const u32string charseq = U"abcabcd";
+    for( size_t pos = 0; pos + 1 < charseq.size(); ++pos )
+    {
+        REQUIRE(lookup_table.convert(charseq[pos], charseq[pos + 1]) == str_lookup_table.convert(charseq.substr(pos, 2)));
+    }
+    REQUIRE(lookup_table.convert(charseq.back(), eos) == str_lookup_table.convert(charseq.back() + eos_repr));
+    REQUIRE(lookup_table.size() == 5U);
+    REQUIRE(lookup_table.count(U'a', U'b') == 2U);
+    REQUIRE(lookup_table.count(U'd', eos) == 1U);
+    REQUIRE(lookup_table.count(U'b', U'a') == 0U);
+    // many bigrams, to rehash
+    for( char32_t c = 0x4E00; c < 0x4E00 + 1000; ++c ){ lookup_table.convert(c, c + 1); }
+    REQUIRE(lookup_table.size() == 1005U);
+    REQUIRE(lookup_table.convert(U'c', U'a') == 2);
+    REQUIRE(lookup_table.convert(0x4E00 + 500, 0x4E00 + 501) == 505);
+    lookup_table.freeze();
+    REQUIRE_THROWS_AS(lookup_table.convert(U'a', U'a'), out_of_range);
+    lookup_table.set_unk();
+    REQUIRE(lookup_table.convert(U'a', U'a') == lookup_table.get_unk_idx());
+    str_lookup_table.freeze();
+    str_lookup_table.set_unk();
+
+    // models saved by the string keyed dict are loaded, and vice versa.
+    stringstream ss;
+    boost::archive::text_oarchive to(ss);
+    to << str_lookup_table;
+    boost::archive::text_iarchive ti(ss);
+    BigramLookupTableWithReplace lookup_table_copy(eos_repr);
+    ti >> lookup_table_copy;
+    REQUIRE(lookup_table_copy.size() == str_lookup_table.size());
+    REQUIRE(lookup_table_copy.convert(U'b', U'c') == str_lookup_table.convert(U"bc"));
+    REQUIRE(lookup_table_copy.convert(U'd', eos) == str_lookup_table.convert(U"d<EOS>"));
+    REQUIRE(lookup_table_copy.count(U'a', U'b') == 2U);
+    REQUIRE(lookup_table_copy.convert(U'x', U'y') == str_lookup_table.get_unk_idx());
+    REQUIRE(lookup_table_copy.has_frozen());
+
+    stringstream sss;
+    boost::archive::text_oarchive too(sss);
+    too << lookup_table_copy;
+    boost::archive::text_iarchive tii(sss);
+    LookupTableWithReplace<u32string> str_lookup_table_copy;
+    tii >> str_lookup_table_copy;
+    REQUIRE(str_lookup_table_copy.size() == str_lookup_table.size());
+    REQUIRE(str_lookup_table_copy.convert(U"d<EOS>") == str_lookup_table.convert(U"d<EOS>"));
+    REQUIRE(str_lookup_table_copy.count(U"ca") == 1U);
+}
@@ -0,0 +1,109 @@
+#define CATCH_CONFIG_MAIN
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+#include "segmenter/cws_module/nn_module/mlp_input1/nn_cws_mlp_input1_all.h"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::Index;
+using slnn::segmenter::nn_module::NnSegmenterMlpInput1All;
+using slnn::trivial::corpus_cache::IndexSpan;
+
+namespace{
+
+struct TestStructureParam
+{
+    bool enable_unigram = true;
+    bool enable_bigram = true;
+    bool enable_lexicon = true;
+    bool enable_type = true;
+    unsigned unigram_dict_sz = 20;
+    unsigned bigram_dict_sz = 30;
+    unsigned lexicon_dict_sz = 5;
+    unsigned type_dict_sz = 4;
+    unsigned unigram_embedding_dim = 4;
+    unsigned bigram_embedding_dim = 3;
+    unsigned lexicon_embedding_dim = 2;
+    unsigned type_embedding_dim = 2;
+    unsigned window_sz = 5;
+    string window_process_method = "concat";
+    vector<unsigned> mlp_hidden_dim_list = { 8 };
+    float mlp_dropout_rate = 0.f;
+    string mlp_nonlinear_func_str = "tanh";
+    unsigned tag_dict_sz = 4;
+    string output_layer_type = "classification";
+};
+
+struct TestInstance
+{
+    vector<Index> unigram, bigram, type;
+    array<vector<Index>, 3> lexicon;
+    // spans on the vectors above, the member names are what `NnSegmenterMlpInput1All::predict` reads.
+    IndexSpan unigramseq, bigramseq, typeseq;
+    array<IndexSpan, 3> lexiconseq;
+};
+
+void random_instance(unsigned len, const TestStructureParam &param, mt19937 &rng, TestInstance &ins)
+{
+    auto random_seq = [len, &rng](unsigned dict_sz, vector<Index> &seq, IndexSpan &span)
+    {
+        uniform_int_distribution<Index> dist(0, dict_sz - 1);
+        seq.resize(len);
+        for( Index &id : seq ){ id = dist(rng); }
+        span = IndexSpan{ seq.data(), seq.size() };
+    };
+    random_seq(param.unigram_dict_sz, ins.unigram, ins.unigramseq);
+    random_seq(param.bigram_dict_sz, ins.bigram, ins.bigramseq);
+    random_seq(param.type_dict_sz, ins.type, ins.typeseq);
+    for( unsigned i = 0; i < 3; ++i ){ random_seq(param.lexicon_dict_sz, ins.lexicon[i], ins.lexiconseq[i]); }
+}
+
+// dynet can be initialized only once in a process.
+NnSegmenterMlpInput1All& get_model(const TestStructureParam &param)
+{
+    static char arg0[] = "test_mlp_input1_precomputation";
+    static char *argv[] = { arg0, nullptr };
+    static NnSegmenterMlpInput1All *model = nullptr;
+    if( !model )
+    {
+        model = new NnSegmenterMlpInput1All(1, argv, 1234);
+        model->build_model_structure(param);
+    }
+    return *model;
+}
+
+} // end of anonymous namespace
+
+TEST_CASE("NnSegmenterMlpInput1All precomputation", "[MlpInput1Precomputation]")
+{
+    TestStructureParam param;
+    NnSegmenterMlpInput1All &model = get_model(param);
+    // only part of the unigrams and bigrams are cached, the others go through the uncached path.
+    vector<Index> unigram_id_list, bigram_id_list;
+    for( Index id = 0; id < static_cast<Index>(param.unigram_dict_sz); id += 2 ){ unigram_id_list.push_back(id); }
+    for( Index id = 0; id < static_cast<Index>(param.bigram_dict_sz); id += 3 ){ bigram_id_list.push_back(id); }
+
+    mt19937 rng(42);
+    // shorter, equal and longer than the window.
+    for( unsigned len : { 1U, 2U, 3U, 4U, 5U, 6U, 9U, 40U } )
+    {
+        for( unsigned round = 0; round < 20; ++round )
+        {
+            TestInstance ins;
+            random_instance(len, param, rng, ins);
+            model.disable_precomputation();
+            vector<Index> graph_pred = model.predict(ins);
+#if HAVE_CUDA
+            REQUIRE_FALSE(model.enable_precomputation(unigram_id_list, bigram_id_list));
+            continue;
+#endif
+            REQUIRE(model.enable_precomputation(unigram_id_list, bigram_id_list));
+            vector<Index> precomputation_pred = model.predict(ins);
+            INFO("len = " << len << ", round = " << round);
+            REQUIRE(graph_pred.size() == len);
+            REQUIRE(precomputation_pred == graph_pred);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "trivial/model_container/binary_model_container.h"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using namespace slnn::trivial::model_container;
+
+TEST_CASE("BinaryModelContainer", "[BinaryModelContainer]")
+{
+    const string path = "test_model_container.bin";
+    const string dict_bytes("dict section\0with zero", 22);
+    vector<float> t1 = { 1.f, 2.f, 3.f },
+        t2 = {},
+        t3(100, 0.5f);
+    {
+        ofstream os(path, ios::binary);
+        write_binary_model(os, dict_bytes, { { t1.data(), t1.size() }, { t2.data(), t2.size() }, { t3.data(), t3.size() } });
+    }
+    REQUIRE(is_binary_model(path) == true);
+    {
+        MappedModelFile mapped_file(path);
+        REQUIRE(mapped_file.get_version() == FormatVersion);
+        REQUIRE(string(mapped_file.get_dict_data(), mapped_file.get_dict_size()) == dict_bytes);
+        REQUIRE(mapped_file.get_tensor_num() == 3U);
+        REQUIRE(vector<float>(mapped_file.get_tensor(0).data, mapped_file.get_tensor(0).data + 3) == t1);
+        REQUIRE(mapped_file.get_tensor(1).size == 0U);
+        REQUIRE(vector<float>(mapped_file.get_tensor(2).data, mapped_file.get_tensor(2).data + 100) == t3);
+        for( size_t i = 0; i < mapped_file.get_tensor_num(); ++i )
+        {
+            REQUIRE(reinterpret_cast<uintptr_t>(mapped_file.get_tensor(i).data) % SectionAlignment == 0U);
+        }
+        REQUIRE_THROWS_AS(mapped_file.get_tensor(3), out_of_range);
+    }
+    // not a binary model
+    {
+        ofstream os(path);
+        os << "22 serialization::archive 12";
+    }
+    REQUIRE(is_binary_model(path) == false);
+    REQUIRE_THROWS_AS(MappedModelFile{ path }, runtime_error);
+    std::remove(path.c_str());
+}
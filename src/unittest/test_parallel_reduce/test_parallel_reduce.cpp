@@ -0,0 +1,59 @@
+#define CATCH_CONFIG_MAIN
+#include <vector>
+#include <stdexcept>
+#include "utils/parallel_reduce.hpp"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using namespace slnn::utils;
+
+namespace{
+
+struct SumT
+{
+    unsigned long sum = 0;
+    unsigned cnt = 0;
+    SumT& operator+=(const SumT &rhs){ sum += rhs.sum; cnt += rhs.cnt; return *this; }
+};
+
+} // end of anonymous namespace
+
+TEST_CASE("parallel_reduce", "[parallel_reduce]")
+{
+    if( !is_parallel_reduce_supported() ){ return; }
+    vector<unsigned> data(1000);
+    for( unsigned i = 0; i < data.size(); ++i ){ data[i] = i * 3 + 1; }
+    auto map_func = [&data](unsigned idx, SumT &result)
+    {
+        result.sum += data[idx];
+        ++result.cnt;
+    };
+    SumT serial_result;
+    for( unsigned i = 10; i < data.size(); ++i ){ map_func(i, serial_result); }
+    SECTION("merged result is the same as the serial one")
+    {
+        SumT result = reduce_in_parallel<SumT>(4U, 10U, static_cast<unsigned>(data.size()), map_func);
+        REQUIRE(result.cnt == serial_result.cnt);
+        REQUIRE(result.sum == serial_result.sum);
+    }
+    SECTION("asynchronous, the caller can modify its own data before wait")
+    {
+        AsyncParallelReduce<SumT> reducer;
+        reducer.start(3U, 10U, static_cast<unsigned>(data.size()), map_func);
+        REQUIRE(reducer.is_running());
+        for( unsigned &val : data ){ val = 0; } // workers see the data at start
+        SumT result = reducer.wait();
+        REQUIRE_FALSE(reducer.is_running());
+        REQUIRE(result.sum == serial_result.sum);
+    }
+    SECTION("empty range")
+    {
+        SumT result = reduce_in_parallel<SumT>(2U, 5U, 5U, map_func);
+        REQUIRE(result.cnt == 0U);
+    }
+    SECTION("failed worker")
+    {
+        auto failed_func = [](unsigned idx, SumT&){ if( idx == 7U ){ throw runtime_error("expected failure"); } };
+        REQUIRE_THROWS_AS(reduce_in_parallel<SumT>(2U, 0U, 20U, failed_func), runtime_error);
+    }
+}
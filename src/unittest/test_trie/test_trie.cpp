@@ -0,0 +1,101 @@
+#define CATCH_CONFIG_MAIN
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include "trivial/trie/double_array_trie.h"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::trivial::trie::DoubleArrayTrie;
+
+namespace{
+
+vector<size_t> all_prefix_match(const DoubleArrayTrie &trie, const u32string &str)
+{
+    vector<DoubleArrayTrie::CodeT> codeseq;
+    trie.encode(str, codeseq);
+    vector<size_t> len_list;
+    trie.prefix_search(codeseq.data(), codeseq.data() + codeseq.size(), [&len_list](size_t len){ len_list.push_back(len); });
+    return len_list;
+}
+
+}
+
+TEST_CASE("DoubleArrayTrie", "[DoubleArrayTrie]")
+{
+    DoubleArrayTrie trie;
+    trie.build({ U"中国", U"中国人", U"中国人民", U"人民", U"中", U"", U"中国", U"\U0001F600\U0001F601" });
+    REQUIRE(trie.size() == 6U);
+    REQUIRE(trie.contains(U"中国") == true);
+    REQUIRE(trie.contains(U"中国人民") == true);
+    REQUIRE(trie.contains(U"中国人民银行") == false);
+    REQUIRE(trie.contains(U"国人") == false);
+    REQUIRE(trie.contains(U"") == false);
+    REQUIRE(trie.contains(U"\U0001F600\U0001F601") == true);
+    REQUIRE(all_prefix_match(trie, U"中国人民银行") == vector<size_t>({ 1, 2, 3, 4 }));
+    REQUIRE(all_prefix_match(trie, U"人民") == vector<size_t>({ 2 }));
+    REQUIRE(all_prefix_match(trie, U"银行").empty());
+    vector<DoubleArrayTrie::CodeT> codeseq;
+    trie.encode(U"x中国人x", codeseq);
+    REQUIRE(codeseq[0] == DoubleArrayTrie::UnkCode);
+    REQUIRE(trie.longest_prefix_match(codeseq.data() + 1, codeseq.data() + codeseq.size()) == 3U);
+    REQUIRE(trie.longest_prefix_match(codeseq.data() + 1, codeseq.data() + 2) == 1U);
+    REQUIRE(trie.longest_prefix_match(codeseq.data(), codeseq.data() + codeseq.size()) == 0U);
+
+    SECTION("serialization")
+    {
+        stringstream ss;
+        {
+            boost::archive::text_oarchive oa(ss);
+            oa << trie;
+        }
+        DoubleArrayTrie loaded_trie;
+        {
+            boost::archive::text_iarchive ia(ss);
+            ia >> loaded_trie;
+        }
+        REQUIRE(loaded_trie.size() == trie.size());
+        REQUIRE(loaded_trie.contains(U"中国人") == true);
+        REQUIRE(all_prefix_match(loaded_trie, U"中国人民银行") == vector<size_t>({ 1, 2, 3, 4 }));
+    }
+
+    SECTION("many words")
+    {
+        // a dense area with many holes, some free slots are retired (dropped from the free list) while building.
+        mt19937 rng(7);
+        vector<u32string> word_list;
+        set<u32string> word_set;
+        for( unsigned i = 0; i < 20000; ++i )
+        {
+            u32string word;
+            unsigned len = 1 + rng() % 6;
+            for( unsigned k = 0; k < len; ++k ){ word.push_back(U'\u4e00' + rng() % (k == 0 ? 2000 : 40)); }
+            word_list.push_back(word);
+            word_set.insert(word);
+        }
+        DoubleArrayTrie big_trie;
+        big_trie.build(word_list);
+        REQUIRE(big_trie.size() == word_set.size());
+        for( const u32string &word : word_set ){ REQUIRE(big_trie.contains(word)); }
+        for( unsigned i = 0; i < 20000; ++i )
+        {
+            u32string word;
+            unsigned len = 1 + rng() % 6;
+            for( unsigned k = 0; k < len; ++k ){ word.push_back(U'\u4e00' + rng() % 2000); }
+            REQUIRE(big_trie.contains(word) == (word_set.count(word) > 0));
+        }
+    }
+
+    SECTION("empty trie")
+    {
+        DoubleArrayTrie empty_trie;
+        REQUIRE(empty_trie.contains(U"中国") == false);
+        empty_trie.build({});
+        REQUIRE(empty_trie.size() == 0U);
+        REQUIRE(all_prefix_match(empty_trie, U"中国").empty());
+    }
+}
@@ -0,0 +1,97 @@
+#define CATCH_CONFIG_MAIN
+#include <vector>
+#include "dynet/dynet.h"
+#include "dynet/expr.h"
+#include "modelmodule/viterbi_decoder.h"
+#include "modelmodule/hyper_output_layers.h"
+#include "utils/stash_model.hpp"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::Index;
+using slnn::ViterbiDecoder;
+
+namespace{
+
+void initialize_dynet_once()
+{
+    static bool is_initialized = false;
+    if( is_initialized ){ return; }
+    static char arg0[] = "test_viterbi_restore";
+    static char *argv[] = { arg0, nullptr };
+    int argc = 1;
+    char **argv_ptr = argv;
+    dynet::initialize(argc, argv_ptr, 1234);
+    is_initialized = true;
+}
+
+void set_values(dynet::ParameterStorage *p, const vector<dynet::real> &values)
+{
+    dynet::TensorTools::SetElements(p->values, values);
+}
+
+// the inputs don't matter, the emission layer is all zero.
+vector<dynet::expr::Expression> build_input(dynet::ComputationGraph &cg, unsigned len, unsigned input_dim)
+{
+    vector<dynet::expr::Expression> input_list(len);
+    for( dynet::expr::Expression &e : input_list ){ e = dynet::expr::input(cg, { input_dim }, vector<dynet::real>(input_dim, 1.f)); }
+    return input_list;
+}
+
+} // end of anonymous namespace
+
+TEST_CASE("ViterbiDecoder::clear_all_score", "[ViterbiDecoder]")
+{
+    ViterbiDecoder decoder1, decoder2;
+    decoder1.set_score({ 0.f, 1.f }, { 0.f, 0.f, 0.f, 0.f });
+    decoder2.set_score({ 1.f, 0.f }, { 0.f, 0.f, 0.f, 0.f });
+    REQUIRE(decoder1.has_score());
+    REQUIRE(decoder2.has_score());
+    ViterbiDecoder::clear_all_score();
+    REQUIRE_FALSE(decoder1.has_score());
+    REQUIRE_FALSE(decoder2.has_score());
+    // score set after the clear is kept.
+    decoder1.set_score({ 0.f, 1.f }, { 0.f, 0.f, 0.f, 0.f });
+    REQUIRE(decoder1.has_score());
+    REQUIRE_FALSE(decoder2.has_score());
+}
+
+TEST_CASE("decode after restoring the stashed model", "[ViterbiDecoder]")
+{
+    initialize_dynet_once();
+    const unsigned input_dim = 3,
+        tag_num = 2,
+        len = 3;
+    dynet::Model model;
+    slnn::CrfBareOutput output_layer(&model, input_dim, tag_num);
+    // parameters: emission w, emission b, init score, transition score
+    vector<dynet::ParameterStorage*> param_list = model.parameters_list();
+    REQUIRE(param_list.size() == 4U);
+    set_values(param_list[0], vector<dynet::real>(tag_num * input_dim, 0.f));
+    set_values(param_list[1], vector<dynet::real>(tag_num, 0.f));
+    set_values(param_list[3], { 1.f, 0.f, 0.f, 1.f }); // keep the tag
+    auto decode = [&]()
+    {
+        dynet::ComputationGraph cg;
+        output_layer.new_graph(cg);
+        vector<Index> pred_seq;
+        output_layer.build_output(build_input(cg, len, input_dim), pred_seq);
+        return pred_seq;
+    };
+    // stashed (best) model: start from tag 0
+    set_values(param_list[2], { 2.f, 0.f });
+    slnn::CNNModelStash stash;
+    REQUIRE(stash.save_when_best(&model, 1.f));
+    REQUIRE(decode() == vector<Index>({ 0, 0, 0 }));
+    // training moves on: start from tag 1. the loss graph drops the cached score.
+    set_values(param_list[2], { 0.f, 2.f });
+    {
+        dynet::ComputationGraph cg;
+        output_layer.new_graph(cg);
+        output_layer.build_output_loss(build_input(cg, len, input_dim), { 1, 1, 1 });
+    }
+    REQUIRE(decode() == vector<Index>({ 1, 1, 1 }));
+    // restore, the score cached from the training parameters should not be used.
+    REQUIRE(stash.load_if_exists(&model));
+    REQUIRE(decode() == vector<Index>({ 0, 0, 0 }));
+}
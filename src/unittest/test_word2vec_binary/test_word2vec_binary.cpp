@@ -0,0 +1,139 @@
+#define CATCH_CONFIG_MAIN
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "dynet/dynet.h"
+#include "dynet/dict.h"
+#include "utils/word2vec_embedding_helper.h"
+#include "../3rdparty/catch/include/catch.hpp"
+
+using namespace std;
+using slnn::Word2vecEmbeddingHelper;
+
+namespace{
+
+const string UnkStr = "<UNK>";
+
+const string EmbeddingText =
+    "4 3\n"
+    "the 0.1 -0.2 0.3\n"
+    "of 1.5 2.25 -3.125\n"
+    "中国 -0.01 0.02 1e-3\n"
+    "and 4 5 6\n";
+
+void initialize_dynet_once()
+{
+    static bool is_initialized = false;
+    if( is_initialized ){ return; }
+    static char arg0[] = "test_word2vec_binary";
+    static char *argv[] = { arg0, nullptr };
+    int argc = 1;
+    char **argv_ptr = argv;
+    dynet::initialize(argc, argv_ptr, 1234);
+    is_initialized = true;
+}
+
+struct LoadedEmbedding
+{
+    dynet::Dict dict;
+    unsigned dim = 0;
+    vector<vector<dynet::real>> value_list; // by word id
+};
+
+// build the dict and load the embedding from the stream, the way the handlers do.
+void load(istream &is, LoadedEmbedding &loaded, const unordered_set<string> *p_vocab_filter = nullptr)
+{
+    unsigned dict_sz = 0;
+    Word2vecEmbeddingHelper::build_fixed_dict(is, loaded.dict, UnkStr, &dict_sz, &loaded.dim, p_vocab_filter);
+    is.clear();
+    is.seekg(0);
+    dynet::Model model;
+    dynet::LookupParameter param = model.add_lookup_parameters(dict_sz, { loaded.dim });
+    Word2vecEmbeddingHelper::load_fixed_embedding(is, loaded.dict, loaded.dim, param);
+    loaded.value_list.resize(dict_sz);
+    for( unsigned id = 0; id < dict_sz; ++id ){ loaded.value_list[id] = dynet::as_vector(param.get()->values[id]); }
+}
+
+void check_same(LoadedEmbedding &text_loaded, LoadedEmbedding &binary_loaded)
+{
+    REQUIRE(binary_loaded.dim == text_loaded.dim);
+    REQUIRE(binary_loaded.dict.size() == text_loaded.dict.size());
+    for( unsigned id = 0; id < text_loaded.dict.size(); ++id )
+    {
+        string word = text_loaded.dict.convert(static_cast<int>(id));
+        INFO("word: " << word);
+        REQUIRE(binary_loaded.dict.convert(word) == static_cast<int>(id));
+        if( word == UnkStr ){ continue; } // not in the embedding, random initialized
+        for( unsigned k = 0; k < text_loaded.dim; ++k )
+        {
+            REQUIRE(binary_loaded.value_list[id][k] == text_loaded.value_list[id][k]);
+        }
+    }
+}
+
+} // end of anonymous namespace
+
+TEST_CASE("word2vec binary round trip", "[Word2vecEmbeddingHelper]")
+{
+    initialize_dynet_once();
+    istringstream text_is(EmbeddingText);
+    REQUIRE_FALSE(Word2vecEmbeddingHelper::is_binary_format(text_is));
+    stringstream binary_ss(ios::in | ios::out | ios::binary);
+    SECTION("all words")
+    {
+        REQUIRE(Word2vecEmbeddingHelper::convert_to_binary(text_is, binary_ss) == 4UL);
+        binary_ss.seekg(0);
+        REQUIRE(Word2vecEmbeddingHelper::is_binary_format(binary_ss));
+        LoadedEmbedding text_loaded,
+            binary_loaded;
+        istringstream text_load_is(EmbeddingText);
+        load(text_load_is, text_loaded);
+        load(binary_ss, binary_loaded);
+        REQUIRE(text_loaded.dict.size() == 5U); // 4 words and UNK
+        check_same(text_loaded, binary_loaded);
+    }
+    SECTION("vocabulary filter")
+    {
+        unordered_set<string> vocab = { "of", "and", "not-in-embedding" };
+        REQUIRE(Word2vecEmbeddingHelper::convert_to_binary(text_is, binary_ss, &vocab) == 2UL);
+        binary_ss.seekg(0);
+        LoadedEmbedding text_loaded,
+            binary_loaded;
+        istringstream text_load_is(EmbeddingText);
+        load(text_load_is, text_loaded, &vocab);
+        load(binary_ss, binary_loaded);
+        REQUIRE(text_loaded.dict.size() == 3U);
+        check_same(text_loaded, binary_loaded);
+    }
+    SECTION("filter when loading the binary")
+    {
+        // skipped rows break the bulk read into runs.
+        Word2vecEmbeddingHelper::convert_to_binary(text_is, binary_ss);
+        binary_ss.seekg(0);
+        unordered_set<string> vocab = { "the", "中国", "and" };
+        LoadedEmbedding text_loaded,
+            binary_loaded;
+        istringstream text_load_is(EmbeddingText);
+        load(text_load_is, text_loaded, &vocab);
+        load(binary_ss, binary_loaded, &vocab);
+        REQUIRE(text_loaded.dict.size() == 4U);
+        check_same(text_loaded, binary_loaded);
+    }
+}
+
+TEST_CASE("word2vec binary dimension check", "[Word2vecEmbeddingHelper]")
+{
+    initialize_dynet_once();
+    istringstream text_is(EmbeddingText);
+    stringstream binary_ss(ios::in | ios::out | ios::binary);
+    Word2vecEmbeddingHelper::convert_to_binary(text_is, binary_ss);
+    binary_ss.seekg(0);
+    dynet::Dict dict;
+    Word2vecEmbeddingHelper::build_fixed_dict(binary_ss, dict, UnkStr);
+    binary_ss.clear();
+    binary_ss.seekg(0);
+    dynet::Model model;
+    dynet::LookupParameter param = model.add_lookup_parameters(dict.size(), { 4 });
+    REQUIRE_THROWS_AS(Word2vecEmbeddingHelper::load_fixed_embedding(binary_ss, dict, 4, param), std::invalid_argument);
+}
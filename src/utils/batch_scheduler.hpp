@@ -0,0 +1,127 @@
+#ifndef SLNN_UTILS_BATCH_SCHEDULER_HPP_
+#define SLNN_UTILS_BATCH_SCHEDULER_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+namespace slnn{
+namespace utils{
+
+/**
+ * length bucketing batch scheduler.
+ * instances are sorted by length (ties are in random order for training), then cut into batches in the sorted order,
+ * so instances of a batch have similar length and little padding. a batch is closed when
+ * 1. it has `max_batch_size` instances (0 for no limit), or
+ * 2. its padded token number (instance number * max length in batch) would exceed `max_batch_tokens` (0 for no limit).
+ *    an instance longer than the budget is a batch alone.
+ * for training, the batch order is shuffled (not the instance order); for inference, batches are in length order,
+ * and the caller restores the original order by the instance index.
+ * it is used by the segmenter model handler, which builds a batch in one graph. the POS and NER handlers train
+ * online (one instance per graph and per update, no batch size), where it degrades to the plain shuffle they do.
+ */
+class BatchScheduler
+{
+public:
+    using BatchT = std::vector<unsigned>;
+    using const_iterator = std::vector<BatchT>::const_iterator;
+public:
+    BatchScheduler(unsigned max_batch_size, std::size_t max_batch_tokens);
+    template <typename DatasetT>
+    static std::vector<std::size_t> get_length_list(const DatasetT &dataset);
+
+    void schedule_for_training(const std::vector<std::size_t> &length_list, std::mt19937 &rng);
+    void schedule_for_inference(const std::vector<std::size_t> &length_list);
+
+    const_iterator begin() const { return batch_list.cbegin(); }
+    const_iterator end() const { return batch_list.cend(); }
+    std::size_t size() const { return batch_list.size(); }
+    const BatchT& operator[](std::size_t idx) const { return batch_list[idx]; }
+    const std::vector<BatchT>& get_batch_list() const { return batch_list; }
+private:
+    void cut_batches(const std::vector<unsigned> &sorted_order, const std::vector<std::size_t> &length_list);
+private:
+    unsigned max_batch_size;
+    std::size_t max_batch_tokens;
+    std::vector<BatchT> batch_list;
+};
+
+
+/**************************************
+ * Inline Implementation
+ **************************************/
+
+inline
+BatchScheduler::BatchScheduler(unsigned max_batch_size, std::size_t max_batch_tokens)
+    :max_batch_size(max_batch_size),
+    max_batch_tokens(max_batch_tokens)
+{}
+
+template <typename DatasetT>
+std::vector<std::size_t> BatchScheduler::get_length_list(const DatasetT &dataset)
+{
+    std::vector<std::size_t> length_list(dataset.size());
+    for( std::size_t i = 0; i < length_list.size(); ++i ){ length_list[i] = dataset[i].size(); }
+    return length_list;
+}
+
+inline
+void BatchScheduler::schedule_for_training(const std::vector<std::size_t> &length_list, std::mt19937 &rng)
+{
+    std::vector<unsigned> order(length_list.size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::shuffle(order.begin(), order.end(), rng);
+    // without batching, the length order is useless.
+    bool is_single = max_batch_size == 1U;
+    if( !is_single )
+    {
+        std::stable_sort(order.begin(), order.end(), [&length_list](unsigned lhs, unsigned rhs)
+        {
+            return length_list[lhs] < length_list[rhs];
+        });
+    }
+    cut_batches(order, length_list);
+    if( !is_single ){ std::shuffle(batch_list.begin(), batch_list.end(), rng); }
+}
+
+inline
+void BatchScheduler::schedule_for_inference(const std::vector<std::size_t> &length_list)
+{
+    std::vector<unsigned> order(length_list.size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::stable_sort(order.begin(), order.end(), [&length_list](unsigned lhs, unsigned rhs)
+    {
+        return length_list[lhs] < length_list[rhs];
+    });
+    cut_batches(order, length_list);
+}
+
+inline
+void BatchScheduler::cut_batches(const std::vector<unsigned> &sorted_order, const std::vector<std::size_t> &length_list)
+{
+    batch_list.clear();
+    BatchT batch;
+    std::size_t batch_max_len = 0;
+    for( unsigned idx : sorted_order )
+    {
+        std::size_t max_len = std::max(batch_max_len, length_list[idx]);
+        bool is_full = (max_batch_size > 0 && batch.size() >= max_batch_size) ||
+            (max_batch_tokens > 0 && (batch.size() + 1) * max_len > max_batch_tokens);
+        if( !batch.empty() && is_full )
+        {
+            batch_list.push_back(std::move(batch));
+            batch.clear();
+            max_len = length_list[idx];
+        }
+        batch.push_back(idx);
+        batch_max_len = max_len;
+    }
+    if( !batch.empty() ){ batch_list.push_back(std::move(batch)); }
+}
+
+} // end of namespace utils
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef SLNN_UTILS_CONLL_CHUNK_EVAL_HPP_
+#define SLNN_UTILS_CONLL_CHUNK_EVAL_HPP_
+
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdexcept>
+#include "typedeclaration.h"
+
+namespace slnn{
+
+/*
+    In-process chunk evaluation, the same as the conlleval (perl) script.
+
+    tag is `PREFIX-TYPE` (e.g. B-PER) or `O`. chunks are found by the chunk start/end rules of conlleval,
+    which cover IOB1/IOB2/IOE schemes, and are extended by the `S` prefix for BIOES. `.` is not a special tag here.
+    every sequence is closed by a sentence boundary (as the empty line in conlleval), so sequences are independent
+    and the counts of every sequence can be merged in any order.
+*/
+
+namespace conll_eval_inner{
+
+enum class ChunkTagPrefix : unsigned char
+{
+    O, B, I, E, S, Other
+};
+
+struct ChunkTagT
+{
+    ChunkTagPrefix prefix;
+    unsigned type; // 0 for empty type (O)
+};
+
+struct EvalTempResultT
+{
+    unsigned long nr_token;
+    unsigned long nr_token_right;
+    unsigned long nr_chunk_gold;
+    unsigned long nr_chunk_predict;
+    unsigned long nr_chunk_right;
+    EvalTempResultT() :
+        nr_token(0), nr_token_right(0), nr_chunk_gold(0), nr_chunk_predict(0), nr_chunk_right(0)
+    {}
+    void clear(){ nr_token = nr_token_right = nr_chunk_gold = nr_chunk_predict = nr_chunk_right = 0; }
+    EvalTempResultT& operator+=(const EvalTempResultT &rhs)
+    {
+        this->nr_token += rhs.nr_token;
+        this->nr_token_right += rhs.nr_token_right;
+        this->nr_chunk_gold += rhs.nr_chunk_gold;
+        this->nr_chunk_predict += rhs.nr_chunk_predict;
+        this->nr_chunk_right += rhs.nr_chunk_right;
+        return *this;
+    }
+};
+
+bool is_chunk_end(const ChunkTagT &prev, const ChunkTagT &cur);
+bool is_chunk_start(const ChunkTagT &prev, const ChunkTagT &cur);
+
+} // end of namespace conll_eval_inner
+
+/**
+ * conll chunk evaluation on index sequences.
+ * tag strings are parsed only once at construction, evaluation does no allocation.
+ * not thread safe (iteratively). for parallel eval, every worker evals a part and the temp results are merged.
+ */
+class ConllChunkEval
+{
+public:
+    using EvalTempResultT = conll_eval_inner::EvalTempResultT;
+    /**
+     * @param tag_dict tag dict, TagDictT::convert(Index) returns the tag string (e.g. dynet::Dict)
+     */
+    template <typename TagDictT>
+    explicit ConllChunkEval(const TagDictT &tag_dict);
+public:
+    // iteratively
+    void start_eval(){ tmp_result4iter.clear(); }
+    void eval_iteratively(const IndexSeq &gold_tagseq, const IndexSeq &pred_tagseq);
+    const EvalTempResultT& get_temp_result() const { return tmp_result4iter; }
+    void merge_temp_result(const EvalTempResultT &other){ tmp_result4iter += other; }
+    // return {ACC , P , R , F1} ( percent !)
+    std::array<float, 4> end_eval() const { return calc_score(tmp_result4iter); }
+    // batch
+    std::array<float, 4> eval(const std::vector<IndexSeq> &gold_tagseq_set, const std::vector<IndexSeq> &pred_tagseq_set) const;
+    EvalTempResultT eval_one(const IndexSeq &gold_tagseq, const IndexSeq &pred_tagseq) const;
+    static std::array<float, 4> calc_score(const EvalTempResultT &result);
+private:
+    const conll_eval_inner::ChunkTagT& get_chunk_tag(Index tag) const;
+private:
+    std::vector<conll_eval_inner::ChunkTagT> chunk_tag_list;
+    EvalTempResultT tmp_result4iter;
+};
+
+
+/******************************************
+ * Inline Implementation
+ ******************************************/
+
+namespace conll_eval_inner{
+
+inline
+bool is_chunk_end(const ChunkTagT &prev, const ChunkTagT &cur)
+{
+    using P = ChunkTagPrefix;
+    if( prev.prefix == P::O ){ return false; }
+    if( prev.prefix == P::E || prev.prefix == P::S ){ return true; }
+    if( (prev.prefix == P::B || prev.prefix == P::I) &&
+        (cur.prefix == P::B || cur.prefix == P::S || cur.prefix == P::O) ){ return true; }
+    return prev.type != cur.type;
+}
+
+inline
+bool is_chunk_start(const ChunkTagT &prev, const ChunkTagT &cur)
+{
+    using P = ChunkTagPrefix;
+    if( cur.prefix == P::O ){ return false; }
+    if( cur.prefix == P::B || cur.prefix == P::S ){ return true; }
+    if( (cur.prefix == P::I || cur.prefix == P::E) &&
+        (prev.prefix == P::E || prev.prefix == P::S || prev.prefix == P::O) ){ return true; }
+    return prev.type != cur.type;
+}
+
+} // end of namespace conll_eval_inner
+
+template <typename TagDictT>
+ConllChunkEval::ConllChunkEval(const TagDictT &tag_dict)
+{
+    using conll_eval_inner::ChunkTagPrefix;
+    std::unordered_map<std::string, unsigned> type2id{ { "", 0U } };
+    chunk_tag_list.resize(tag_dict.size());
+    for( std::size_t i = 0; i < chunk_tag_list.size(); ++i )
+    {
+        const std::string &tag = tag_dict.convert(static_cast<Index>(i));
+        // split at the first '-' as conlleval, no '-' means empty type.
+        std::string::size_type split_pos = tag.find('-');
+        std::string prefix = tag.substr(0, split_pos),
+            type = split_pos == std::string::npos ? std::string() : tag.substr(split_pos + 1);
+        ChunkTagPrefix prefix_val = ChunkTagPrefix::Other;
+        if( prefix == "O" ){ prefix_val = ChunkTagPrefix::O; }
+        else if( prefix == "B" ){ prefix_val = ChunkTagPrefix::B; }
+        else if( prefix == "I" ){ prefix_val = ChunkTagPrefix::I; }
+        else if( prefix == "E" ){ prefix_val = ChunkTagPrefix::E; }
+        else if( prefix == "S" ){ prefix_val = ChunkTagPrefix::S; }
+        unsigned type_id = type2id.emplace(type, static_cast<unsigned>(type2id.size())).first->second;
+        chunk_tag_list[i] = conll_eval_inner::ChunkTagT{ prefix_val, type_id };
+    }
+}
+
+inline
+const conll_eval_inner::ChunkTagT& ConllChunkEval::get_chunk_tag(Index tag) const
+{
+    if( tag < 0 || static_cast<std::size_t>(tag) >= chunk_tag_list.size() )
+    {
+        throw std::out_of_range("conll chunk eval: tag index (" + std::to_string(tag) + ") is out of the tag dict.");
+    }
+    return chunk_tag_list[tag];
+}
+
+inline
+void ConllChunkEval::eval_iteratively(const IndexSeq &gold_tagseq, const IndexSeq &pred_tagseq)
+{
+    tmp_result4iter += eval_one(gold_tagseq, pred_tagseq);
+}
+
+inline
+std::array<float, 4>
+ConllChunkEval::eval(const std::vector<IndexSeq> &gold_tagseq_set, const std::vector<IndexSeq> &pred_tagseq_set) const
+{
+    if( gold_tagseq_set.size() != pred_tagseq_set.size() )
+    {
+        throw std::invalid_argument("conll chunk eval: gold and predict sequence number are not equal.");
+    }
+    EvalTempResultT result;
+    for( std::size_t i = 0; i < gold_tagseq_set.size(); ++i ){ result += eval_one(gold_tagseq_set[i], pred_tagseq_set[i]); }
+    return calc_score(result);
+}
+
+inline
+ConllChunkEval::EvalTempResultT
+ConllChunkEval::eval_one(const IndexSeq &gold_tagseq, const IndexSeq &pred_tagseq) const
+{
+    using conll_eval_inner::ChunkTagT;
+    using conll_eval_inner::ChunkTagPrefix;
+    using conll_eval_inner::is_chunk_start;
+    using conll_eval_inner::is_chunk_end;
+    if( gold_tagseq.size() != pred_tagseq.size() )
+    {
+        throw std::invalid_argument("conll chunk eval: gold and predict sequence length are not equal.");
+    }
+    static const ChunkTagT boundary{ ChunkTagPrefix::O, 0U };
+    EvalTempResultT result;
+    std::size_t seqlen = gold_tagseq.size();
+    const ChunkTagT *last_gold = &boundary,
+        *last_pred = &boundary;
+    bool is_in_right_chunk = false;
+    // one more step for the sentence boundary, to close the last chunks.
+    for( std::size_t i = 0; i <= seqlen; ++i )
+    {
+        const ChunkTagT &gold = i < seqlen ? get_chunk_tag(gold_tagseq[i]) : boundary,
+            &pred = i < seqlen ? get_chunk_tag(pred_tagseq[i]) : boundary;
+        if( is_in_right_chunk )
+        {
+            bool is_gold_end = is_chunk_end(*last_gold, gold),
+                is_pred_end = is_chunk_end(*last_pred, pred);
+            if( is_gold_end && is_pred_end && last_gold->type == last_pred->type )
+            {
+                is_in_right_chunk = false;
+                ++result.nr_chunk_right;
+            }
+            else if( is_gold_end != is_pred_end || gold.type != pred.type ){ is_in_right_chunk = false; }
+        }
+        bool is_gold_start = is_chunk_start(*last_gold, gold),
+            is_pred_start = is_chunk_start(*last_pred, pred);
+        if( is_gold_start && is_pred_start && gold.type == pred.type ){ is_in_right_chunk = true; }
+        if( is_gold_start ){ ++result.nr_chunk_gold; }
+        if( is_pred_start ){ ++result.nr_chunk_predict; }
+        if( i < seqlen )
+        {
+            ++result.nr_token;
+            if( gold_tagseq[i] == pred_tagseq[i] ){ ++result.nr_token_right; }
+        }
+        last_gold = &gold;
+        last_pred = &pred;
+    }
+    return result;
+}
+
+inline
+std::array<float, 4> ConllChunkEval::calc_score(const EvalTempResultT &result)
+{
+    float acc = result.nr_token == 0 ? 0.f : 100.f * result.nr_token_right / result.nr_token,
+        p = result.nr_chunk_predict == 0 ? 0.f : 100.f * result.nr_chunk_right / result.nr_chunk_predict,
+        r = result.nr_chunk_gold == 0 ? 0.f : 100.f * result.nr_chunk_right / result.nr_chunk_gold,
+        f1 = (p + r) == 0.f ? 0.f : 2.f * p * r / (p + r);
+    return std::array<float, 4>{ { acc, p, r, f1 } };
+}
+
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SLNN_UTILS_DYNET_BINARY_MODEL_HPP_
+#define SLNN_UTILS_DYNET_BINARY_MODEL_HPP_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <stdexcept>
+#include "dynet/dynet.h"
+#include "trivial/model_container/binary_model_container.h"
+
+namespace slnn{
+namespace dynet_binary_model{
+
+/**
+ * glue between dynet::Model and the binary model container.
+ * the tensor order is: all parameters, then every row of all lookup parameters (model order).
+ * with the CUDA backend the tensors are in device memory, they are copied through the host instead.
+ */
+
+std::vector<dynet::Tensor*> get_parameter_tensor_list(const dynet::Model *model);
+
+/**
+ * write the container with the parameters of model.
+ */
+void write_binary_model(std::ostream &os, const std::string &dict_bytes, const dynet::Model *model);
+
+/**
+ * use the parameter data in the mapped binary model in place (no copy, copied to device with CUDA).
+ * the model structure should have been built. the caller should keep `mapped_file` alive as long as the model is used.
+ */
+void bind_parameters(dynet::Model *model, const trivial::model_container::MappedModelFile &mapped_file);
+
+/*********************************************
+ * Inline Implementation
+ *********************************************/
+
+inline
+std::vector<dynet::Tensor*> get_parameter_tensor_list(const dynet::Model *model)
+{
+    std::vector<dynet::Tensor*> tensor_list;
+    for( dynet::ParameterStorage *p : model->parameters_list() ){ tensor_list.push_back(&p->values); }
+    for( dynet::LookupParameterStorage *p : model->lookup_parameters_list() )
+    {
+        for( dynet::Tensor &t : p->values ){ tensor_list.push_back(&t); }
+    }
+    return tensor_list;
+}
+
+inline
+void write_binary_model(std::ostream &os, const std::string &dict_bytes, const dynet::Model *model)
+{
+    std::vector<dynet::Tensor*> tensor_list = get_parameter_tensor_list(model);
+    std::vector<trivial::model_container::TensorView> view_list;
+    view_list.reserve(tensor_list.size());
+#if HAVE_CUDA
+    std::vector<std::vector<float>> host_value_list;
+    host_value_list.reserve(tensor_list.size());
+    for( const dynet::Tensor *t : tensor_list )
+    {
+        host_value_list.push_back(dynet::as_vector(*t));
+        view_list.push_back({ host_value_list.back().data(), host_value_list.back().size() });
+    }
+#else
+    for( const dynet::Tensor *t : tensor_list ){ view_list.push_back({ t->v, t->d.size() }); }
+#endif
+    trivial::model_container::write_binary_model(os, dict_bytes, view_list);
+}
+
+inline
+void bind_parameters(dynet::Model *model, const trivial::model_container::MappedModelFile &mapped_file)
+{
+    std::vector<dynet::Tensor*> tensor_list = get_parameter_tensor_list(model);
+    if( tensor_list.size() != mapped_file.get_tensor_num() )
+    {
+        throw std::invalid_argument("binary model: parameter number is not matched with the model structure.");
+    }
+    for( std::size_t i = 0; i < tensor_list.size(); ++i )
+    {
+        if( tensor_list[i]->d.size() != mapped_file.get_tensor(i).size )
+        {
+            throw std::invalid_argument("binary model: parameter " + std::to_string(i) + " size is not matched.");
+        }
+    }
+    for( std::size_t i = 0; i < tensor_list.size(); ++i )
+    {
+#if HAVE_CUDA
+        const trivial::model_container::TensorView &view = mapped_file.get_tensor(i);
+        dynet::TensorTools::SetElements(*tensor_list[i], std::vector<float>(view.data, view.data + view.size));
+#else
+        tensor_list[i]->v = mapped_file.get_mutable_tensor_data(i);
+#endif
+    }
+}
+
+} // end of namespace dynet_binary_model
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,285 @@
+#ifndef SLNN_UTILS_LAZY_SPARSE_TRAINER_HPP_
+#define SLNN_UTILS_LAZY_SPARSE_TRAINER_HPP_
+
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include "dynet/dynet.h"
+
+namespace slnn{
+
+/**
+ * momentum / adagrad / adam trainer with sparse (lazy) update for lookup parameters.
+ * the parameters are updated as the dynet trainers (the same formula, learning rate schedule and gradient clipping),
+ * but only the rows of lookup parameters touched in the current graph (`non_zero_grads`) and their optimizer state
+ * are updated, so the cost of an update is proportional to the sentence length instead of the vocabulary size.
+ * the decay of the skipped steps is applied when the row is touched again (or at `flush`):
+ *   - momentum: exactly, the velocity keeps moving the row for the skipped steps (geometric sum).
+ *   - adagrad: nothing to decay.
+ *   - adam: the moments are decayed by beta^k, the movement of the skipped steps is not replayed (lazy adam).
+ * so the forward of a touched row sees it without the pending momentum movement, it is the only difference
+ * from the dense momentum update.
+ * the normal parameters are updated at every step. the optimizer state is not serialized (as dynet).
+ * the state is process-local, so it can't be used for hogwild training on shared parameters.
+ * tensors should be in host memory, so a trainer on a model can't be created with the CUDA backend
+ * (the kernels on host blocks are still usable).
+ */
+class LazySparseTrainer
+{
+public:
+    enum class Method { Momentum, Adagrad, Adam };
+    LazySparseTrainer(dynet::Model *model, Method method);
+    LazySparseTrainer(const LazySparseTrainer&) = delete;
+    LazySparseTrainer& operator=(const LazySparseTrainer&) = delete;
+    void update(dynet::real scale = 1.f);
+    // also flushes the lazy update, so every row is up to date at the epoch end.
+    void update_epoch(dynet::real r = 1.f);
+    // apply the pending decay (movement) of the skipped steps to all the rows.
+    void flush();
+public:
+    // as dynet::Trainer
+    dynet::real eta0;
+    dynet::real eta;
+    dynet::real eta_decay;
+    dynet::real epoch;
+    bool clipping_enabled;
+    dynet::real clip_threshold;
+    // momentum
+    dynet::real momentum;
+    // adagrad, adam
+    dynet::real epsilon;
+    // adam
+    dynet::real beta_1;
+    dynet::real beta_2;
+private:
+    struct LookupState
+    {
+        std::vector<dynet::real> state1; // (nr_row x dim), velocity / squared gradient sum / first moment
+        std::vector<dynet::real> state2; // (nr_row x dim), second moment (adam)
+        std::vector<unsigned long> last_step_list; // the step of the last update of every row
+    };
+    void alloc_state();
+    dynet::real calc_gradient_scale(dynet::real scale) const;
+public:
+    // the kernels on a block of values and its optimizer state (`s2` is only for adam).
+    // catch_up(k) followed by update_dense is k + 1 dense steps whose first k gradients are zero.
+    void update_dense(dynet::real *w, const dynet::real *g, std::size_t sz, dynet::real *s1, dynet::real *s2,
+        dynet::real gscale) const;
+    void catch_up(dynet::real *w, std::size_t sz, dynet::real *s1, dynet::real *s2, unsigned long nr_skipped) const;
+private:
+    dynet::Model *model;
+    Method method;
+    unsigned long step; // number of the finished updates
+    bool is_state_allocated;
+    std::vector<std::vector<dynet::real>> param_state1_list;
+    std::vector<std::vector<dynet::real>> param_state2_list;
+    std::vector<LookupState> lookup_state_list;
+};
+
+/*********************************************
+ * Inline Implementation
+ *********************************************/
+
+inline
+LazySparseTrainer::LazySparseTrainer(dynet::Model *model, Method method)
+    :eta_decay(0.f),
+    epoch(0.f),
+    clipping_enabled(true),
+    clip_threshold(5.f),
+    momentum(0.9f),
+    epsilon(method == Method::Adam ? 1e-8f : 1e-20f),
+    beta_1(0.9f),
+    beta_2(0.999f),
+    model(model),
+    method(method),
+    step(0),
+    is_state_allocated(false)
+{
+    // default learning rate of dynet
+    eta0 = eta = method == Method::Momentum ? 0.01f : (method == Method::Adagrad ? 0.1f : 0.001f);
+#if HAVE_CUDA
+    if( model ){ throw std::logic_error("sparse update methods are not supported with the CUDA backend."); }
+#endif
+}
+
+inline
+void LazySparseTrainer::alloc_state()
+{
+    bool has_state2 = method == Method::Adam;
+    param_state1_list.clear();
+    param_state2_list.clear();
+    for( const dynet::ParameterStorage *p : model->parameters_list() )
+    {
+        param_state1_list.emplace_back(p->values.d.size(), 0.f);
+        param_state2_list.emplace_back(has_state2 ? p->values.d.size() : 0U, 0.f);
+    }
+    lookup_state_list.clear();
+    for( const dynet::LookupParameterStorage *p : model->lookup_parameters_list() )
+    {
+        std::size_t nr_row = p->values.size(),
+            dim = nr_row == 0 ? 0U : p->values[0].d.size();
+        LookupState state;
+        state.state1.assign(nr_row * dim, 0.f);
+        state.state2.assign(has_state2 ? nr_row * dim : 0U, 0.f);
+        state.last_step_list.assign(nr_row, 0UL);
+        lookup_state_list.push_back(std::move(state));
+    }
+    is_state_allocated = true;
+}
+
+/**
+ * as dynet::Trainer::clip_gradients, but the norm of lookup parameters is summed on the touched rows only.
+ */
+inline
+dynet::real LazySparseTrainer::calc_gradient_scale(dynet::real scale) const
+{
+    if( !clipping_enabled ){ return 1.f; }
+    double sq_sum = 0.;
+    auto accumulate = [&sq_sum](const dynet::Tensor &g)
+    {
+        std::size_t sz = g.d.size();
+        for( std::size_t i = 0; i < sz; ++i ){ sq_sum += static_cast<double>(g.v[i]) * g.v[i]; }
+    };
+    for( const dynet::ParameterStorage *p : model->parameters_list() ){ accumulate(p->g); }
+    for( const dynet::LookupParameterStorage *p : model->lookup_parameters_list() )
+    {
+        for( unsigned row : p->non_zero_grads ){ accumulate(p->grads[row]); }
+    }
+    dynet::real gg = static_cast<dynet::real>(std::sqrt(sq_sum));
+    if( std::isnan(gg) || std::isinf(gg) ){ throw std::runtime_error("lazy sparse trainer: magnitude of gradient is bad: " + std::to_string(gg)); }
+    return scale * gg > clip_threshold ? clip_threshold / (scale * gg) : 1.f;
+}
+
+/**
+ * one step (`step + 1`) of the optimizer on a dense block.
+ */
+inline
+void LazySparseTrainer::update_dense(dynet::real *w, const dynet::real *g, std::size_t sz, dynet::real *s1, dynet::real *s2,
+    dynet::real gscale) const
+{
+    switch( method )
+    {
+    case Method::Momentum:
+        for( std::size_t i = 0; i < sz; ++i )
+        {
+            s1[i] = momentum * s1[i] - eta * gscale * g[i];
+            w[i] += s1[i];
+        }
+        break;
+    case Method::Adagrad:
+        for( std::size_t i = 0; i < sz; ++i )
+        {
+            dynet::real reg = g[i] * gscale;
+            s1[i] += reg * reg;
+            w[i] -= eta * reg / std::sqrt(s1[i] + epsilon);
+        }
+        break;
+    case Method::Adam:
+    {
+        dynet::real bias1 = 1.f - std::pow(beta_1, static_cast<dynet::real>(step + 1)),
+            bias2 = 1.f - std::pow(beta_2, static_cast<dynet::real>(step + 1));
+        for( std::size_t i = 0; i < sz; ++i )
+        {
+            dynet::real reg = g[i] * gscale;
+            s1[i] = beta_1 * s1[i] + (1.f - beta_1) * reg;
+            s2[i] = beta_2 * s2[i] + (1.f - beta_2) * reg * reg;
+            w[i] -= eta * (s1[i] / bias1) / (std::sqrt(s2[i] / bias2) + epsilon);
+        }
+        break;
+    }
+    }
+}
+
+/**
+ * apply the decay of `nr_skipped` steps (zero gradient) on a row.
+ */
+inline
+void LazySparseTrainer::catch_up(dynet::real *w, std::size_t sz, dynet::real *s1, dynet::real *s2, unsigned long nr_skipped) const
+{
+    if( nr_skipped == 0 ){ return; }
+    if( method == Method::Momentum )
+    {
+        // v_k = m^k * v, w += v * (m + m^2 + ... + m^k)
+        dynet::real decay = std::pow(momentum, static_cast<dynet::real>(nr_skipped)),
+            move_ratio = momentum == 1.f ? static_cast<dynet::real>(nr_skipped) : momentum * (1.f - decay) / (1.f - momentum);
+        for( std::size_t i = 0; i < sz; ++i )
+        {
+            w[i] += s1[i] * move_ratio;
+            s1[i] *= decay;
+        }
+    }
+    else if( method == Method::Adam )
+    {
+        dynet::real decay1 = std::pow(beta_1, static_cast<dynet::real>(nr_skipped)),
+            decay2 = std::pow(beta_2, static_cast<dynet::real>(nr_skipped));
+        for( std::size_t i = 0; i < sz; ++i )
+        {
+            s1[i] *= decay1;
+            s2[i] *= decay2;
+        }
+    }
+}
+
+inline
+void LazySparseTrainer::update(dynet::real scale)
+{
+    if( !is_state_allocated ){ alloc_state(); }
+    dynet::real gscale = scale * calc_gradient_scale(scale);
+    const std::vector<dynet::ParameterStorage*> &param_list = model->parameters_list();
+    for( std::size_t i = 0; i < param_list.size(); ++i )
+    {
+        dynet::ParameterStorage *p = param_list[i];
+        update_dense(p->values.v, p->g.v, p->values.d.size(), param_state1_list[i].data(), param_state2_list[i].data(), gscale);
+        p->clear();
+    }
+    const std::vector<dynet::LookupParameterStorage*> &lookup_param_list = model->lookup_parameters_list();
+    for( std::size_t i = 0; i < lookup_param_list.size(); ++i )
+    {
+        dynet::LookupParameterStorage *p = lookup_param_list[i];
+        LookupState &state = lookup_state_list[i];
+        for( unsigned row : p->non_zero_grads )
+        {
+            std::size_t dim = p->values[row].d.size();
+            dynet::real *s1 = state.state1.data() + row * dim,
+                *s2 = state.state2.empty() ? nullptr : state.state2.data() + row * dim;
+            catch_up(p->values[row].v, dim, s1, s2, step - state.last_step_list[row]);
+            update_dense(p->values[row].v, p->grads[row].v, dim, s1, s2, gscale);
+            state.last_step_list[row] = step + 1;
+        }
+        p->clear(); // only the touched rows are zeroed
+    }
+    ++step;
+}
+
+inline
+void LazySparseTrainer::flush()
+{
+    if( !is_state_allocated ){ return; }
+    const std::vector<dynet::LookupParameterStorage*> &lookup_param_list = model->lookup_parameters_list();
+    for( std::size_t i = 0; i < lookup_param_list.size(); ++i )
+    {
+        dynet::LookupParameterStorage *p = lookup_param_list[i];
+        LookupState &state = lookup_state_list[i];
+        for( std::size_t row = 0; row < p->values.size(); ++row )
+        {
+            std::size_t dim = p->values[row].d.size();
+            catch_up(p->values[row].v, dim, state.state1.data() + row * dim,
+                state.state2.empty() ? nullptr : state.state2.data() + row * dim, step - state.last_step_list[row]);
+            state.last_step_list[row] = step;
+        }
+    }
+}
+
+inline
+void LazySparseTrainer::update_epoch(dynet::real r)
+{
+    flush();
+    epoch += r;
+    eta = eta0 / (1.f + epoch * eta_decay);
+}
+
+} // end of namespace slnn
+
+#endif
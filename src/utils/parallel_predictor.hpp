@@ -0,0 +1,608 @@
+#ifndef SLNN_UTILS_PARALLEL_PREDICTOR_HPP_
+#define SLNN_UTILS_PARALLEL_PREDICTOR_HPP_
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <streambuf>
+#include <functional>
+#include <stdexcept>
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#endif
+
+namespace slnn{
+namespace utils{
+
+/**
+ * Process based parallel prediction.
+ * DyNet allows only one ComputationGraph in a process, so the workers are processes forked after the model
+ * has been loaded: the model is loaded once, and the parameters are shared copy-on-write among workers
+ * (for the mapped binary model, they are shared in the page cache, too). every worker keeps its own graph.
+ * 1. `predict_in_parallel` : input lines are cut into chunks and dispatched to the workers round-robin,
+ *    results are written back in the input order (by chunk sequence).
+ * 2. `serve_on_unix_socket` : long-running service. pre-forked workers accept connections on a unix socket,
+ *    a client writes lines, shuts down its writing side, then reads the tagged lines.
+ * 3. `run_pipeline` : chained stages (e.g. segment -> postag -> ner), one process per stage, connected by pipes.
+ *    a pipe is a bounded queue (the writer blocks when the kernel buffer is full), so stages run overlapped.
+ * the prediction is done by `StreamPredictFunc`, which should tag every line of the input stream to the output stream.
+ */
+
+using StreamPredictFunc = std::function<void(std::istream&, std::ostream&)>;
+
+bool is_parallel_predict_supported();
+
+/**
+ * predict lines of `is` to `os` by `nr_worker` processes.
+ * @return line number.
+ */
+unsigned long predict_in_parallel(std::istream &is, std::ostream &os, StreamPredictFunc predict_func,
+    unsigned nr_worker, unsigned chunk_line_num);
+
+/**
+ * serve on unix socket `socket_path` by `nr_worker` processes, until SIGINT / SIGTERM.
+ */
+void serve_on_unix_socket(const std::string &socket_path, StreamPredictFunc predict_func, unsigned nr_worker);
+
+/**
+ * run `stage_list` as a pipeline from `is` to `os`. stage k reads the output of stage k-1.
+ * the model of a stage should be loaded inside its function (every stage is a separate process,
+ * and the last stage runs in the calling process), and every stage should flush its output stream periodically.
+ */
+void run_pipeline(std::istream &is, std::ostream &os, const std::vector<StreamPredictFunc> &stage_list);
+
+
+/**************************************
+ * Inline Implementation
+ **************************************/
+
+#ifndef _WIN32
+
+namespace parallel_predictor_inner{
+
+inline
+bool write_all(int fd, const char *data, std::size_t sz)
+{
+    while( sz > 0 )
+    {
+        ssize_t n = ::write(fd, data, sz);
+        if( n < 0 && errno == EINTR ){ continue; }
+        if( n <= 0 ){ return false; }
+        data += n;
+        sz -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+inline
+bool read_all(int fd, char *data, std::size_t sz)
+{
+    while( sz > 0 )
+    {
+        ssize_t n = ::read(fd, data, sz);
+        if( n < 0 && errno == EINTR ){ continue; }
+        if( n <= 0 ){ return false; }
+        data += n;
+        sz -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// message = uint64 length + content
+inline
+bool send_message(int fd, const std::string &msg)
+{
+    std::uint64_t sz = msg.size();
+    return write_all(fd, reinterpret_cast<const char*>(&sz), sizeof(sz)) && write_all(fd, msg.data(), msg.size());
+}
+
+// return false when the peer is closed
+inline
+bool recv_message(int fd, std::string &msg)
+{
+    std::uint64_t sz = 0;
+    if( !read_all(fd, reinterpret_cast<char*>(&sz), sizeof(sz)) ){ return false; }
+    msg.resize(sz);
+    return sz == 0 || read_all(fd, &msg[0], sz);
+}
+
+/**
+ * read at most `line_num` lines into `chunk` ('\n' is kept for every line).
+ * @return line number read.
+ */
+inline
+unsigned read_chunk(std::istream &is, unsigned line_num, std::string &chunk)
+{
+    chunk.clear();
+    std::string line;
+    unsigned cnt = 0;
+    while( cnt < line_num && std::getline(is, line) )
+    {
+        chunk += line;
+        chunk += '\n';
+        ++cnt;
+    }
+    return cnt;
+}
+
+/**
+ * std::streambuf on a file descriptor (socket), with separate get and put area.
+ */
+class FdStreamBuf : public std::streambuf
+{
+public:
+    explicit FdStreamBuf(int fd, std::size_t buf_sz=65536)
+        :fd(fd), in_buf(buf_sz), out_buf(buf_sz)
+    {
+        setg(in_buf.data(), in_buf.data(), in_buf.data());
+        setp(out_buf.data(), out_buf.data() + out_buf.size());
+    }
+    ~FdStreamBuf(){ flush_out(); }
+    FdStreamBuf(const FdStreamBuf&) = delete;
+    FdStreamBuf& operator=(const FdStreamBuf&) = delete;
+protected:
+    int_type underflow() override
+    {
+        if( gptr() < egptr() ){ return traits_type::to_int_type(*gptr()); }
+        ssize_t n;
+        do{ n = ::read(fd, in_buf.data(), in_buf.size()); } while( n < 0 && errno == EINTR );
+        if( n <= 0 ){ return traits_type::eof(); }
+        setg(in_buf.data(), in_buf.data(), in_buf.data() + n);
+        return traits_type::to_int_type(*gptr());
+    }
+    int_type overflow(int_type ch) override
+    {
+        if( flush_out() != 0 ){ return traits_type::eof(); }
+        if( !traits_type::eq_int_type(ch, traits_type::eof()) )
+        {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+    int sync() override { return flush_out(); }
+private:
+    int flush_out()
+    {
+        std::size_t sz = pptr() - pbase();
+        if( sz > 0 && !write_all(fd, pbase(), sz) ){ return -1; }
+        setp(out_buf.data(), out_buf.data() + out_buf.size());
+        return 0;
+    }
+private:
+    int fd;
+    std::vector<char> in_buf;
+    std::vector<char> out_buf;
+};
+
+inline
+volatile std::sig_atomic_t& stop_flag()
+{
+    static volatile std::sig_atomic_t flag = 0;
+    return flag;
+}
+
+inline
+void on_stop_signal(int)
+{
+    stop_flag() = 1;
+}
+
+// only to wake up `sigsuspend` when a worker exits.
+inline
+void on_child_signal(int)
+{}
+
+inline
+void kill_and_wait(const std::vector<pid_t> &pid_list)
+{
+    for( pid_t pid : pid_list ){ if( pid > 0 ){ ::kill(pid, SIGTERM); } }
+    for( pid_t pid : pid_list ){ if( pid > 0 ){ ::waitpid(pid, nullptr, 0); } }
+}
+
+} // end of namespace parallel_predictor_inner
+
+inline
+bool is_parallel_predict_supported()
+{
+    return true;
+}
+
+inline
+unsigned long predict_in_parallel(std::istream &is, std::ostream &os, StreamPredictFunc predict_func,
+    unsigned nr_worker, unsigned chunk_line_num)
+{
+    using namespace parallel_predictor_inner;
+    if( nr_worker == 0 || chunk_line_num == 0 )
+    {
+        throw std::invalid_argument("parallel predict: worker number and chunk line number should be positive.");
+    }
+    os.flush(); // nothing buffered should be inherited by the workers
+    // per worker: request pipe (coordinator -> worker), response pipe (worker -> coordinator)
+    std::vector<int> req_fd_list, resp_fd_list;
+    std::vector<pid_t> pid_list;
+    auto close_all = [&req_fd_list, &resp_fd_list]()
+    {
+        for( int fd : req_fd_list ){ ::close(fd); }
+        for( int fd : resp_fd_list ){ ::close(fd); }
+        req_fd_list.clear();
+        resp_fd_list.clear();
+    };
+    for( unsigned worker_id = 0; worker_id < nr_worker; ++worker_id )
+    {
+        int req_pipe[2], resp_pipe[2];
+        if( ::pipe(req_pipe) != 0 ){ close_all(); kill_and_wait(pid_list); throw std::runtime_error("parallel predict: failed to create pipe."); }
+        if( ::pipe(resp_pipe) != 0 )
+        {
+            ::close(req_pipe[0]); ::close(req_pipe[1]);
+            close_all(); kill_and_wait(pid_list);
+            throw std::runtime_error("parallel predict: failed to create pipe.");
+        }
+        pid_t pid = ::fork();
+        if( pid == 0 )
+        {
+            // worker. close the coordinator side (including those of the previous workers), so EOF can be seen.
+            for( int fd : req_fd_list ){ ::close(fd); }
+            for( int fd : resp_fd_list ){ ::close(fd); }
+            ::close(req_pipe[1]);
+            ::close(resp_pipe[0]);
+            try
+            {
+                std::string request;
+                while( recv_message(req_pipe[0], request) )
+                {
+                    std::istringstream iss(request);
+                    std::ostringstream oss;
+                    predict_func(iss, oss);
+                    if( !send_message(resp_pipe[1], oss.str()) ){ _exit(1); }
+                }
+            }
+            catch( const std::exception &e )
+            {
+                std::cerr << "predict worker " << worker_id << " failed: " << e.what() << "\n";
+                _exit(1);
+            }
+            catch( ... )
+            {
+                std::cerr << "predict worker " << worker_id << " failed: unknown exception\n";
+                _exit(1);
+            }
+            _exit(0);
+        }
+        ::close(req_pipe[0]);
+        ::close(resp_pipe[1]);
+        if( pid < 0 )
+        {
+            ::close(req_pipe[1]); ::close(resp_pipe[0]);
+            close_all(); kill_and_wait(pid_list);
+            throw std::runtime_error("parallel predict: failed to fork worker.");
+        }
+        pid_list.push_back(pid);
+        req_fd_list.push_back(req_pipe[1]);
+        resp_fd_list.push_back(resp_pipe[0]);
+    }
+    // a dead worker should be reported by error, not by SIGPIPE.
+    void (*pre_sigpipe_handler)(int) = std::signal(SIGPIPE, SIG_IGN);
+    unsigned long nr_sent = 0,
+        nr_received = 0,
+        nr_line = 0;
+    bool is_ok = true;
+    std::string chunk, result;
+    // chunk k is always dispatched to worker (k % nr_worker), and only one chunk is in flight for a worker.
+    for( unsigned worker_id = 0; worker_id < nr_worker; ++worker_id )
+    {
+        unsigned cnt = read_chunk(is, chunk_line_num, chunk);
+        if( cnt == 0 ){ break; }
+        if( !send_message(req_fd_list[worker_id], chunk) ){ is_ok = false; break; }
+        nr_line += cnt;
+        ++nr_sent;
+    }
+    while( is_ok && nr_received < nr_sent )
+    {
+        unsigned worker_id = nr_received % nr_worker;
+        if( !recv_message(resp_fd_list[worker_id], result) ){ is_ok = false; break; }
+        os.write(result.data(), result.size());
+        os.flush();
+        ++nr_received;
+        unsigned cnt = read_chunk(is, chunk_line_num, chunk);
+        if( cnt == 0 ){ continue; }
+        if( !send_message(req_fd_list[worker_id], chunk) ){ is_ok = false; break; }
+        nr_line += cnt;
+        ++nr_sent;
+    }
+    close_all(); // workers see EOF and exit
+    if( !is_ok ){ kill_and_wait(pid_list); }
+    else
+    {
+        for( pid_t pid : pid_list )
+        {
+            int status = 0;
+            if( ::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ){ is_ok = false; }
+        }
+    }
+    std::signal(SIGPIPE, pre_sigpipe_handler);
+    if( !is_ok ){ throw std::runtime_error("parallel predict: worker process failed."); }
+    return nr_line;
+}
+
+inline
+void serve_on_unix_socket(const std::string &socket_path, StreamPredictFunc predict_func, unsigned nr_worker)
+{
+    using namespace parallel_predictor_inner;
+    if( nr_worker == 0 ){ throw std::invalid_argument("predict server: worker number should be positive."); }
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if( socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path) )
+    {
+        throw std::invalid_argument("predict server: invalid socket path '" + socket_path + "'");
+    }
+    std::strcpy(addr.sun_path, socket_path.c_str());
+    struct stat path_stat;
+    if( ::stat(socket_path.c_str(), &path_stat) == 0 )
+    {
+        // left by the previous run
+        if( !S_ISSOCK(path_stat.st_mode) )
+        {
+            throw std::runtime_error("predict server: '" + socket_path + "' exists and is not a socket.");
+        }
+        ::unlink(socket_path.c_str());
+    }
+    int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if( listen_fd < 0 ){ throw std::runtime_error("predict server: failed to create socket."); }
+    if( ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listen_fd, 128) != 0 )
+    {
+        ::close(listen_fd);
+        throw std::runtime_error("predict server: failed to listen on '" + socket_path + "'");
+    }
+    // the stop and child signals are blocked out of `sigsuspend`, so the loop condition is checked with them
+    // pending, not delivered: a signal coming between the check and the wait is not lost (it wakes up the wait).
+    sigset_t block_mask, pre_mask, wait_mask;
+    sigemptyset(&block_mask);
+    sigaddset(&block_mask, SIGINT);
+    sigaddset(&block_mask, SIGTERM);
+    sigaddset(&block_mask, SIGCHLD);
+    ::sigprocmask(SIG_BLOCK, &block_mask, &pre_mask);
+    wait_mask = pre_mask;
+    sigdelset(&wait_mask, SIGINT);
+    sigdelset(&wait_mask, SIGTERM);
+    sigdelset(&wait_mask, SIGCHLD);
+    auto spawn_worker = [listen_fd, &predict_func, &pre_mask]() -> pid_t
+    {
+        pid_t pid = ::fork();
+        if( pid != 0 ){ return pid; }
+        // worker
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        std::signal(SIGCHLD, SIG_DFL);
+        ::sigprocmask(SIG_SETMASK, &pre_mask, nullptr);
+        std::signal(SIGPIPE, SIG_IGN); // client may leave early
+        while( true )
+        {
+            int conn_fd = ::accept(listen_fd, nullptr, nullptr);
+            if( conn_fd < 0 )
+            {
+                if( errno == EINTR || errno == ECONNABORTED ){ continue; }
+                _exit(1);
+            }
+            try
+            {
+                FdStreamBuf buf(conn_fd);
+                std::istream conn_is(&buf);
+                std::ostream conn_os(&buf);
+                predict_func(conn_is, conn_os);
+                conn_os.flush();
+            }
+            catch( const std::exception &e )
+            {
+                std::cerr << "predict server worker " << ::getpid() << " : " << e.what() << "\n";
+            }
+            catch( ... )
+            {
+                std::cerr << "predict server worker " << ::getpid() << " : unknown exception\n";
+            }
+            ::close(conn_fd);
+        }
+    };
+    // stop by SIGINT / SIGTERM.
+    struct sigaction stop_action, child_action, pre_int_action, pre_term_action, pre_child_action;
+    std::memset(&stop_action, 0, sizeof(stop_action));
+    stop_action.sa_handler = on_stop_signal;
+    sigemptyset(&stop_action.sa_mask);
+    std::memset(&child_action, 0, sizeof(child_action));
+    child_action.sa_handler = on_child_signal;
+    sigemptyset(&child_action.sa_mask);
+    stop_flag() = 0;
+    ::sigaction(SIGINT, &stop_action, &pre_int_action);
+    ::sigaction(SIGTERM, &stop_action, &pre_term_action);
+    ::sigaction(SIGCHLD, &child_action, &pre_child_action);
+    std::vector<pid_t> pid_list;
+    for( unsigned i = 0; i < nr_worker; ++i )
+    {
+        pid_t pid = spawn_worker();
+        if( pid > 0 ){ pid_list.push_back(pid); }
+    }
+    std::cerr << "+ Serving on unix socket '" << socket_path << "' with " << pid_list.size() << " worker(s) .\n";
+    while( !stop_flag() && !pid_list.empty() )
+    {
+        // respawn the dead workers
+        int status = 0;
+        pid_t pid;
+        while( (pid = ::waitpid(-1, &status, WNOHANG)) > 0 )
+        {
+            for( pid_t &worker_pid : pid_list )
+            {
+                if( worker_pid != pid ){ continue; }
+                std::cerr << "predict server worker " << pid << " exited, respawn it.\n";
+                worker_pid = stop_flag() ? -1 : spawn_worker();
+            }
+        }
+        if( pid < 0 && errno == ECHILD ){ break; } // no worker alive, and none can be spawned
+        if( stop_flag() ){ break; }
+        // atomically unblock the signals and wait for one of them.
+        ::sigsuspend(&wait_mask);
+    }
+    kill_and_wait(pid_list);
+    ::close(listen_fd);
+    ::unlink(socket_path.c_str());
+    ::sigaction(SIGINT, &pre_int_action, nullptr);
+    ::sigaction(SIGTERM, &pre_term_action, nullptr);
+    ::sigaction(SIGCHLD, &pre_child_action, nullptr);
+    ::sigprocmask(SIG_SETMASK, &pre_mask, nullptr);
+    std::cerr << "+ Server stopped .\n";
+}
+
+inline
+void run_pipeline(std::istream &is, std::ostream &os, const std::vector<StreamPredictFunc> &stage_list)
+{
+    using namespace parallel_predictor_inner;
+    if( stage_list.empty() ){ throw std::invalid_argument("pipeline: no stage."); }
+    os.flush();
+    std::size_t nr_stage = stage_list.size();
+    // pipe k : stage k -> stage k+1
+    std::vector<int> read_fd_list, write_fd_list;
+    std::vector<pid_t> pid_list;
+    auto close_all = [&read_fd_list, &write_fd_list]()
+    {
+        for( int fd : read_fd_list ){ if( fd >= 0 ){ ::close(fd); } }
+        for( int fd : write_fd_list ){ if( fd >= 0 ){ ::close(fd); } }
+    };
+    for( std::size_t k = 0; k + 1 < nr_stage; ++k )
+    {
+        int fds[2];
+        if( ::pipe(fds) != 0 ){ close_all(); throw std::runtime_error("pipeline: failed to create pipe."); }
+        read_fd_list.push_back(fds[0]);
+        write_fd_list.push_back(fds[1]);
+    }
+    // stages except the last one run in the child processes.
+    for( std::size_t k = 0; k + 1 < nr_stage; ++k )
+    {
+        pid_t pid = ::fork();
+        if( pid == 0 )
+        {
+            int in_fd = k == 0 ? -1 : read_fd_list[k - 1],
+                out_fd = write_fd_list[k];
+            // keep only the own ends open, so every reader sees EOF when its writer finishes.
+            for( int fd : read_fd_list ){ if( fd != in_fd ){ ::close(fd); } }
+            for( int fd : write_fd_list ){ if( fd != out_fd ){ ::close(fd); } }
+            int exit_code = 0;
+            try
+            {
+                FdStreamBuf out_buf(out_fd);
+                std::ostream stage_os(&out_buf);
+                if( k == 0 ){ stage_list[k](is, stage_os); }
+                else
+                {
+                    FdStreamBuf in_buf(in_fd);
+                    std::istream stage_is(&in_buf);
+                    stage_list[k](stage_is, stage_os);
+                }
+                stage_os.flush();
+                if( !stage_os ){ exit_code = 1; }
+            }
+            catch( const std::exception &e )
+            {
+                std::cerr << "pipeline stage " << k << " failed: " << e.what() << "\n";
+                exit_code = 1;
+            }
+            catch( ... )
+            {
+                std::cerr << "pipeline stage " << k << " failed: unknown exception\n";
+                exit_code = 1;
+            }
+            _exit(exit_code);
+        }
+        if( pid < 0 )
+        {
+            close_all();
+            kill_and_wait(pid_list);
+            throw std::runtime_error("pipeline: failed to fork stage process.");
+        }
+        pid_list.push_back(pid);
+    }
+    int last_in_fd = nr_stage > 1 ? read_fd_list.back() : -1;
+    for( int fd : read_fd_list ){ if( fd != last_in_fd ){ ::close(fd); } }
+    for( int fd : write_fd_list ){ ::close(fd); }
+    bool is_ok = true;
+    try
+    {
+        if( nr_stage == 1 ){ stage_list.back()(is, os); }
+        else
+        {
+            FdStreamBuf in_buf(last_in_fd);
+            std::istream stage_is(&in_buf);
+            stage_list.back()(stage_is, os);
+        }
+        os.flush();
+    }
+    catch( ... )
+    {
+        if( last_in_fd >= 0 ){ ::close(last_in_fd); }
+        kill_and_wait(pid_list);
+        throw;
+    }
+    if( last_in_fd >= 0 ){ ::close(last_in_fd); }
+    for( pid_t pid : pid_list )
+    {
+        int status = 0;
+        if( ::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ){ is_ok = false; }
+    }
+    if( !is_ok ){ throw std::runtime_error("pipeline: stage process failed."); }
+}
+
+#else
+
+inline
+bool is_parallel_predict_supported()
+{
+    return false;
+}
+
+inline
+unsigned long predict_in_parallel(std::istream&, std::ostream&, StreamPredictFunc, unsigned, unsigned)
+{
+    throw std::logic_error("parallel predict is not supported on this platform.");
+}
+
+inline
+void serve_on_unix_socket(const std::string&, StreamPredictFunc, unsigned)
+{
+    throw std::logic_error("unix socket server is not supported on this platform.");
+}
+
+inline
+void run_pipeline(std::istream &is, std::ostream &os, const std::vector<StreamPredictFunc> &stage_list)
+{
+    // run the stages one after another through in-memory buffer.
+    std::string buffered;
+    for( std::size_t k = 0; k < stage_list.size(); ++k )
+    {
+        std::istringstream stage_iss(buffered);
+        std::istream &stage_is = k == 0 ? is : static_cast<std::istream&>(stage_iss);
+        if( k + 1 == stage_list.size() ){ stage_list[k](stage_is, os); }
+        else
+        {
+            std::ostringstream stage_oss;
+            stage_list[k](stage_is, stage_oss);
+            buffered = stage_oss.str();
+        }
+    }
+}
+
+#endif
+
+} // end of namespace utils
+} // end of namespace slnn
+
+#endif
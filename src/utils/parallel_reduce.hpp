@@ -0,0 +1,200 @@
+#ifndef SLNN_UTILS_PARALLEL_REDUCE_HPP_
+#define SLNN_UTILS_PARALLEL_REDUCE_HPP_
+
+#include <atomic>
+#include <new>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <type_traits>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+namespace slnn{
+namespace utils{
+
+/**
+ * Process based parallel reduce on an index range.
+ * DyNet allows only one ComputationGraph in a process, so the workers are processes forked from the caller:
+ * every worker owns a copy (copy-on-write) of the model and the graph, pulls index from a shared atomic cursor,
+ * and accumulates its own partial result in shared memory. the partial results are merged by `operator+=`.
+ * `ResultT` should be trivially copyable (it lives in shared memory) and default constructed as zero.
+ * the model is read at fork time: unless the parameters are in shared memory (hogwild), the workers see
+ * a snapshot of the parameters, and the caller can go on updating its own copy (see `AsyncParallelReduce`).
+ */
+
+bool is_parallel_reduce_supported();
+
+/**
+ * call `map_func(idx, partial_result)` for idx in [idx_begin, idx_end) by `nr_worker` processes.
+ * @return the merged result of all workers.
+ */
+template <typename ResultT, typename MapFunc>
+ResultT reduce_in_parallel(unsigned nr_worker, unsigned idx_begin, unsigned idx_end, MapFunc map_func);
+
+/**
+ * asynchronous parallel reduce. `start` forks the workers and returns at once, `wait` joins them.
+ * at most one reduce is running in an instance.
+ */
+template <typename ResultT>
+class AsyncParallelReduce
+{
+    static_assert(std::is_trivially_copyable<ResultT>::value, "ResultT should be trivially copyable.");
+public:
+    AsyncParallelReduce() : mem(nullptr), mem_sz(0), nr_worker(0){}
+    ~AsyncParallelReduce();
+    AsyncParallelReduce(const AsyncParallelReduce&) = delete;
+    AsyncParallelReduce& operator=(const AsyncParallelReduce&) = delete;
+    template <typename MapFunc>
+    void start(unsigned nr_worker, unsigned idx_begin, unsigned idx_end, MapFunc map_func);
+    bool is_running() const { return mem != nullptr; }
+    ResultT wait();
+private:
+    void *mem;
+    std::size_t mem_sz;
+    unsigned nr_worker;
+#ifndef _WIN32
+    std::vector<pid_t> worker_pid_list;
+#endif
+};
+
+
+/**************************************
+ * Inline Implementation
+ **************************************/
+
+inline
+bool is_parallel_reduce_supported()
+{
+#ifndef _WIN32
+    return ATOMIC_INT_LOCK_FREE == 2; // the cursor should be address-free to be shared among processes.
+#else
+    return false;
+#endif
+}
+
+template <typename ResultT, typename MapFunc>
+ResultT reduce_in_parallel(unsigned nr_worker, unsigned idx_begin, unsigned idx_end, MapFunc map_func)
+{
+    AsyncParallelReduce<ResultT> reducer;
+    reducer.start(nr_worker, idx_begin, idx_end, map_func);
+    return reducer.wait();
+}
+
+#ifndef _WIN32
+
+namespace parallel_reduce_inner{
+
+constexpr std::size_t ResultOffset = 64; // keep the cursor in its own cache line
+
+} // end of namespace parallel_reduce_inner
+
+template <typename ResultT>
+AsyncParallelReduce<ResultT>::~AsyncParallelReduce()
+{
+    if( is_running() )
+    {
+        try{ wait(); }
+        catch( const std::exception &e ){ std::cerr << "parallel reduce: " << e.what() << "\n"; }
+    }
+}
+
+template <typename ResultT>
+template <typename MapFunc>
+void AsyncParallelReduce<ResultT>::start(unsigned nr_worker, unsigned idx_begin, unsigned idx_end, MapFunc map_func)
+{
+    using parallel_reduce_inner::ResultOffset;
+    if( is_running() ){ throw std::logic_error("parallel reduce: the last reduce is still running."); }
+    this->nr_worker = nr_worker;
+    mem_sz = ResultOffset + nr_worker * sizeof(ResultT);
+    mem = mmap(nullptr, mem_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if( mem == MAP_FAILED )
+    {
+        mem = nullptr;
+        throw std::runtime_error("parallel reduce: failed to map shared memory.");
+    }
+    std::atomic<unsigned> *cursor = new (mem) std::atomic<unsigned>(idx_begin);
+    ResultT *result_list = reinterpret_cast<ResultT*>(static_cast<char*>(mem) + ResultOffset);
+    for( unsigned i = 0; i < nr_worker; ++i ){ new (result_list + i) ResultT(); }
+    // flush the buffered output, or it will be written again by every worker.
+    std::cout.flush();
+    std::cerr.flush();
+    worker_pid_list.clear();
+    for( unsigned worker_id = 0; worker_id < nr_worker; ++worker_id )
+    {
+        pid_t pid = fork();
+        if( pid == 0 )
+        {
+            // worker. exit without stack unwinding, the resources are owned by the caller.
+            try
+            {
+                unsigned idx;
+                while( (idx = cursor->fetch_add(1U)) < idx_end ){ map_func(idx, result_list[worker_id]); }
+            }
+            catch( const std::exception &e )
+            {
+                std::cerr << "parallel reduce worker " << worker_id << " failed: " << e.what() << "\n";
+                _exit(1);
+            }
+            catch( ... )
+            {
+                // the exception should never escape to the caller's stack in the child.
+                std::cerr << "parallel reduce worker " << worker_id << " failed: unknown exception\n";
+                _exit(1);
+            }
+            _exit(0);
+        }
+        else if( pid < 0 ){ break; } // the forked workers can finish all the indices.
+        worker_pid_list.push_back(pid);
+    }
+}
+
+template <typename ResultT>
+ResultT AsyncParallelReduce<ResultT>::wait()
+{
+    using parallel_reduce_inner::ResultOffset;
+    if( !is_running() ){ throw std::logic_error("parallel reduce: no reduce is running."); }
+    bool is_all_ok = !worker_pid_list.empty();
+    for( pid_t pid : worker_pid_list )
+    {
+        int status = 0;
+        if( waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ){ is_all_ok = false; }
+    }
+    worker_pid_list.clear();
+    const ResultT *result_list = reinterpret_cast<const ResultT*>(static_cast<char*>(mem) + ResultOffset);
+    ResultT merged_result;
+    for( unsigned i = 0; i < nr_worker; ++i ){ merged_result += result_list[i]; }
+    munmap(mem, mem_sz);
+    mem = nullptr;
+    if( !is_all_ok ){ throw std::runtime_error("parallel reduce: worker process failed."); }
+    return merged_result;
+}
+
+#else
+
+template <typename ResultT>
+AsyncParallelReduce<ResultT>::~AsyncParallelReduce(){}
+
+template <typename ResultT>
+template <typename MapFunc>
+void AsyncParallelReduce<ResultT>::start(unsigned, unsigned, unsigned, MapFunc)
+{
+    throw std::logic_error("parallel reduce: not supported on this platform.");
+}
+
+template <typename ResultT>
+ResultT AsyncParallelReduce<ResultT>::wait()
+{
+    throw std::logic_error("parallel reduce: not supported on this platform.");
+}
+
+#endif
+
+} // end of namespace utils
+} // end of namespace slnn
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef SLNN_UTILS_PARAMETER_SNAPSHOT_HPP_
+#define SLNN_UTILS_PARAMETER_SNAPSHOT_HPP_
+
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+#include "dynet/dynet.h"
+
+namespace slnn{
+
+/**
+ * in-memory snapshot of the parameter values of a dynet::Model.
+ * the values of every parameter (and every row of lookup parameter) are copied into one flat shadow buffer,
+ * which is allocated at the first `take` and reused later. `restore` copies them back in place,
+ * so the tensor memory owned by others (shared memory in hogwild training, mapped model file) is kept.
+ * only values are kept (no gradients, no optimizer state), the same as the serialized model.
+ * with the CUDA backend the values are copied between device and the host buffer by dynet's tensor tools.
+ */
+class ParameterSnapshot
+{
+public:
+    ParameterSnapshot() : is_taken(false){}
+    void take(dynet::Model *model);
+    bool restore(dynet::Model *model) const;
+    bool empty() const { return !is_taken; }
+    void clear(){ is_taken = false; }
+private:
+    static std::vector<dynet::Tensor*> collect_tensor(dynet::Model *model);
+private:
+    std::vector<dynet::real> shadow_buffer;
+    std::vector<std::size_t> tensor_sz_list;
+    bool is_taken;
+};
+
+/*********************************************
+ * Inline Implementation
+ *********************************************/
+
+inline
+std::vector<dynet::Tensor*> ParameterSnapshot::collect_tensor(dynet::Model *model)
+{
+    std::vector<dynet::Tensor*> tensor_list;
+    for( dynet::ParameterStorage *p : model->parameters_list() ){ tensor_list.push_back(&p->values); }
+    for( dynet::LookupParameterStorage *p : model->lookup_parameters_list() )
+    {
+        for( dynet::Tensor &t : p->values ){ tensor_list.push_back(&t); }
+    }
+    return tensor_list;
+}
+
+inline
+void ParameterSnapshot::take(dynet::Model *model)
+{
+    std::vector<dynet::Tensor*> tensor_list = collect_tensor(model);
+    tensor_sz_list.resize(tensor_list.size());
+    std::size_t total_sz = 0;
+    for( std::size_t i = 0; i < tensor_list.size(); ++i )
+    {
+        tensor_sz_list[i] = tensor_list[i]->d.size();
+        total_sz += tensor_sz_list[i];
+    }
+    shadow_buffer.resize(total_sz); // no reallocation after the first time
+    dynet::real *cur = shadow_buffer.data();
+    for( std::size_t i = 0; i < tensor_list.size(); ++i )
+    {
+#if HAVE_CUDA
+        std::vector<dynet::real> host_values = dynet::as_vector(*tensor_list[i]);
+        std::memcpy(cur, host_values.data(), tensor_sz_list[i] * sizeof(dynet::real));
+#else
+        std::memcpy(cur, tensor_list[i]->v, tensor_sz_list[i] * sizeof(dynet::real));
+#endif
+        cur += tensor_sz_list[i];
+    }
+    is_taken = true;
+}
+
+/**
+ * copy the snapshot back to model.
+ * return : bool
+ *              true if restored, false if no snapshot has been taken.
+ */
+inline
+bool ParameterSnapshot::restore(dynet::Model *model) const
+{
+    if( !is_taken ){ return false; }
+    std::vector<dynet::Tensor*> tensor_list = collect_tensor(model);
+    if( tensor_list.size() != tensor_sz_list.size() )
+    {
+        throw std::logic_error("parameter snapshot: parameter number is not matched with the snapshot.");
+    }
+    const dynet::real *cur = shadow_buffer.data();
+    for( std::size_t i = 0; i < tensor_list.size(); ++i )
+    {
+        if( tensor_list[i]->d.size() != tensor_sz_list[i] )
+        {
+            throw std::logic_error("parameter snapshot: parameter size is not matched with the snapshot.");
+        }
+#if HAVE_CUDA
+        dynet::TensorTools::SetElements(*tensor_list[i], std::vector<dynet::real>(cur, cur + tensor_sz_list[i]));
+#else
+        std::memcpy(tensor_list[i]->v, cur, tensor_sz_list[i] * sizeof(dynet::real));
+#endif
+        cur += tensor_sz_list[i];
+    }
+    return true;
+}
+
+} // end of namespace slnn
+
+#endif
@@ -3,20 +3,79 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <utility>
 namespace slnn{
 
+// (offset, length) of a token in the line
+using TokenSpan = std::pair<std::size_t, std::size_t>;
+
+/**
+ * split the sequence into token spans at every delimiter (the same result as boost::split without token compress,
+ * so consecutive delimiters give an empty token, and an empty sequence gives one empty token).
+ */
+template <typename CharT, typename PredicateT>
+void split_to_spans(const CharT *seq, std::size_t len, PredicateT is_delimiter, std::vector<TokenSpan> &out_span_list)
+{
+    out_span_list.clear();
+    std::size_t token_begin = 0;
+    for( std::size_t i = 0; i < len; ++i )
+    {
+        if( is_delimiter(seq[i]) )
+        {
+            out_span_list.emplace_back(token_begin, i - token_begin);
+            token_begin = i + 1;
+        }
+    }
+    out_span_list.emplace_back(token_begin, len - token_begin);
+}
+
+// trim the white spaces of the view (the same as boost::trim for ASCII spaces).
+inline
+void trim_view(const char *&line, std::size_t &len)
+{
+    auto is_space = [](char c){ return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; };
+    while( len > 0 && is_space(line[len - 1]) ){ --len; }
+    while( len > 0 && is_space(*line) ){ ++line; --len; }
+}
+
+/**
+ * base reader.
+ * lines are read from the stream buffer block by block (the available bytes, at most `BlockSize`), and returned
+ * as views into the block, so there is no allocation or copy per line.
+ * the lines should be read only by this reader (read-ahead bytes are in the block), and `count_line` should be called
+ * before reading.
+ */
 struct Reader
 {
+    static constexpr std::size_t BlockSize = 1U << 20;
+
     Reader(std::istream &is);
     bool good();
     size_t count_line();
+    // read a line (without '\n'). the view is valid until the next reading.
+    bool readline_view(const char *&out_line, std::size_t &out_len);
 
     std::istream &is;
+private:
+    bool fill_block();
+private:
+    std::vector<char> block;
+    std::size_t block_begin;
+    std::size_t block_end;
+    std::size_t scan_pos; // no '\n' in [block_begin, scan_pos)
+    bool is_eof;
 };
 
 inline
 Reader::Reader(std::istream &is)
-    :is(is)
+    :is(is),
+    block_begin(0),
+    block_end(0),
+    scan_pos(0),
+    is_eof(false)
 {}
 
 inline
@@ -35,6 +94,12 @@ size_t Reader::count_line()
     // clear state
     is.clear();
     std::istream::streampos pos_backup = is.tellg();
+    if( pos_backup == std::istream::streampos(-1) )
+    {
+        // not seekable (pipe, stdin), the line number is unknown.
+        is.setstate(state_backup);
+        return 0;
+    }
 
     is.seekg(0);
     size_t line_cnt;
@@ -52,5 +117,90 @@ size_t Reader::count_line()
     return line_cnt;
 }
 
+inline
+bool Reader::fill_block()
+{
+    if( is_eof ){ return false; }
+    if( !is ){ is_eof = true; return false; }
+    if( block.empty() ){ block.resize(BlockSize); }
+    if( block_end == block.size() )
+    {
+        if( block_begin > 0 )
+        {
+            // move the partial line to the front
+            std::memmove(block.data(), block.data() + block_begin, block_end - block_begin);
+            block_end -= block_begin;
+            scan_pos -= block_begin;
+            block_begin = 0;
+        }
+        else{ block.resize(block.size() * 2); } // line longer than the block
+    }
+    // read what is available, so streaming input works line by line.
+    std::streambuf *sb = is.rdbuf();
+    char *dst = block.data() + block_end;
+    std::streamsize free_sz = static_cast<std::streamsize>(block.size() - block_end),
+        read_sz = 0;
+    // nothing buffered (e.g. a pipe): force an underflow, it blocks until some bytes come (or EOF).
+    if( sb->in_avail() > 0 || !std::istream::traits_type::eq_int_type(sb->sgetc(), std::istream::traits_type::eof()) )
+    {
+        std::streamsize avail_sz = sb->in_avail();
+        if( avail_sz > 0 ){ read_sz = sb->sgetn(dst, std::min(avail_sz, free_sz)); }
+        else if( sb == std::cin.rdbuf() )
+        {
+            // `std::cin` synchronized with stdio has no buffer (`in_avail` is always 0). read a line by stdio,
+            // which is what the stream buffer reads from.
+            int ch;
+            while( read_sz < free_sz && (ch = std::getc(stdin)) != EOF )
+            {
+                dst[read_sz++] = static_cast<char>(ch);
+                if( ch == '\n' ){ break; }
+            }
+        }
+        else{ read_sz = sb->sgetn(dst, 1); } // other unbuffered stream buffer
+    }
+    if( read_sz <= 0 )
+    {
+        is_eof = true;
+        is.setstate(std::ios::eofbit);
+        return false;
+    }
+    block_end += static_cast<std::size_t>(read_sz);
+    return true;
+}
+
+/**
+ * read a line as a view into the block (the same lines as std::getline).
+ * @param out_line line begin
+ * @param out_len line length, '\n' is not included
+ * @return false if no more line
+ */
+inline
+bool Reader::readline_view(const char *&out_line, std::size_t &out_len)
+{
+    while( true )
+    {
+        const char *lf = scan_pos < block_end ?
+            static_cast<const char*>(std::memchr(block.data() + scan_pos, '\n', block_end - scan_pos)) : nullptr;
+        if( lf )
+        {
+            std::size_t lf_pos = lf - block.data();
+            out_line = block.data() + block_begin;
+            out_len = lf_pos - block_begin;
+            block_begin = scan_pos = lf_pos + 1;
+            return true;
+        }
+        scan_pos = block_end;
+        if( !fill_block() )
+        {
+            if( block_begin >= block_end ){ return false; }
+            // last line without '\n'
+            out_line = block.data() + block_begin;
+            out_len = block_end - block_begin;
+            block_begin = scan_pos = block_end;
+            return true;
+        }
+    }
+}
+
 } // end of namespace slnn
 #endif
\ No newline at end of file
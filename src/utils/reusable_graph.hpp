@@ -0,0 +1,51 @@
+#ifndef SLNN_UTILS_REUSABLE_GRAPH_HPP_
+#define SLNN_UTILS_REUSABLE_GRAPH_HPP_
+
+#include "dynet/dynet.h"
+
+namespace slnn{
+
+/**
+ * one computation graph reused for all the instances.
+ * DyNet permits only one graph at the same time (in one process, so it is also the per-thread graph),
+ * constructing and destructing it for every instance rebuilds the execution engine and the node containers.
+ * here the empty graph is checkpointed once, and `renew` reverts to the checkpoint: the nodes are dropped and
+ * the memory pools of values (the DyNet arena) are rewinded to the checkpoint mark, not freed,
+ * so the same memory is used by every instance.
+ * `ComputationGraph::clear()` is not used: it keeps the evaluated node number of the execution engine,
+ * then the next forward reads the stale values of the old graph (dim error).
+ * !! dynet::initialize should be called before the construction.
+ */
+class ReusableGraph
+{
+public:
+    ReusableGraph(){ cg.checkpoint(); }
+    ReusableGraph(const ReusableGraph&) = delete;
+    ReusableGraph& operator=(const ReusableGraph&) = delete;
+    /**
+     * drop the graph of the last instance.
+     * @return the empty graph
+     */
+    dynet::ComputationGraph& renew();
+    dynet::ComputationGraph& get(){ return cg; }
+private:
+    dynet::ComputationGraph cg;
+};
+
+/*********************************************
+ * Inline Implementation
+ *********************************************/
+
+inline
+dynet::ComputationGraph& ReusableGraph::renew()
+{
+    cg.revert(); // checkpoint is popped
+    // revert only resets the evaluated number to the checkpoint node, which is underflowed for the empty graph.
+    cg.invalidate();
+    cg.checkpoint();
+    return cg;
+}
+
+} // end of namespace slnn
+
+#endif
@@ -6,13 +6,15 @@
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include "dynet/dynet.h"
+#include "parameter_snapshot.hpp"
+#include "modelmodule/viterbi_decoder.h"
 
 namespace slnn{
 
 struct CNNModelStash // we'd better change it's name to TrainingHelper
 {
     float best_score;
-    std::stringstream best_model_tmp_ss;
+    ParameterSnapshot best_model_snapshot;
     CNNModelStash(float train_error_threshold=20.f);
     bool save_when_best(dynet::Model *best_model, float current_score);
     bool load_if_exists(dynet::Model *dynet_model);
@@ -30,7 +32,6 @@ private :
 inline
 CNNModelStash::CNNModelStash(float train_error_threshold)
     :best_score(0.f),
-    best_model_tmp_ss(""),
     train_error_threshold(train_error_threshold),
     is_good(true)
 {}
@@ -47,9 +48,7 @@ bool CNNModelStash::save_when_best(dynet::Model *model, float score)
     {
         BOOST_LOG_TRIVIAL(info) << "better model has been found . stash it .";
         best_score = score;
-        best_model_tmp_ss.str(""); // first , clear it's content !
-        boost::archive::text_oarchive to(best_model_tmp_ss); // to construct an text_oarchive using stringstream
-        to << *model;
+        best_model_snapshot.take(model);
         return true ;
     }
     else { return false; }
@@ -63,13 +62,9 @@ bool CNNModelStash::save_when_best(dynet::Model *model, float score)
 inline
 bool CNNModelStash::load_if_exists(dynet::Model *dynet_model)
 {
-    if( best_model_tmp_ss.rdbuf()->in_avail() != 0 )
-    {
-        boost::archive::text_iarchive ti(best_model_tmp_ss);
-        ti >> *dynet_model;
-        return true;
-    }
-    else { return false ; }
+    bool is_loaded = best_model_snapshot.restore(dynet_model);
+    if( is_loaded ){ ViterbiDecoder::clear_all_score(); } // the decoders may cache the score of the last training step
+    return is_loaded;
 }
 
 inline
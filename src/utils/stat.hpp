@@ -10,12 +10,6 @@
 #include <stdlib.h>
 #include <chrono>
 
-#ifndef _WIN32
-#include <unistd.h>
-#else
-#include <process.h>
-#endif
-
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/core.hpp>
@@ -23,6 +17,7 @@
 
 #include "dynet/dict.h"
 #include "segmenter/cws_module/cws_tagging_system.h"
+#include "conll_chunk_eval.hpp"
 
 /*************************************
  * Stat 
@@ -123,13 +118,7 @@ using Stat = PostagStat;
 
 struct NerStat : public BasicStat
 {
-    std::string eval_script_path;
-    std::string tmp_output_path;
-    NerStat(const std::string &eval_script_path , const std::string &tmp_output_path=std::string("eval_out.tmp") , 
-            bool is_predict=false) :
-        BasicStat(is_predict),
-        eval_script_path(eval_script_path), tmp_output_path(tmp_output_path)
-    {}
+    NerStat(bool is_predict=false) : BasicStat(is_predict){}
     
     // return {ACC , P , R , F1} ( percent !)
     std::array<float , 4>
@@ -137,68 +126,7 @@ struct NerStat : public BasicStat
         const std::vector<IndexSeq> &predict_ner_seqs , 
         const dynet::Dict &ner_dict) 
     {
-        std::array<float , 4> fake_ret = {100.f , 100.f , 100.f , 100.f } ;
-#ifndef _MSC_VER
-        std::array<float, 4> ret;
-        // write `WORD GOLD_NER PREDICT_NER` to temporal output , where we using fake `WORD` , it is no use for evaluation result
-        // - set unique output path
-        unsigned timestamp = std::chrono::high_resolution_clock::now().time_since_epoch().count() ;
-        unsigned pid = static_cast<unsigned>(::getpid()) ;
-        tmp_output_path = tmp_output_path + "_" + std::to_string(pid) + "_" + std::to_string(timestamp) ;
-        std::ofstream tmp_of(tmp_output_path);
-        if (!tmp_of)
-        { 
-            BOOST_LOG_TRIVIAL(fatal) << "Failed to create temporial output file for evaltion `" << tmp_output_path
-                << "`";
-            abort();
-        }
-        for (size_t seq_idx = 0; seq_idx < predict_ner_seqs.size(); ++seq_idx)
-        {
-            const IndexSeq &ner_seq = gold_ner_seqs.at(seq_idx),
-                &predict_seq = predict_ner_seqs.at(seq_idx);
-            for (size_t token_idx = 0; token_idx < predict_seq.size(); ++token_idx)
-            {
-                tmp_of << "W" << " "
-                    << ner_dict.convert(ner_seq.at(token_idx)) << " "
-                    << ner_dict.convert(predict_seq.at(token_idx)) << "\n";
-            }
-            tmp_of << "\n"; // split of one sequence
-        }
-        tmp_of.close();
-        std::string cmd = eval_script_path + " " + tmp_output_path;
-        BOOST_LOG_TRIVIAL(info) << "Running: " << cmd << std::endl;
-        FILE* pipe = popen(cmd.c_str(), "r");
-        if (!pipe) {
-            return fake_ret ;
-        }
-        char buffer[128];
-        std::string result = "";
-        while (!feof(pipe)) {
-            if (fgets(buffer, 128, pipe) != NULL) { result += buffer; }
-        }
-        pclose(pipe);
-        // rm tmp output file
-        pipe = popen( (std::string("rm -f ") + tmp_output_path).c_str() , "r") ;
-        if(!pipe)
-        {
-            std::cerr << "Error . failed to rm temp output file : `" << tmp_output_path << "`\n" ; 
-        }
-        else
-        {
-            pclose(pipe) ;
-        }
-        std::stringstream S(result);
-        std::string token;
-        unsigned idx = 0 ;
-        while (S >> token) {
-            boost::algorithm::trim(token);
-            ret[idx++] = stof(token);
-        }
-        return ret ;
-#else
-        return fake_ret ;
-#endif
-        return fake_ret ;
+        return ConllChunkEval(ner_dict).eval(gold_ner_seqs, predict_ner_seqs);
     }
 };
 
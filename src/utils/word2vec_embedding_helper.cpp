@@ -1,3 +1,8 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
 #include <boost/log/trivial.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
@@ -8,10 +13,108 @@ using namespace std;
 using namespace dynet;
 namespace slnn{
 
-void Word2vecEmbeddingHelper::build_fixed_dict(ifstream &is, Dict &fixed_dict, const string &unk_str,
-    unsigned *p_dict_size, unsigned *p_embedding_dim)
+namespace{
+
+const char Word2vecBinaryMagic[8] = { 'S', 'L', 'N', 'N', 'W', '2', 'V', 'B' };
+constexpr std::uint32_t Word2vecBinaryVersion = 1U;
+constexpr std::uint32_t EndianTag = 0x01020304U;
+constexpr std::uint64_t SectionAlignment = 64U;
+
+struct Word2vecBinaryHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint64_t nr_word;
+    std::uint64_t embedding_dim;
+    std::uint64_t matrix_offset;
+    std::uint64_t vocab_offset;
+    std::uint64_t reserved[2];
+};
+static_assert(sizeof(Word2vecBinaryHeader) == 64U, "word2vec binary header should be 64 bytes.");
+
+std::uint64_t align_offset(std::uint64_t offset)
+{
+    return (offset + SectionAlignment - 1U) / SectionAlignment * SectionAlignment;
+}
+
+void write_padding(ostream &os, std::uint64_t from, std::uint64_t to)
+{
+    static const char zeros[SectionAlignment] = { 0 };
+    os.write(zeros, static_cast<std::streamsize>(to - from));
+}
+
+Word2vecBinaryHeader read_binary_header(istream &is)
+{
+    Word2vecBinaryHeader header;
+    if( !is.read(reinterpret_cast<char*>(&header), sizeof(header)) )
+    {
+        throw runtime_error("word2vec binary: failed to read the header.");
+    }
+    if( memcmp(header.magic, Word2vecBinaryMagic, sizeof(header.magic)) != 0 )
+    {
+        throw runtime_error("word2vec binary: magic is not matched.");
+    }
+    if( header.endian_tag != EndianTag ){ throw runtime_error("word2vec binary: byte order is not matched."); }
+    if( header.version > Word2vecBinaryVersion )
+    {
+        throw runtime_error("word2vec binary: version " + to_string(header.version) + " is not supported.");
+    }
+    return header;
+}
+
+/**
+ * read the vocabulary section. word i is word_bytes[word_end_list[i-1], word_end_list[i]).
+ * start_pos : position of the header in the stream.
+ */
+void read_binary_vocabulary(istream &is, streampos start_pos, const Word2vecBinaryHeader &header,
+    vector<std::uint64_t> &word_end_list, string &word_bytes)
+{
+    is.seekg(start_pos + static_cast<streamoff>(header.vocab_offset));
+    word_end_list.resize(static_cast<size_t>(header.nr_word));
+    is.read(reinterpret_cast<char*>(word_end_list.data()), word_end_list.size() * sizeof(std::uint64_t));
+    for( size_t i = 1; i < word_end_list.size(); ++i )
+    {
+        if( word_end_list[i - 1] > word_end_list[i] ){ throw runtime_error("word2vec binary: broken vocabulary."); }
+    }
+    word_bytes.resize(word_end_list.empty() ? 0U : static_cast<size_t>(word_end_list.back()));
+    if( !word_bytes.empty() ){ is.read(&word_bytes[0], word_bytes.size()); }
+    if( !is ){ throw runtime_error("word2vec binary: failed to read the vocabulary."); }
+}
+
+} // end of anonymous namespace
+
+void Word2vecEmbeddingHelper::build_fixed_dict(istream &is, Dict &fixed_dict, const string &unk_str,
+    unsigned *p_dict_size, unsigned *p_embedding_dim, const unordered_set<string> *p_vocab_filter)
 {
     BOOST_LOG_TRIVIAL(info) << "initialize fixed dict .";
+    auto is_in_vocab = [p_vocab_filter](const string &word)
+    {
+        return p_vocab_filter == nullptr || p_vocab_filter->count(word) != 0;
+    };
+    if( is_binary_format(is) )
+    {
+        // only the vocabulary section is read.
+        streampos start_pos = is.tellg();
+        Word2vecBinaryHeader header = read_binary_header(is);
+        vector<std::uint64_t> word_end_list;
+        string word_bytes,
+            word;
+        read_binary_vocabulary(is, start_pos, header, word_end_list, word_bytes);
+        std::uint64_t word_begin = 0;
+        for( std::uint64_t word_end : word_end_list )
+        {
+            word.assign(word_bytes, static_cast<size_t>(word_begin), static_cast<size_t>(word_end - word_begin));
+            word_begin = word_end;
+            if( is_in_vocab(word) ){ fixed_dict.convert(word); }
+        }
+        fixed_dict.freeze();
+        fixed_dict.set_unk(unk_str);
+        if( p_dict_size ){ *p_dict_size = fixed_dict.size(); }
+        if( p_embedding_dim ){ *p_embedding_dim = static_cast<unsigned>(header.embedding_dim); }
+        BOOST_LOG_TRIVIAL(info) << "build fixed dict done (binary embedding) .";
+        return;
+    }
     std::string line;
     std::vector<std::string> split_cont;
     getline(is, line); // first line should be the infomation : word-dict-size , word-embedding-dimension
@@ -40,14 +143,14 @@ void Word2vecEmbeddingHelper::build_fixed_dict(ifstream &is, Dict &fixed_dict, c
         std::string::size_type delim_pos = line.find(" ");
         assert(delim_pos != std::string::npos);
         std::string word = line.substr(0, delim_pos);
-        fixed_dict.convert(word);  // add to dict
+        if( is_in_vocab(word) ){ fixed_dict.convert(word); } // add to dict
     }
     //  freeze & add unk to fixed_dict
     fixed_dict.freeze();
     fixed_dict.set_unk(unk_str);
     if( p_dict_size )
     {
-        if( is_standard_word2vec_format ){ assert(fixed_dict_sz == fixed_dict.size()) ; }
+        if( is_standard_word2vec_format && !p_vocab_filter ){ assert(fixed_dict_sz == fixed_dict.size()) ; }
         *p_dict_size = fixed_dict.size() ;
     }
     if( p_embedding_dim ){ *p_embedding_dim = fixed_word_dim; }
@@ -55,11 +158,78 @@ void Word2vecEmbeddingHelper::build_fixed_dict(ifstream &is, Dict &fixed_dict, c
     BOOST_LOG_TRIVIAL(info) << "build fixed dict done .";
 }
 
-void Word2vecEmbeddingHelper::load_fixed_embedding(std::ifstream &is, dynet::Dict &fixed_dict, unsigned fixed_word_dim, dynet::LookupParameter fixed_lookup_param)
+void Word2vecEmbeddingHelper::load_fixed_embedding(std::istream &is, dynet::Dict &fixed_dict, unsigned fixed_word_dim, dynet::LookupParameter fixed_lookup_param)
 {
     // set lookup parameters from outer word embedding
     // using words_loopup_param.initialize( word_id , value_vector )
     BOOST_LOG_TRIVIAL(info) << "load pre-trained word embedding .";
+    if( is_binary_format(is) )
+    {
+        streampos start_pos = is.tellg();
+        Word2vecBinaryHeader header = read_binary_header(is);
+        if( header.embedding_dim != fixed_word_dim )
+        {
+            throw invalid_argument("word2vec binary: embedding dimension (" + to_string(header.embedding_dim) +
+                ") is not matched with the fixed word dimension (" + to_string(fixed_word_dim) + ").");
+        }
+        vector<std::uint64_t> word_end_list;
+        string word_bytes,
+            word;
+        read_binary_vocabulary(is, start_pos, header, word_end_list, word_bytes);
+        // rows are read directly into the parameter memory. consecutive rows whose parameter memory is also
+        // consecutive are read by one `read`, so it is one read of the whole matrix for a dict built from the same file.
+        // (with the CUDA backend, rows are read one by one through the host.)
+        dynet::LookupParameterStorage *p_storage = fixed_lookup_param.get();
+        std::uint64_t row_sz = static_cast<std::uint64_t>(fixed_word_dim) * sizeof(float);
+        std::uint64_t word_begin = 0,
+            run_row = 0,
+            run_len = 0;
+        dynet::real *run_dest = nullptr;
+        unsigned long nr_loaded = 0;
+#if HAVE_CUDA
+        std::vector<dynet::real> row_value(fixed_word_dim);
+#endif
+        auto read_run = [&]()
+        {
+            if( run_len == 0 ){ return; }
+            is.seekg(start_pos + static_cast<streamoff>(header.matrix_offset + run_row * row_sz));
+            if( !is.read(reinterpret_cast<char*>(run_dest), static_cast<streamsize>(run_len * row_sz)) )
+            {
+                throw runtime_error("word2vec binary: failed to read the embedding matrix.");
+            }
+            nr_loaded += run_len;
+            run_len = 0;
+        };
+        for( std::uint64_t row = 0; row < word_end_list.size(); ++row )
+        {
+            word.assign(word_bytes, static_cast<size_t>(word_begin), static_cast<size_t>(word_end_list[row] - word_begin));
+            word_begin = word_end_list[row];
+            if( !fixed_dict.contains(word) ){ continue; } // filtered
+#if HAVE_CUDA
+            // the parameter memory is on device, read the row to host and copy it by `initialize`.
+            is.seekg(start_pos + static_cast<streamoff>(header.matrix_offset + row * row_sz));
+            if( !is.read(reinterpret_cast<char*>(row_value.data()), static_cast<streamsize>(row_sz)) )
+            {
+                throw runtime_error("word2vec binary: failed to read the embedding matrix.");
+            }
+            fixed_lookup_param.initialize(fixed_dict.convert(word), row_value);
+            ++nr_loaded;
+            continue;
+#endif
+            dynet::real *dest = p_storage->values.at(static_cast<size_t>(fixed_dict.convert(word))).v;
+            if( run_len > 0 && row == run_row + run_len && dest == run_dest + run_len * fixed_word_dim ){ ++run_len; }
+            else
+            {
+                read_run();
+                run_row = row;
+                run_dest = dest;
+                run_len = 1;
+            }
+        }
+        read_run();
+        BOOST_LOG_TRIVIAL(info) << "load fixed embedding done (binary embedding, " << nr_loaded << " words) .";
+        return;
+    }
     std::string line;
     std::vector<std::string> split_cont;
     getline(is, line); // first line is the infomation , skip
@@ -76,6 +246,7 @@ void Word2vecEmbeddingHelper::load_fixed_embedding(std::ifstream &is, dynet::Dic
             continue;
         }
         std::string &word = split_cont.at(0);
+        if( !fixed_dict.contains(word) ){ continue; } // filtered
         Index word_id = fixed_dict.convert(word);
         for( size_t idx = 1; idx < split_cont.size(); ++idx )
         {
@@ -107,4 +278,94 @@ float Word2vecEmbeddingHelper::calc_hit_rate(dynet::Dict &fixed_dict, dynet::Dic
     return hit_rate;
 }
 
+unsigned long Word2vecEmbeddingHelper::convert_to_binary(std::istream &text_is, std::ostream &binary_os,
+    const std::unordered_set<std::string> *p_vocab_filter)
+{
+    BOOST_LOG_TRIVIAL(info) << "convert word2vec embedding to binary format .";
+    streampos start_pos = binary_os.tellp();
+    std::string line,
+        word;
+    // the first line is the infomation (word number and dimension), or the first embedding.
+    if( !getline(text_is, line) ){ throw runtime_error("word2vec text: empty embedding."); }
+    std::vector<std::string> split_cont;
+    boost::trim_right(line);
+    boost::split(split_cont, line, boost::is_any_of(" "));
+    bool is_info_line = split_cont.size() == 2U;
+    std::uint64_t embedding_dim = is_info_line ? std::stoul(split_cont[1]) : split_cont.size() - 1U;
+    // the rows are written as read, the header is written at last.
+    Word2vecBinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    binary_os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    header.matrix_offset = align_offset(sizeof(header));
+    write_padding(binary_os, sizeof(header), header.matrix_offset);
+    std::vector<float> embedding_vec(static_cast<size_t>(embedding_dim), 0.f);
+    std::vector<std::uint64_t> word_end_list;
+    std::string word_bytes;
+    unsigned long line_cnt = 0;
+    // parse by strtof on the line, no split.
+    auto convert_line = [&](const std::string &text_line)
+    {
+        std::string::size_type delim_pos = text_line.find(' ');
+        if( delim_pos == std::string::npos ){ return false; }
+        word.assign(text_line, 0, delim_pos);
+        if( p_vocab_filter && p_vocab_filter->count(word) == 0 ){ return true; }
+        const char *p = text_line.c_str() + delim_pos;
+        char *end = nullptr;
+        std::uint64_t nr_value = 0;
+        for( float val = std::strtof(p, &end); end != p; val = std::strtof(p, &end) )
+        {
+            if( nr_value < embedding_dim ){ embedding_vec[static_cast<size_t>(nr_value)] = val; }
+            ++nr_value;
+            p = end;
+        }
+        if( nr_value != embedding_dim ){ return false; }
+        binary_os.write(reinterpret_cast<const char*>(embedding_vec.data()), embedding_vec.size() * sizeof(float));
+        word_bytes += word;
+        word_end_list.push_back(word_bytes.size());
+        return true;
+    };
+    bool has_line = !is_info_line;
+    while( has_line || getline(text_is, line) )
+    {
+        has_line = false;
+        ++line_cnt;
+        if( !convert_line(line) ){ BOOST_LOG_TRIVIAL(warning) << "bad embedding line at " << line_cnt << " , skipped ."; }
+    }
+    header.nr_word = word_end_list.size();
+    std::uint64_t matrix_end = header.matrix_offset + header.nr_word * embedding_dim * sizeof(float);
+    header.vocab_offset = align_offset(matrix_end);
+    write_padding(binary_os, matrix_end, header.vocab_offset);
+    binary_os.write(reinterpret_cast<const char*>(word_end_list.data()), word_end_list.size() * sizeof(std::uint64_t));
+    binary_os.write(word_bytes.data(), word_bytes.size());
+    // header
+    std::memcpy(header.magic, Word2vecBinaryMagic, sizeof(header.magic));
+    header.version = Word2vecBinaryVersion;
+    header.endian_tag = EndianTag;
+    header.embedding_dim = embedding_dim;
+    binary_os.seekp(start_pos);
+    binary_os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    binary_os.seekp(0, std::ios::end);
+    if( !binary_os ){ throw runtime_error("word2vec binary: failed to write."); }
+    BOOST_LOG_TRIVIAL(info) << "convert done . " << header.nr_word << " words with dimension " << embedding_dim << " .";
+    return static_cast<unsigned long>(header.nr_word);
+}
+
+bool Word2vecEmbeddingHelper::is_binary_format(std::istream &is)
+{
+    streampos pos = is.tellg();
+    char magic[sizeof(Word2vecBinaryMagic)] = { 0 };
+    is.read(magic, sizeof(magic));
+    bool is_binary = is.gcount() == static_cast<std::streamsize>(sizeof(magic)) &&
+        std::memcmp(magic, Word2vecBinaryMagic, sizeof(magic)) == 0;
+    is.clear();
+    is.seekg(pos);
+    return is_binary;
+}
+
+void Word2vecEmbeddingHelper::read_vocabulary(std::istream &is, std::unordered_set<std::string> &vocab)
+{
+    std::string word;
+    while( is >> word ){ vocab.insert(word); }
+}
+
 } // end of namespace slnn
@@ -1,20 +1,33 @@
 #ifndef UTILS_WORD2VEC_EMBEDDING_HELPER_H_
 #define UTILS_WORD2VEC_EMBEDDING_HELPER_H_
 
+#include <iostream>
 #include <fstream>
+#include <string>
+#include <unordered_set>
 
 #include "dynet/dynet.h"
 #include "dynet/dict.h"
 
 namespace slnn{
+
+/*
+ * pre-trained embedding in word2vec text format, or in binary format (converted by `convert_to_binary`).
+ * the format is detected by the magic, so the binary file can be used anywhere the text file is used.
+ * binary layout (host byte order, `endian_tag` is checked when reading):
+ *   1. header (64 bytes, see `Word2vecBinaryHeader` in the implementation)
+ *   2. matrix: nr_word * embedding_dim float32, row i for word i. 64 bytes aligned.
+ *   3. vocabulary: nr_word uint64 end offsets of words, then the words bytes.
+ * so the dict is built without parsing the floats, and the rows are read into the lookup parameter by bulk.
+ */
 struct Word2vecEmbeddingHelper
 {
     /* bulid_fixed_dict
     *
     * PARAMES
     * -------
-    * is : [in] , ifstream .
-    *      reference to wordembedding file stream
+    * is : [in] , istream .
+    *      reference to wordembedding file stream (text or binary)
     * fixed_dict : [in], dynet::Dict
     *              reference to fixed dict ,
     * unk_str : [in] , string
@@ -23,34 +36,60 @@ struct Word2vecEmbeddingHelper
     *             after build the dict , set the dict size(if given)
     * embedding_dim : [out] , pointer to unsigned [optional]
     *                 after build the dict , set the embedding dim (if given)
+    * vocab_filter : [in] , pointer to word set [optional]
+    *                only words in the set are added to the dict (if given)
     * RETURN
     * ------
     * void
     */
     static
-        void build_fixed_dict(std::ifstream &is, dynet::Dict &fixed_dict, const std::string &unk_str,
-            unsigned *p_dict_size = nullptr, unsigned *p_embedding_dim = nullptr);
+        void build_fixed_dict(std::istream &is, dynet::Dict &fixed_dict, const std::string &unk_str,
+            unsigned *p_dict_size = nullptr, unsigned *p_embedding_dim = nullptr,
+            const std::unordered_set<std::string> *p_vocab_filter = nullptr);
 
     /* load_fixed_embedding
     * PARAMES
     * -------
-    * is : [in] , ifstream
-    *      wordembedding fstream
+    * is : [in] , istream
+    *      wordembedding stream (text or binary), at the beginning.
     * fixed_dict : [in], dynet::Dict&
-    *      dict to map word 2 index
+    *      dict to map word 2 index, words out of the dict are skipped.
     * fixed_word_dim : [in], unsigned
            for check when loading word embedding
-    * fixed_lookup_param : [in], dynet::LookupParameter 
+    * fixed_lookup_param : [in], dynet::LookupParameter
     *      to store the word embedding
     * RETURN
     * ------
     * void
     */
     static
-        void load_fixed_embedding(std::ifstream &is, dynet::Dict &fixed_dict, unsigned fixed_word_dim, dynet::LookupParameter fixed_lookup_param);
+        void load_fixed_embedding(std::istream &is, dynet::Dict &fixed_dict, unsigned fixed_word_dim, dynet::LookupParameter fixed_lookup_param);
 
     static float calc_hit_rate(dynet::Dict &fixed_dict, dynet::Dict &dynamic_dict, const std::string &fixed_dict_unk_str);
+
+    /* convert_to_binary
+    * PARAMES
+    * -------
+    * text_is : [in] , istream
+    *      wordembedding in word2vec text format
+    * binary_os : [in] , ostream
+    *      output stream (opened in binary mode, seekable)
+    * vocab_filter : [in] , pointer to word set [optional]
+    *      only words in the set are converted (if given)
+    * RETURN
+    * ------
+    * number of words converted
+    */
+    static
+        unsigned long convert_to_binary(std::istream &text_is, std::ostream &binary_os,
+            const std::unordered_set<std::string> *p_vocab_filter = nullptr);
+
+    // detect the binary format by magic. the stream position is not changed.
+    static bool is_binary_format(std::istream &is);
+
+    // add the white-space separated words of the stream to vocab.
+    static void read_vocabulary(std::istream &is, std::unordered_set<std::string> &vocab);
 };
 
 } // end of namespace slnn
-#endif 
\ No newline at end of file
+#endif